@@ -44,10 +44,12 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include "GmCommon.h"
 #include "GridNode.h"
 #include "IntensityMeasureWidget.h"
+#include "LocalRecordSelector.h"
 #include "MapViewSubWidget.h"
 #include "NGAW2Converter.h"
 #include "RecordSelectionWidget.h"
 #include "RuptureWidget.h"
+#include "SiteClusteredRecordSelector.h"
 #include "SimCenterPreferences.h"
 #include "SiteConfigWidget.h"
 #include "SiteGridWidget.h"
@@ -79,6 +81,10 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <QFile>
 #include <QFileInfo>
 #include <QList>
+#include <QRegularExpression>
+#include <QSet>
+#include <QTextStream>
+#include <QtConcurrent>
 #include <QPlainTextEdit>
 #include <QDialog>
 #include <QJsonObject>
@@ -86,8 +92,235 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <QStringList>
 #include <QString>
 
+#include <cmath>
+
 using namespace Esri::ArcGISRuntime;
 
+namespace
+{
+// The inputs of the local selection of the records, gathered on the UI thread so that the selection can run on a worker thread
+struct ClusteredSelectionInputs
+{
+    QString pathToOutputDirectory;
+    QString pathToFlatfile;
+    RecordSelectionConfig::ErrorMetric errorMetric;
+    double minScaleFactor;
+    double maxScaleFactor;
+    double clusterTolerance;
+    int numGM;
+    QVariant magnitudeRange;
+    QVariant distanceRange;
+    QVariant vs30Range;
+};
+
+
+// Selects the records from the local flatfile for the spectra of the sites saved by the hazard simulation, once for each cluster of sites with similar spectra
+// The message is shown in the progress dialog
+int selectLocalRecords(const ClusteredSelectionInputs& inputs, QString& message, QString& errorMessage)
+{
+    auto pathToOutputDirectory = inputs.pathToOutputDirectory;
+
+    // The intensity measures that the hazard simulation saves for each site, listed in a grid file like the one of the records
+    QString pathToIMGrid = pathToOutputDirectory + "IMs" + QDir::separator() + "EventGrid.csv";
+
+    if(!QFileInfo::exists(pathToIMGrid))
+    {
+        message = "The intensity measures of the sites were not found at " + pathToIMGrid + ", the records selected by the hazard simulation are used.\n";
+        return 0;
+    }
+
+    CSVReaderWriter csvTool;
+
+    QString err;
+    auto gridData = csvTool.parseCSVFile(pathToIMGrid, err);
+
+    if(!err.isEmpty())
+    {
+        errorMessage = err;
+        return -1;
+    }
+
+    if(gridData.size() < 2)
+    {
+        errorMessage = "The grid file " + pathToIMGrid + " does not list any sites";
+        return -1;
+    }
+
+    gridData.pop_front();
+
+    auto numSites = gridData.size();
+
+    // The target spectrum of each site is the geometric mean of the simulated spectral accelerations, the sites are read in parallel
+    QRegularExpression periodExpression("^S[Aa]\\s*[\\(_]\\s*([0-9]*\\.?[0-9]+)\\s*\\)?$");
+
+    QVector<QVector<double>> sitePeriods(numSites);
+    QVector<QVector<double>> siteSpectra(numSites);
+    QVector<QString> siteErrors(numSites);
+
+    auto periodsData = sitePeriods.data();
+    auto spectraData = siteSpectra.data();
+    auto siteErrorsData = siteErrors.data();
+
+    QVector<int> sites(numSites);
+    for(int i = 0; i<numSites; ++i)
+        sites[i] = i;
+
+    QtConcurrent::blockingMap(sites, [&](const int i)
+    {
+        const auto& row = gridData.at(i);
+
+        if(row.size() < 3)
+        {
+            siteErrorsData[i] = "The row " + QString::number(i + 1) + " of the grid file " + pathToIMGrid + " should have the file, longitude and latitude of the site";
+            return;
+        }
+
+        auto pathToSiteFile = QFileInfo(pathToIMGrid).dir().absolutePath() + QDir::separator() + row.at(0);
+
+        CSVReaderWriter siteCSVTool;
+
+        auto siteData = siteCSVTool.parseCSVFile(pathToSiteFile, siteErrorsData[i]);
+
+        if(!siteErrorsData[i].isEmpty())
+            return;
+
+        if(siteData.size() < 2)
+        {
+            siteErrorsData[i] = "The file " + pathToSiteFile + " does not have any intensity measures";
+            return;
+        }
+
+        const auto& headers = siteData.first();
+
+        for(int j = 0; j<headers.size(); ++j)
+        {
+            auto match = periodExpression.match(headers.at(j).trimmed());
+
+            if(!match.hasMatch())
+                continue;
+
+            auto logSum = 0.0;
+
+            for(int k = 1; k<siteData.size(); ++k)
+            {
+                auto Sa = siteData.at(k).value(j).toDouble();
+
+                if(Sa <= 0.0)
+                {
+                    siteErrorsData[i] = "The spectral accelerations in the file " + pathToSiteFile + " should be greater than zero";
+                    return;
+                }
+
+                logSum += std::log(Sa);
+            }
+
+            periodsData[i].push_back(match.captured(1).toDouble());
+            spectraData[i].push_back(std::exp(logSum/(siteData.size() - 1)));
+        }
+    });
+
+    for(auto&& it : siteErrors)
+    {
+        if(!it.isEmpty())
+        {
+            errorMessage = it;
+            return -1;
+        }
+    }
+
+    auto periods = sitePeriods.first();
+
+    if(periods.isEmpty())
+    {
+        errorMessage = "The intensity measures of the sites do not include any spectral accelerations";
+        return -1;
+    }
+
+    for(auto&& it : sitePeriods)
+    {
+        if(it != periods)
+        {
+            errorMessage = "The spectral accelerations of all of the sites should be at the same periods";
+            return -1;
+        }
+    }
+
+    LocalRecordSelector recordSelector;
+
+    if(recordSelector.openFlatfile(inputs.pathToFlatfile, errorMessage) != 0)
+        return -1;
+
+    recordSelector.setErrorMetric(inputs.errorMetric);
+    recordSelector.setScaleFactorBounds(inputs.minScaleFactor, inputs.maxScaleFactor);
+
+    SiteClusteredRecordSelector clusteredSelector;
+    clusteredSelector.setTolerance(inputs.clusterTolerance);
+
+    QVector<QVector<RecordMatch>> siteRecords;
+    QVector<int> siteClusters;
+
+    if(clusteredSelector.selectRecords(recordSelector, periods, siteSpectra, inputs.numGM, inputs.magnitudeRange, inputs.distanceRange, inputs.vs30Range, siteRecords, siteClusters, errorMessage) != 0)
+        return -1;
+
+    // Replace the records selected by the hazard simulation with a file of the records and their scale factors for each site
+    QVector<QStringList> eventGridData;
+    eventGridData.push_back({"GP_file", "Longitude", "Latitude"});
+
+    QSet<int> clusters;
+    QSet<int> uniqueRecords;
+    QStringList recordsToDownload;
+
+    for(int i = 0; i<numSites; ++i)
+    {
+        const auto& row = gridData.at(i);
+
+        QVector<QStringList> siteData;
+        siteData.push_back({"TH_file", "factor"});
+
+        for(auto&& it : siteRecords.at(i))
+        {
+            auto recordName = "RSN" + QString::number(it.recordSequenceNumber);
+
+            siteData.push_back({recordName, QString::number(it.scaleFactor, 'g', 10)});
+
+            if(!uniqueRecords.contains(it.recordSequenceNumber))
+            {
+                uniqueRecords.insert(it.recordSequenceNumber);
+                recordsToDownload.append(QString::number(it.recordSequenceNumber));
+            }
+        }
+
+        if(csvTool.saveCSVFile(siteData, pathToOutputDirectory + row.at(0), errorMessage) != 0)
+            return -1;
+
+        eventGridData.push_back({row.at(0), row.at(1), row.at(2)});
+
+        clusters.insert(siteClusters.at(i));
+    }
+
+    if(csvTool.saveCSVFile(eventGridData, pathToOutputDirectory + "EventGrid.csv", errorMessage) != 0)
+        return -1;
+
+    QFile recordsListFile(pathToOutputDirectory + "RSN.csv");
+
+    if(!recordsListFile.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        errorMessage = "Could not open the file " + recordsListFile.fileName() + " for writing";
+        return -1;
+    }
+
+    QTextStream out(&recordsListFile);
+    out << recordsToDownload.join(",") << "\n";
+    recordsListFile.close();
+
+    message = "The records of " + QString::number(numSites) + " sites were selected for " + QString::number(clusters.size())
+            + " clusters of sites, " + QString::number(recordsToDownload.size()) + " unique records.\n";
+
+    return 0;
+}
+}
+
+
 GMWidget::GMWidget(QWidget *parent, VisualizationWidget* visWidget) : SimCenterAppWidget(parent), theVisualizationWidget(visWidget)
 {
     initAppConfig();
@@ -97,6 +330,9 @@ GMWidget::GMWidget(QWidget *parent, VisualizationWidget* visWidget) : SimCenterA
     progressTextEdit = nullptr;
 
     process = new QProcess(this);
+
+    selectionWatcher = new QFutureWatcher<int>(this);
+    connect(selectionWatcher, &QFutureWatcher<int>::finished, this, &GMWidget::handleClusteredSelectionFinished);
     connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this, &GMWidget::handleProcessFinished);
     connect(process, &QProcess::readyReadStandardOutput, this, &GMWidget::handleProcessTextOutput);
     connect(process, &QProcess::started, this, &GMWidget::handleProcessStarted);
@@ -166,7 +402,8 @@ GMWidget::GMWidget(QWidget *parent, VisualizationWidget* visWidget) : SimCenterA
 
 GMWidget::~GMWidget()
 {
-
+    // The worker thread of the local selection writes to the members
+    selectionWatcher->waitForFinished();
 }
 
 
@@ -374,11 +611,26 @@ GMWidget::outputAppDataToJSON(QJsonObject &jsonObj) {
     jsonObj["Application"] = "EQSS";
 
     QJsonObject appData;
+    appData["RecordSelection"] = m_selectionconfig->getJson();
     jsonObj["ApplicationData"]=appData;
 
     return true;
 }
 
+
+bool GMWidget::inputAppDataFromJSON(QJsonObject &jsonObject)
+{
+    auto appData = jsonObject["ApplicationData"].toObject();
+
+    if(appData.contains("RecordSelection"))
+    {
+        m_selectionconfig->setJson(appData["RecordSelection"].toObject());
+        m_selectionWidget->updateFromConfig();
+    }
+
+    return true;
+}
+
 bool GMWidget::outputToJSON(QJsonObject &jsonObj)
 {
     /*
@@ -624,6 +876,72 @@ void GMWidget::handleProcessFinished(int exitCode, QProcess::ExitStatus exitStat
         return;
     }
 
+    // Select the records on this machine, once for each cluster of sites with similar spectra, when a local flatfile is given
+    // The records are downloaded once the selection is finished
+    if(!m_selectionconfig->getFlatfilePath().isEmpty())
+    {
+        this->selectClusteredRecords();
+        return;
+    }
+
+    this->startDownload();
+}
+
+
+void GMWidget::selectClusteredRecords(void)
+{
+    progressTextEdit->appendPlainText("Selecting the ground motion records from the local flatfile.\n");
+
+    auto scalingObj = spatialCorrWidget->getJsonScaling();
+
+    ClusteredSelectionInputs inputs;
+    inputs.pathToOutputDirectory = m_appConfig->getOutputDirectoryPath() + QDir::separator();
+    inputs.pathToFlatfile = m_selectionconfig->getFlatfilePath();
+    inputs.errorMetric = m_selectionconfig->getError();
+    inputs.minScaleFactor = scalingObj.value("Minimum").toDouble();
+    inputs.maxScaleFactor = scalingObj.value("Maximum").toDouble();
+    inputs.clusterTolerance = m_selectionconfig->getClusterTolerance();
+    inputs.numGM = m_siteConfigWidget->getNumberOfGMPerSite();
+    inputs.magnitudeRange = m_selectionconfig->getMagnitudeRange();
+    inputs.distanceRange = m_selectionconfig->getDistanceRange();
+    inputs.vs30Range = m_selectionconfig->getVs30Range();
+
+    auto message = &selectionMessage;
+    auto errMsg = &selectionErrMsg;
+
+    message->clear();
+    errMsg->clear();
+
+    this->m_runButton->setEnabled(false);
+
+    selectionWatcher->setFuture(QtConcurrent::run([inputs, message, errMsg]()
+    {
+        return selectLocalRecords(inputs, *message, *errMsg);
+    }));
+}
+
+
+void GMWidget::handleClusteredSelectionFinished(void)
+{
+    this->m_runButton->setEnabled(true);
+
+    if(!selectionMessage.isEmpty())
+        progressTextEdit->appendPlainText(selectionMessage);
+
+    if(selectionWatcher->result() != 0)
+    {
+        this->handleErrorMessage(selectionErrMsg);
+        progressBar->hide();
+
+        return;
+    }
+
+    this->startDownload();
+}
+
+
+void GMWidget::startDownload(void)
+{
     progressTextEdit->appendPlainText("Contacting PEER server to download ground motion records.\n");
 
     QApplication::processEvents();
@@ -885,20 +1203,10 @@ int GMWidget::processDownloadedRecords(QString& errorMessage)
         // create the feature attributes
         QMap<QString, QVariant> featureAttributes;
 
-        auto vecGMs = GMStation.getStationGroundMotions();
-        featureAttributes.insert("Number of Ground Motions", vecGMs.size());
-
-        QString GMNames;
-        for(int i = 0; i<vecGMs.size(); ++i)
-        {
-            auto GMName = vecGMs.at(i).getName();
+        // Only the metadata of the records is needed for the attributes
+        featureAttributes.insert("Number of Ground Motions", GMStation.getNumberOfGroundMotions());
 
-            GMNames.append(GMName);
-
-            if(i != vecGMs.size()-1)
-                GMNames.append(", ");
-
-        }
+        QString GMNames = GMStation.getGroundMotionNames().join(", ");
 
         featureAttributes.insert("Station Name", stationName);
         featureAttributes.insert("Ground Motions", GMNames);
@@ -951,6 +1259,22 @@ int GMWidget::parseDownloadedRecords(QString zipFile)
 
     NGAW2Converter tool;
 
+    // The records are baseline corrected, filtered and resampled before they are written if it is selected
+    GroundMotionSignalProcessor processor;
+    processor.setLowCutFrequency(m_selectionconfig->getLowCutFrequency());
+    processor.setHighCutFrequency(m_selectionconfig->getHighCutFrequency());
+    processor.setTargetTimeStep(m_selectionconfig->getTargetTimeStep());
+
+    if(m_selectionconfig->getProcessRecords() && processor.getLowCutFrequency() > 0.0 && processor.getHighCutFrequency() > 0.0 && processor.getLowCutFrequency() >= processor.getHighCutFrequency())
+    {
+        QString errMsg = "The low cut frequency of the filter should be less than the high cut frequency";
+        this->handleErrorMessage(errMsg);
+        return -1;
+    }
+
+    tool.setProcessingEnabled(m_selectionconfig->getProcessRecords());
+    tool.setSignalProcessor(processor);
+
     // Import the search results overview file provided by the PEER Ground Motion Database for this batch - this file will get overwritten on the next batch
     QString errMsg;
     auto res1 = tool.parseNGAW2SearchResults(pathToOutputDirectory,NGA2Results,errMsg);
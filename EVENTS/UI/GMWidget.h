@@ -42,6 +42,7 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include "GroundMotionStation.h"
 #include "PeerNgaWest2Client.h"
 
+#include <QFutureWatcher>
 #include <QProcess>
 #include <QJsonObject>
 
@@ -82,6 +83,7 @@ public:
     ~GMWidget();
 
     bool outputAppDataToJSON(QJsonObject &jsonObject);
+    bool inputAppDataFromJSON(QJsonObject &jsonObject);
     bool outputToJSON(QJsonObject &jsonObject);
     bool inputFromJSON(QJsonObject &jsonObject);
     void saveAppSettings();
@@ -119,6 +121,9 @@ public slots:
 
 private slots:
 
+    // Downloads the records once the local selection is finished
+    void handleClusteredSelectionFinished(void);
+
 private:
     PeerNgaWest2Client peerClient;
 
@@ -153,6 +158,18 @@ private:
 
     int processDownloadedRecords(QString& errorMessage);
 
+    // Selects the records from the local flatfile for the spectra of the sites saved by the hazard simulation on a worker thread, once for each cluster of sites with similar spectra
+    void selectClusteredRecords(void);
+
+    // Starts the download of the selected records from the PEER server
+    void startDownload(void);
+
+    QFutureWatcher<int>* selectionWatcher;
+
+    // Written by the worker thread of the local selection
+    QString selectionMessage;
+    QString selectionErrMsg;
+
     void handleErrorMessage(const QString& errorMessage);
 
     int numDownloaded;
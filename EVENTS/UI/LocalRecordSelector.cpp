@@ -0,0 +1,494 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "LocalRecordSelector.h"
+
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace
+{
+// The number of records that are handled together, the sums of a chunk of records stay in the cache while the periods are swept
+const int chunkSize = 2048;
+
+// The bounds of a range, or an unbounded range if the variant does not hold a range
+QPair<double, double> toRange(const QVariant& range)
+{
+    if(!range.isValid() || range.isNull())
+        return qMakePair(-std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity());
+
+    return range.value<QPair<double, double>>();
+}
+
+bool isInRange(const double value, const QPair<double, double>& range)
+{
+    if(std::isinf(range.first) && std::isinf(range.second))
+        return true;
+
+    return value >= range.first && value <= range.second;
+}
+}
+
+
+LocalRecordSelector::LocalRecordSelector()
+{
+    errorMetric = RecordSelectionConfig::ErrorMetric::RMSE;
+    minScaleFactor = 0.1;
+    maxScaleFactor = 20.0;
+}
+
+
+int LocalRecordSelector::openFlatfile(const QString& pathToFile, QString& errMsg)
+{
+    return flatfile.open(pathToFile, errMsg);
+}
+
+
+const NGAWest2Flatfile& LocalRecordSelector::getFlatfile(void) const
+{
+    return flatfile;
+}
+
+
+RecordSelectionConfig::ErrorMetric LocalRecordSelector::getErrorMetric() const
+{
+    return errorMetric;
+}
+
+
+void LocalRecordSelector::setErrorMetric(const RecordSelectionConfig::ErrorMetric& value)
+{
+    errorMetric = value;
+}
+
+
+double LocalRecordSelector::getMinScaleFactor() const
+{
+    return minScaleFactor;
+}
+
+
+double LocalRecordSelector::getMaxScaleFactor() const
+{
+    return maxScaleFactor;
+}
+
+
+void LocalRecordSelector::setScaleFactorBounds(const double minFactor, const double maxFactor)
+{
+    minScaleFactor = minFactor;
+    maxScaleFactor = maxFactor;
+}
+
+
+int LocalRecordSelector::selectRecords(const QList<QPair<double, double>>& spectrum, const int nRecords, QVariant magnitudeRange, QVariant distanceRange, QVariant vs30Range,
+                                       QVector<RecordMatch>& matches, QString& errMsg) const
+{
+    matches.clear();
+
+    if(!flatfile.isOpen())
+    {
+        errMsg = "The flatfile of the records is not open";
+        return -1;
+    }
+
+    if(nRecords <= 0)
+    {
+        errMsg = "The number of records to select should be greater than zero";
+        return -1;
+    }
+
+    if(minScaleFactor <= 0.0 || maxScaleFactor < minScaleFactor)
+    {
+        errMsg = "The minimum scaling factor should be greater than zero and less than the maximum scaling factor";
+        return -1;
+    }
+
+    // The log of the target at the periods of the flatfile that it covers
+    QVector<int> periodIndices;
+    QVector<double> logTarget;
+
+    if(this->interpolateTarget(spectrum, periodIndices, logTarget, errMsg) != 0)
+        return -1;
+
+    auto numTargetPeriods = periodIndices.size();
+
+    auto numRecords = flatfile.getNumberOfRecords();
+
+    auto magnitudes = flatfile.getMagnitudes();
+    auto distances = flatfile.getRuptureDistances();
+    auto vs30s = flatfile.getVs30s();
+
+    auto magnitudeBounds = toRange(magnitudeRange);
+    auto distanceBounds = toRange(distanceRange);
+    auto vs30Bounds = toRange(vs30Range);
+
+    auto logMinScale = std::log(minScaleFactor);
+    auto logMaxScale = std::log(maxScaleFactor);
+
+    auto metric = errorMetric;
+
+    // The error and the scale factor of every record, NaN for the records that are filtered out or have missing spectral accelerations
+    QVector<double> errors(numRecords, std::numeric_limits<double>::quiet_NaN());
+    QVector<double> logScales(numRecords, 0.0);
+
+    auto errorsData = errors.data();
+    auto logScalesData = logScales.data();
+
+    QVector<int> chunks((numRecords + chunkSize - 1)/chunkSize);
+    for(int i = 0; i<chunks.size(); ++i)
+        chunks[i] = i;
+
+    // Each chunk of records is handled by one thread, the periods are swept in the outer loop so that the inner loops run over contiguous columns of the flatfile and are vectorized
+    QtConcurrent::blockingMap(chunks, [&](const int chunk)
+    {
+        auto begin = chunk*chunkSize;
+        auto size = std::min(chunkSize, numRecords - begin);
+
+        std::vector<double> sums(size, 0.0);
+        std::vector<double> squaredSums(size, 0.0);
+
+        for(int k = 0; k<numTargetPeriods; ++k)
+        {
+            const auto column = flatfile.getLogSpectralAccelerations(periodIndices.at(k)) + begin;
+            const auto logSa = logTarget.at(k);
+
+            auto sumsData = sums.data();
+            auto squaredSumsData = squaredSums.data();
+
+            for(int i = 0; i<size; ++i)
+            {
+                auto residual = logSa - static_cast<double>(column[i]);
+
+                sumsData[i] += residual;
+                squaredSumsData[i] += residual*residual;
+            }
+        }
+
+        // The scale factor that minimizes the squared error is the mean of the residuals, a missing value in the flatfile gives a NaN sum
+        std::vector<double> chunkScales(size);
+
+        for(int i = 0; i<size; ++i)
+        {
+            auto mean = sums[i]/numTargetPeriods;
+
+            chunkScales[i] = std::min(std::max(mean, logMinScale), logMaxScale);
+        }
+
+        if(metric == RecordSelectionConfig::ErrorMetric::RMSE || metric == RecordSelectionConfig::ErrorMetric::MSE)
+        {
+            // The mean of the squared residuals of the scaled record, from the sums of the residuals
+            for(int i = 0; i<size; ++i)
+            {
+                auto mean = sums[i]/numTargetPeriods;
+                auto logScale = chunkScales[i];
+
+                auto meanSquared = std::max(squaredSums[i]/numTargetPeriods - 2.0*logScale*mean + logScale*logScale, 0.0);
+
+                sums[i] = metric == RecordSelectionConfig::ErrorMetric::RMSE ? std::sqrt(meanSquared) : meanSquared;
+            }
+        }
+        else
+        {
+            // The absolute errors need a second sweep over the periods with the scale factors
+            std::vector<double> absoluteSums(size, 0.0);
+
+            auto scalesData = chunkScales.data();
+            auto errorSumsData = absoluteSums.data();
+
+            for(int k = 0; k<numTargetPeriods; ++k)
+            {
+                const auto column = flatfile.getLogSpectralAccelerations(periodIndices.at(k)) + begin;
+                const auto logSa = logTarget.at(k);
+
+                if(metric == RecordSelectionConfig::ErrorMetric::AbsSum)
+                {
+                    for(int i = 0; i<size; ++i)
+                        errorSumsData[i] += std::abs(logSa - static_cast<double>(column[i]) - scalesData[i]);
+                }
+                else
+                {
+                    // The percentage error of the scaled spectral acceleration
+                    for(int i = 0; i<size; ++i)
+                        errorSumsData[i] += std::abs(std::exp(static_cast<double>(column[i]) + scalesData[i] - logSa) - 1.0);
+                }
+            }
+
+            for(int i = 0; i<size; ++i)
+                sums[i] = metric == RecordSelectionConfig::ErrorMetric::AbsSum ? absoluteSums[i] : 100.0*absoluteSums[i]/numTargetPeriods;
+        }
+
+        for(int i = 0; i<size; ++i)
+        {
+            auto index = begin + i;
+
+            if(!isInRange(magnitudes[index], magnitudeBounds) || !isInRange(distances[index], distanceBounds) || !isInRange(vs30s[index], vs30Bounds))
+                continue;
+
+            errorsData[index] = sums[i];
+            logScalesData[index] = chunkScales[i];
+        }
+    });
+
+    // The records with the smallest errors
+    QVector<int> candidates;
+
+    for(int i = 0; i<numRecords; ++i)
+    {
+        if(!std::isnan(errors.at(i)))
+            candidates.push_back(i);
+    }
+
+    if(candidates.isEmpty())
+    {
+        errMsg = "None of the records of the flatfile are in the magnitude, distance and Vs30 ranges and have spectral accelerations at the periods of the target spectrum";
+        return -1;
+    }
+
+    auto numMatches = std::min(nRecords, candidates.size());
+
+    std::partial_sort(candidates.begin(), candidates.begin() + numMatches, candidates.end(), [&](const int a, const int b)
+    {
+        return errors.at(a) < errors.at(b) || (errors.at(a) == errors.at(b) && a < b);
+    });
+
+    auto recordSequenceNumbers = flatfile.getRecordSequenceNumbers();
+
+    matches.reserve(numMatches);
+
+    for(int k = 0; k<numMatches; ++k)
+    {
+        auto i = candidates.at(k);
+
+        RecordMatch match;
+        match.recordIndex = i;
+        match.recordSequenceNumber = recordSequenceNumbers[i];
+        match.magnitude = magnitudes[i];
+        match.distance = distances[i];
+        match.vs30 = vs30s[i];
+        match.scaleFactor = std::exp(logScales.at(i));
+        match.error = errors.at(i);
+
+        matches.push_back(match);
+    }
+
+    return 0;
+}
+
+
+int LocalRecordSelector::rescaleRecords(const QList<QPair<double, double>>& spectrum, QVector<RecordMatch>& matches, QString& errMsg) const
+{
+    if(!flatfile.isOpen())
+    {
+        errMsg = "The flatfile of the records is not open";
+        return -1;
+    }
+
+    QVector<int> periodIndices;
+    QVector<double> logTarget;
+
+    if(this->interpolateTarget(spectrum, periodIndices, logTarget, errMsg) != 0)
+        return -1;
+
+    auto numTargetPeriods = periodIndices.size();
+    auto numRecords = flatfile.getNumberOfRecords();
+
+    auto logMinScale = std::log(minScaleFactor);
+    auto logMaxScale = std::log(maxScaleFactor);
+
+    QVector<double> residuals(numTargetPeriods);
+
+    // Only a handful of records, each one is handled on its own
+    for(auto&& match : matches)
+    {
+        if(match.recordIndex < 0 || match.recordIndex >= numRecords)
+        {
+            errMsg = "The record " + QString::number(match.recordSequenceNumber) + " is not in the flatfile";
+            return -1;
+        }
+
+        auto sum = 0.0;
+
+        for(int k = 0; k<numTargetPeriods; ++k)
+        {
+            residuals[k] = logTarget.at(k) - static_cast<double>(flatfile.getLogSpectralAccelerations(periodIndices.at(k))[match.recordIndex]);
+            sum += residuals.at(k);
+        }
+
+        auto logScale = std::min(std::max(sum/numTargetPeriods, logMinScale), logMaxScale);
+
+        auto errorSum = 0.0;
+
+        for(auto&& it : residuals)
+        {
+            switch(errorMetric)
+            {
+            case RecordSelectionConfig::ErrorMetric::AbsSum:
+                errorSum += std::abs(it - logScale);
+                break;
+            case RecordSelectionConfig::ErrorMetric::MAPE:
+                errorSum += std::abs(std::exp(logScale - it) - 1.0);
+                break;
+            default:
+                errorSum += (it - logScale)*(it - logScale);
+                break;
+            }
+        }
+
+        switch(errorMetric)
+        {
+        case RecordSelectionConfig::ErrorMetric::AbsSum:
+            match.error = errorSum;
+            break;
+        case RecordSelectionConfig::ErrorMetric::MAPE:
+            match.error = 100.0*errorSum/numTargetPeriods;
+            break;
+        case RecordSelectionConfig::ErrorMetric::MSE:
+            match.error = errorSum/numTargetPeriods;
+            break;
+        default:
+            match.error = std::sqrt(errorSum/numTargetPeriods);
+            break;
+        }
+
+        match.scaleFactor = std::exp(logScale);
+    }
+
+    return 0;
+}
+
+
+int LocalRecordSelector::interpolateTarget(const QList<QPair<double, double>>& spectrum, QVector<int>& periodIndices, QVector<double>& logTarget, QString& errMsg) const
+{
+    // The target spectrum in the order of increasing period, in log-log space
+    QVector<QPair<double, double>> target;
+
+    for(auto&& it : spectrum)
+    {
+        if(it.first <= 0.0 || it.second <= 0.0)
+        {
+            errMsg = "The periods and spectral accelerations of the target spectrum should be greater than zero";
+            return -1;
+        }
+
+        target.push_back(qMakePair(std::log(it.first), std::log(it.second)));
+    }
+
+    if(target.isEmpty())
+    {
+        errMsg = "The target spectrum is empty";
+        return -1;
+    }
+
+    std::sort(target.begin(), target.end());
+
+    auto numPeriods = flatfile.getNumberOfPeriods();
+    auto periods = flatfile.getPeriods();
+
+    // The periods of the flatfile that are in the range of the target spectrum, with a small tolerance for periods that are rounded
+    auto tolerance = 1.0e-6;
+
+    periodIndices.clear();
+
+    for(int j = 0; j<numPeriods; ++j)
+    {
+        auto logPeriod = std::log(periods[j]);
+
+        if(logPeriod >= target.first().first - tolerance && logPeriod <= target.last().first + tolerance)
+            periodIndices.push_back(j);
+    }
+
+    // A target at a single period, or between two periods of the flatfile, is matched at the nearest period
+    if(periodIndices.isEmpty())
+    {
+        auto logMiddle = 0.5*(target.first().first + target.last().first);
+
+        auto nearest = -1;
+        auto nearestDistance = std::numeric_limits<double>::infinity();
+
+        for(int j = 0; j<numPeriods; ++j)
+        {
+            auto distance = std::abs(std::log(periods[j]) - logMiddle);
+
+            if(distance < nearestDistance)
+            {
+                nearest = j;
+                nearestDistance = distance;
+            }
+        }
+
+        if(nearest == -1)
+        {
+            errMsg = "The flatfile does not have any spectral accelerations";
+            return -1;
+        }
+
+        periodIndices.push_back(nearest);
+    }
+
+    // The log of the target at the periods of the flatfile
+    auto numTargetPeriods = periodIndices.size();
+
+    logTarget.resize(numTargetPeriods);
+
+    for(int k = 0; k<numTargetPeriods; ++k)
+    {
+        auto logPeriod = std::log(periods[periodIndices.at(k)]);
+
+        auto upper = std::lower_bound(target.begin(), target.end(), qMakePair(logPeriod, -std::numeric_limits<double>::infinity()));
+
+        if(upper == target.begin())
+            logTarget[k] = target.first().second;
+        else if(upper == target.end())
+            logTarget[k] = target.last().second;
+        else
+        {
+            auto lower = upper - 1;
+
+            auto fraction = upper->first > lower->first ? (logPeriod - lower->first)/(upper->first - lower->first) : 0.0;
+
+            logTarget[k] = lower->second + fraction*(upper->second - lower->second);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,109 @@
+#ifndef LOCALRECORDSELECTOR_H
+#define LOCALRECORDSELECTOR_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "NGAWest2Flatfile.h"
+#include "RecordSelectionConfig.h"
+
+#include <QList>
+#include <QPair>
+#include <QVariant>
+#include <QVector>
+
+// A record of the flatfile that matches a target spectrum
+struct RecordMatch
+{
+    // The row of the record in the flatfile
+    int recordIndex;
+
+    int recordSequenceNumber;
+
+    double magnitude;
+    double distance;
+    double vs30;
+
+    // The factor that the record is scaled by to match the target spectrum, within the scaling bounds
+    double scaleFactor;
+
+    // The error of the scaled spectrum of the record with respect to the target spectrum
+    double error;
+};
+
+
+// Selects the records of a local NGA-West2 flatfile that best match a target spectrum, without a search on the PEER website
+// The error is computed over the periods of the flatfile that are in the range of the periods of the target spectrum, on the natural log of the spectral accelerations
+// The scale factor of each record is the one that minimizes the squared error of the log spectra, clamped to the scaling bounds
+class LocalRecordSelector
+{
+public:
+    LocalRecordSelector();
+
+    int openFlatfile(const QString& pathToFile, QString& errMsg);
+
+    const NGAWest2Flatfile& getFlatfile(void) const;
+
+    RecordSelectionConfig::ErrorMetric getErrorMetric() const;
+    void setErrorMetric(const RecordSelectionConfig::ErrorMetric& value);
+
+    double getMinScaleFactor() const;
+    double getMaxScaleFactor() const;
+    void setScaleFactorBounds(const double minScaleFactor, const double maxScaleFactor);
+
+    // The spectrum is a list of periods and spectral accelerations in g, the ranges are pairs of doubles and no filter is applied for a range that is not valid
+    // The matches are in the order of increasing error
+    int selectRecords(const QList<QPair<double, double>>& spectrum, const int nRecords, QVariant magnitudeRange, QVariant distanceRange, QVariant vs30Range,
+                      QVector<RecordMatch>& matches, QString& errMsg) const;
+
+    // Recomputes the scale factors and the errors of records that were already selected against another target spectrum
+    int rescaleRecords(const QList<QPair<double, double>>& spectrum, QVector<RecordMatch>& matches, QString& errMsg) const;
+
+private:
+
+    // The periods of the flatfile that the target spectrum covers and the log of the target at those periods
+    int interpolateTarget(const QList<QPair<double, double>>& spectrum, QVector<int>& periodIndices, QVector<double>& logTarget, QString& errMsg) const;
+
+    NGAWest2Flatfile flatfile;
+
+    RecordSelectionConfig::ErrorMetric errorMetric;
+
+    double minScaleFactor;
+    double maxScaleFactor;
+};
+
+#endif // LOCALRECORDSELECTOR_H
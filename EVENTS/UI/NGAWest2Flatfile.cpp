@@ -0,0 +1,386 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "NGAWest2Flatfile.h"
+#include "CSVReaderWriter.h"
+
+#include <QByteArray>
+#include <QPair>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QStringList>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace
+{
+const char flatfileMagic[8] = {'R','2','D','F','L','A','T',' '};
+
+const quint32 flatfileVersion = 1;
+
+qint64 alignTo8(const qint64 value)
+{
+    return (value + 7) & ~qint64(7);
+}
+
+// The index of the first of the given headers that is in the row of headers, or -1
+int findColumn(const QStringList& headers, const QStringList& names)
+{
+    for(auto&& it : names)
+    {
+        auto index = headers.indexOf(it);
+
+        if(index != -1)
+            return index;
+    }
+
+    return -1;
+}
+
+// The flatfile marks the missing values with -999
+double toValue(const QStringList& row, const int column)
+{
+    if(column < 0 || column >= row.size())
+        return std::numeric_limits<double>::quiet_NaN();
+
+    bool ok;
+    auto value = row.at(column).toDouble(&ok);
+
+    if(!ok || value == -999.0)
+        return std::numeric_limits<double>::quiet_NaN();
+
+    return value;
+}
+
+template <typename T>
+void appendColumn(QByteArray& contents, const QVector<T>& values)
+{
+    contents.append(reinterpret_cast<const char*>(values.constData()), values.size()*static_cast<int>(sizeof(T)));
+    contents.append(QByteArray(alignTo8(contents.size()) - contents.size(), '\0'));
+}
+}
+
+
+NGAWest2Flatfile::NGAWest2Flatfile()
+{
+    std::memset(&header, 0, sizeof(Header));
+    mappedData = nullptr;
+}
+
+
+NGAWest2Flatfile::~NGAWest2Flatfile()
+{
+    this->close();
+}
+
+
+QString NGAWest2Flatfile::extension(void)
+{
+    return ".r2dflat";
+}
+
+
+int NGAWest2Flatfile::convertFlatfile(const QString& pathToCSVFile, const QString& pathToFile, QString& errMsg)
+{
+    CSVReaderWriter csvTool;
+
+    auto data = csvTool.parseCSVFile(pathToCSVFile, errMsg);
+
+    if(!errMsg.isEmpty())
+        return -1;
+
+    if(data.size() < 2)
+    {
+        errMsg = "The flatfile " + pathToCSVFile + " does not contain any records";
+        return -1;
+    }
+
+    QStringList headers;
+    for(auto&& it : data.first())
+        headers.append(it.trimmed());
+
+    auto rsnColumn = findColumn(headers, {"Record Sequence Number", "RSN"});
+    auto magnitudeColumn = findColumn(headers, {"Earthquake Magnitude", "Magnitude"});
+    auto distanceColumn = findColumn(headers, {"ClstD (km)", "Rrup"});
+    auto vs30Column = findColumn(headers, {"Vs30 (m/s) selected for analysis", "Vs30"});
+
+    if(rsnColumn == -1 || magnitudeColumn == -1 || distanceColumn == -1 || vs30Column == -1)
+    {
+        errMsg = "The flatfile " + pathToCSVFile + " should have the record sequence number, magnitude, rupture distance and Vs30 columns";
+        return -1;
+    }
+
+    // The spectral accelerations, in the order of increasing period
+    QRegularExpression periodExpression("^T\\s*([0-9]*\\.?[0-9]+)\\s*S$", QRegularExpression::CaseInsensitiveOption);
+
+    QVector<QPair<double, int>> periodColumns;
+
+    for(int i = 0; i<headers.size(); ++i)
+    {
+        auto match = periodExpression.match(headers.at(i));
+
+        if(match.hasMatch())
+            periodColumns.push_back(qMakePair(match.captured(1).toDouble(), i));
+    }
+
+    std::sort(periodColumns.begin(), periodColumns.end());
+
+    if(periodColumns.isEmpty())
+    {
+        errMsg = "The flatfile " + pathToCSVFile + " does not have any spectral acceleration columns";
+        return -1;
+    }
+
+    auto numRecords = data.size() - 1;
+    auto numPeriods = periodColumns.size();
+
+    QVector<double> periods(numPeriods);
+    QVector<qint32> recordSequenceNumbers(numRecords);
+    QVector<double> magnitudes(numRecords);
+    QVector<double> distances(numRecords);
+    QVector<double> vs30s(numRecords);
+    QVector<float> spectra(numPeriods*numRecords);
+
+    for(int j = 0; j<numPeriods; ++j)
+        periods[j] = periodColumns.at(j).first;
+
+    for(int i = 0; i<numRecords; ++i)
+    {
+        const auto& row = data.at(i + 1);
+
+        recordSequenceNumbers[i] = row.value(rsnColumn).toInt();
+        magnitudes[i] = toValue(row, magnitudeColumn);
+        distances[i] = toValue(row, distanceColumn);
+        vs30s[i] = toValue(row, vs30Column);
+
+        for(int j = 0; j<numPeriods; ++j)
+        {
+            auto Sa = toValue(row, periodColumns.at(j).second);
+
+            spectra[j*numRecords + i] = Sa > 0.0 ? static_cast<float>(std::log(Sa)) : std::numeric_limits<float>::quiet_NaN();
+        }
+    }
+
+    Header newHeader;
+    std::memset(&newHeader, 0, sizeof(Header));
+    std::memcpy(newHeader.magic, flatfileMagic, sizeof(flatfileMagic));
+
+    newHeader.version = flatfileVersion;
+    newHeader.numRecords = numRecords;
+    newHeader.numPeriods = numPeriods;
+
+    QByteArray contents(alignTo8(sizeof(Header)), '\0');
+
+    newHeader.periodsOffset = contents.size();
+    appendColumn(contents, periods);
+
+    newHeader.recordSequenceNumbersOffset = contents.size();
+    appendColumn(contents, recordSequenceNumbers);
+
+    newHeader.magnitudesOffset = contents.size();
+    appendColumn(contents, magnitudes);
+
+    newHeader.distancesOffset = contents.size();
+    appendColumn(contents, distances);
+
+    newHeader.vs30sOffset = contents.size();
+    appendColumn(contents, vs30s);
+
+    newHeader.spectraOffset = contents.size();
+    appendColumn(contents, spectra);
+
+    std::memcpy(contents.data(), &newHeader, sizeof(Header));
+
+    // The flatfile only replaces an existing one once it was written in full, so that an interrupted conversion does not leave a truncated file that looks newer than the csv file
+    QSaveFile outFile(pathToFile);
+
+    if(!outFile.open(QIODevice::WriteOnly))
+    {
+        errMsg = "Could not open the file " + pathToFile + " for writing";
+        return -1;
+    }
+
+    if(outFile.write(contents) != contents.size() || !outFile.commit())
+    {
+        errMsg = "Could not write the flatfile to the file " + pathToFile + ": " + outFile.errorString();
+        return -1;
+    }
+
+    return 0;
+}
+
+
+int NGAWest2Flatfile::open(const QString& pathToFile, QString& errMsg)
+{
+    this->close();
+
+    file.setFileName(pathToFile);
+
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        errMsg = "Could not open the file at: " + pathToFile;
+        return -1;
+    }
+
+    auto fileSize = file.size();
+
+    if(fileSize < static_cast<qint64>(sizeof(Header)))
+    {
+        errMsg = "The file " + pathToFile + " is not a flatfile";
+        file.close();
+        return -1;
+    }
+
+    // The mapping stays in place until the flatfile is closed
+    auto data = file.map(0, fileSize);
+
+    if(data == nullptr)
+    {
+        errMsg = "Could not map the file " + pathToFile;
+        file.close();
+        return -1;
+    }
+
+    mappedData = data;
+
+    std::memcpy(&header, data, sizeof(Header));
+
+    if(std::memcmp(header.magic, flatfileMagic, sizeof(flatfileMagic)) != 0 || header.version > flatfileVersion)
+    {
+        errMsg = "The file " + pathToFile + " is not a flatfile or was written by a newer version";
+        this->close();
+        return -1;
+    }
+
+    auto numRecords = static_cast<qint64>(header.numRecords);
+    auto numPeriods = static_cast<qint64>(header.numPeriods);
+
+    auto fits = [&](const qint64 offset, const qint64 size)
+    {
+        return offset >= static_cast<qint64>(sizeof(Header)) && offset % 8 == 0 && offset + size <= fileSize;
+    };
+
+    if(numRecords < 0 || numPeriods < 0 ||
+            !fits(header.periodsOffset, numPeriods*8) ||
+            !fits(header.recordSequenceNumbersOffset, numRecords*4) ||
+            !fits(header.magnitudesOffset, numRecords*8) ||
+            !fits(header.distancesOffset, numRecords*8) ||
+            !fits(header.vs30sOffset, numRecords*8) ||
+            !fits(header.spectraOffset, numPeriods*numRecords*4))
+    {
+        errMsg = "The flatfile " + pathToFile + " is corrupt";
+        this->close();
+        return -1;
+    }
+
+    return 0;
+}
+
+
+void NGAWest2Flatfile::close(void)
+{
+    if(mappedData != nullptr)
+        file.unmap(const_cast<uchar*>(mappedData));
+
+    mappedData = nullptr;
+
+    if(file.isOpen())
+        file.close();
+
+    std::memset(&header, 0, sizeof(Header));
+}
+
+
+bool NGAWest2Flatfile::isOpen(void) const
+{
+    return mappedData != nullptr;
+}
+
+
+int NGAWest2Flatfile::getNumberOfRecords(void) const
+{
+    return header.numRecords;
+}
+
+
+int NGAWest2Flatfile::getNumberOfPeriods(void) const
+{
+    return header.numPeriods;
+}
+
+
+const double* NGAWest2Flatfile::getPeriods(void) const
+{
+    return mappedData ? reinterpret_cast<const double*>(mappedData + header.periodsOffset) : nullptr;
+}
+
+
+const qint32* NGAWest2Flatfile::getRecordSequenceNumbers(void) const
+{
+    return mappedData ? reinterpret_cast<const qint32*>(mappedData + header.recordSequenceNumbersOffset) : nullptr;
+}
+
+
+const double* NGAWest2Flatfile::getMagnitudes(void) const
+{
+    return mappedData ? reinterpret_cast<const double*>(mappedData + header.magnitudesOffset) : nullptr;
+}
+
+
+const double* NGAWest2Flatfile::getRuptureDistances(void) const
+{
+    return mappedData ? reinterpret_cast<const double*>(mappedData + header.distancesOffset) : nullptr;
+}
+
+
+const double* NGAWest2Flatfile::getVs30s(void) const
+{
+    return mappedData ? reinterpret_cast<const double*>(mappedData + header.vs30sOffset) : nullptr;
+}
+
+
+const float* NGAWest2Flatfile::getLogSpectralAccelerations(const int periodIndex) const
+{
+    if(mappedData == nullptr || periodIndex < 0 || periodIndex >= header.numPeriods)
+        return nullptr;
+
+    return reinterpret_cast<const float*>(mappedData + header.spectraOffset) + static_cast<qint64>(periodIndex)*header.numRecords;
+}
@@ -0,0 +1,109 @@
+#ifndef NGAWEST2FLATFILE_H
+#define NGAWEST2FLATFILE_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include <QFile>
+#include <QString>
+#include <QVector>
+
+// Columnar copy of the NGA-West2 flatfile that is read through a memory mapping of the file
+// Each column is stored contiguously on an 8 byte boundary: the periods of the spectra, the record sequence numbers, the magnitudes, the rupture distances, the Vs30 values, and then the natural log of the RotD50 spectral accelerations, one column of all of the records per period
+// A value that is missing in the flatfile is stored as NaN
+class NGAWest2Flatfile
+{
+public:
+    NGAWest2Flatfile();
+    ~NGAWest2Flatfile();
+
+    // The extension of the columnar flatfile
+    static QString extension(void);
+
+    // Converts the csv flatfile of the RotD50 spectra of the NGA-West2 records to the columnar format
+    // The spectral accelerations are in the columns with headers of the form T0.010S
+    static int convertFlatfile(const QString& pathToCSVFile, const QString& pathToFile, QString& errMsg);
+
+    int open(const QString& pathToFile, QString& errMsg);
+
+    void close(void);
+
+    bool isOpen(void) const;
+
+    int getNumberOfRecords(void) const;
+
+    int getNumberOfPeriods(void) const;
+
+    // The columns point into the mapping of the file and are valid while the file is open
+    const double* getPeriods(void) const;
+
+    const qint32* getRecordSequenceNumbers(void) const;
+
+    const double* getMagnitudes(void) const;
+
+    const double* getRuptureDistances(void) const;
+
+    const double* getVs30s(void) const;
+
+    // The natural log of the spectral accelerations of all of the records at the period with the given index
+    const float* getLogSpectralAccelerations(const int periodIndex) const;
+
+private:
+
+    struct Header
+    {
+        char magic[8];
+        quint32 version;
+        quint32 reserved;
+        qint32 numRecords;
+        qint32 numPeriods;
+        qint64 periodsOffset;
+        qint64 recordSequenceNumbersOffset;
+        qint64 magnitudesOffset;
+        qint64 distancesOffset;
+        qint64 vs30sOffset;
+        qint64 spectraOffset;
+    };
+
+    Header header;
+
+    QFile file;
+
+    const uchar* mappedData;
+};
+
+#endif // NGAWEST2FLATFILE_H
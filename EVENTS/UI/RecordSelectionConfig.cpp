@@ -39,10 +39,55 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include "RecordSelectionConfig.h"
 
 #include <QDebug>
+#include <QJsonArray>
+#include <QtNumeric>
+
+#include <cmath>
+#include <limits>
+
+namespace
+{
+// The range of the selector with an infinite bound where a bound is not set
+QVariant toRange(const QPair<double, double>& bounds)
+{
+    if(std::isnan(bounds.first) && std::isnan(bounds.second))
+        return QVariant();
+
+    auto min = std::isnan(bounds.first) ? -std::numeric_limits<double>::infinity() : bounds.first;
+    auto max = std::isnan(bounds.second) ? std::numeric_limits<double>::infinity() : bounds.second;
+
+    return QVariant::fromValue(qMakePair(min, max));
+}
+
+// The bounds are saved as an array of two values, a bound that is not set is null
+QJsonArray boundsToJson(const QPair<double, double>& bounds)
+{
+    QJsonArray array;
+    array.append(std::isnan(bounds.first) ? QJsonValue() : QJsonValue(bounds.first));
+    array.append(std::isnan(bounds.second) ? QJsonValue() : QJsonValue(bounds.second));
+
+    return array;
+}
+
+QPair<double, double> boundsFromJson(const QJsonValue& value)
+{
+    auto array = value.toArray();
+
+    return qMakePair(array.at(0).toDouble(qQNaN()), array.at(1).toDouble(qQNaN()));
+}
+}
 
 RecordSelectionConfig::RecordSelectionConfig(QObject *parent) : QObject(parent)
 {
     this->m_error = ErrorMetric::RMSE;
+    this->m_clusterTolerance = 0.1;
+    this->m_processRecords = false;
+    this->m_lowCutFrequency = 0.1;
+    this->m_highCutFrequency = 25.0;
+    this->m_targetTimeStep = 0.0;
+    this->m_magnitudeBounds = qMakePair(qQNaN(), qQNaN());
+    this->m_distanceBounds = qMakePair(qQNaN(), qQNaN());
+    this->m_vs30Bounds = qMakePair(qQNaN(), qQNaN());
 }
 
 
@@ -88,11 +133,163 @@ void RecordSelectionConfig::setError(const ErrorMetric &error)
 }
 
 
+QString RecordSelectionConfig::getFlatfilePath() const
+{
+    return m_flatfilePath;
+}
+
+
+void RecordSelectionConfig::setFlatfilePath(const QString &path)
+{
+    m_flatfilePath = path;
+}
+
+
+double RecordSelectionConfig::getClusterTolerance() const
+{
+    return m_clusterTolerance;
+}
+
+
+void RecordSelectionConfig::setClusterTolerance(const double tolerance)
+{
+    m_clusterTolerance = tolerance;
+}
+
+
+bool RecordSelectionConfig::getProcessRecords() const
+{
+    return m_processRecords;
+}
+
+
+void RecordSelectionConfig::setProcessRecords(const bool value)
+{
+    m_processRecords = value;
+}
+
+
+double RecordSelectionConfig::getLowCutFrequency() const
+{
+    return m_lowCutFrequency;
+}
+
+
+void RecordSelectionConfig::setLowCutFrequency(const double value)
+{
+    m_lowCutFrequency = value;
+}
+
+
+double RecordSelectionConfig::getHighCutFrequency() const
+{
+    return m_highCutFrequency;
+}
+
+
+void RecordSelectionConfig::setHighCutFrequency(const double value)
+{
+    m_highCutFrequency = value;
+}
+
+
+double RecordSelectionConfig::getTargetTimeStep() const
+{
+    return m_targetTimeStep;
+}
+
+
+void RecordSelectionConfig::setTargetTimeStep(const double value)
+{
+    m_targetTimeStep = value;
+}
+
+
+QPair<double, double> RecordSelectionConfig::getMagnitudeBounds() const
+{
+    return m_magnitudeBounds;
+}
+
+
+QPair<double, double> RecordSelectionConfig::getDistanceBounds() const
+{
+    return m_distanceBounds;
+}
+
+
+QPair<double, double> RecordSelectionConfig::getVs30Bounds() const
+{
+    return m_vs30Bounds;
+}
+
+
+QVariant RecordSelectionConfig::getMagnitudeRange() const
+{
+    return toRange(m_magnitudeBounds);
+}
+
+
+QVariant RecordSelectionConfig::getDistanceRange() const
+{
+    return toRange(m_distanceBounds);
+}
+
+
+QVariant RecordSelectionConfig::getVs30Range() const
+{
+    return toRange(m_vs30Bounds);
+}
+
+
+void RecordSelectionConfig::setMagnitudeBounds(const double min, const double max)
+{
+    m_magnitudeBounds = qMakePair(min, max);
+}
+
+
+void RecordSelectionConfig::setDistanceBounds(const double min, const double max)
+{
+    m_distanceBounds = qMakePair(min, max);
+}
+
+
+void RecordSelectionConfig::setVs30Bounds(const double min, const double max)
+{
+    m_vs30Bounds = qMakePair(min, max);
+}
+
+
 QJsonObject RecordSelectionConfig::getJson()
 {
     QJsonObject db;
 
     db.insert("Database", this->getDatabase());
+    db.insert("FlatfilePath", m_flatfilePath);
+    db.insert("ClusterTolerance", m_clusterTolerance);
+    db.insert("ProcessRecords", m_processRecords);
+    db.insert("LowCutFrequency", m_lowCutFrequency);
+    db.insert("HighCutFrequency", m_highCutFrequency);
+    db.insert("TargetTimeStep", m_targetTimeStep);
+    db.insert("MagnitudeRange", boundsToJson(m_magnitudeBounds));
+    db.insert("DistanceRange", boundsToJson(m_distanceBounds));
+    db.insert("Vs30Range", boundsToJson(m_vs30Bounds));
 
     return db;
 }
+
+
+void RecordSelectionConfig::setJson(const QJsonObject& json)
+{
+    if(json.value("Database").toString() == "NGAWest2")
+        this->setDatabase("PEER NGA West 2");
+
+    m_flatfilePath = json.value("FlatfilePath").toString();
+    m_clusterTolerance = json.value("ClusterTolerance").toDouble(m_clusterTolerance);
+    m_processRecords = json.value("ProcessRecords").toBool(m_processRecords);
+    m_lowCutFrequency = json.value("LowCutFrequency").toDouble(m_lowCutFrequency);
+    m_highCutFrequency = json.value("HighCutFrequency").toDouble(m_highCutFrequency);
+    m_targetTimeStep = json.value("TargetTimeStep").toDouble(m_targetTimeStep);
+    m_magnitudeBounds = boundsFromJson(json.value("MagnitudeRange"));
+    m_distanceBounds = boundsFromJson(json.value("DistanceRange"));
+    m_vs30Bounds = boundsFromJson(json.value("Vs30Range"));
+}
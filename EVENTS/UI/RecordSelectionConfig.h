@@ -41,6 +41,8 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include "JsonSerializable.h"
 
 #include <QObject>
+#include <QPair>
+#include <QVariant>
 
 class RecordSelectionConfig : public QObject, JsonSerializable
 {
@@ -56,18 +58,66 @@ public:
     void setError(const ErrorMetric &error);
     ErrorMetric getError() const;
 
+    // The columnar NGA-West2 flatfile for the selection of the records on this machine, the records are selected by the hazard simulation if it is empty
+    QString getFlatfilePath() const;
+
+    // The largest root mean square difference of the log spectra of the sites that share a selection of records
+    double getClusterTolerance() const;
+
+    // Whether the downloaded records are baseline corrected, band-pass filtered and resampled before they are written
+    bool getProcessRecords() const;
+
+    // The corner frequencies of the band-pass filter in Hz
+    double getLowCutFrequency() const;
+    double getHighCutFrequency() const;
+
+    // The time step of the processed records, zero keeps the time step of each record
+    double getTargetTimeStep() const;
+
+    // The ranges of the magnitude, the rupture distance in km and the Vs30 in m/s of the records that are selected from the local flatfile
+    // A bound that is not set is NaN, the ranges are returned as variants of QPair<double, double> with an infinite bound where it is not set, or an invalid variant if neither bound is set
+    QPair<double, double> getMagnitudeBounds() const;
+    QPair<double, double> getDistanceBounds() const;
+    QPair<double, double> getVs30Bounds() const;
+
+    QVariant getMagnitudeRange() const;
+    QVariant getDistanceRange() const;
+    QVariant getVs30Range() const;
+
+    void setMagnitudeBounds(const double min, const double max);
+    void setDistanceBounds(const double min, const double max);
+    void setVs30Bounds(const double min, const double max);
+
     QJsonObject getJson();
 
+    // Reads back the settings that are saved by getJson
+    void setJson(const QJsonObject& json);
+
 signals:
     void databaseChanged(QString newDatabase);
     void errorChanged(ErrorMetric error);
 
 public slots:
     void setDatabase(const QString &database);
+    void setFlatfilePath(const QString &path);
+    void setClusterTolerance(const double tolerance);
+    void setProcessRecords(const bool value);
+    void setLowCutFrequency(const double value);
+    void setHighCutFrequency(const double value);
+    void setTargetTimeStep(const double value);
 
 private:
     QString m_database;
     ErrorMetric m_error;
+    QString m_flatfilePath;
+    double m_clusterTolerance;
+    bool m_processRecords;
+    double m_lowCutFrequency;
+    double m_highCutFrequency;
+    double m_targetTimeStep;
+    QPair<double, double> m_magnitudeBounds;
+    QPair<double, double> m_distanceBounds;
+    QPair<double, double> m_vs30Bounds;
 
 };
 
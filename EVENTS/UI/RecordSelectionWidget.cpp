@@ -36,7 +36,38 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 // Written by: Stevan Gavrilovic
 
+#include "NGAWest2Flatfile.h"
 #include "RecordSelectionWidget.h"
+#include "WorkflowAppR2D.h"
+
+#include <QtConcurrent>
+
+#include <cmath>
+
+namespace
+{
+// The columnar flatfile that a csv flatfile is converted to by default, next to the csv file
+QString getColumnarPath(const QString& pathToCSVFile)
+{
+    QFileInfo csvFileInfo(pathToCSVFile);
+
+    return csvFileInfo.absolutePath() + QDir::separator() + csvFileInfo.completeBaseName() + NGAWest2Flatfile::extension();
+}
+
+// A bound that is not set is NaN in the configuration and empty in the line edit
+double toBound(const QString& text)
+{
+    bool OK;
+    auto value = text.toDouble(&OK);
+
+    return OK ? value : qQNaN();
+}
+
+QString toBoundText(const double value)
+{
+    return std::isnan(value) ? QString() : QString::number(value);
+}
+}
 
 RecordSelectionWidget::RecordSelectionWidget(RecordSelectionConfig& selectionConfig, QWidget *parent) : QWidget(parent), m_selectionConfig(selectionConfig)
 {
@@ -58,8 +89,142 @@ RecordSelectionWidget::RecordSelectionWidget(RecordSelectionConfig& selectionCon
     m_selectionConfig.setDatabase("PEER NGA West 2");
     m_dbBox->setSizePolicy(QSizePolicy::Expanding,QSizePolicy::Maximum);
 
+    // Optional local selection of the records from a columnar flatfile, with the sites grouped by their spectra
+    QLabel* flatfileLabel = new QLabel(tr("Local Flatfile:"),this);
+    m_flatfileLineEdit = new QLineEdit(this);
+    m_flatfileLineEdit->setPlaceholderText(tr("Select on the PEER website"));
+    m_flatfileLineEdit->setToolTip(tr("The hazard simulation still selects the records for each site, the local selection runs after it and replaces that selection with one selection for each cluster of sites with similar spectra.\n"
+                                      "It does not speed up the hazard simulation, it reduces the number of records that are downloaded from the PEER website."));
+    connect(m_flatfileLineEdit, &QLineEdit::textChanged, &this->m_selectionConfig, &RecordSelectionConfig::setFlatfilePath);
+
+    m_browseFlatfileButton = new QPushButton(tr("Browse"),this);
+    connect(m_browseFlatfileButton, &QPushButton::clicked, this, [this]()
+    {
+        auto path = QFileDialog::getOpenFileName(this, tr("NGA-West2 Flatfile"), QString(), "Flatfile (*" + NGAWest2Flatfile::extension() + " *.csv)");
+
+        if(path.isEmpty())
+            return;
+
+        // A csv flatfile is converted on first use, the columnar flatfile next to it is used as long as it is newer than the csv file
+        if(path.endsWith(".csv", Qt::CaseInsensitive))
+        {
+            auto pathToFile = getColumnarPath(path);
+
+            QFileInfo fileInfo(pathToFile);
+
+            // The columnar flatfile is converted again if it cannot be opened, e.g., when it was left behind by an older version
+            QString errMsg;
+            NGAWest2Flatfile flatfile;
+
+            if(!fileInfo.exists() || fileInfo.lastModified() < QFileInfo(path).lastModified() || flatfile.open(pathToFile, errMsg) != 0)
+            {
+                this->convertFlatfile(path, pathToFile);
+                return;
+            }
+
+            path = pathToFile;
+        }
+
+        m_flatfileLineEdit->setText(path);
+    });
+
+    // The csv flatfile of the PEER spectra is converted once to the columnar format
+    m_convertFlatfileButton = new QPushButton(tr("Convert Flatfile..."),this);
+    m_convertFlatfileButton->setToolTip(tr("Converts the csv flatfile of the NGA-West2 RotD50 spectra to the columnar format that is used for the local selection"));
+    connect(m_convertFlatfileButton, &QPushButton::clicked, this, [this]()
+    {
+        auto pathToCSVFile = QFileDialog::getOpenFileName(this, tr("NGA-West2 Flatfile"), QString(), "Flatfile (*.csv)");
+
+        if(pathToCSVFile.isEmpty())
+            return;
+
+        auto pathToFile = QFileDialog::getSaveFileName(this, tr("Columnar Flatfile"), getColumnarPath(pathToCSVFile), "Flatfile (*" + NGAWest2Flatfile::extension() + ")");
+
+        if(!pathToFile.isEmpty())
+            this->convertFlatfile(pathToCSVFile, pathToFile);
+    });
+
+    m_conversionWatcher = new QFutureWatcher<QString>(this);
+    connect(m_conversionWatcher, &QFutureWatcher<QString>::finished, this, &RecordSelectionWidget::handleConversionFinished);
+
+    QLabel* toleranceLabel = new QLabel(tr("Site Cluster Tolerance:"),this);
+    m_toleranceLineEdit = new QLineEdit(this);
+    m_toleranceLineEdit->setValidator(new QDoubleValidator(0.01, 10.0, 3, this));
+    m_toleranceLineEdit->setText(QString::number(m_selectionConfig.getClusterTolerance()));
+    m_toleranceLineEdit->setToolTip(tr("The largest root mean square difference of the natural log of the spectra of the sites that share a selection of records"));
+    connect(m_toleranceLineEdit, &QLineEdit::textChanged, this, [this](const QString& text)
+    {
+        m_selectionConfig.setClusterTolerance(text.toDouble());
+    });
+
+    // Optional processing of the downloaded records before they are written
+    m_processCheckBox = new QCheckBox(tr("Baseline correct, filter and resample the records"),this);
+    m_processCheckBox->setChecked(m_selectionConfig.getProcessRecords());
+    m_processCheckBox->setToolTip(tr("Removes a linear baseline and applies an acausal Butterworth band-pass filter to the downloaded records before they are written"));
+
+    QLabel* lowCutLabel = new QLabel(tr("Low Cut Frequency (Hz):"),this);
+    m_lowCutLineEdit = new QLineEdit(this);
+    m_lowCutLineEdit->setValidator(new QDoubleValidator(0.0, 100.0, 3, this));
+    m_lowCutLineEdit->setText(QString::number(m_selectionConfig.getLowCutFrequency()));
+    m_lowCutLineEdit->setToolTip(tr("A frequency of zero leaves out the high-pass side of the filter"));
+    connect(m_lowCutLineEdit, &QLineEdit::textChanged, this, [this](const QString& text)
+    {
+        m_selectionConfig.setLowCutFrequency(text.toDouble());
+    });
+
+    QLabel* highCutLabel = new QLabel(tr("High Cut Frequency (Hz):"),this);
+    m_highCutLineEdit = new QLineEdit(this);
+    m_highCutLineEdit->setValidator(new QDoubleValidator(0.0, 1000.0, 3, this));
+    m_highCutLineEdit->setText(QString::number(m_selectionConfig.getHighCutFrequency()));
+    m_highCutLineEdit->setToolTip(tr("A frequency of zero leaves out the low-pass side of the filter"));
+    connect(m_highCutLineEdit, &QLineEdit::textChanged, this, [this](const QString& text)
+    {
+        m_selectionConfig.setHighCutFrequency(text.toDouble());
+    });
+
+    QLabel* timeStepLabel = new QLabel(tr("Time Step (s):"),this);
+    m_timeStepLineEdit = new QLineEdit(this);
+    m_timeStepLineEdit->setValidator(new QDoubleValidator(0.0, 1.0, 4, this));
+    m_timeStepLineEdit->setText(QString::number(m_selectionConfig.getTargetTimeStep()));
+    m_timeStepLineEdit->setToolTip(tr("The records are resampled to this time step, zero keeps the time step of each record"));
+    connect(m_timeStepLineEdit, &QLineEdit::textChanged, this, [this](const QString& text)
+    {
+        m_selectionConfig.setTargetTimeStep(text.toDouble());
+    });
+
+    auto setProcessingInputsEnabled = [=](bool checked)
+    {
+        m_lowCutLineEdit->setEnabled(checked);
+        m_highCutLineEdit->setEnabled(checked);
+        m_timeStepLineEdit->setEnabled(checked);
+    };
+
+    setProcessingInputsEnabled(m_processCheckBox->isChecked());
+
+    connect(m_processCheckBox, &QCheckBox::toggled, &this->m_selectionConfig, &RecordSelectionConfig::setProcessRecords);
+    connect(m_processCheckBox, &QCheckBox::toggled, this, setProcessingInputsEnabled);
+
     formLayout->addWidget(databaseLabel,0,0);
-    formLayout->addWidget(m_dbBox,0,1);
+    formLayout->addWidget(m_dbBox,0,1,1,3);
+    formLayout->addWidget(flatfileLabel,1,0);
+    formLayout->addWidget(m_flatfileLineEdit,1,1);
+    formLayout->addWidget(m_browseFlatfileButton,1,2);
+    formLayout->addWidget(m_convertFlatfileButton,1,3);
+    formLayout->addWidget(toleranceLabel,2,0);
+    formLayout->addWidget(m_toleranceLineEdit,2,1,1,3);
+
+    // The records that are selected from the local flatfile can be limited to ranges of their magnitude, distance and Vs30
+    this->addRangeRow(formLayout, 3, tr("Magnitude Range:"), 10.0, m_magnitudeMinLineEdit, m_magnitudeMaxLineEdit);
+    this->addRangeRow(formLayout, 4, tr("Distance Range (km):"), 1000.0, m_distanceMinLineEdit, m_distanceMaxLineEdit);
+    this->addRangeRow(formLayout, 5, tr("Vs30 Range (m/s):"), 5000.0, m_vs30MinLineEdit, m_vs30MaxLineEdit);
+
+    formLayout->addWidget(m_processCheckBox,6,0,1,4);
+    formLayout->addWidget(lowCutLabel,7,0);
+    formLayout->addWidget(m_lowCutLineEdit,7,1,1,3);
+    formLayout->addWidget(highCutLabel,8,0);
+    formLayout->addWidget(m_highCutLineEdit,8,1,1,3);
+    formLayout->addWidget(timeStepLabel,9,0);
+    formLayout->addWidget(m_timeStepLineEdit,9,1,1,3);
 
     selectionGroupBox->setLayout(formLayout);
 
@@ -71,3 +236,97 @@ RecordSelectionWidget::RecordSelectionWidget(RecordSelectionConfig& selectionCon
 }
 
 
+void RecordSelectionWidget::updateFromConfig(void)
+{
+    m_flatfileLineEdit->setText(m_selectionConfig.getFlatfilePath());
+    m_toleranceLineEdit->setText(QString::number(m_selectionConfig.getClusterTolerance()));
+    m_processCheckBox->setChecked(m_selectionConfig.getProcessRecords());
+    m_lowCutLineEdit->setText(QString::number(m_selectionConfig.getLowCutFrequency()));
+    m_highCutLineEdit->setText(QString::number(m_selectionConfig.getHighCutFrequency()));
+    m_timeStepLineEdit->setText(QString::number(m_selectionConfig.getTargetTimeStep()));
+
+    // The ranges are set in the configuration again from the line edits, they are already in it
+    QSignalBlocker magnitudeMinBlocker(m_magnitudeMinLineEdit);
+    QSignalBlocker magnitudeMaxBlocker(m_magnitudeMaxLineEdit);
+    QSignalBlocker distanceMinBlocker(m_distanceMinLineEdit);
+    QSignalBlocker distanceMaxBlocker(m_distanceMaxLineEdit);
+    QSignalBlocker vs30MinBlocker(m_vs30MinLineEdit);
+    QSignalBlocker vs30MaxBlocker(m_vs30MaxLineEdit);
+
+    m_magnitudeMinLineEdit->setText(toBoundText(m_selectionConfig.getMagnitudeBounds().first));
+    m_magnitudeMaxLineEdit->setText(toBoundText(m_selectionConfig.getMagnitudeBounds().second));
+    m_distanceMinLineEdit->setText(toBoundText(m_selectionConfig.getDistanceBounds().first));
+    m_distanceMaxLineEdit->setText(toBoundText(m_selectionConfig.getDistanceBounds().second));
+    m_vs30MinLineEdit->setText(toBoundText(m_selectionConfig.getVs30Bounds().first));
+    m_vs30MaxLineEdit->setText(toBoundText(m_selectionConfig.getVs30Bounds().second));
+}
+
+
+void RecordSelectionWidget::addRangeRow(QGridLayout* layout, const int row, const QString& label, const double top, QLineEdit*& minLineEdit, QLineEdit*& maxLineEdit)
+{
+    minLineEdit = new QLineEdit(this);
+    minLineEdit->setValidator(new QDoubleValidator(0.0, top, 3, this));
+    minLineEdit->setPlaceholderText(tr("Minimum"));
+    minLineEdit->setToolTip(tr("The records are selected from the local flatfile without a lower bound if this is left empty"));
+    connect(minLineEdit, &QLineEdit::textChanged, this, &RecordSelectionWidget::updateRanges);
+
+    maxLineEdit = new QLineEdit(this);
+    maxLineEdit->setValidator(new QDoubleValidator(0.0, top, 3, this));
+    maxLineEdit->setPlaceholderText(tr("Maximum"));
+    maxLineEdit->setToolTip(tr("The records are selected from the local flatfile without an upper bound if this is left empty"));
+    connect(maxLineEdit, &QLineEdit::textChanged, this, &RecordSelectionWidget::updateRanges);
+
+    layout->addWidget(new QLabel(label, this),row,0);
+    layout->addWidget(minLineEdit,row,1);
+    layout->addWidget(maxLineEdit,row,2,1,2);
+}
+
+
+void RecordSelectionWidget::updateRanges(void)
+{
+    m_selectionConfig.setMagnitudeBounds(toBound(m_magnitudeMinLineEdit->text()), toBound(m_magnitudeMaxLineEdit->text()));
+    m_selectionConfig.setDistanceBounds(toBound(m_distanceMinLineEdit->text()), toBound(m_distanceMaxLineEdit->text()));
+    m_selectionConfig.setVs30Bounds(toBound(m_vs30MinLineEdit->text()), toBound(m_vs30MaxLineEdit->text()));
+}
+
+
+void RecordSelectionWidget::convertFlatfile(const QString& pathToCSVFile, const QString& pathToFile)
+{
+    if(m_conversionWatcher->isRunning())
+        return;
+
+    m_convertedFlatfilePath = pathToFile;
+
+    m_browseFlatfileButton->setEnabled(false);
+    m_convertFlatfileButton->setEnabled(false);
+
+    WorkflowAppR2D::getInstance()->statusMessage("Converting the flatfile " + pathToCSVFile);
+
+    // The csv file of the flatfile is large, it is parsed and written on a worker thread
+    m_conversionWatcher->setFuture(QtConcurrent::run([pathToCSVFile, pathToFile]()
+    {
+        QString errMsg;
+        NGAWest2Flatfile::convertFlatfile(pathToCSVFile, pathToFile, errMsg);
+
+        return errMsg;
+    }));
+}
+
+
+void RecordSelectionWidget::handleConversionFinished(void)
+{
+    m_browseFlatfileButton->setEnabled(true);
+    m_convertFlatfileButton->setEnabled(true);
+
+    auto errMsg = m_conversionWatcher->result();
+
+    if(!errMsg.isEmpty())
+    {
+        WorkflowAppR2D::getInstance()->errorMessage(errMsg);
+        return;
+    }
+
+    m_flatfileLineEdit->setText(m_convertedFlatfilePath);
+
+    WorkflowAppR2D::getInstance()->statusMessage("The flatfile is converted to " + m_convertedFlatfilePath);
+}
@@ -40,6 +40,7 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 #include "RecordSelectionConfig.h"
 
+#include <QFutureWatcher>
 #include <QWidget>
 #include <QtWidgets>
 
@@ -49,9 +50,42 @@ class RecordSelectionWidget : public QWidget
 public:
     explicit RecordSelectionWidget(RecordSelectionConfig& selectionConfig, QWidget *parent = nullptr);
 
+    // Shows the settings of the configuration, e.g., after they are read from a file
+    void updateFromConfig(void);
+
+private slots:
+    // Selects the converted flatfile once the conversion is finished
+    void handleConversionFinished(void);
+
 private:
+    // Converts a csv flatfile to the columnar format on a worker thread
+    void convertFlatfile(const QString& pathToCSVFile, const QString& pathToFile);
+
+    // Creates the line edits of the lower and the upper bound of a range and adds them to the row of the layout
+    void addRangeRow(QGridLayout* layout, const int row, const QString& label, const double top, QLineEdit*& minLineEdit, QLineEdit*& maxLineEdit);
+
+    // Sets the ranges of the configuration from the line edits, an empty bound is not set
+    void updateRanges(void);
+
     RecordSelectionConfig& m_selectionConfig;
     QComboBox* m_dbBox;
+    QLineEdit* m_flatfileLineEdit;
+    QPushButton* m_browseFlatfileButton;
+    QPushButton* m_convertFlatfileButton;
+    QLineEdit* m_toleranceLineEdit;
+    QLineEdit* m_magnitudeMinLineEdit;
+    QLineEdit* m_magnitudeMaxLineEdit;
+    QLineEdit* m_distanceMinLineEdit;
+    QLineEdit* m_distanceMaxLineEdit;
+    QLineEdit* m_vs30MinLineEdit;
+    QLineEdit* m_vs30MaxLineEdit;
+    QCheckBox* m_processCheckBox;
+    QLineEdit* m_lowCutLineEdit;
+    QLineEdit* m_highCutLineEdit;
+    QLineEdit* m_timeStepLineEdit;
+
+    QFutureWatcher<QString>* m_conversionWatcher;
+    QString m_convertedFlatfilePath;
 
 };
 
@@ -0,0 +1,355 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "SiteClusteredRecordSelector.h"
+
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+// The mean squared difference of two log spectra
+double squaredDistance(const QVector<double>& a, const QVector<double>& b)
+{
+    auto sum = 0.0;
+
+    for(int k = 0; k<a.size(); ++k)
+    {
+        auto difference = a.at(k) - b.at(k);
+        sum += difference*difference;
+    }
+
+    return sum/a.size();
+}
+
+QList<QPair<double, double>> toSpectrum(const QVector<double>& periods, const QVector<double>& logSpectrum)
+{
+    QList<QPair<double, double>> spectrum;
+
+    for(int k = 0; k<periods.size(); ++k)
+        spectrum.append(qMakePair(periods.at(k), std::exp(logSpectrum.at(k))));
+
+    return spectrum;
+}
+}
+
+
+SiteClusteredRecordSelector::SiteClusteredRecordSelector()
+{
+    tolerance = 0.1;
+    maxIterations = 50;
+
+    // Each cluster is one selection of records and one set of downloads
+    maxClusters = 100;
+}
+
+
+double SiteClusteredRecordSelector::getTolerance() const
+{
+    return tolerance;
+}
+
+
+void SiteClusteredRecordSelector::setTolerance(const double value)
+{
+    tolerance = value;
+}
+
+
+int SiteClusteredRecordSelector::getMaxIterations() const
+{
+    return maxIterations;
+}
+
+
+void SiteClusteredRecordSelector::setMaxIterations(const int value)
+{
+    maxIterations = value;
+}
+
+
+int SiteClusteredRecordSelector::getMaxClusters() const
+{
+    return maxClusters;
+}
+
+
+void SiteClusteredRecordSelector::setMaxClusters(const int value)
+{
+    if(value > 0)
+        maxClusters = value;
+}
+
+
+int SiteClusteredRecordSelector::clusterSpectra(const QVector<QVector<double>>& logSpectra, QVector<int>& siteClusters, QVector<QVector<double>>& clusterCenters, QString& errMsg) const
+{
+    siteClusters.clear();
+    clusterCenters.clear();
+
+    auto numSites = logSpectra.size();
+
+    if(numSites == 0)
+    {
+        errMsg = "There are no site spectra to cluster";
+        return -1;
+    }
+
+    auto numPeriods = logSpectra.first().size();
+
+    for(auto&& it : logSpectra)
+    {
+        if(it.size() != numPeriods || numPeriods == 0)
+        {
+            errMsg = "The spectra of all of the sites should have the same number of periods";
+            return -1;
+        }
+    }
+
+    if(tolerance < 0.0)
+    {
+        errMsg = "The spectral tolerance of the clusters should not be negative";
+        return -1;
+    }
+
+    auto boundedTolerance = std::max(tolerance, minTolerance);
+    auto squaredTolerance = boundedTolerance*boundedTolerance;
+
+    auto clusterLimit = std::min(maxClusters, numSites);
+
+    // Start with a single cluster at the mean of all of the spectra
+    QVector<double> mean(numPeriods, 0.0);
+
+    for(auto&& it : logSpectra)
+        for(int k = 0; k<numPeriods; ++k)
+            mean[k] += it.at(k)/numSites;
+
+    clusterCenters.push_back(mean);
+
+    siteClusters.fill(0, numSites);
+    QVector<double> siteDistances(numSites, 0.0);
+
+    auto clustersData = siteClusters.data();
+    auto distancesData = siteDistances.data();
+
+    QVector<int> sites(numSites);
+    for(int i = 0; i<numSites; ++i)
+        sites[i] = i;
+
+    while(true)
+    {
+        // Lloyd iterations, the sites are assigned to their nearest centers in parallel
+        for(int iteration = 0; iteration<maxIterations; ++iteration)
+        {
+            QVector<int> previousClusters = siteClusters;
+
+            QtConcurrent::blockingMap(sites, [&](const int i)
+            {
+                auto nearest = 0;
+                auto nearestDistance = std::numeric_limits<double>::infinity();
+
+                for(int c = 0; c<clusterCenters.size(); ++c)
+                {
+                    auto distance = squaredDistance(logSpectra.at(i), clusterCenters.at(c));
+
+                    if(distance < nearestDistance)
+                    {
+                        nearest = c;
+                        nearestDistance = distance;
+                    }
+                }
+
+                clustersData[i] = nearest;
+                distancesData[i] = nearestDistance;
+            });
+
+            if(iteration > 0 && previousClusters == siteClusters)
+                break;
+
+            // The centers move to the mean of their sites, a center without any sites stays in place
+            QVector<QVector<double>> sums(clusterCenters.size(), QVector<double>(numPeriods, 0.0));
+            QVector<int> counts(clusterCenters.size(), 0);
+
+            for(int i = 0; i<numSites; ++i)
+            {
+                auto& sum = sums[siteClusters.at(i)];
+
+                for(int k = 0; k<numPeriods; ++k)
+                    sum[k] += logSpectra.at(i).at(k);
+
+                ++counts[siteClusters.at(i)];
+            }
+
+            for(int c = 0; c<clusterCenters.size(); ++c)
+            {
+                if(counts.at(c) == 0)
+                    continue;
+
+                for(int k = 0; k<numPeriods; ++k)
+                    clusterCenters[c][k] = sums.at(c).at(k)/counts.at(c);
+            }
+        }
+
+        // The centers moved after the last assignment when the iterations did not converge, so the distances are taken to where the centers are now
+        QtConcurrent::blockingMap(sites, [&](const int i)
+        {
+            distancesData[i] = squaredDistance(logSpectra.at(i), clusterCenters.at(clustersData[i]));
+        });
+
+        // The sites that are farthest from the center of each cluster that is not within the tolerance become the centers of new clusters
+        QVector<int> farthestSites(clusterCenters.size(), -1);
+
+        for(int i = 0; i<numSites; ++i)
+        {
+            auto c = siteClusters.at(i);
+
+            if(siteDistances.at(i) <= squaredTolerance)
+                continue;
+
+            if(farthestSites.at(c) == -1 || siteDistances.at(i) > siteDistances.at(farthestSites.at(c)))
+                farthestSites[c] = i;
+        }
+
+        auto numSplit = 0;
+
+        for(auto&& it : farthestSites)
+        {
+            if(it == -1 || clusterCenters.size() >= clusterLimit)
+                continue;
+
+            clusterCenters.push_back(logSpectra.at(it));
+            ++numSplit;
+        }
+
+        if(numSplit == 0)
+            break;
+    }
+
+    return 0;
+}
+
+
+int SiteClusteredRecordSelector::selectRecords(const LocalRecordSelector& selector, const QVector<double>& periods, const QVector<QVector<double>>& siteSpectra, const int nRecords,
+                                               QVariant magnitudeRange, QVariant distanceRange, QVariant vs30Range,
+                                               QVector<QVector<RecordMatch>>& siteRecords, QVector<int>& siteClusters, QString& errMsg) const
+{
+    siteRecords.clear();
+
+    // The clusters are found in log-spectral space
+    QVector<QVector<double>> logSpectra(siteSpectra.size());
+
+    for(int i = 0; i<siteSpectra.size(); ++i)
+    {
+        const auto& spectrum = siteSpectra.at(i);
+
+        if(spectrum.size() != periods.size())
+        {
+            errMsg = "The spectrum of the site " + QString::number(i) + " does not have a value at each period";
+            return -1;
+        }
+
+        logSpectra[i].resize(spectrum.size());
+
+        for(int k = 0; k<spectrum.size(); ++k)
+        {
+            if(spectrum.at(k) <= 0.0)
+            {
+                errMsg = "The spectral accelerations of the site " + QString::number(i) + " should be greater than zero";
+                return -1;
+            }
+
+            logSpectra[i][k] = std::log(spectrum.at(k));
+        }
+    }
+
+    QVector<QVector<double>> clusterCenters;
+
+    if(this->clusterSpectra(logSpectra, siteClusters, clusterCenters, errMsg) != 0)
+        return -1;
+
+    auto numClusters = clusterCenters.size();
+
+    // One selection for the center of each cluster, the selections run one after the other since each one is already parallel
+    QVector<QVector<RecordMatch>> clusterRecords(numClusters);
+
+    for(int c = 0; c<numClusters; ++c)
+    {
+        if(selector.selectRecords(toSpectrum(periods, clusterCenters.at(c)), nRecords, magnitudeRange, distanceRange, vs30Range, clusterRecords[c], errMsg) != 0)
+            return -1;
+    }
+
+    // The records of each site are those of its cluster, with the scale factors for the spectrum of the site
+    siteRecords.resize(siteSpectra.size());
+
+    auto siteRecordsData = siteRecords.data();
+
+    QVector<QString> errors(siteSpectra.size());
+    auto errorsData = errors.data();
+
+    QVector<int> sites(siteSpectra.size());
+    for(int i = 0; i<sites.size(); ++i)
+        sites[i] = i;
+
+    QtConcurrent::blockingMap(sites, [&](const int i)
+    {
+        auto records = clusterRecords.at(siteClusters.at(i));
+
+        if(selector.rescaleRecords(toSpectrum(periods, logSpectra.at(i)), records, errorsData[i]) != 0)
+            return;
+
+        std::stable_sort(records.begin(), records.end(), [](const RecordMatch& a, const RecordMatch& b)
+        {
+            return a.error < b.error;
+        });
+
+        siteRecordsData[i] = records;
+    });
+
+    for(auto&& it : errors)
+    {
+        if(!it.isEmpty())
+        {
+            errMsg = it;
+            return -1;
+        }
+    }
+
+    return 0;
+}
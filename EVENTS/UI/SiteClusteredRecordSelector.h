@@ -0,0 +1,85 @@
+#ifndef SITECLUSTEREDRECORDSELECTOR_H
+#define SITECLUSTEREDRECORDSELECTOR_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "LocalRecordSelector.h"
+
+#include <QVector>
+
+// Selects the records of a grid of sites once per group of sites with similar target spectra, instead of once per site
+// The target spectra are clustered with k-means on the natural log of the spectral accelerations, and the number of clusters is increased until every site is within the tolerance of the spectrum at the center of its cluster
+// The records are selected for the spectrum at the center of each cluster, and the scale factors and errors of the records are then recomputed for the spectrum of each site
+class SiteClusteredRecordSelector
+{
+public:
+    SiteClusteredRecordSelector();
+
+    // The largest root mean square difference of the log spectral accelerations of a site and the center of its cluster
+    // A tolerance below the minimum tolerance is raised to it, so that sites with almost the same spectra share a cluster
+    double getTolerance() const;
+    void setTolerance(const double value);
+
+    // The clusters are no longer split once there are this many, the sites that are not within the tolerance then stay with their nearest center
+    int getMaxClusters() const;
+    void setMaxClusters(const int value);
+
+    static constexpr double minTolerance = 0.01;
+
+    int getMaxIterations() const;
+    void setMaxIterations(const int value);
+
+    // The log spectra are indexed by [site][period], the cluster of each site is an index into the centers of the clusters
+    int clusterSpectra(const QVector<QVector<double>>& logSpectra, QVector<int>& siteClusters, QVector<QVector<double>>& clusterCenters, QString& errMsg) const;
+
+    // The spectral accelerations of each site are at the given periods, in g
+    // The records of each site are in the order of increasing error, the ranges are passed on to the selector
+    int selectRecords(const LocalRecordSelector& selector, const QVector<double>& periods, const QVector<QVector<double>>& siteSpectra, const int nRecords,
+                      QVariant magnitudeRange, QVariant distanceRange, QVariant vs30Range,
+                      QVector<QVector<RecordMatch>>& siteRecords, QVector<int>& siteClusters, QString& errMsg) const;
+
+private:
+
+    double tolerance;
+
+    int maxIterations;
+
+    int maxClusters;
+};
+
+#endif // SITECLUSTEREDRECORDSELECTOR_H
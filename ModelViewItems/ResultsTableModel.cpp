@@ -0,0 +1,450 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "ResultsTableModel.h"
+
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+namespace
+{
+
+// Sort by the value and then by the row so that the order is deterministic, NaN values go last
+bool isLessThan(const QVector<double>& values, const int a, const int b)
+{
+    auto valA = values.at(a);
+    auto valB = values.at(b);
+
+    auto nanA = std::isnan(valA);
+    auto nanB = std::isnan(valB);
+
+    if(nanA || nanB)
+    {
+        if(nanA != nanB)
+            return nanB;
+
+        return a < b;
+    }
+
+    if(valA != valB)
+        return valA < valB;
+
+    return a < b;
+}
+
+}
+
+ResultsTableModel::ResultsTableModel(QObject *parent) : QAbstractTableModel(parent)
+{
+    sortColumn = 0;
+    sortOrder = Qt::AscendingOrder;
+}
+
+
+int ResultsTableModel::rowCount(const QModelIndex &parent) const
+{
+    if(parent.isValid())
+        return 0;
+
+    return rowOrder.size();
+}
+
+
+int ResultsTableModel::columnCount(const QModelIndex &parent) const
+{
+    if(parent.isValid())
+        return 0;
+
+    return headers.size();
+}
+
+
+QVariant ResultsTableModel::data(const QModelIndex &index, int role) const
+{
+    if(!index.isValid() || index.row() >= rowOrder.size() || index.column() >= columns.size())
+        return QVariant();
+
+    auto row = rowOrder.at(index.row());
+
+    if(role == Qt::DisplayRole)
+    {
+        if(index.column() == 0)
+            return QString::number(IDs.at(row));
+
+        // Fixed notation so that the values of a column line up, the default notation switches to exponents past six digits
+        return QString::number(columns.at(index.column()).at(row), 'f', precisions.value(index.column(), 2));
+    }
+    else if(role == Qt::UserRole)
+    {
+        if(index.column() == 0)
+            return IDs.at(row);
+
+        return columns.at(index.column()).at(row);
+    }
+
+    return QVariant();
+}
+
+
+QVariant ResultsTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if(role != Qt::DisplayRole)
+        return QVariant();
+
+    if(orientation == Qt::Horizontal)
+        return headers.value(section);
+
+    return section + 1;
+}
+
+
+void ResultsTableModel::sort(int column, Qt::SortOrder order)
+{
+    if(column < 0 || column >= permutations.size())
+        return;
+
+    sortColumn = column;
+    sortOrder = order;
+
+    if(order == Qt::DescendingOrder)
+        this->setRowOrder(this->getDescendingPermutation(column));
+    else
+        this->setRowOrder(permutations.at(column));
+}
+
+
+void ResultsTableModel::setResults(const QStringList& headers, const QVector<int>& IDs, const QVector<QVector<double>>& columns)
+{
+    this->beginResetModel();
+
+    this->headers = headers;
+    this->IDs = IDs;
+
+    this->columns.clear();
+    this->columns.reserve(columns.size() + 1);
+
+    QVector<double> IDColumn(IDs.size());
+    for(int i = 0; i<IDs.size(); ++i)
+        IDColumn[i] = IDs.at(i);
+
+    this->columns.push_back(IDColumn);
+    this->columns.append(columns);
+
+    this->computePermutations();
+
+    // Show the rows in the order of the asset IDs
+    rowOrder = permutations.value(0);
+
+    sortColumn = 0;
+    sortOrder = Qt::AscendingOrder;
+
+    this->endResetModel();
+}
+
+
+void ResultsTableModel::updateResults(const QVector<int>& IDs, const QVector<QVector<double>>& columns, const QVector<int>& rows)
+{
+    auto numRowsBefore = this->IDs.size();
+    auto numRows = IDs.size();
+
+    if(numRowsBefore == 0 || numRows < numRowsBefore || columns.size() + 1 != this->columns.size())
+    {
+        this->setResults(headers, IDs, columns);
+        return;
+    }
+
+    // The rows whose values may have changed, the new rows are always among them
+    QVector<bool> isChanged(numRows, false);
+
+    for(auto&& row : rows)
+    {
+        if(row >= 0 && row < numRows)
+            isChanged[row] = true;
+    }
+
+    for(int i = numRowsBefore; i<numRows; ++i)
+        isChanged[i] = true;
+
+    QVector<int> changedRows;
+    auto hasChangedRowsBefore = false;
+
+    for(int i = 0; i<numRows; ++i)
+    {
+        if(!isChanged.at(i))
+            continue;
+
+        changedRows.push_back(i);
+
+        if(i < numRowsBefore)
+            hasChangedRowsBefore = true;
+    }
+
+    auto IDColumn = this->columns.first();
+    IDColumn.resize(numRows);
+
+    for(int i = numRowsBefore; i<numRows; ++i)
+        IDColumn[i] = IDs.at(i);
+
+    this->IDs = IDs;
+
+    this->columns.clear();
+    this->columns.push_back(IDColumn);
+    this->columns.append(columns);
+
+    QVector<int> colIndices;
+    for(int i = 0; i<this->columns.size(); ++i)
+        colIndices.push_back(i);
+
+    // Each thread merges the changed rows into the permutation of its own column, the vector is detached up front
+    auto permutationsData = permutations.data();
+
+    QtConcurrent::blockingMap(colIndices, [&](const int col)
+    {
+        const auto& values = this->columns.at(col);
+
+        auto lessThan = [&values](const int a, const int b)
+        {
+            return isLessThan(values, a, b);
+        };
+
+        const auto& permutation = permutationsData[col];
+
+        QVector<int> unchangedRows;
+        unchangedRows.reserve(permutation.size());
+
+        for(auto&& row : permutation)
+        {
+            if(!isChanged.at(row))
+                unchangedRows.push_back(row);
+        }
+
+        auto sortedRows = changedRows;
+        std::sort(sortedRows.begin(), sortedRows.end(), lessThan);
+
+        QVector<int> merged(unchangedRows.size() + sortedRows.size());
+        std::merge(unchangedRows.begin(), unchangedRows.end(), sortedRows.begin(), sortedRows.end(), merged.begin(), lessThan);
+
+        permutationsData[col] = merged;
+    });
+
+    auto newOrder = sortOrder == Qt::DescendingOrder ? this->getDescendingPermutation(sortColumn) : permutations.at(sortColumn);
+
+    if(std::equal(rowOrder.begin(), rowOrder.end(), newOrder.begin()))
+    {
+        // The rows that are shown keep their order, e.g., when the results are sorted by the asset ID, so the new rows are only inserted at the end
+        if(numRows > numRowsBefore)
+        {
+            this->beginInsertRows(QModelIndex(), numRowsBefore, numRows - 1);
+            rowOrder = newOrder;
+            this->endInsertRows();
+        }
+    }
+    else
+    {
+        // The new rows are inserted at the end and then moved to their place in the sorting, together with the changed rows
+        if(numRows > numRowsBefore)
+        {
+            this->beginInsertRows(QModelIndex(), numRowsBefore, numRows - 1);
+
+            for(int i = numRowsBefore; i<numRows; ++i)
+                rowOrder.push_back(i);
+
+            this->endInsertRows();
+        }
+
+        this->setRowOrder(newOrder);
+    }
+
+    if(!hasChangedRowsBefore)
+        return;
+
+    // Only the rows that were already shown and whose values changed are updated in the view
+    QVector<int> viewRows(numRows);
+    for(int i = 0; i<numRows; ++i)
+        viewRows[rowOrder.at(i)] = i;
+
+    QVector<int> changedViewRows;
+    for(auto&& row : changedRows)
+    {
+        if(row < numRowsBefore)
+            changedViewRows.push_back(viewRows.at(row));
+    }
+
+    std::sort(changedViewRows.begin(), changedViewRows.end());
+
+    // One signal for each run of consecutive rows
+    for(int i = 0; i<changedViewRows.size(); )
+    {
+        auto j = i;
+        while(j + 1 < changedViewRows.size() && changedViewRows.at(j + 1) == changedViewRows.at(j) + 1)
+            ++j;
+
+        emit dataChanged(this->index(changedViewRows.at(i), 0), this->index(changedViewRows.at(j), headers.size() - 1));
+
+        i = j + 1;
+    }
+}
+
+
+void ResultsTableModel::setPrecisions(const QVector<int>& values)
+{
+    precisions = values;
+
+    if(!rowOrder.isEmpty() && !headers.isEmpty())
+        emit dataChanged(this->index(0, 0), this->index(rowOrder.size() - 1, headers.size() - 1), {Qt::DisplayRole});
+}
+
+
+void ResultsTableModel::clear(void)
+{
+    this->beginResetModel();
+
+    headers.clear();
+    IDs.clear();
+    columns.clear();
+    permutations.clear();
+    rowOrder.clear();
+
+    sortColumn = 0;
+    sortOrder = Qt::AscendingOrder;
+
+    this->endResetModel();
+}
+
+
+int ResultsTableModel::getRowID(const int row) const
+{
+    return IDs.at(rowOrder.at(row));
+}
+
+
+int ResultsTableModel::getSourceRow(const int row) const
+{
+    return rowOrder.at(row);
+}
+
+
+void ResultsTableModel::computePermutations(void)
+{
+    auto numRows = IDs.size();
+
+    permutations.fill(QVector<int>(), columns.size());
+
+    QVector<int> colIndices;
+    for(int i = 0; i<columns.size(); ++i)
+        colIndices.push_back(i);
+
+    // Each thread sorts the permutation of its own column, the vector is detached up front
+    auto permutationsData = permutations.data();
+
+    QtConcurrent::blockingMap(colIndices, [&](const int col)
+    {
+        const auto& values = columns.at(col);
+
+        QVector<int> permutation(numRows);
+        std::iota(permutation.begin(), permutation.end(), 0);
+
+        std::sort(permutation.begin(), permutation.end(), [&values](const int a, const int b)
+        {
+            return isLessThan(values, a, b);
+        });
+
+        permutationsData[col] = permutation;
+    });
+}
+
+
+QVector<int> ResultsTableModel::getDescendingPermutation(const int column) const
+{
+    const auto& ascending = permutations.at(column);
+    const auto& values = columns.at(column);
+
+    // The NaN values are at the end of the ascending permutation and stay there
+    auto numValues = ascending.size();
+    while(numValues > 0 && std::isnan(values.at(ascending.at(numValues - 1))))
+        --numValues;
+
+    QVector<int> descending;
+    descending.reserve(ascending.size());
+
+    // Take the runs of equal values from the largest to the smallest, each run keeps its rows in ascending order
+    auto end = numValues;
+
+    while(end > 0)
+    {
+        auto begin = end - 1;
+
+        while(begin > 0 && values.at(ascending.at(begin - 1)) == values.at(ascending.at(end - 1)))
+            --begin;
+
+        for(int i = begin; i<end; ++i)
+            descending.push_back(ascending.at(i));
+
+        end = begin;
+    }
+
+    for(int i = numValues; i<ascending.size(); ++i)
+        descending.push_back(ascending.at(i));
+
+    return descending;
+}
+
+
+void ResultsTableModel::setRowOrder(const QVector<int>& order)
+{
+    emit layoutAboutToBeChanged();
+
+    QVector<int> viewRows(order.size());
+    for(int i = 0; i<order.size(); ++i)
+        viewRows[order.at(i)] = i;
+
+    auto oldIndexes = this->persistentIndexList();
+
+    QModelIndexList newIndexes;
+    for(auto&& it : oldIndexes)
+        newIndexes.append(this->index(viewRows.at(rowOrder.at(it.row())), it.column()));
+
+    rowOrder = order;
+
+    this->changePersistentIndexList(oldIndexes, newIndexes);
+
+    emit layoutChanged();
+}
@@ -0,0 +1,115 @@
+#ifndef RESULTSTABLEMODEL_H
+#define RESULTSTABLEMODEL_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include <QAbstractTableModel>
+#include <QStringList>
+#include <QVector>
+
+// Read-only table model over typed result columns, the first column is the asset ID
+// The view only asks for the rows that are visible, and the rows are sorted through permutations of the row indices that are computed once per column when the results are set, the rows that are appended later are merged into them
+class ResultsTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    explicit ResultsTableModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+
+    // The display role returns the value as text, Qt::UserRole returns the value as a number
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
+
+    // The headers include the header of the asset ID column, each of the columns has one value per asset
+    void setResults(const QStringList& headers, const QVector<int>& IDs, const QVector<QVector<double>>& columns);
+
+    // Sets the results after rows were appended to them, the given rows are the ones that changed, the rows past the previous end are inserted
+    // Only the changed rows are sorted and merged into the permutations, and the view keeps the sorting that is selected
+    void updateResults(const QVector<int>& IDs, const QVector<QVector<double>>& columns, const QVector<int>& rows);
+
+    // The number of decimals that each column is shown with, the asset IDs are shown without decimals and the columns without a precision with two
+    void setPrecisions(const QVector<int>& values);
+
+    void clear(void);
+
+    // Returns the asset ID shown in the given row of the view
+    int getRowID(const int row) const;
+
+    // Returns the row in the results of the given row of the view
+    int getSourceRow(const int row) const;
+
+private:
+
+    // Computes the permutations that sort each column in ascending order
+    void computePermutations(void);
+
+    // The rows of a column in descending order, with the NaN values last and the equal values in the order of their rows
+    QVector<int> getDescendingPermutation(const int column) const;
+
+    // Shows the rows in the given order and moves the persistent indexes, e.g., the selection, with their rows
+    void setRowOrder(const QVector<int>& order);
+
+    QStringList headers;
+
+    // The number of decimals of each column
+    QVector<int> precisions;
+
+    QVector<int> IDs;
+
+    // The values of each column, the asset IDs are included as the first column so that they can be sorted like the others
+    QVector<QVector<double>> columns;
+
+    // The ascending sort permutation of each column
+    QVector<QVector<int>> permutations;
+
+    // The order in which the rows are shown
+    QVector<int> rowOrder;
+
+    // The sorting that is shown, so that it can be restored when the results are updated
+    int sortColumn;
+    Qt::SortOrder sortOrder;
+};
+
+#endif // RESULTSTABLEMODEL_H
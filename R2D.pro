@@ -118,7 +118,9 @@ SOURCES +=  Events/UI/EarthquakeRuptureForecast.cpp \
             Events/UI/HBoxFormLayout.cpp \
             Events/UI/IntensityMeasure.cpp \
             Events/UI/IntensityMeasureWidget.cpp \
+            Events/UI/LocalRecordSelector.cpp \
             Events/UI/Location.cpp \
+            Events/UI/NGAWest2Flatfile.cpp \
             Events/UI/PeerLoginDialog.cpp \
             Events/UI/PeerNGAWest2Client.cpp \
             Events/UI/PointSourceRupture.cpp \
@@ -128,6 +130,7 @@ SOURCES +=  Events/UI/EarthquakeRuptureForecast.cpp \
             Events/UI/RuptureLocation.cpp \
             Events/UI/RuptureWidget.cpp \
             Events/UI/Site.cpp \
+            Events/UI/SiteClusteredRecordSelector.cpp \
             Events/UI/SiteConfig.cpp \
             Events/UI/SiteConfigWidget.cpp \
             Events/UI/SiteGrid.cpp \
@@ -135,12 +138,35 @@ SOURCES +=  Events/UI/EarthquakeRuptureForecast.cpp \
             Events/UI/SiteWidget.cpp \
             Events/UI/SpatialCorrelationWidget.cpp \
             Tools/AssetInputDelegate.cpp \
+            Tools/BootstrapEngine.cpp \
             Tools/ComponentDatabase.cpp \
             Tools/CSVReaderWriter.cpp \
+            Tools/DMResultsProcessor.cpp \
+            Tools/DVResultsAggregator.cpp \
+            Tools/EDPResultsProcessor.cpp \
+            Tools/FFT.cpp \
+            Tools/GroundMotionRecordCache.cpp \
+            Tools/GroundMotionRecordFile.cpp \
+            Tools/GroundMotionSignalProcessor.cpp \
+            Tools/GroupByEngine.cpp \
+            Tools/IntensityMeasureCalculator.cpp \
+            Tools/MappedResultsTable.cpp \
+            Tools/MinMaxPyramid.cpp \
             Tools/NGAW2Converter.cpp \
+            Tools/PandasHDF5Reader.cpp \
+            Tools/PDFReportWriter.cpp \
+            Tools/PeerRecordParser.cpp \
             Tools/PelicunPostProcessor.cpp \
+            Tools/PointGridIndex.cpp \
             Tools/REmpiricalProbabilityDistribution.cpp \
+            Tools/RealizationStreamReader.cpp \
+            Tools/ResponseSpectrumCalculator.cpp \
+            Tools/ResultsComparison.cpp \
+            Tools/ResultsDirectoryWatcher.cpp \
+            Tools/ResultsTable.cpp \
+            Tools/SpatialAggregator.cpp \
             Tools/TablePrinter.cpp \
+            Tools/TDigest.cpp \
             Tools/XMLAdaptor.cpp \
             Tools/ShakeMapClient.cpp \
             UIWidgets/AnalysisWidget.cpp \
@@ -157,6 +183,7 @@ SOURCES +=  Events/UI/EarthquakeRuptureForecast.cpp \
             UIWidgets/ComponentInputWidget.cpp \
             UIWidgets/DLWidget.cpp \
             UIWidgets/DamageMeasureWidget.cpp \
+            UIWidgets/DamageStateChartWidget.cpp \
             UIWidgets/DecisionVariableWidget.cpp \
             UIWidgets/EarthquakeInputWidget.cpp \
             UIWidgets/EngDemandParameterWidget.cpp \
@@ -175,14 +202,18 @@ SOURCES +=  Events/UI/EarthquakeRuptureForecast.cpp \
             UIWidgets/NoneWidget.cpp \
             UIWidgets/OpenSeesPyBuildingModel.cpp \
             UIWidgets/PelicunDLWidget.cpp \
+            UIWidgets/PivotTableWidget.cpp \
             UIWidgets/PopUpWidget.cpp \
+            UIWidgets/ResultsComparisonWidget.cpp \
             UIWidgets/ResultsMapViewWidget.cpp \
             UIWidgets/ResultsWidget.cpp \
             UIWidgets/SecondaryComponentSelection.cpp \
             UIWidgets/ShakeMapWidget.cpp \
             UIWidgets/SimCenterEventRegional.cpp \
             UIWidgets/SimCenterMapGraphicsView.cpp \
+            UIWidgets/SpatialAggregationWidget.cpp \
             UIWidgets/StructuralModelingWidget.cpp \
+            UIWidgets/TimeHistoryChartWidget.cpp \
             UIWidgets/UQWidget.cpp \
             UIWidgets/UserDefinedEDPR.cpp \
             UIWidgets/UserInputGMWidget.cpp \
@@ -190,6 +221,7 @@ SOURCES +=  Events/UI/EarthquakeRuptureForecast.cpp \
             ModelViewItems/LayerTreeItem.cpp \
             ModelViewItems/TreeItem.cpp \
             ModelViewItems/ListTreeModel.cpp \
+            ModelViewItems/ResultsTableModel.cpp \
             ModelViewItems/LayerTreeModel.cpp \
             ModelViewItems/LayerTreeView.cpp \
             ModelViewItems/TreeViewStyle.cpp \
@@ -215,7 +247,9 @@ HEADERS +=  Events/UI/EarthquakeRuptureForecast.h \
             Events/UI/IntensityMeasure.h \
             Events/UI/IntensityMeasureWidget.h \
             Events/UI/JsonSerializable.h \
+            Events/UI/LocalRecordSelector.h \
             Events/UI/Location.h \
+            Events/UI/NGAWest2Flatfile.h \
             Events/UI/PeerLoginDialog.h \
             Events/UI/PeerNGAWest2Client.h \
             Events/UI/PointSourceRupture.h \
@@ -225,6 +259,7 @@ HEADERS +=  Events/UI/EarthquakeRuptureForecast.h \
             Events/UI/RuptureLocation.h \
             Events/UI/RuptureWidget.h \
             Events/UI/Site.h \
+            Events/UI/SiteClusteredRecordSelector.h \
             Events/UI/SiteConfig.h \
             Events/UI/SiteConfigWidget.h \
             Events/UI/SiteGrid.h \
@@ -232,12 +267,36 @@ HEADERS +=  Events/UI/EarthquakeRuptureForecast.h \
             Events/UI/SiteWidget.h \
             Events/UI/SpatialCorrelationWidget.h \
             Tools/AssetInputDelegate.h \
+            Tools/BootstrapEngine.h \
             Tools/ComponentDatabase.h \
             Tools/CSVReaderWriter.h \
+            Tools/DMResultsProcessor.h \
+            Tools/DVResultsAggregator.h \
+            Tools/EDPResultsProcessor.h \
+            Tools/FFT.h \
+            Tools/GroundMotionRecordCache.h \
+            Tools/GroundMotionRecordFile.h \
+            Tools/GroundMotionSignalProcessor.h \
+            Tools/GroupByEngine.h \
+            Tools/IntensityMeasureCalculator.h \
+            Tools/MappedResultsTable.h \
+            Tools/MinMaxPyramid.h \
             Tools/NGAW2Converter.h \
+            Tools/PandasHDF5Reader.h \
+            Tools/PDFReportWriter.h \
+            Tools/PeerRecordParser.h \
             Tools/PelicunPostProcessor.h \
+            Tools/PointGridIndex.h \
             Tools/REmpiricalProbabilityDistribution.h \
+            Tools/RealizationFields.h \
+            Tools/RealizationStreamReader.h \
+            Tools/ResponseSpectrumCalculator.h \
+            Tools/ResultsComparison.h \
+            Tools/ResultsDirectoryWatcher.h \
+            Tools/ResultsTable.h \
+            Tools/SpatialAggregator.h \
             Tools/TablePrinter.h \
+            Tools/TDigest.h \
             Tools/XMLAdaptor.h \
             Tools/shakeMapClient.h \
             UIWidgets/AnalysisWidget.h \
@@ -254,6 +313,7 @@ HEADERS +=  Events/UI/EarthquakeRuptureForecast.h \
             UIWidgets/ComponentInputWidget.h \
             UIWidgets/DLWidget.h \
             UIWidgets/DamageMeasureWidget.h \
+            UIWidgets/DamageStateChartWidget.h \
             UIWidgets/DecisionVariableWidget.h \
             UIWidgets/EarthquakeInputWidget.h \
             UIWidgets/EngDemandParameterWidget.h \
@@ -272,14 +332,18 @@ HEADERS +=  Events/UI/EarthquakeRuptureForecast.h \
             UIWidgets/NoneWidget.h \
             UIWidgets/OpenSeesPyBuildingModel.h \
             UIWidgets/PelicunDLWidget.h \
+            UIWidgets/PivotTableWidget.h \
             UIWidgets/PopUpWidget.h \
+            UIWidgets/ResultsComparisonWidget.h \
             UIWidgets/ResultsMapViewWidget.h \
             UIWidgets/ResultsWidget.h \
             UIWidgets/SecondaryComponentSelection.h \
             UIWidgets/ShakeMapWidget.h \
             UIWidgets/SimCenterEventRegional.h \
             UIWidgets/SimCenterMapGraphicsView.h \
+            UIWidgets/SpatialAggregationWidget.h \
             UIWidgets/StructuralModelingWidget.h \
+            UIWidgets/TimeHistoryChartWidget.h \
             UIWidgets/UQWidget.h \
             UIWidgets/UserDefinedEDPR.h \
             UIWidgets/UserInputGMWidget.h \
@@ -287,6 +351,7 @@ HEADERS +=  Events/UI/EarthquakeRuptureForecast.h \
             ModelViewItems/LayerTreeItem.h \
             ModelViewItems/TreeItem.h \
             ModelViewItems/ListTreeModel.h \
+            ModelViewItems/ResultsTableModel.h \
             ModelViewItems/LayerTreeModel.h \
             ModelViewItems/LayerTreeView.h \
             ModelViewItems/TreeViewStyle.h \
@@ -321,6 +386,11 @@ DISTFILES += \
 macos:LIBS += /usr/lib/libcurl.dylib -llapack -lblas
 linux:LIBS += /usr/lib/x86_64-linux-gnu/libcurl.so
 
+# HDF5 is used to read the pelicun results, on Windows it comes from conan
+macos:LIBS += -lhdf5
+linux:INCLUDEPATH += /usr/include/hdf5/serial
+linux:LIBS += -L/usr/lib/x86_64-linux-gnu/hdf5/serial -lhdf5
+
 # Path to build directory
 win32 {
 DESTDIR = $$shell_path($$OUT_PWD)
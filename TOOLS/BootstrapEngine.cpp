@@ -0,0 +1,253 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "BootstrapEngine.h"
+
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cmath>
+
+BootstrapEngine::BootstrapEngine(const int numReplicates, const double confidenceLevel) : numReplicates(numReplicates), confidenceLevel(confidenceLevel)
+{
+    seed = 20210315;
+
+    cancelled = false;
+}
+
+
+QVector<BootstrapInterval> BootstrapEngine::sumIntervals(const QVector<QVector<double>>& samples) const
+{
+    auto numMetrics = samples.size();
+
+    QVector<BootstrapInterval> intervals(numMetrics);
+
+    if(numMetrics == 0 || numReplicates < 2)
+        return intervals;
+
+    auto numSamples = samples.first().size();
+
+    for(auto&& it : samples)
+    {
+        if(it.size() != numSamples)
+            return intervals;
+    }
+
+    if(numSamples == 0)
+        return intervals;
+
+    // The replicate totals of each metric, each replicate is written by one thread
+    QVector<QVector<double>> replicateSums(numMetrics, QVector<double>(numReplicates, 0.0));
+
+    QVector<double*> replicateSumsData;
+    for(auto&& it : replicateSums)
+        replicateSumsData.push_back(it.data());
+
+    QVector<const double*> samplesData;
+    for(auto&& it : samples)
+        samplesData.push_back(it.constData());
+
+    QVector<int> replicates;
+    for(int i = 0; i<numReplicates; ++i)
+        replicates.push_back(i);
+
+    const auto localSeed = seed;
+
+    // Maps the upper 53 bits of a random number to [0, numSamples)
+    const auto scale = static_cast<double>(numSamples)/9007199254740992.0;
+
+    QtConcurrent::blockingMap(replicates, [&](const int replicate)
+    {
+        if(cancelled)
+            return;
+
+        // The indices are drawn in batches and then gathered metric by metric so that the inner loops are simple sums
+        const int batchSize = 1024;
+
+        int indices[batchSize];
+
+        QVector<double> sums(numMetrics, 0.0);
+
+        for(int begin = 0; begin<numSamples; begin += batchSize)
+        {
+            auto end = std::min(begin + batchSize, numSamples);
+            auto count = end - begin;
+
+            for(int j = 0; j<count; ++j)
+            {
+                auto r = BootstrapEngine::random(localSeed, replicate, begin + j);
+
+                indices[j] = std::min(static_cast<int>((r >> 11)*scale), numSamples - 1);
+            }
+
+            for(int m = 0; m<numMetrics; ++m)
+            {
+                auto values = samplesData.at(m);
+
+                auto sum = 0.0;
+
+                for(int j = 0; j<count; ++j)
+                    sum += values[indices[j]];
+
+                sums[m] += sum;
+            }
+        }
+
+        for(int m = 0; m<numMetrics; ++m)
+            replicateSumsData[m][replicate] = sums.at(m);
+    });
+
+    if(cancelled)
+        return QVector<BootstrapInterval>();
+
+    auto alpha = 1.0 - confidenceLevel;
+
+    // Percentile of the sorted replicates, interpolated between the order statistics
+    auto percentile = [](const QVector<double>& sorted, const double p)
+    {
+        auto pos = p*(sorted.size() - 1);
+        auto lower = static_cast<int>(pos);
+        auto upper = std::min(lower + 1, sorted.size() - 1);
+
+        return sorted.at(lower) + (pos - lower)*(sorted.at(upper) - sorted.at(lower));
+    };
+
+    for(int m = 0; m<numMetrics; ++m)
+    {
+        auto& sums = replicateSums[m];
+
+        std::sort(sums.begin(), sums.end());
+
+        auto& interval = intervals[m];
+
+        for(auto&& it : samples.at(m))
+            interval.estimate += it;
+
+        interval.lower = percentile(sums, alpha/2.0);
+        interval.upper = percentile(sums, 1.0 - alpha/2.0);
+
+        // Standard error from the variance of the replicates
+        auto mean = 0.0;
+        auto M2 = 0.0;
+
+        for(int i = 0; i<sums.size(); ++i)
+        {
+            auto delta = sums.at(i) - mean;
+            mean += delta/(i + 1);
+            M2 += delta*(sums.at(i) - mean);
+        }
+
+        interval.stdError = std::sqrt(M2/(sums.size() - 1));
+    }
+
+    return intervals;
+}
+
+
+void BootstrapEngine::cancel(void)
+{
+    cancelled = true;
+}
+
+
+void BootstrapEngine::resetCancel(void)
+{
+    cancelled = false;
+}
+
+
+bool BootstrapEngine::isCancelled(void) const
+{
+    return cancelled;
+}
+
+
+quint64 BootstrapEngine::random(const quint64 seed, const quint64 stream, const quint64 counter)
+{
+    // The key of a stream is hashed from the seed so that neighbouring streams are not correlated
+    auto key = BootstrapEngine::mix(seed ^ BootstrapEngine::mix(stream + 0x9E3779B97F4A7C15ULL));
+
+    return BootstrapEngine::mix(key + counter*0x9E3779B97F4A7C15ULL);
+}
+
+
+quint64 BootstrapEngine::mix(quint64 x)
+{
+    x = (x ^ (x >> 30))*0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27))*0x94D049BB133111EBULL;
+
+    return x ^ (x >> 31);
+}
+
+
+int BootstrapEngine::getNumReplicates() const
+{
+    return numReplicates;
+}
+
+
+void BootstrapEngine::setNumReplicates(const int value)
+{
+    if(value > 1)
+        numReplicates = value;
+}
+
+
+double BootstrapEngine::getConfidenceLevel() const
+{
+    return confidenceLevel;
+}
+
+
+void BootstrapEngine::setConfidenceLevel(const double value)
+{
+    if(value > 0.0 && value < 1.0)
+        confidenceLevel = value;
+}
+
+
+quint64 BootstrapEngine::getSeed() const
+{
+    return seed;
+}
+
+
+void BootstrapEngine::setSeed(const quint64 value)
+{
+    seed = value;
+}
@@ -0,0 +1,101 @@
+#ifndef BOOTSTRAPENGINE_H
+#define BOOTSTRAPENGINE_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include <QVector>
+
+#include <atomic>
+
+// Bootstrap estimate of a statistic with its percentile confidence interval
+struct BootstrapInterval
+{
+    double estimate = 0.0;
+    double lower = 0.0;
+    double upper = 0.0;
+    double stdError = 0.0;
+};
+
+
+// Nonparametric bootstrap of the totals of per asset, or per realization, results
+// The replicates are resampled in parallel on the global thread pool, each replicate draws from its own stream of a counter-based generator so that the results are the same regardless of the number of threads
+class BootstrapEngine
+{
+public:
+    BootstrapEngine(const int numReplicates = 2000, const double confidenceLevel = 0.90);
+
+    // Returns the interval of the sum of each metric, where samples[i] are the values of metric i over the assets
+    // All of the metrics are resampled with the same draws so that the intervals are consistent with each other
+    // Returns no intervals if it was cancelled, the flag is checked before each replicate
+    QVector<BootstrapInterval> sumIntervals(const QVector<QVector<double>>& samples) const;
+
+    // Stops a bootstrap that is running on another thread
+    void cancel(void);
+
+    // Clears a previous cancellation before a new bootstrap is started
+    void resetCancel(void);
+
+    bool isCancelled(void) const;
+
+    // The counter-based generator, returns the random number at the position counter of the stream
+    static quint64 random(const quint64 seed, const quint64 stream, const quint64 counter);
+
+    int getNumReplicates() const;
+    void setNumReplicates(const int value);
+
+    double getConfidenceLevel() const;
+    void setConfidenceLevel(const double value);
+
+    quint64 getSeed() const;
+    void setSeed(const quint64 value);
+
+private:
+
+    // The finalizer of SplitMix64
+    static quint64 mix(quint64 x);
+
+    int numReplicates;
+
+    double confidenceLevel;
+
+    quint64 seed;
+
+    std::atomic<bool> cancelled;
+};
+
+#endif // BOOTSTRAPENGINE_H
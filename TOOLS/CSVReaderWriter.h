@@ -56,8 +56,7 @@ public:
     // The string list corresponds to the items within a row, i.e., the values in the cells. There are as many items in the string list as there are in the row of the CSV file
     QVector<QStringList> parseCSVFile(const QString &pathToFile, QString& err);
 
-private:
-
+    // Parses a single row of a CSV file into the values of its cells
     QStringList parseLineCSV(const QString &csvString);
 
 };
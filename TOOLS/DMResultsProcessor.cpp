@@ -0,0 +1,279 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "DMResultsProcessor.h"
+#include "ResultsTable.h"
+
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+DMResultsProcessor::DMResultsProcessor()
+{
+
+}
+
+
+int DMResultsProcessor::process(const ResultsTable& DMResults, DMSummary& summary, QString& errMsg) const
+{
+    summary = DMSummary();
+
+    if(DMResults.isEmpty())
+    {
+        errMsg = "The DM results are empty";
+        return -1;
+    }
+
+    auto headers = DMResults.getHeaders();
+
+    // Group the columns by all of their levels except for the last one, which is the damage state
+    QVector<DamageStateGroup> groups;
+
+    for(int col = 1; col<headers.size(); ++col)
+    {
+        if(!DMResults.hasColumn(col))
+            continue;
+
+        auto levels = headers.at(col).split("-", Qt::SkipEmptyParts);
+
+        if(levels.size() < 2)
+            continue;
+
+        auto damageState = levels.takeLast();
+        auto name = levels.join("-");
+
+        auto it = std::find_if(groups.begin(), groups.end(), [&name](const DamageStateGroup& group)
+        {
+            return group.name == name;
+        });
+
+        if(it == groups.end())
+        {
+            DamageStateGroup group;
+            group.name = name;
+            groups.append(group);
+            it = groups.end() - 1;
+        }
+
+        it->damageStates.append(damageState);
+        it->columns.append(col);
+    }
+
+    // A column on its own, e.g., the collapse probability, is not a distribution of damage states
+    for(auto&& group : groups)
+    {
+        if(group.columns.size() < 2)
+            continue;
+
+        // Sort the damage states by their number where the labels are numbers, e.g., 1 or DS1, otherwise keep the order of the columns
+        QVector<int> order(group.columns.size());
+        std::iota(order.begin(), order.end(), 0);
+
+        QVector<double> values(group.columns.size());
+        auto allNumbers = true;
+
+        for(int k = 0; k<group.damageStates.size(); ++k)
+        {
+            auto label = group.damageStates.at(k);
+
+            if(label.startsWith("DS", Qt::CaseInsensitive))
+                label = label.mid(2);
+
+            bool OK;
+            values[k] = label.toDouble(&OK);
+
+            allNumbers = allNumbers && OK;
+        }
+
+        if(!allNumbers)
+            std::iota(values.begin(), values.end(), 0.0);
+
+        std::stable_sort(order.begin(), order.end(), [&values](const int a, const int b)
+        {
+            return values.at(a) < values.at(b);
+        });
+
+        DamageStateGroup sortedGroup;
+        sortedGroup.name = group.name;
+
+        for(auto&& k : order)
+        {
+            sortedGroup.damageStates.append(group.damageStates.at(k));
+            sortedGroup.columns.append(group.columns.at(k));
+            sortedGroup.damageStateValues.append(values.at(k));
+        }
+
+        summary.groups.append(sortedGroup);
+    }
+
+    if(summary.groups.isEmpty())
+    {
+        errMsg = "Could not find any damage states in the DM results";
+        return -1;
+    }
+
+    auto numRows = DMResults.numRows();
+    auto numGroups = summary.groups.size();
+
+    summary.IDs = DMResults.getIDs();
+    summary.expectedDamageStates.fill(QVector<double>(numRows, std::numeric_limits<double>::quiet_NaN()), numGroups);
+    summary.mostLikelyDamageStates.fill(QVector<int>(numRows, -1), numGroups);
+
+    // Each block writes to its own rows, the vectors are detached up front
+    QVector<double*> expectedData;
+    QVector<int*> mostLikelyData;
+
+    for(int g = 0; g<numGroups; ++g)
+    {
+        expectedData.append(summary.expectedDamageStates[g].data());
+        mostLikelyData.append(summary.mostLikelyDamageStates[g].data());
+    }
+
+    const int blockSize = 16384;
+
+    QVector<int> blocks;
+    for(int i = 0; i<numRows; i += blockSize)
+        blocks.push_back(i);
+
+    QtConcurrent::blockingMap(blocks, [&](const int begin)
+    {
+        auto end = std::min(begin + blockSize, numRows);
+
+        for(int g = 0; g<numGroups; ++g)
+        {
+            const auto& group = summary.groups.at(g);
+
+            QVector<const double*> columns;
+            for(auto&& col : group.columns)
+                columns.append(DMResults.getColumn(col).constData());
+
+            for(int i = begin; i<end; ++i)
+            {
+                auto sum = 0.0;
+                auto weightedSum = 0.0;
+                auto maxProb = 0.0;
+                auto mostLikely = -1;
+
+                for(int k = 0; k<columns.size(); ++k)
+                {
+                    auto prob = columns.at(k)[i];
+
+                    if(!(prob > 0.0))
+                        continue;
+
+                    sum += prob;
+                    weightedSum += prob*group.damageStateValues.at(k);
+
+                    if(prob > maxProb)
+                    {
+                        maxProb = prob;
+                        mostLikely = k;
+                    }
+                }
+
+                // The probabilities are normalized in case they do not sum to one, e.g., due to rounding in the csv file
+                if(sum > 0.0)
+                    expectedData[g][i] = weightedSum/sum;
+
+                mostLikelyData[g][i] = mostLikely;
+            }
+        }
+    });
+
+    return 0;
+}
+
+
+int DMResultsProcessor::getClassDistributions(const ResultsTable& DMResults, const DamageStateGroup& group, const DictionaryColumn& classColumn, QVector<QVector<double>>& distributions, QString& errMsg)
+{
+    distributions.clear();
+
+    if(classColumn.codes.size() != DMResults.numRows())
+    {
+        errMsg = "The class column " + classColumn.name + " has " + QString::number(classColumn.codes.size()) + " rows, the DM results have " + QString::number(DMResults.numRows());
+        return -1;
+    }
+
+    GroupByEngine theEngine;
+    theEngine.addKeyColumn(classColumn);
+
+    auto numClasses = classColumn.dictionary.size();
+    auto numStates = group.columns.size();
+
+    distributions.fill(QVector<double>(numStates, 0.0), numClasses);
+
+    // The mean probability of each damage state over the assets of a class
+    for(int k = 0; k<numStates; ++k)
+    {
+        GroupByResult result;
+
+        if(theEngine.groupBy(DMResults.getColumn(group.columns.at(k)), result, errMsg) != 0)
+            return -1;
+
+        for(int i = 0; i<result.numGroups(); ++i)
+        {
+            auto mean = result.means.at(i);
+
+            distributions[result.keyCodes.at(i).at(0)][k] = std::isnan(mean) ? 0.0 : mean;
+        }
+    }
+
+    // Normalize so that the fractions of each class sum to one
+    for(auto&& it : distributions)
+    {
+        auto sum = std::accumulate(it.begin(), it.end(), 0.0);
+
+        if(sum > 0.0)
+        {
+            for(auto&& val : it)
+                val /= sum;
+        }
+    }
+
+    return 0;
+}
+
+
+QStringList DMResultsProcessor::getDamageFields(void)
+{
+    return {"ExpectedDS", "MostLikelyDS"};
+}
+
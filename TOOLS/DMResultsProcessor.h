@@ -0,0 +1,94 @@
+#ifndef DMRESULTSPROCESSOR_H
+#define DMRESULTSPROCESSOR_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "GroupByEngine.h"
+
+#include <QStringList>
+#include <QVector>
+
+class ResultsTable;
+
+// The damage state probabilities of a group of components of the assets, e.g., the structural components
+struct DamageStateGroup
+{
+    QString name;
+
+    // The labels of the damage states in ascending order and their columns in the DM results
+    QStringList damageStates;
+    QVector<int> columns;
+
+    // The damage state number of each label, or its position if the label is not a number
+    QVector<double> damageStateValues;
+};
+
+
+// The per asset damage of each group
+struct DMSummary
+{
+    QVector<int> IDs;
+
+    QVector<DamageStateGroup> groups;
+
+    // The expected damage state of each asset, i.e., expectedDamageStates[g][i] is the mean damage state of group g of asset i
+    QVector<QVector<double>> expectedDamageStates;
+
+    // The index into the damage states of the group of the most likely damage state of each asset, or -1 if there are no probabilities
+    QVector<QVector<int>> mostLikelyDamageStates;
+};
+
+
+// Summarizes the DM results of pelicun, i.e., the probability of each damage state of each group of components of an asset
+// The columns are labelled with the levels of the group and the damage state, e.g., S-1-DS2, the columns that share all but the last level form a group
+class DMResultsProcessor
+{
+public:
+    DMResultsProcessor();
+
+    int process(const ResultsTable& DMResults, DMSummary& summary, QString& errMsg) const;
+
+    // The distribution of the damage states of a group in each class of assets, e.g., in each occupancy class
+    // The class column must be in the order of the rows of the DM results, distributions[c][k] is the fraction of the assets of class c in damage state k
+    static int getClassDistributions(const ResultsTable& DMResults, const DamageStateGroup& group, const DictionaryColumn& classColumn, QVector<QVector<double>>& distributions, QString& errMsg);
+
+    // The names of the damage columns that are written to the assets, for the first group in the results
+    static QStringList getDamageFields(void);
+};
+
+#endif // DMRESULTSPROCESSOR_H
@@ -0,0 +1,217 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "DVResultsAggregator.h"
+#include "ResultsTable.h"
+
+#include <QtConcurrent>
+
+DVResultsTotals::DVResultsTotals()
+{
+    beginRow = 0;
+    endRow = 0;
+    structLosses.fill(0.0,4);
+    NSAccLosses.fill(0.0,4);
+    NSDriftLosses.fill(0.0,4);
+    injuries.fill(0.0,4);
+    repairTime = 0.0;
+    numAssets = 0;
+}
+
+
+void DVResultsTotals::merge(const DVResultsTotals& other)
+{
+    for(int i = 0; i<4; ++i)
+    {
+        structLosses[i] += other.structLosses.at(i);
+        NSAccLosses[i] += other.NSAccLosses.at(i);
+        NSDriftLosses[i] += other.NSDriftLosses.at(i);
+        injuries[i] += other.injuries.at(i);
+    }
+
+    repairTime += other.repairTime;
+
+    repairCostDistribution.merge(other.repairCostDistribution);
+
+    numAssets += other.numAssets;
+
+    if(errMsg.isEmpty())
+        errMsg = other.errMsg;
+}
+
+
+DVResultsAggregator::DVResultsAggregator(const bool withNSLosses) : withNSLosses(withNSLosses)
+{
+    blockSize = 4096;
+}
+
+
+QFuture<DVResultsTotals> DVResultsAggregator::run(const ResultsTable& DVResults, const QVector<int>& rows) const
+{
+    // The columns are implicitly shared so the copy in the lambda is cheap
+    auto aggregator = *this;
+
+    return QtConcurrent::run([aggregator, DVResults, rows]()
+    {
+        return aggregator.compute(DVResults, rows);
+    });
+}
+
+
+DVResultsTotals DVResultsAggregator::compute(const ResultsTable& DVResults, const QVector<int>& rows) const
+{
+    auto numRows = rows.isEmpty() ? DVResults.numRows() : rows.size();
+
+    // Split the rows into blocks
+    QVector<DVResultsTotals> blocks;
+
+    for(int i = 0; i<numRows; i += blockSize)
+    {
+        DVResultsTotals block;
+        block.beginRow = i;
+        block.endRow = std::min(i + blockSize, numRows);
+
+        blocks.push_back(block);
+    }
+
+    // Each block is summed independently
+    QtConcurrent::blockingMap(blocks, [this, &DVResults, &rows](DVResultsTotals& block)
+    {
+        this->processBlock(DVResults, rows, block);
+    });
+
+    // Merge the partial sums in the order of the blocks
+    DVResultsTotals totals;
+    totals.beginRow = 0;
+    totals.endRow = numRows;
+
+    for(auto&& block : blocks)
+        totals.merge(block);
+
+    return totals;
+}
+
+
+void DVResultsAggregator::processBlock(const ResultsTable& DVResults, const QVector<int>& rows, DVResultsTotals& block) const
+{
+    // Gather the rows through the selection if one is given
+    auto rowAt = [&rows](const int i)
+    {
+        return rows.isEmpty() ? i : rows.at(i);
+    };
+
+    // Exceptions cannot be thrown across threads, an error is recorded in the block instead
+    auto sumColumn = [&](const int col)
+    {
+        if(!DVResults.hasColumn(col))
+        {
+            block.errMsg = "The DV results are missing the column " + QString::number(col);
+            return 0.0;
+        }
+
+        const auto& values = DVResults.getColumn(col);
+
+        auto sum = 0.0;
+        for(int i = block.beginRow; i<block.endRow; ++i)
+            sum += values.at(rowAt(i));
+
+        return sum;
+    };
+
+    // This assumes that the output from pelicun will not change
+    if(DVResults.hasColumn(1))
+    {
+        const auto& costs = DVResults.getColumn(1);     // Aggregate repair cost (mean)
+
+        for(int i = block.beginRow; i<block.endRow; ++i)
+            block.repairCostDistribution.addSample(costs.at(rowAt(i)));
+    }
+    else
+        block.errMsg = "The DV results are missing the column 1";
+
+    // Aggregate repair time (mean)
+    if(withNSLosses)
+        block.repairTime = sumColumn(28);
+    else
+        block.repairTime = sumColumn(13);
+
+    // Structural losses damage state 1 to 4 (mean)
+    for(int j = 0; j<4; ++j)
+        block.structLosses[j] = sumColumn(8+j);
+
+    if(withNSLosses)
+    {
+        for(int j = 0; j<4; ++j)
+        {
+            block.NSAccLosses[j] = sumColumn(19+j);    // Non-structural acceleration sensitive losses damage state 1 to 4 (mean)
+            block.NSDriftLosses[j] = sumColumn(24+j);  // Non-structural drift sensitive losses damage state 1 to 4 (mean)
+        }
+
+        // Injuries severity level 1 to 4 (mean)
+        for(int j = 0; j<4; ++j)
+            block.injuries[j] = sumColumn(33+5*j);
+    }
+    else
+    {
+        // Injuries severity level 1 to 4 (mean)
+        for(int j = 0; j<4; ++j)
+            block.injuries[j] = sumColumn(18+5*j);
+    }
+
+    block.numAssets = block.endRow - block.beginRow;
+}
+
+
+bool DVResultsAggregator::hasNSLosses(const ResultsTable& DVResults)
+{
+    // There are 38 columns, including the asset ID, without the non-structural losses
+    return DVResults.numColumns() != 38;
+}
+
+
+int DVResultsAggregator::getBlockSize() const
+{
+    return blockSize;
+}
+
+
+void DVResultsAggregator::setBlockSize(int value)
+{
+    if(value > 0)
+        blockSize = value;
+}
@@ -0,0 +1,112 @@
+#ifndef DVRESULTSAGGREGATOR_H
+#define DVRESULTSAGGREGATOR_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "REmpiricalProbabilityDistribution.h"
+
+#include <QFuture>
+#include <QString>
+#include <QVector>
+
+class ResultsTable;
+
+// Sums of the pelicun DV results over a block of assets
+// The partial sums of the individual blocks are merged into the regional totals
+struct DVResultsTotals
+{
+    DVResultsTotals();
+
+    // Adds the sums of another block to this one
+    void merge(const DVResultsTotals& other);
+
+    // The range of rows [beginRow, endRow) in the results that this block covers, or the range of entries in the list of selected rows
+    int beginRow;
+    int endRow;
+
+    // Losses for damage states 1 to 4
+    QVector<double> structLosses;
+    QVector<double> NSAccLosses;
+    QVector<double> NSDriftLosses;
+
+    // Injuries for severity levels 1 to 4, where level 4 are the fatalities
+    QVector<double> injuries;
+
+    double repairTime;
+
+    // Distribution of the mean repair cost of the assets in the block, for the histogram
+    REmpiricalProbabilityDistribution repairCostDistribution;
+
+    int numAssets;
+
+    // Non-empty if a column is missing from the results
+    QString errMsg;
+};
+
+
+// Parallel reduction of the pelicun DV results
+// The rows are split into blocks that are summed on the global thread pool, the partial sums are then merged in the order of the blocks so that the totals do not depend on the number of threads
+class DVResultsAggregator
+{
+public:
+    DVResultsAggregator(const bool withNSLosses);
+
+    // Starts the reduction on a worker thread and returns immediately
+    // If rows is not empty then only the given rows are summed, e.g., the rows of a selection of assets
+    QFuture<DVResultsTotals> run(const ResultsTable& DVResults, const QVector<int>& rows = QVector<int>()) const;
+
+    // Runs the reduction and blocks until it is complete
+    DVResultsTotals compute(const ResultsTable& DVResults, const QVector<int>& rows = QVector<int>()) const;
+
+    // The non-structural losses are not in the results if the analysis did not include them
+    static bool hasNSLosses(const ResultsTable& DVResults);
+
+    int getBlockSize() const;
+    void setBlockSize(int value);
+
+private:
+
+    void processBlock(const ResultsTable& DVResults, const QVector<int>& rows, DVResultsTotals& block) const;
+
+    bool withNSLosses;
+
+    // The number of rows processed by a thread at a time
+    int blockSize;
+};
+
+#endif // DVRESULTSAGGREGATOR_H
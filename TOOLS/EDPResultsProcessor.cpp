@@ -0,0 +1,264 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "EDPResultsProcessor.h"
+#include "ResultsTable.h"
+
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+EDPResultsProcessor::EDPResultsProcessor()
+{
+    statistic = "mean";
+}
+
+
+int EDPResultsProcessor::process(const ResultsTable& EDPResults, EDPSummary& summary, QString& errMsg) const
+{
+    summary = EDPSummary();
+
+    if(EDPResults.isEmpty())
+    {
+        errMsg = "The EDP results are empty";
+        return -1;
+    }
+
+    auto headers = EDPResults.getHeaders();
+
+    // Split the headers into their levels, the levels are the type, the location, the direction and, if there is more than one statistic, the statistic
+    QVector<QStringList> levels(headers.size());
+
+    QStringList statistics;
+
+    for(int col = 1; col<headers.size(); ++col)
+    {
+        if(!EDPResults.hasColumn(col))
+            continue;
+
+        levels[col] = headers.at(col).split("-", Qt::SkipEmptyParts);
+
+        if(levels.at(col).size() >= 4 && !statistics.contains(levels.at(col).last()))
+            statistics.append(levels.at(col).last());
+    }
+
+    QString selectedStatistic;
+
+    for(auto&& it : statistics)
+    {
+        if(it.compare(statistic, Qt::CaseInsensitive) == 0)
+            selectedStatistic = it;
+    }
+
+    if(selectedStatistic.isEmpty() && !statistics.isEmpty())
+        selectedStatistic = statistics.first();
+
+    // The columns of each demand type and their locations
+    QVector<QVector<int>> typeColumns;
+    QVector<QVector<int>> typeLocations;
+
+    for(int col = 1; col<headers.size(); ++col)
+    {
+        const auto& colLevels = levels.at(col);
+
+        if(colLevels.isEmpty())
+            continue;
+
+        if(!selectedStatistic.isEmpty() && colLevels.size() >= 4 && colLevels.last() != selectedStatistic)
+            continue;
+
+        auto type = colLevels.first();
+
+        auto typeIndex = summary.demandTypes.indexOf(type);
+
+        if(typeIndex == -1)
+        {
+            typeIndex = summary.demandTypes.size();
+            summary.demandTypes.append(type);
+            typeColumns.append(QVector<int>());
+            typeLocations.append(QVector<int>());
+        }
+
+        typeColumns[typeIndex].append(col);
+        typeLocations[typeIndex].append(colLevels.value(1).toInt());
+    }
+
+    if(summary.demandTypes.isEmpty())
+    {
+        errMsg = "Could not find any demands in the EDP results";
+        return -1;
+    }
+
+    auto numRows = EDPResults.numRows();
+    auto numTypes = summary.demandTypes.size();
+
+    summary.IDs = EDPResults.getIDs();
+    summary.peakDemands.fill(QVector<double>(numRows, std::numeric_limits<double>::quiet_NaN()), numTypes);
+    summary.peakLocations.fill(QVector<int>(numRows, 0), numTypes);
+
+    // The column pointers so that the inner loop does not go through the table
+    QVector<QVector<const double*>> typeData(numTypes);
+
+    for(int k = 0; k<numTypes; ++k)
+    {
+        for(auto&& col : typeColumns.at(k))
+            typeData[k].append(EDPResults.getColumn(col).constData());
+    }
+
+    // Each block writes to its own rows of the peak demands, the vectors are detached up front
+    QVector<double*> peakData;
+    QVector<int*> locationData;
+
+    for(int k = 0; k<numTypes; ++k)
+    {
+        peakData.append(summary.peakDemands[k].data());
+        locationData.append(summary.peakLocations[k].data());
+    }
+
+    const int blockSize = 16384;
+
+    QVector<int> blocks;
+    for(int i = 0; i<numRows; i += blockSize)
+        blocks.push_back(i);
+
+    // The partial sums and maximums of each block, merged in the order of the blocks
+    QVector<QVector<double>> blockSums(blocks.size(), QVector<double>(numTypes, 0.0));
+    QVector<QVector<double>> blockMaxs(blocks.size(), QVector<double>(numTypes, std::numeric_limits<double>::lowest()));
+    QVector<QVector<int>> blockCounts(blocks.size(), QVector<int>(numTypes, 0));
+
+    auto blockSumsData = blockSums.data();
+    auto blockMaxsData = blockMaxs.data();
+    auto blockCountsData = blockCounts.data();
+
+    QtConcurrent::blockingMap(blocks, [&](const int begin)
+    {
+        auto end = std::min(begin + blockSize, numRows);
+        auto block = begin/blockSize;
+
+        auto& sums = blockSumsData[block];
+        auto& maxs = blockMaxsData[block];
+        auto& counts = blockCountsData[block];
+
+        for(int k = 0; k<numTypes; ++k)
+        {
+            const auto& columns = typeData.at(k);
+            const auto& locations = typeLocations.at(k);
+
+            for(int i = begin; i<end; ++i)
+            {
+                auto peak = std::numeric_limits<double>::lowest();
+                auto location = 0;
+
+                for(int c = 0; c<columns.size(); ++c)
+                {
+                    auto val = columns.at(c)[i];
+
+                    if(val > peak)
+                    {
+                        peak = val;
+                        location = locations.at(c);
+                    }
+                }
+
+                // All of the demands of the asset are NaN
+                if(peak == std::numeric_limits<double>::lowest())
+                    continue;
+
+                peakData[k][i] = peak;
+                locationData[k][i] = location;
+
+                sums[k] += peak;
+                maxs[k] = std::max(maxs[k], peak);
+                ++counts[k];
+            }
+        }
+    });
+
+    summary.portfolioMeans.fill(0.0, numTypes);
+    summary.portfolioMaxs.fill(std::numeric_limits<double>::quiet_NaN(), numTypes);
+
+    for(int k = 0; k<numTypes; ++k)
+    {
+        auto sum = 0.0;
+        auto max = std::numeric_limits<double>::lowest();
+        auto count = 0;
+
+        for(int b = 0; b<blocks.size(); ++b)
+        {
+            sum += blockSums.at(b).at(k);
+            max = std::max(max, blockMaxs.at(b).at(k));
+            count += blockCounts.at(b).at(k);
+        }
+
+        if(count == 0)
+            continue;
+
+        summary.portfolioMeans[k] = sum/count;
+        summary.portfolioMaxs[k] = max;
+    }
+
+    return 0;
+}
+
+
+QString EDPResultsProcessor::getStatistic() const
+{
+    return statistic;
+}
+
+
+void EDPResultsProcessor::setStatistic(const QString& value)
+{
+    statistic = value;
+}
+
+
+QString EDPResultsProcessor::getDemandField(const QString& demandType)
+{
+    return "Max" + demandType;
+}
+
+
+QStringList EDPResultsProcessor::getDemandFields(void)
+{
+    // The demands of the regional earthquake workflow, i.e., the peak interstory drift and the peak floor acceleration
+    return {getDemandField("PID"), getDemandField("PFA")};
+}
+
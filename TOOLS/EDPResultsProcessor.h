@@ -0,0 +1,89 @@
+#ifndef EDPRESULTSPROCESSOR_H
+#define EDPRESULTSPROCESSOR_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include <QStringList>
+#include <QVector>
+
+class ResultsTable;
+
+// The peak demands of each asset, e.g., the maximum peak interstory drift over the stories and the directions
+struct EDPSummary
+{
+    QVector<int> IDs;
+
+    // The demand types in the results, e.g., PID and PFA
+    QStringList demandTypes;
+
+    // The peak of each demand type over the locations and the directions of each asset, i.e., peakDemands[k][i] is the peak of demand type k of asset i
+    QVector<QVector<double>> peakDemands;
+
+    // The location, i.e., the story or the floor, where the peak of each demand type occurs
+    QVector<QVector<int>> peakLocations;
+
+    // The mean and the maximum of the peak demands over all of the assets
+    QVector<double> portfolioMeans;
+    QVector<double> portfolioMaxs;
+};
+
+
+// Computes the per asset peak demands from the EDP results of pelicun
+// The columns of the results are labelled with the demand type, the location, the direction and the statistic, e.g., PID-1-1-mean
+// The columns of the selected statistic are reduced in one pass over the rows, the rows are split into blocks that are processed on separate threads
+class EDPResultsProcessor
+{
+public:
+    EDPResultsProcessor();
+
+    int process(const ResultsTable& EDPResults, EDPSummary& summary, QString& errMsg) const;
+
+    // The statistic of the demands that is reduced, e.g., mean or median, the first statistic of the results is used if it is not found
+    QString getStatistic() const;
+    void setStatistic(const QString& value);
+
+    // The names of the peak demand columns that are written to the assets, e.g., MaxPID and MaxPFA
+    static QString getDemandField(const QString& demandType);
+    static QStringList getDemandFields(void);
+
+private:
+
+    QString statistic;
+};
+
+#endif // EDPRESULTSPROCESSOR_H
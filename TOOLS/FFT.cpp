@@ -0,0 +1,165 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "FFT.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+void FFT::transform(QVector<std::complex<double>>& data, const bool inverse)
+{
+    const double pi = 3.14159265358979323846;
+
+    auto n = data.size();
+
+    if(n < 2)
+        return;
+
+    auto values = data.data();
+
+    // Bit reversal permutation
+    for(int i = 1, j = 0; i<n; ++i)
+    {
+        auto bit = n >> 1;
+
+        for(; j & bit; bit >>= 1)
+            j ^= bit;
+
+        j ^= bit;
+
+        if(i < j)
+            std::swap(values[i], values[j]);
+    }
+
+    // Butterflies, the twiddle factors of a stage are computed once and shared by all of its butterflies
+    QVector<std::complex<double>> twiddles(n/2);
+
+    for(int len = 2; len<=n; len <<= 1)
+    {
+        auto halfLen = len/2;
+
+        auto angle = 2.0*pi/len*(inverse ? 1.0 : -1.0);
+
+        for(int k = 0; k<halfLen; ++k)
+            twiddles[k] = std::polar(1.0, angle*k);
+
+        for(int i = 0; i<n; i += len)
+        {
+            for(int k = 0; k<halfLen; ++k)
+            {
+                auto u = values[i+k];
+                auto v = values[i+k+halfLen]*twiddles.at(k);
+
+                values[i+k] = u + v;
+                values[i+k+halfLen] = u - v;
+            }
+        }
+    }
+
+    if(inverse)
+    {
+        auto factor = 1.0/n;
+
+        for(int i = 0; i<n; ++i)
+            values[i] *= factor;
+    }
+}
+
+
+QVector<std::complex<double>> FFT::forward(const QVector<double>& signal, const int size)
+{
+    QVector<std::complex<double>> spectrum(size, std::complex<double>(0.0, 0.0));
+
+    auto numValues = std::min(signal.size(), size);
+
+    for(int i = 0; i<numValues; ++i)
+        spectrum[i] = std::complex<double>(signal.at(i), 0.0);
+
+    FFT::transform(spectrum);
+
+    return spectrum;
+}
+
+
+QVector<double> FFT::inverse(QVector<std::complex<double>> spectrum)
+{
+    FFT::transform(spectrum, true);
+
+    QVector<double> signal(spectrum.size());
+
+    for(int i = 0; i<spectrum.size(); ++i)
+        signal[i] = spectrum.at(i).real();
+
+    return signal;
+}
+
+
+QVector<double> FFT::convolve(const QVector<double>& a, const QVector<double>& b)
+{
+    if(a.isEmpty() || b.isEmpty())
+        return QVector<double>();
+
+    auto resultSize = a.size() + b.size() - 1;
+
+    // Zero pad so that the circular convolution of the transform does not wrap around
+    auto size = FFT::nextPowerOfTwo(resultSize);
+
+    auto spectrumA = FFT::forward(a, size);
+    auto spectrumB = FFT::forward(b, size);
+
+    for(int i = 0; i<size; ++i)
+        spectrumA[i] *= spectrumB.at(i);
+
+    auto result = FFT::inverse(spectrumA);
+
+    result.resize(resultSize);
+
+    return result;
+}
+
+
+int FFT::nextPowerOfTwo(const int n)
+{
+    int size = 1;
+
+    while(size < n)
+        size <<= 1;
+
+    return size;
+}
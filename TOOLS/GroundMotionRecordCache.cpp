@@ -0,0 +1,587 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "GroundMotionRecordCache.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QSet>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cctype>
+
+namespace
+{
+// Reads the top level keys of a json object without parsing the arrays, the text of each scalar value is returned and the elements of each array are counted
+int scanJsonObject(const QByteArray& bytes, QHash<QString, QByteArray>& scalars, QHash<QString, int>& arraySizes)
+{
+    const auto data = bytes.constData();
+    const int n = bytes.size();
+
+    int i = 0;
+
+    auto skipSpace = [&]()
+    {
+        while(i < n && std::isspace(static_cast<unsigned char>(data[i])))
+            ++i;
+    };
+
+    // Moves past the string that starts at the current position
+    auto skipString = [&]()
+    {
+        ++i;
+
+        while(i < n)
+        {
+            if(data[i] == '\\')
+                i += 2;
+            else if(data[i++] == '"')
+                return true;
+        }
+
+        return false;
+    };
+
+    skipSpace();
+
+    if(i >= n || data[i] != '{')
+        return -1;
+
+    ++i;
+
+    while(true)
+    {
+        skipSpace();
+
+        if(i < n && data[i] == '}')
+            return 0;
+
+        if(i >= n || data[i] != '"')
+            return -1;
+
+        auto keyBegin = i + 1;
+
+        if(!skipString())
+            return -1;
+
+        auto key = QString::fromUtf8(data + keyBegin, i - keyBegin - 1);
+
+        skipSpace();
+
+        if(i >= n || data[i] != ':')
+            return -1;
+
+        ++i;
+
+        skipSpace();
+
+        auto valueBegin = i;
+        auto isArray = i < n && data[i] == '[';
+
+        // Skip the value, the commas at the first level of an array separate its elements
+        int depth = 0;
+        int numElements = 0;
+        bool hasElement = false;
+
+        while(i < n)
+        {
+            auto c = data[i];
+
+            if(c == '"')
+            {
+                hasElement = hasElement || depth == 1;
+
+                if(!skipString())
+                    return -1;
+
+                continue;
+            }
+
+            if(c == '[' || c == '{')
+            {
+                hasElement = hasElement || depth == 1;
+                ++depth;
+            }
+            else if(c == ']' || c == '}')
+            {
+                if(depth == 0)
+                    break;
+
+                --depth;
+
+                if(depth == 0)
+                {
+                    ++i;
+                    break;
+                }
+            }
+            else if(c == ',')
+            {
+                if(depth == 0)
+                    break;
+
+                if(depth == 1)
+                    ++numElements;
+            }
+            else if(depth == 1 && !std::isspace(static_cast<unsigned char>(c)))
+                hasElement = true;
+
+            ++i;
+        }
+
+        if(isArray)
+            arraySizes.insert(key, hasElement ? numElements + 1 : 0);
+        else
+            scalars.insert(key, QByteArray(data + valueBegin, i - valueBegin).trimmed());
+
+        skipSpace();
+
+        if(i < n && data[i] == ',')
+        {
+            ++i;
+            continue;
+        }
+
+        if(i < n && data[i] == '}')
+            return 0;
+
+        return -1;
+    }
+}
+
+
+// Parses the text of a scalar json value, an empty text is an undefined value
+QJsonValue parseJsonScalar(const QByteArray& text)
+{
+    if(text.isEmpty())
+        return QJsonValue(QJsonValue::Undefined);
+
+    auto doc = QJsonDocument::fromJson("[" + text + "]");
+
+    if(!doc.isArray() || doc.array().isEmpty())
+        return QJsonValue(QJsonValue::Undefined);
+
+    return doc.array().at(0);
+}
+}
+
+GroundMotionRecordCache::GroundMotionRecordCache()
+{
+    residentBytes = 0;
+
+    // About 300 records of three components with 10,000 points each
+    memoryBudget = 256*1024*1024;
+}
+
+
+int GroundMotionRecordCache::loadRecords(const QStringList& recordFiles, QString& errMsg)
+{
+    auto newFiles = this->getNewRecordFiles(recordFiles);
+
+    auto numFiles = newFiles.size();
+
+    if(numFiles == 0)
+        return 0;
+
+    // Each file is read into its own slot, so the threads do not share anything
+    QVector<std::shared_ptr<GroundMotionRecordInfo>> newInfos(numFiles);
+    QVector<QString> errors(numFiles);
+
+    auto infosData = newInfos.data();
+    auto errorsData = errors.data();
+
+    QVector<int> indices(numFiles);
+    for(int i = 0; i<numFiles; ++i)
+        indices[i] = i;
+
+    QtConcurrent::blockingMap(indices, [&](const int i)
+    {
+        auto info = std::make_shared<GroundMotionRecordInfo>();
+
+        if(readRecordInfo(newFiles.at(i), *info, errorsData[i]) == 0)
+            infosData[i] = std::move(info);
+    });
+
+    // Keep the records that were read, and report the first file that failed
+    for(int i = 0; i<numFiles; ++i)
+    {
+        if(newInfos.at(i))
+            this->insertRecordInfo(newFiles.at(i), newInfos.at(i));
+        else if(errMsg.isEmpty())
+            errMsg = errors.at(i);
+    }
+
+    return errMsg.isEmpty() ? 0 : -1;
+}
+
+
+QStringList GroundMotionRecordCache::getNewRecordFiles(const QStringList& recordFiles) const
+{
+    QStringList newFiles;
+    QSet<QString> seenFiles;
+
+    QMutexLocker locker(&mutex);
+
+    for(auto&& it : recordFiles)
+    {
+        if(recordInfos.contains(it) || seenFiles.contains(it))
+            continue;
+
+        seenFiles.insert(it);
+        newFiles.append(it);
+    }
+
+    return newFiles;
+}
+
+
+void GroundMotionRecordCache::insertRecordInfo(const QString& recordFile, std::shared_ptr<const GroundMotionRecordInfo> info)
+{
+    QMutexLocker locker(&mutex);
+
+    recordInfos.insert(recordFile, info);
+}
+
+
+std::shared_ptr<const GroundMotionRecordInfo> GroundMotionRecordCache::getRecordInfo(const QString& recordFile) const
+{
+    QMutexLocker locker(&mutex);
+
+    return recordInfos.value(recordFile);
+}
+
+
+std::shared_ptr<const GroundMotionRecord> GroundMotionRecordCache::getRecord(const QString& recordFile, QString& errMsg)
+{
+    {
+        QMutexLocker locker(&mutex);
+
+        auto it = residentRecords.find(recordFile);
+
+        if(it != residentRecords.end())
+        {
+            recentlyUsed.splice(recentlyUsed.begin(), recentlyUsed, it->position);
+            return it->record;
+        }
+    }
+
+    // The file is read without holding the lock, so that other records can be served in the meantime
+    auto record = std::make_shared<GroundMotionRecord>();
+
+    if(readRecord(recordFile, *record, errMsg) != 0)
+        return nullptr;
+
+    QMutexLocker locker(&mutex);
+
+    // Another thread may have read the same record in the meantime
+    auto it = residentRecords.find(recordFile);
+
+    if(it != residentRecords.end())
+    {
+        recentlyUsed.splice(recentlyUsed.begin(), recentlyUsed, it->position);
+        return it->record;
+    }
+
+    recentlyUsed.push_front(recordFile);
+
+    ResidentRecord resident;
+    resident.record = record;
+    resident.numBytes = recordBytes(*record);
+    resident.position = recentlyUsed.begin();
+
+    residentRecords.insert(recordFile, resident);
+    residentBytes += resident.numBytes;
+
+    this->evict();
+
+    return record;
+}
+
+
+std::shared_ptr<const GroundMotionRecord> GroundMotionRecordCache::peekRecord(const QString& recordFile, QString& errMsg) const
+{
+    {
+        QMutexLocker locker(&mutex);
+
+        auto it = residentRecords.find(recordFile);
+
+        if(it != residentRecords.end())
+            return it->record;
+    }
+
+    auto record = std::make_shared<GroundMotionRecord>();
+
+    if(readRecord(recordFile, *record, errMsg) != 0)
+        return nullptr;
+
+    return record;
+}
+
+
+bool GroundMotionRecordCache::contains(const QString& recordFile) const
+{
+    QMutexLocker locker(&mutex);
+
+    return recordInfos.contains(recordFile);
+}
+
+
+int GroundMotionRecordCache::size(void) const
+{
+    QMutexLocker locker(&mutex);
+
+    return recordInfos.size();
+}
+
+
+void GroundMotionRecordCache::clear(void)
+{
+    QMutexLocker locker(&mutex);
+
+    recordInfos.clear();
+    residentRecords.clear();
+    recentlyUsed.clear();
+    residentBytes = 0;
+}
+
+
+qint64 GroundMotionRecordCache::getMemoryBudget() const
+{
+    QMutexLocker locker(&mutex);
+
+    return memoryBudget;
+}
+
+
+void GroundMotionRecordCache::setMemoryBudget(const qint64 value)
+{
+    QMutexLocker locker(&mutex);
+
+    if(value <= 0)
+        return;
+
+    memoryBudget = value;
+
+    this->evict();
+}
+
+
+qint64 GroundMotionRecordCache::getResidentBytes() const
+{
+    QMutexLocker locker(&mutex);
+
+    return residentBytes;
+}
+
+
+void GroundMotionRecordCache::evict(void)
+{
+    while(residentBytes > memoryBudget && recentlyUsed.size() > 1)
+    {
+        auto it = residentRecords.find(recentlyUsed.back());
+
+        residentBytes -= it->numBytes;
+
+        residentRecords.erase(it);
+        recentlyUsed.pop_back();
+    }
+}
+
+
+qint64 GroundMotionRecordCache::recordBytes(const GroundMotionRecord& record)
+{
+    qint64 numBytes = sizeof(GroundMotionRecord);
+
+    for(auto&& it : record.channels)
+        numBytes += static_cast<qint64>(it.size())*static_cast<qint64>(sizeof(double));
+
+    return numBytes;
+}
+
+
+int GroundMotionRecordCache::readRecord(const QString& recordFile, GroundMotionRecord& record, QString& errMsg)
+{
+    if(!recordFile.endsWith(GroundMotionRecordFile::extension()))
+        return readJsonRecord(recordFile, record, errMsg);
+
+    if(GroundMotionRecordFile::read(recordFile, record, errMsg) == 0)
+        return 0;
+
+    // The values of the binary record are corrupt, read the json file of the same record instead if there is one
+    auto jsonFile = recordFile.left(recordFile.size() - GroundMotionRecordFile::extension().size()) + ".json";
+
+    if(!QFileInfo::exists(jsonFile))
+        return -1;
+
+    errMsg.clear();
+
+    return readJsonRecord(jsonFile, record, errMsg);
+}
+
+
+int GroundMotionRecordCache::readRecordInfo(const QString& recordFile, GroundMotionRecordInfo& info, QString& errMsg)
+{
+    if(recordFile.endsWith(GroundMotionRecordFile::extension()))
+        return GroundMotionRecordFile::readInfo(recordFile, info, errMsg);
+
+    QFile file(recordFile);
+    if (!file.open(QFile::ReadOnly | QFile::Text))
+    {
+        errMsg = "Could not open the file at: " + recordFile;
+        return -1;
+    }
+
+    // Only the scalar values are parsed, the time histories are counted
+    QHash<QString, QByteArray> scalars;
+    QHash<QString, int> arraySizes;
+
+    if(scanJsonObject(file.readAll(), scalars, arraySizes) != 0)
+    {
+        errMsg = "Error parsing the file " + recordFile;
+        return -1;
+    }
+
+    auto gmNameObj = parseJsonScalar(scalars.value("name"));
+
+    if(gmNameObj.isNull() || gmNameObj.isUndefined())
+    {
+        errMsg = "NUll JSON object for field 'name' in " + recordFile;
+        return -1;
+    }
+
+    auto dTObj = parseJsonScalar(scalars.value("dT"));
+
+    if(dTObj.isNull() || dTObj.isUndefined())
+    {
+        errMsg = "NUll JSON object for field 'dT' in " + recordFile;
+        return -1;
+    }
+
+    info = GroundMotionRecordInfo();
+    info.name = gmNameObj.toString();
+    info.dT = dTObj.toDouble();
+
+    const QStringList directions = {"x", "y", "z"};
+
+    for(int k = 0; k<3; ++k)
+    {
+        info.numPoints = std::max(info.numPoints, arraySizes.value("data_" + directions.at(k)));
+
+        auto PGAObj = parseJsonScalar(scalars.value("PGA_" + directions.at(k)));
+
+        if(PGAObj.isDouble())
+            info.peakValues[k] = PGAObj.toDouble(0.0);
+    }
+
+    return 0;
+}
+
+
+int GroundMotionRecordCache::readJsonRecord(const QString& recordFile, GroundMotionRecord& record, QString& errMsg)
+{
+    record = GroundMotionRecord();
+
+    QFile file(recordFile);
+    if (!file.open(QFile::ReadOnly | QFile::Text))
+    {
+        errMsg = "Could not open the file at: " + recordFile;
+        return -1;
+    }
+
+    QJsonParseError parseError;
+    auto doc = QJsonDocument::fromJson(file.readAll(), &parseError);
+
+    file.close();
+
+    if(doc.isNull())
+    {
+        errMsg = "Error parsing the file " + recordFile + ": " + parseError.errorString();
+        return -1;
+    }
+
+    auto jsonObj = doc.object();
+
+    auto gmNameObj = jsonObj.value("name");
+
+    if(gmNameObj.isNull() || gmNameObj.isUndefined())
+    {
+        errMsg = "NUll JSON object for field 'name' in " + recordFile;
+        return -1;
+    }
+
+    auto dTObj = jsonObj.value("dT");
+
+    if(dTObj.isNull() || dTObj.isUndefined())
+    {
+        errMsg = "NUll JSON object for field 'dT' in " + recordFile;
+        return -1;
+    }
+
+    record.name = gmNameObj.toString();
+    record.dT = dTObj.toDouble();
+
+    const QStringList directions = {"x", "y", "z"};
+
+    for(int k = 0; k<3; ++k)
+    {
+        auto dataObj = jsonObj.value("data_" + directions.at(k));
+
+        if(dataObj.isArray())
+        {
+            auto dataArray = dataObj.toArray();
+
+            auto& values = record.channels[k];
+            values.resize(dataArray.size());
+
+            for(int i = 0; i<dataArray.size(); ++i)
+                values[i] = dataArray.at(i).toDouble(0.0);
+        }
+
+        auto PGAObj = jsonObj.value("PGA_" + directions.at(k));
+
+        if(PGAObj.isDouble())
+            record.peakValues[k] = PGAObj.toDouble(0.0);
+    }
+
+    return 0;
+}
@@ -0,0 +1,124 @@
+#ifndef GROUNDMOTIONRECORDCACHE_H
+#define GROUNDMOTIONRECORDCACHE_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "GroundMotionRecordFile.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QStringList>
+
+#include <list>
+#include <memory>
+
+// Records that are shared by the ground motion stations, e.g., the same record is often assigned to hundreds of grid points
+// Only the metadata of the records is kept for the life of the cache, the time histories are read when they are needed and the least recently used ones are evicted once the memory budget is exceeded
+class GroundMotionRecordCache
+{
+public:
+    GroundMotionRecordCache();
+
+    // Reads the metadata of the records that are not already in the cache, the unique files are read in parallel
+    int loadRecords(const QStringList& recordFiles, QString& errMsg);
+
+    // The files of the list that are not already in the cache, without duplicates
+    QStringList getNewRecordFiles(const QStringList& recordFiles) const;
+
+    // Adds the metadata of a record that was read by the caller, e.g., with readRecordInfo on the worker threads of a future that shows its progress
+    void insertRecordInfo(const QString& recordFile, std::shared_ptr<const GroundMotionRecordInfo> info);
+
+    // Returns a null pointer if the record is not in the cache
+    std::shared_ptr<const GroundMotionRecordInfo> getRecordInfo(const QString& recordFile) const;
+
+    // Returns the record with its time histories, reading them from the file if they are not resident
+    // A record that is evicted stays valid for as long as the caller holds on to it
+    std::shared_ptr<const GroundMotionRecord> getRecord(const QString& recordFile, QString& errMsg);
+
+    // Returns the record if it is resident, without moving it up in the order of use, otherwise reads it from the file without keeping it
+    // Used for a pass over all of the records, e.g., to compute their intensity measures, so that the pass does not evict the records that are in use
+    std::shared_ptr<const GroundMotionRecord> peekRecord(const QString& recordFile, QString& errMsg) const;
+
+    bool contains(const QString& recordFile) const;
+
+    int size(void) const;
+
+    void clear(void);
+
+    // The time histories that are resident are kept within this many bytes, except for the most recently used record
+    qint64 getMemoryBudget() const;
+    void setMemoryBudget(const qint64 value);
+
+    qint64 getResidentBytes() const;
+
+    // Reads a record from either the binary record file or the json file written by the NGA West 2 converter
+    static int readRecord(const QString& recordFile, GroundMotionRecord& record, QString& errMsg);
+
+    // Reads the metadata of a record, only the header is read from a binary record file and the arrays of a json file are counted without being parsed
+    static int readRecordInfo(const QString& recordFile, GroundMotionRecordInfo& info, QString& errMsg);
+
+private:
+
+    struct ResidentRecord
+    {
+        std::shared_ptr<const GroundMotionRecord> record;
+        qint64 numBytes;
+        std::list<QString>::iterator position;
+    };
+
+    static int readJsonRecord(const QString& recordFile, GroundMotionRecord& record, QString& errMsg);
+
+    static qint64 recordBytes(const GroundMotionRecord& record);
+
+    // Removes the least recently used time histories until the resident records fit within the budget
+    void evict(void);
+
+    QHash<QString, std::shared_ptr<const GroundMotionRecordInfo>> recordInfos;
+
+    // The records with their time histories in memory, the most recently used record is at the front of the list
+    QHash<QString, ResidentRecord> residentRecords;
+    std::list<QString> recentlyUsed;
+
+    qint64 residentBytes;
+
+    qint64 memoryBudget;
+
+    mutable QMutex mutex;
+};
+
+#endif // GROUNDMOTIONRECORDCACHE_H
@@ -0,0 +1,355 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "GroundMotionRecordFile.h"
+
+#include <QByteArray>
+#include <QFile>
+#include <QSaveFile>
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace
+{
+const char recordMagic[8] = {'R','2','D','G','M','R','E','C'};
+
+const quint32 recordVersion = 1;
+
+qint64 alignTo8(const qint64 value)
+{
+    return (value + 7) & ~qint64(7);
+}
+}
+
+
+GroundMotionRecord::GroundMotionRecord()
+{
+    dT = 0.0;
+    units = "g";
+    channels.resize(3);
+    peakValues.fill(std::numeric_limits<double>::quiet_NaN(), 3);
+}
+
+
+GroundMotionRecordInfo::GroundMotionRecordInfo()
+{
+    dT = 0.0;
+    units = "g";
+    numPoints = 0;
+    peakValues.fill(std::numeric_limits<double>::quiet_NaN(), 3);
+}
+
+
+QString GroundMotionRecordFile::extension(void)
+{
+    return ".r2dgm";
+}
+
+
+int GroundMotionRecordFile::write(const QString& pathToFile, const GroundMotionRecord& record, QString& errMsg, const Precision precision, const bool compress)
+{
+    if(record.channels.size() != 3 || record.peakValues.size() != 3)
+    {
+        errMsg = "The record " + record.name + " should have three components";
+        return -1;
+    }
+
+    Header header;
+    std::memset(&header, 0, sizeof(Header));
+    std::memcpy(header.magic, recordMagic, sizeof(recordMagic));
+
+    header.version = recordVersion;
+    header.flags = (precision == Float32 ? IsFloat32 : 0) | (compress ? IsCompressed : 0);
+    header.dT = record.dT;
+    header.numPoints = 0;
+
+    auto unitsBytes = record.units.toUtf8().left(sizeof(header.units) - 1);
+    std::memcpy(header.units, unitsBytes.constData(), unitsBytes.size());
+
+    // The bytes of each component as they are stored in the file
+    QVector<QByteArray> channelBytes(3);
+
+    for(int k = 0; k<3; ++k)
+    {
+        const auto& values = record.channels.at(k);
+
+        header.peakValues[k] = record.peakValues.at(k);
+
+        if(values.isEmpty())
+            continue;
+
+        if(header.numPoints != 0 && values.size() != header.numPoints)
+        {
+            errMsg = "The components of the record " + record.name + " do not have the same number of points";
+            return -1;
+        }
+
+        header.numPoints = values.size();
+        header.channelMask |= (1 << k);
+
+        QByteArray bytes;
+
+        if(precision == Float32)
+        {
+            bytes.resize(values.size()*static_cast<int>(sizeof(float)));
+            auto data = reinterpret_cast<float*>(bytes.data());
+
+            for(int i = 0; i<values.size(); ++i)
+                data[i] = static_cast<float>(values.at(i));
+        }
+        else
+            bytes = QByteArray(reinterpret_cast<const char*>(values.constData()), values.size()*static_cast<int>(sizeof(double)));
+
+        channelBytes[k] = compress ? qCompress(bytes) : bytes;
+    }
+
+    auto nameBytes = record.name.toUtf8();
+    header.nameSize = nameBytes.size();
+
+    // The components follow the name, each one on an 8 byte boundary
+    auto offset = alignTo8(static_cast<qint64>(sizeof(Header)) + nameBytes.size());
+
+    for(int k = 0; k<3; ++k)
+    {
+        if(channelBytes.at(k).isEmpty())
+        {
+            header.channelOffsets[k] = -1;
+            continue;
+        }
+
+        header.channelOffsets[k] = offset;
+        header.channelSizes[k] = channelBytes.at(k).size();
+
+        offset = alignTo8(offset + channelBytes.at(k).size());
+    }
+
+    QByteArray contents(static_cast<int>(offset), '\0');
+
+    std::memcpy(contents.data(), &header, sizeof(Header));
+    std::memcpy(contents.data() + sizeof(Header), nameBytes.constData(), nameBytes.size());
+
+    for(int k = 0; k<3; ++k)
+    {
+        if(header.channelOffsets[k] >= 0)
+            std::memcpy(contents.data() + header.channelOffsets[k], channelBytes.at(k).constData(), channelBytes.at(k).size());
+    }
+
+    // The file only replaces an existing one once it was written in full, so that an interrupted write does not leave a truncated record next to the json file
+    QSaveFile file(pathToFile);
+
+    if(!file.open(QIODevice::WriteOnly))
+    {
+        errMsg = "Could not open the file " + pathToFile + " for writing";
+        return -1;
+    }
+
+    if(file.write(contents) != contents.size() || !file.commit())
+    {
+        errMsg = "Could not write the record to the file " + pathToFile + ": " + file.errorString();
+        return -1;
+    }
+
+    return 0;
+}
+
+
+int GroundMotionRecordFile::read(const QString& pathToFile, GroundMotionRecord& record, QString& errMsg)
+{
+    record = GroundMotionRecord();
+
+    QFile file(pathToFile);
+
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        errMsg = "Could not open the file at: " + pathToFile;
+        return -1;
+    }
+
+    auto fileSize = file.size();
+
+    if(fileSize < static_cast<qint64>(sizeof(Header)))
+    {
+        errMsg = "The file " + pathToFile + " is not a ground motion record";
+        return -1;
+    }
+
+    // The mapping is released when the file object goes out of scope
+    auto data = file.map(0, fileSize);
+
+    if(data == nullptr)
+    {
+        errMsg = "Could not map the file " + pathToFile;
+        return -1;
+    }
+
+    Header header;
+    std::memcpy(&header, data, sizeof(Header));
+
+    if(std::memcmp(header.magic, recordMagic, sizeof(recordMagic)) != 0 || header.version != recordVersion)
+    {
+        errMsg = "The file " + pathToFile + " is not a ground motion record or was written by a newer version";
+        return -1;
+    }
+
+    if(header.numPoints < 0 || header.nameSize < 0 || static_cast<qint64>(sizeof(Header)) + header.nameSize > fileSize)
+    {
+        errMsg = "The ground motion record " + pathToFile + " is corrupt";
+        return -1;
+    }
+
+    record.name = QString::fromUtf8(reinterpret_cast<const char*>(data) + sizeof(Header), header.nameSize);
+    record.units = QString::fromUtf8(header.units, static_cast<int>(strnlen(header.units, sizeof(header.units))));
+    record.dT = header.dT;
+
+    auto isFloat32 = (header.flags & IsFloat32) != 0;
+    auto isCompressed = (header.flags & IsCompressed) != 0;
+
+    auto valueSize = isFloat32 ? static_cast<qint64>(sizeof(float)) : static_cast<qint64>(sizeof(double));
+    auto expectedSize = header.numPoints*valueSize;
+
+    for(int k = 0; k<3; ++k)
+    {
+        if((header.channelMask & (1 << k)) == 0)
+            continue;
+
+        auto offset = header.channelOffsets[k];
+        auto size = header.channelSizes[k];
+
+        if(offset < 0 || size < 0 || offset + size > fileSize || (!isCompressed && size != expectedSize))
+        {
+            errMsg = "The ground motion record " + pathToFile + " is truncated";
+            return -1;
+        }
+
+        const uchar* bytes = data + offset;
+
+        QByteArray uncompressed;
+
+        if(isCompressed)
+        {
+            uncompressed = qUncompress(bytes, static_cast<int>(size));
+
+            if(uncompressed.size() != expectedSize)
+            {
+                errMsg = "Could not decompress the ground motion record " + pathToFile;
+                return -1;
+            }
+
+            bytes = reinterpret_cast<const uchar*>(uncompressed.constData());
+        }
+
+        auto& values = record.channels[k];
+        values.resize(header.numPoints);
+
+        // The doubles are copied straight from the mapping, the floats are widened
+        if(isFloat32)
+        {
+            for(int i = 0; i<header.numPoints; ++i)
+            {
+                float val;
+                std::memcpy(&val, bytes + i*sizeof(float), sizeof(float));
+                values[i] = val;
+            }
+        }
+        else
+            std::memcpy(values.data(), bytes, expectedSize);
+
+        record.peakValues[k] = header.peakValues[k];
+    }
+
+    return 0;
+}
+
+
+int GroundMotionRecordFile::readInfo(const QString& pathToFile, GroundMotionRecordInfo& info, QString& errMsg)
+{
+    info = GroundMotionRecordInfo();
+
+    QFile file(pathToFile);
+
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        errMsg = "Could not open the file at: " + pathToFile;
+        return -1;
+    }
+
+    Header header;
+
+    if(file.read(reinterpret_cast<char*>(&header), sizeof(Header)) != static_cast<qint64>(sizeof(Header)))
+    {
+        errMsg = "The file " + pathToFile + " is not a ground motion record";
+        return -1;
+    }
+
+    if(std::memcmp(header.magic, recordMagic, sizeof(recordMagic)) != 0 || header.version != recordVersion)
+    {
+        errMsg = "The file " + pathToFile + " is not a ground motion record or was written by a newer version";
+        return -1;
+    }
+
+    if(header.numPoints < 0 || header.nameSize < 0 || static_cast<qint64>(sizeof(Header)) + header.nameSize > file.size())
+    {
+        errMsg = "The ground motion record " + pathToFile + " is corrupt";
+        return -1;
+    }
+
+    // Check that the components are inside of the file, so that a truncated file is found without reading them
+    for(int k = 0; k<3; ++k)
+    {
+        if((header.channelMask & (1 << k)) != 0 && (header.channelOffsets[k] < 0 || header.channelSizes[k] < 0 || header.channelOffsets[k] + header.channelSizes[k] > file.size()))
+        {
+            errMsg = "The ground motion record " + pathToFile + " is truncated or corrupt";
+            return -1;
+        }
+    }
+
+    info.name = QString::fromUtf8(file.read(header.nameSize));
+    info.units = QString::fromUtf8(header.units, static_cast<int>(strnlen(header.units, sizeof(header.units))));
+    info.dT = header.dT;
+    info.numPoints = header.numPoints;
+
+    for(int k = 0; k<3; ++k)
+    {
+        if((header.channelMask & (1 << k)) != 0)
+            info.peakValues[k] = header.peakValues[k];
+    }
+
+    return 0;
+}
@@ -0,0 +1,123 @@
+#ifndef GROUNDMOTIONRECORDFILE_H
+#define GROUNDMOTIONRECORDFILE_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include <QString>
+#include <QVector>
+
+// A ground motion record with up to three components, e.g., the two horizontal and the vertical acceleration time histories
+struct GroundMotionRecord
+{
+    GroundMotionRecord();
+
+    QString name;
+
+    // The units of the time histories, e.g., g
+    QString units;
+
+    double dT;
+
+    // The time histories in the x, y, and z directions, a component that is not in the record is empty
+    QVector<QVector<double>> channels;
+
+    // The peak absolute value of each component, NaN if the component is not in the record
+    QVector<double> peakValues;
+};
+
+
+// The metadata of a ground motion record, without the time histories
+struct GroundMotionRecordInfo
+{
+    GroundMotionRecordInfo();
+
+    QString name;
+
+    QString units;
+
+    double dT;
+
+    // The number of points in each of the components
+    int numPoints;
+
+    QVector<double> peakValues;
+};
+
+
+// Binary container of a ground motion record that is read through a memory mapping of the file, so that loading a record does not involve parsing text
+// The file has a fixed size header with the time step, the number of points, the units and the peak values, followed by the name and the components
+// Each component starts on an 8 byte boundary and is stored as float64 or float32, and optionally compressed with zlib
+// The values are stored in the byte order of the machine that wrote the file, which is little endian on all of the supported platforms
+class GroundMotionRecordFile
+{
+public:
+
+    enum Precision {Float64 = 0, Float32 = 1};
+
+    // The extension of the record files, next to the json files of the same records
+    static QString extension(void);
+
+    static int write(const QString& pathToFile, const GroundMotionRecord& record, QString& errMsg, const Precision precision = Float64, const bool compress = false);
+
+    static int read(const QString& pathToFile, GroundMotionRecord& record, QString& errMsg);
+
+    // Reads only the header and the name of the record
+    static int readInfo(const QString& pathToFile, GroundMotionRecordInfo& info, QString& errMsg);
+
+private:
+
+    struct Header
+    {
+        char magic[8];
+        quint32 version;
+        quint32 flags;
+        double dT;
+        qint32 numPoints;
+        qint32 channelMask;
+        double peakValues[3];
+        char units[8];
+        qint32 nameSize;
+        qint32 reserved;
+        qint64 channelOffsets[3];
+        qint64 channelSizes[3];
+    };
+
+    enum Flags {IsFloat32 = 1, IsCompressed = 2};
+};
+
+#endif // GROUNDMOTIONRECORDFILE_H
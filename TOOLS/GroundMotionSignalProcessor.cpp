@@ -0,0 +1,420 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "GroundMotionSignalProcessor.h"
+#include "FFT.h"
+#include "GroundMotionRecordFile.h"
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+
+GroundMotionSignalProcessor::GroundMotionSignalProcessor()
+{
+    baselineOrder = 1;
+    filterEnabled = true;
+    lowCutFrequency = 0.1;
+    highCutFrequency = 25.0;
+    filterOrder = 4;
+    keepPadding = false;
+    targetTimeStep = 0.0;
+}
+
+
+int GroundMotionSignalProcessor::processRecord(GroundMotionRecord& record, QString& errMsg) const
+{
+    if(this->processComponents(record.channels, record.dT, errMsg) != 0)
+    {
+        errMsg = "Error processing the record " + record.name + ": " + errMsg;
+        return -1;
+    }
+
+    for(int k = 0; k<3; ++k)
+    {
+        const auto& values = record.channels.at(k);
+
+        if(values.isEmpty())
+            continue;
+
+        auto peak = 0.0;
+        for(auto&& it : values)
+            peak = std::max(peak, std::fabs(it));
+
+        record.peakValues[k] = peak;
+    }
+
+    return 0;
+}
+
+
+int GroundMotionSignalProcessor::processComponents(QVector<QVector<double>>& channels, double& dT, QString& errMsg) const
+{
+    if(dT <= 0.0)
+    {
+        errMsg = "The time step should be greater than zero";
+        return -1;
+    }
+
+    QVector<int> components;
+    int numPoints = 0;
+
+    for(int k = 0; k<channels.size(); ++k)
+    {
+        if(channels.at(k).isEmpty())
+            continue;
+
+        components.push_back(k);
+        numPoints = std::max(numPoints, channels.at(k).size());
+    }
+
+    if(components.isEmpty())
+        return 0;
+
+    // The components are given the same number of points, the shorter ones are padded with zeros at the end
+    for(auto&& k : components)
+        channels[k].resize(numPoints);
+
+    if(baselineOrder >= 0)
+    {
+        for(auto&& k : components)
+            removeBaseline(channels[k], baselineOrder);
+    }
+
+    if(filterEnabled && (lowCutFrequency > 0.0 || highCutFrequency > 0.0))
+    {
+        auto numPadding = lowCutFrequency > 0.0 ? static_cast<int>(std::ceil(1.5*filterOrder/lowCutFrequency/dT)) : 0;
+
+        for(auto&& k : components)
+        {
+            QVector<double> padded(numPoints + 2*numPadding, 0.0);
+            std::copy(channels.at(k).begin(), channels.at(k).end(), padded.begin() + numPadding);
+            channels[k] = padded;
+        }
+
+        // The components are filtered two at a time
+        for(int i = 0; i<components.size(); i += 2)
+        {
+            auto second = i + 1 < components.size() ? &channels[components.at(i+1)] : nullptr;
+
+            this->filter(channels[components.at(i)], second, dT, lowCutFrequency, highCutFrequency);
+        }
+
+        if(!keepPadding)
+        {
+            for(auto&& k : components)
+                channels[k] = channels.at(k).mid(numPadding, numPoints);
+        }
+    }
+
+    if(targetTimeStep > 0.0 && std::fabs(targetTimeStep - dT) > 1.0e-9*dT)
+    {
+        // Remove the content above the new Nyquist frequency before the time step increases
+        if(targetTimeStep > dT)
+        {
+            auto cutoff = 0.8*0.5/targetTimeStep;
+
+            for(int i = 0; i<components.size(); i += 2)
+            {
+                auto second = i + 1 < components.size() ? &channels[components.at(i+1)] : nullptr;
+
+                this->filter(channels[components.at(i)], second, dT, 0.0, cutoff);
+            }
+        }
+
+        for(auto&& k : components)
+            channels[k] = resample(channels.at(k), dT, targetTimeStep);
+
+        dT = targetTimeStep;
+    }
+
+    return 0;
+}
+
+
+void GroundMotionSignalProcessor::filter(QVector<double>& first, QVector<double>* second, const double dT, const double lowCut, const double highCut) const
+{
+    auto numPoints = first.size();
+
+    auto size = FFT::nextPowerOfTwo(numPoints);
+
+    QVector<std::complex<double>> spectrum(size, std::complex<double>(0.0, 0.0));
+
+    for(int i = 0; i<numPoints; ++i)
+        spectrum[i] = std::complex<double>(first.at(i), second ? second->at(i) : 0.0);
+
+    FFT::transform(spectrum);
+
+    // The gain is real and symmetric, so the two signals stay separated in the real and imaginary parts
+    // The gain is the squared magnitude of the Butterworth filter, i.e., the filter applied forward and backward
+    auto twoN = 2.0*filterOrder;
+
+    for(int k = 0; k<size; ++k)
+    {
+        auto f = std::min(k, size - k)/(size*dT);
+
+        auto gain = 1.0;
+
+        if(lowCut > 0.0)
+        {
+            auto r = std::pow(f/lowCut, twoN);
+            gain *= r/(1.0 + r);
+        }
+
+        if(highCut > 0.0)
+            gain /= 1.0 + std::pow(f/highCut, twoN);
+
+        spectrum[k] *= gain;
+    }
+
+    FFT::transform(spectrum, true);
+
+    for(int i = 0; i<numPoints; ++i)
+    {
+        first[i] = spectrum.at(i).real();
+
+        if(second)
+            (*second)[i] = spectrum.at(i).imag();
+    }
+}
+
+
+void GroundMotionSignalProcessor::removeBaseline(QVector<double>& values, const int order)
+{
+    auto numPoints = values.size();
+
+    if(numPoints < 2 || order < 0)
+        return;
+
+    auto numTerms = std::min(order, 3) + 1;
+
+    // Normal equations of the fit, with the time scaled to [-1, 1] so that they are well conditioned
+    double A[4][5] = {};
+
+    auto scaledTime = [numPoints](const int i)
+    {
+        return 2.0*i/(numPoints - 1) - 1.0;
+    };
+
+    for(int i = 0; i<numPoints; ++i)
+    {
+        auto t = scaledTime(i);
+
+        double powers[7] = {1.0};
+        for(int p = 1; p<7; ++p)
+            powers[p] = powers[p-1]*t;
+
+        for(int r = 0; r<numTerms; ++r)
+        {
+            for(int c = 0; c<numTerms; ++c)
+                A[r][c] += powers[r+c];
+
+            A[r][numTerms] += powers[r]*values.at(i);
+        }
+    }
+
+    // Gaussian elimination with partial pivoting
+    for(int c = 0; c<numTerms; ++c)
+    {
+        auto pivot = c;
+        for(int r = c+1; r<numTerms; ++r)
+        {
+            if(std::fabs(A[r][c]) > std::fabs(A[pivot][c]))
+                pivot = r;
+        }
+
+        for(int j = 0; j<=numTerms; ++j)
+            std::swap(A[c][j], A[pivot][j]);
+
+        if(A[c][c] == 0.0)
+            return;
+
+        for(int r = c+1; r<numTerms; ++r)
+        {
+            auto factor = A[r][c]/A[c][c];
+
+            for(int j = c; j<=numTerms; ++j)
+                A[r][j] -= factor*A[c][j];
+        }
+    }
+
+    double coefficients[4] = {};
+
+    for(int r = numTerms-1; r>=0; --r)
+    {
+        auto sum = A[r][numTerms];
+
+        for(int j = r+1; j<numTerms; ++j)
+            sum -= A[r][j]*coefficients[j];
+
+        coefficients[r] = sum/A[r][r];
+    }
+
+    for(int i = 0; i<numPoints; ++i)
+    {
+        auto t = scaledTime(i);
+
+        auto fit = 0.0;
+        for(int r = numTerms-1; r>=0; --r)
+            fit = fit*t + coefficients[r];
+
+        values[i] -= fit;
+    }
+}
+
+
+QVector<double> GroundMotionSignalProcessor::resample(const QVector<double>& values, const double dT, const double newDT)
+{
+    auto numPoints = values.size();
+
+    if(numPoints < 2 || dT <= 0.0 || newDT <= 0.0)
+        return values;
+
+    auto duration = (numPoints - 1)*dT;
+
+    auto numNewPoints = static_cast<int>(std::floor(duration/newDT + 1.0e-9)) + 1;
+
+    QVector<double> result(numNewPoints);
+
+    auto at = [&values, numPoints](const int i)
+    {
+        return values.at(std::min(std::max(i, 0), numPoints - 1));
+    };
+
+    for(int j = 0; j<numNewPoints; ++j)
+    {
+        auto x = j*newDT/dT;
+
+        auto i = std::min(static_cast<int>(x), numPoints - 2);
+        auto t = x - i;
+
+        // Catmull-Rom cubic through the four neighbouring samples
+        auto p0 = at(i-1);
+        auto p1 = at(i);
+        auto p2 = at(i+1);
+        auto p3 = at(i+2);
+
+        result[j] = p1 + 0.5*t*(p2 - p0 + t*(2.0*p0 - 5.0*p1 + 4.0*p2 - p3 + t*(3.0*(p1 - p2) + p3 - p0)));
+    }
+
+    return result;
+}
+
+
+int GroundMotionSignalProcessor::getBaselineOrder() const
+{
+    return baselineOrder;
+}
+
+
+void GroundMotionSignalProcessor::setBaselineOrder(const int value)
+{
+    baselineOrder = std::min(std::max(value, -1), 3);
+}
+
+
+bool GroundMotionSignalProcessor::getFilterEnabled() const
+{
+    return filterEnabled;
+}
+
+
+void GroundMotionSignalProcessor::setFilterEnabled(const bool value)
+{
+    filterEnabled = value;
+}
+
+
+double GroundMotionSignalProcessor::getLowCutFrequency() const
+{
+    return lowCutFrequency;
+}
+
+
+void GroundMotionSignalProcessor::setLowCutFrequency(const double value)
+{
+    lowCutFrequency = std::max(value, 0.0);
+}
+
+
+double GroundMotionSignalProcessor::getHighCutFrequency() const
+{
+    return highCutFrequency;
+}
+
+
+void GroundMotionSignalProcessor::setHighCutFrequency(const double value)
+{
+    highCutFrequency = std::max(value, 0.0);
+}
+
+
+int GroundMotionSignalProcessor::getFilterOrder() const
+{
+    return filterOrder;
+}
+
+
+void GroundMotionSignalProcessor::setFilterOrder(const int value)
+{
+    if(value > 0)
+        filterOrder = value;
+}
+
+
+bool GroundMotionSignalProcessor::getKeepPadding() const
+{
+    return keepPadding;
+}
+
+
+void GroundMotionSignalProcessor::setKeepPadding(const bool value)
+{
+    keepPadding = value;
+}
+
+
+double GroundMotionSignalProcessor::getTargetTimeStep() const
+{
+    return targetTimeStep;
+}
+
+
+void GroundMotionSignalProcessor::setTargetTimeStep(const double value)
+{
+    targetTimeStep = std::max(value, 0.0);
+}
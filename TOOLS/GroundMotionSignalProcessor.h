@@ -0,0 +1,114 @@
+#ifndef GROUNDMOTIONSIGNALPROCESSOR_H
+#define GROUNDMOTIONSIGNALPROCESSOR_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include <QString>
+#include <QVector>
+
+struct GroundMotionRecord;
+
+// Processing of ground motion records before they are used in an analysis, in this order:
+// 1. Baseline correction, i.e., removal of the least squares polynomial fit of the acceleration
+// 2. Zero padding at both ends so that the filter transients and the wrap around of the transform stay out of the record (1.5*order/lowCut seconds at each end, as recommended by Boore, 2005)
+// 3. Acausal Butterworth band-pass filtering, applied in the frequency domain
+// 4. Resampling to a common time step, with an anti-alias low-pass filter when the time step increases
+// The components of a record are transformed two at a time as the real and imaginary parts of a complex signal, i.e., the two horizontal components share one transform and the vertical component has its own
+// Each record is processed on its own, the callers process the records in parallel
+class GroundMotionSignalProcessor
+{
+public:
+    GroundMotionSignalProcessor();
+
+    // The peak values of the record are updated
+    int processRecord(GroundMotionRecord& record, QString& errMsg) const;
+
+    // The order of the polynomial that is removed from the acceleration, -1 to skip the baseline correction
+    int getBaselineOrder() const;
+    void setBaselineOrder(const int value);
+
+    bool getFilterEnabled() const;
+    void setFilterEnabled(const bool value);
+
+    // The corner frequencies in Hz, a corner frequency of zero leaves out that side of the band-pass filter
+    double getLowCutFrequency() const;
+    void setLowCutFrequency(const double value);
+
+    double getHighCutFrequency() const;
+    void setHighCutFrequency(const double value);
+
+    int getFilterOrder() const;
+    void setFilterOrder(const int value);
+
+    // Whether the zero padding stays in the processed record, otherwise it is removed after filtering
+    bool getKeepPadding() const;
+    void setKeepPadding(const bool value);
+
+    // The time step of the processed records, zero keeps the time step of each record
+    double getTargetTimeStep() const;
+    void setTargetTimeStep(const double value);
+
+    // Fits and subtracts a polynomial of the given order with least squares
+    static void removeBaseline(QVector<double>& values, const int order);
+
+    // Resamples a signal from one time step to another with cubic interpolation, the duration of the signal is kept
+    static QVector<double> resample(const QVector<double>& values, const double dT, const double newDT);
+
+private:
+
+    // Filters one or two signals of the same length that are packed into the real and imaginary parts
+    void filter(QVector<double>& first, QVector<double>* second, const double dT, const double lowCut, const double highCut) const;
+
+    int processComponents(QVector<QVector<double>>& channels, double& dT, QString& errMsg) const;
+
+    int baselineOrder;
+
+    bool filterEnabled;
+
+    double lowCutFrequency;
+
+    double highCutFrequency;
+
+    int filterOrder;
+
+    bool keepPadding;
+
+    double targetTimeStep;
+};
+
+#endif // GROUNDMOTIONSIGNALPROCESSOR_H
@@ -0,0 +1,473 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "GroupByEngine.h"
+
+#include <QHash>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+DictionaryColumn DictionaryColumn::encode(const QString& name, const QStringList& values)
+{
+    DictionaryColumn column;
+    column.name = name;
+    column.codes.resize(values.size());
+
+    // Codes in the order that the labels are first seen
+    QHash<QString, int> firstSeen;
+
+    for(int i = 0; i<values.size(); ++i)
+    {
+        const auto& value = values.at(i);
+
+        auto it = firstSeen.constFind(value);
+
+        if(it == firstSeen.constEnd())
+        {
+            it = firstSeen.insert(value, column.dictionary.size());
+            column.dictionary.append(value);
+        }
+
+        column.codes[i] = it.value();
+    }
+
+    // Sort the dictionary and remap the codes
+    QVector<int> order(column.dictionary.size());
+    for(int i = 0; i<order.size(); ++i)
+        order[i] = i;
+
+    std::sort(order.begin(), order.end(), [&column](const int a, const int b)
+    {
+        return column.dictionary.at(a) < column.dictionary.at(b);
+    });
+
+    QVector<int> remap(order.size());
+    QStringList sortedDictionary;
+
+    for(int i = 0; i<order.size(); ++i)
+    {
+        remap[order.at(i)] = i;
+        sortedDictionary.append(column.dictionary.at(order.at(i)));
+    }
+
+    column.dictionary = sortedDictionary;
+
+    for(auto&& it : column.codes)
+        it = remap.at(it);
+
+    return column;
+}
+
+
+void DictionaryColumn::append(const QStringList& values)
+{
+    QHash<QString, int> lookup;
+    lookup.reserve(dictionary.size());
+
+    for(int i = 0; i<dictionary.size(); ++i)
+        lookup.insert(dictionary.at(i), i);
+
+    QStringList newLabels;
+
+    for(auto&& value : values)
+    {
+        if(!lookup.contains(value))
+        {
+            lookup.insert(value, -1);
+            newLabels.append(value);
+        }
+    }
+
+    // The codes of the rows that were encoded before only change if there are new labels
+    if(!newLabels.isEmpty())
+    {
+        auto sortedDictionary = dictionary + newLabels;
+        std::sort(sortedDictionary.begin(), sortedDictionary.end());
+
+        for(int i = 0; i<sortedDictionary.size(); ++i)
+            lookup.insert(sortedDictionary.at(i), i);
+
+        QVector<int> remap(dictionary.size());
+        for(int i = 0; i<dictionary.size(); ++i)
+            remap[i] = lookup.value(dictionary.at(i));
+
+        for(auto&& it : codes)
+            it = remap.at(it);
+
+        dictionary = sortedDictionary;
+    }
+
+    codes.reserve(codes.size() + values.size());
+
+    for(auto&& value : values)
+        codes.push_back(lookup.value(value));
+}
+
+
+DictionaryColumn DictionaryColumn::encodeBins(const QString& name, const QVector<double>& values, const double binWidth)
+{
+    DictionaryColumn column;
+    column.name = name;
+    column.codes.resize(values.size());
+
+    if(values.isEmpty())
+        return column;
+
+    auto width = binWidth > 0.0 ? binWidth : 1.0;
+
+    // The bin of each value, the NaN values get their own bin after all of the others
+    const auto noBin = std::numeric_limits<qint64>::max();
+
+    QVector<qint64> bins(values.size());
+
+    for(int i = 0; i<values.size(); ++i)
+    {
+        auto val = values.at(i);
+
+        bins[i] = std::isfinite(val) ? static_cast<qint64>(std::floor(val/width)) : noBin;
+    }
+
+    auto sortedBins = bins;
+    std::sort(sortedBins.begin(), sortedBins.end());
+    sortedBins.erase(std::unique(sortedBins.begin(), sortedBins.end()), sortedBins.end());
+
+    for(auto&& it : sortedBins)
+    {
+        if(it == noBin)
+            column.dictionary.append("None");
+        else
+            column.dictionary.append(QString::number(it*width) + " - " + QString::number((it+1)*width));
+    }
+
+    for(int i = 0; i<values.size(); ++i)
+        column.codes[i] = static_cast<int>(std::lower_bound(sortedBins.begin(), sortedBins.end(), bins.at(i)) - sortedBins.begin());
+
+    return column;
+}
+
+
+int GroupByResult::numGroups() const
+{
+    return counts.size();
+}
+
+
+GroupByEngine::GroupByEngine()
+{
+
+}
+
+
+void GroupByEngine::addKeyColumn(const DictionaryColumn& column)
+{
+    keyColumns.push_back(column);
+
+    // The last column varies fastest in the composite key so that the groups are in lexical order of the keys
+    strides.fill(1, keyColumns.size());
+
+    for(int k = keyColumns.size()-2; k>=0; --k)
+        strides[k] = strides.at(k+1)*std::max(1, keyColumns.at(k+1).dictionary.size());
+}
+
+
+void GroupByEngine::clearKeyColumns(void)
+{
+    keyColumns.clear();
+    strides.clear();
+}
+
+
+int GroupByEngine::numKeyColumns(void) const
+{
+    return keyColumns.size();
+}
+
+
+int GroupByEngine::groupBy(const QVector<double>& values, GroupByResult& result, QString& errMsg) const
+{
+    result = GroupByResult();
+
+    if(keyColumns.isEmpty())
+    {
+        errMsg = "There are no columns to group by";
+        return -1;
+    }
+
+    auto numRows = values.size();
+
+    qint64 numKeys = 1;
+
+    for(auto&& it : keyColumns)
+    {
+        if(it.codes.size() != numRows)
+        {
+            errMsg = "The column " + it.name + " has " + QString::number(it.codes.size()) + " rows but there are " + QString::number(numRows) + " values";
+            return -1;
+        }
+
+        result.keyNames.append(it.name);
+
+        numKeys *= std::max(1, it.dictionary.size());
+    }
+
+    const int rangeSize = 16384;
+
+    QVector<int> ranges;
+    for(int i = 0; i<numRows; i += rangeSize)
+        ranges.push_back(i);
+
+    QVector<qint64> groupKeys;
+    QVector<Partial> groupPartials;
+
+    // Dense arrays for each range as long as they are small compared to the number of rows
+    if(numKeys <= std::max(qint64(4096), static_cast<qint64>(rangeSize)))
+        this->groupDense(values, ranges, rangeSize, numKeys, groupKeys, groupPartials);
+    else
+        this->groupHashed(values, ranges, rangeSize, groupKeys, groupPartials);
+
+    auto numGroups = groupKeys.size();
+
+    result.keys.resize(numGroups);
+    result.keyCodes.resize(numGroups);
+    result.counts.resize(numGroups);
+    result.validCounts.resize(numGroups);
+    result.sums.resize(numGroups);
+    result.means.resize(numGroups);
+    result.mins.resize(numGroups);
+    result.maxs.resize(numGroups);
+
+    for(int g = 0; g<numGroups; ++g)
+    {
+        auto key = groupKeys.at(g);
+
+        for(int k = 0; k<keyColumns.size(); ++k)
+        {
+            auto code = static_cast<int>(key/strides.at(k));
+            key -= code*strides.at(k);
+
+            result.keyCodes[g].push_back(code);
+            result.keys[g].append(keyColumns.at(k).dictionary.value(code));
+        }
+
+        const auto& partial = groupPartials.at(g);
+
+        auto nan = std::numeric_limits<double>::quiet_NaN();
+
+        result.counts[g] = partial.count;
+        result.validCounts[g] = partial.validCount;
+        result.sums[g] = partial.sum;
+        result.means[g] = partial.validCount > 0 ? partial.sum/partial.validCount : nan;
+        result.mins[g] = partial.validCount > 0 ? partial.min : nan;
+        result.maxs[g] = partial.validCount > 0 ? partial.max : nan;
+    }
+
+    return 0;
+}
+
+
+QVector<double> GroupByEngine::getAggregate(const GroupByResult& result, const Aggregate aggregate)
+{
+    switch(aggregate)
+    {
+    case Count:
+    {
+        QVector<double> counts;
+        counts.reserve(result.counts.size());
+
+        for(auto&& it : result.counts)
+            counts.push_back(it);
+
+        return counts;
+    }
+    case Sum:
+        return result.sums;
+    case Mean:
+        return result.means;
+    case Min:
+        return result.mins;
+    case Max:
+        return result.maxs;
+    }
+
+    return QVector<double>();
+}
+
+
+void GroupByEngine::groupDense(const QVector<double>& values, const QVector<int>& ranges, const int rangeSize, const qint64 numKeys, QVector<qint64>& groupKeys, QVector<Partial>& groupPartials) const
+{
+    auto numRows = values.size();
+
+    // Each range has its own array of partial aggregates
+    QVector<QVector<Partial>> rangePartials(ranges.size());
+    auto rangePartialsData = rangePartials.data();
+
+    QVector<int> rangeIndices;
+    for(int r = 0; r<ranges.size(); ++r)
+        rangeIndices.push_back(r);
+
+    QtConcurrent::blockingMap(rangeIndices, [&](const int r)
+    {
+        QVector<Partial> partials(static_cast<int>(numKeys));
+
+        auto begin = ranges.at(r);
+        auto end = std::min(begin + rangeSize, numRows);
+
+        for(int i = begin; i<end; ++i)
+            partials[static_cast<int>(this->compositeKey(i))].add(values.at(i));
+
+        rangePartialsData[r] = partials;
+    });
+
+    // Merge in the order of the ranges and keep the groups that have rows
+    QVector<Partial> partials(static_cast<int>(numKeys));
+
+    for(auto&& range : rangePartials)
+    {
+        for(int key = 0; key<numKeys; ++key)
+            partials[key].merge(range.at(key));
+    }
+
+    for(int key = 0; key<numKeys; ++key)
+    {
+        if(partials.at(key).count == 0)
+            continue;
+
+        groupKeys.push_back(key);
+        groupPartials.push_back(partials.at(key));
+    }
+}
+
+
+void GroupByEngine::groupHashed(const QVector<double>& values, const QVector<int>& ranges, const int rangeSize, QVector<qint64>& groupKeys, QVector<Partial>& groupPartials) const
+{
+    auto numRows = values.size();
+
+    QVector<QHash<qint64, Partial>> rangePartials(ranges.size());
+    auto rangePartialsData = rangePartials.data();
+
+    QVector<int> rangeIndices;
+    for(int r = 0; r<ranges.size(); ++r)
+        rangeIndices.push_back(r);
+
+    QtConcurrent::blockingMap(rangeIndices, [&](const int r)
+    {
+        QHash<qint64, Partial> partials;
+
+        auto begin = ranges.at(r);
+        auto end = std::min(begin + rangeSize, numRows);
+
+        for(int i = begin; i<end; ++i)
+            partials[this->compositeKey(i)].add(values.at(i));
+
+        rangePartialsData[r] = partials;
+    });
+
+    QHash<qint64, Partial> partials;
+
+    for(auto&& range : rangePartials)
+    {
+        for(auto it = range.constBegin(); it != range.constEnd(); ++it)
+            partials[it.key()].merge(it.value());
+    }
+
+    // The order of a hash is arbitrary, sort the groups by their keys
+    groupKeys = partials.keys().toVector();
+    std::sort(groupKeys.begin(), groupKeys.end());
+
+    for(auto&& key : groupKeys)
+        groupPartials.push_back(partials.value(key));
+}
+
+
+qint64 GroupByEngine::compositeKey(const int row) const
+{
+    qint64 key = 0;
+
+    for(int k = 0; k<keyColumns.size(); ++k)
+        key += keyColumns.at(k).codes.at(row)*strides.at(k);
+
+    return key;
+}
+
+
+void GroupByEngine::Partial::add(const double value)
+{
+    ++count;
+
+    if(std::isnan(value))
+        return;
+
+    if(validCount == 0)
+    {
+        min = value;
+        max = value;
+    }
+    else
+    {
+        min = std::min(min, value);
+        max = std::max(max, value);
+    }
+
+    ++validCount;
+    sum += value;
+}
+
+
+void GroupByEngine::Partial::merge(const Partial& other)
+{
+    if(other.validCount > 0)
+    {
+        if(validCount == 0)
+        {
+            min = other.min;
+            max = other.max;
+        }
+        else
+        {
+            min = std::min(min, other.min);
+            max = std::max(max, other.max);
+        }
+    }
+
+    count += other.count;
+    validCount += other.validCount;
+    sum += other.sum;
+}
@@ -0,0 +1,141 @@
+#ifndef GROUPBYENGINE_H
+#define GROUPBYENGINE_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include <QStringList>
+#include <QVector>
+
+// A column of labels that is stored as integer codes into a dictionary of the distinct labels
+// The dictionary is sorted so that the order of the codes is the order of the labels
+struct DictionaryColumn
+{
+    QString name;
+
+    QStringList dictionary;
+
+    QVector<int> codes;
+
+    // Encodes the labels, the dictionary is in lexical order
+    static DictionaryColumn encode(const QString& name, const QStringList& values);
+
+    // Appends the labels of more rows, the labels that are new are inserted into the dictionary in lexical order and the codes are remapped
+    void append(const QStringList& values);
+
+    // Encodes the values into bins of the given width, e.g., the decade of the year built, the dictionary is in numerical order and NaN values are labelled 'None'
+    static DictionaryColumn encodeBins(const QString& name, const QVector<double>& values, const double binWidth);
+};
+
+
+// The aggregates of each group, the groups are in the order of their keys
+struct GroupByResult
+{
+    QStringList keyNames;
+
+    // The labels of the keys of each group, i.e., keys[i][k] is the label of key column k of group i
+    QVector<QStringList> keys;
+
+    // The codes of the keys of each group in the dictionaries of the key columns
+    QVector<QVector<int>> keyCodes;
+
+    // The number of rows in each group, and the number that have a value that is not NaN
+    QVector<int> counts;
+    QVector<int> validCounts;
+
+    QVector<double> sums;
+    QVector<double> means;
+    QVector<double> mins;
+    QVector<double> maxs;
+
+    int numGroups() const;
+};
+
+
+// Group by aggregation of a value column over one or more key columns, e.g., the repair cost by occupancy class and structure type
+// The key columns are dictionary encoded so that a group is found by integer arithmetic on the codes instead of by comparing strings
+// The rows are split into ranges that are aggregated on separate threads and the partial aggregates are merged in the order of the ranges, so the result does not depend on the number of threads
+class GroupByEngine
+{
+public:
+    GroupByEngine();
+
+    enum Aggregate {Count = 0, Sum = 1, Mean = 2, Min = 3, Max = 4};
+
+    void addKeyColumn(const DictionaryColumn& column);
+
+    void clearKeyColumns(void);
+
+    int numKeyColumns(void) const;
+
+    // Aggregates the values over the groups of the key columns, NaN values are counted but are not part of the other aggregates
+    int groupBy(const QVector<double>& values, GroupByResult& result, QString& errMsg) const;
+
+    // Returns the aggregate of the result as a vector with one entry per group
+    static QVector<double> getAggregate(const GroupByResult& result, const Aggregate aggregate);
+
+private:
+
+    // The partial aggregate of a group
+    struct Partial
+    {
+        int count = 0;
+        int validCount = 0;
+        double sum = 0.0;
+        double min = 0.0;
+        double max = 0.0;
+
+        void add(const double value);
+
+        void merge(const Partial& other);
+    };
+
+    // Groups with the composite key as an index into dense arrays, used when the number of possible keys is small
+    void groupDense(const QVector<double>& values, const QVector<int>& ranges, const int rangeSize, const qint64 numKeys, QVector<qint64>& groupKeys, QVector<Partial>& groupPartials) const;
+
+    // Groups with hash tables when the number of possible keys is large and most of them are empty
+    void groupHashed(const QVector<double>& values, const QVector<int>& ranges, const int rangeSize, QVector<qint64>& groupKeys, QVector<Partial>& groupPartials) const;
+
+    qint64 compositeKey(const int row) const;
+
+    QVector<DictionaryColumn> keyColumns;
+
+    // The radix of each key column in the composite key
+    QVector<qint64> strides;
+};
+
+#endif // GROUPBYENGINE_H
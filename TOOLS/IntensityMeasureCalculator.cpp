@@ -0,0 +1,364 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "IntensityMeasureCalculator.h"
+#include "GroundMotionRecordFile.h"
+#include "GroundMotionTimeHistory.h"
+
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+const double gravity = 9.80665;
+
+// Returns the time at which the normalized cumulative intensity first reaches the given level, interpolated between the samples
+double crossingTime(const QVector<double>& cumulative, const double level, const double dT)
+{
+    auto target = level*cumulative.last();
+
+    auto it = std::lower_bound(cumulative.begin(), cumulative.end(), target);
+
+    auto i = static_cast<int>(it - cumulative.begin());
+
+    if(i == 0)
+        return 0.0;
+
+    auto prev = cumulative.at(i-1);
+    auto next = cumulative.at(i);
+
+    auto fraction = next > prev ? (target - prev)/(next - prev) : 0.0;
+
+    return (i - 1 + fraction)*dT;
+}
+}
+
+
+IntensityMeasures::IntensityMeasures()
+{
+    PGA = std::numeric_limits<double>::quiet_NaN();
+    PGV = PGA;
+    PGD = PGA;
+    AriasIntensity = PGA;
+    CAV = PGA;
+    D5_75 = PGA;
+    D5_95 = PGA;
+    SaAvg = PGA;
+}
+
+
+IntensityMeasureCalculator::IntensityMeasureCalculator()
+{
+    spectrumCalculator.setPeriods(ResponseSpectrumCalculator::logSpacedPeriods(0.2, 3.0, 10));
+    spectrumCalculator.setDampingRatios({0.05});
+}
+
+
+int IntensityMeasureCalculator::computeIntensityMeasures(const QVector<double>& acceleration, const double dT, IntensityMeasures& measures, QString& errMsg) const
+{
+    measures = IntensityMeasures();
+
+    auto numPoints = acceleration.size();
+
+    if(numPoints < 2 || dT <= 0.0)
+    {
+        errMsg = "The time history should have at least two points and a positive time step";
+        return -1;
+    }
+
+    auto acc = acceleration.constData();
+
+    // The running integrals are all advanced in the same pass over the samples
+    QVector<double> cumulativeArias(numPoints);
+    auto arias = cumulativeArias.data();
+
+    auto peakAcc = std::fabs(acc[0]);
+    auto peakVel = 0.0;
+    auto peakDisp = 0.0;
+    auto vel = 0.0;
+    auto disp = 0.0;
+    auto cav = 0.0;
+
+    arias[0] = 0.0;
+
+    for(int i = 1; i<numPoints; ++i)
+    {
+        auto a0 = acc[i-1];
+        auto a1 = acc[i];
+
+        auto velNext = vel + 0.5*dT*(a0 + a1);
+        disp += 0.5*dT*(vel + velNext);
+        vel = velNext;
+
+        cav += 0.5*dT*(std::fabs(a0) + std::fabs(a1));
+        arias[i] = arias[i-1] + 0.5*dT*(a0*a0 + a1*a1);
+
+        peakAcc = std::max(peakAcc, std::fabs(a1));
+        peakVel = std::max(peakVel, std::fabs(vel));
+        peakDisp = std::max(peakDisp, std::fabs(disp));
+    }
+
+    measures.PGA = peakAcc;
+    measures.PGV = peakVel*gravity*100.0;
+    measures.PGD = peakDisp*gravity*100.0;
+    measures.CAV = cav;
+
+    // Ia = pi/(2g) * integral of a^2, with the acceleration in m/s^2
+    measures.AriasIntensity = M_PI/(2.0*gravity)*arias[numPoints-1]*gravity*gravity;
+
+    if(arias[numPoints-1] > 0.0)
+    {
+        auto t5 = crossingTime(cumulativeArias, 0.05, dT);
+
+        measures.D5_75 = crossingTime(cumulativeArias, 0.75, dT) - t5;
+        measures.D5_95 = crossingTime(cumulativeArias, 0.95, dT) - t5;
+    }
+
+    ResponseSpectrum spectrum;
+
+    if(spectrumCalculator.computeSpectrum(acceleration, dT, spectrum, errMsg) != 0)
+        return -1;
+
+    auto sumLog = 0.0;
+    auto isPositive = true;
+
+    for(auto&& it : spectrum.PSA.first())
+    {
+        if(it <= 0.0)
+            isPositive = false;
+        else
+            sumLog += std::log(it);
+    }
+
+    measures.SaAvg = isPositive ? std::exp(sumLog/spectrum.PSA.first().size()) : 0.0;
+
+    return 0;
+}
+
+
+int IntensityMeasureCalculator::computeIntensityMeasures(const GroundMotionRecord& record, RecordIntensityMeasures& measures, QString& errMsg) const
+{
+    measures = RecordIntensityMeasures();
+    measures.name = record.name;
+
+    double factorToG = 1.0;
+
+    if(getFactorToG(record.units, factorToG) != 0)
+    {
+        errMsg = record.name + ": the units " + record.units + " of the acceleration are not supported";
+        return -1;
+    }
+
+    IntensityMeasures* components[3] = {&measures.x, &measures.y, &measures.z};
+
+    for(int k = 0; k<3; ++k)
+    {
+        if(record.channels.at(k).isEmpty())
+            continue;
+
+        auto acceleration = record.channels.at(k);
+
+        if(factorToG != 1.0)
+        {
+            for(auto&& it : acceleration)
+                it *= factorToG;
+        }
+
+        QString err;
+        if(this->computeIntensityMeasures(acceleration, record.dT, *components[k], err) != 0)
+        {
+            errMsg = record.name + ": " + err;
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+
+int IntensityMeasureCalculator::computeIntensityMeasures(const QVector<GroundMotionTimeHistory>& records, QVector<RecordIntensityMeasures>& measures, QString& errMsg) const
+{
+    auto numRecords = records.size();
+
+    measures.clear();
+    measures.resize(numRecords);
+
+    QVector<QString> errors(3*numRecords);
+
+    auto measuresData = measures.data();
+    auto errorsData = errors.data();
+
+    for(int i = 0; i<numRecords; ++i)
+        measuresData[i].name = records.at(i).getName();
+
+    // One task per component of each record, each task writes only to its own entries
+    QVector<int> tasks(3*numRecords);
+    for(int i = 0; i<tasks.size(); ++i)
+        tasks[i] = i;
+
+    QtConcurrent::blockingMap(tasks, [&](const int task)
+    {
+        const auto& record = records.at(task/3);
+        auto component = task % 3;
+
+        auto values = component == 0 ? record.getX() : (component == 1 ? record.getY() : record.getZ());
+
+        if(values.isEmpty())
+            return;
+
+        for(auto&& it : values)
+            it *= record.getScalingFactor();
+
+        auto& result = measuresData[task/3];
+        auto& target = component == 0 ? result.x : (component == 1 ? result.y : result.z);
+
+        QString err;
+        if(this->computeIntensityMeasures(values, record.getDT(), target, err) != 0)
+            errorsData[task] = record.getName() + ": " + err;
+    });
+
+    for(auto&& it : errors)
+    {
+        if(!it.isEmpty())
+        {
+            errMsg = it;
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+
+QVector<double> IntensityMeasureCalculator::getSaAvgPeriods() const
+{
+    return spectrumCalculator.getPeriods();
+}
+
+
+void IntensityMeasureCalculator::setSaAvgPeriods(const QVector<double>& value)
+{
+    spectrumCalculator.setPeriods(value);
+}
+
+
+int IntensityMeasureCalculator::getFactorToG(const QString& units, double& factor)
+{
+    // Normalize the spelling, e.g., m/s^2, m/sec2 and mps2 are the same
+    auto key = units.trimmed().toLower();
+    key.remove(' ');
+    key.remove('^');
+    key.replace("sec", "s");
+    key.replace('/', 'p');
+
+    if(key.isEmpty() || key == "g")
+        factor = 1.0;
+    else if(key == "mps2")
+        factor = 1.0/gravity;
+    else if(key == "cmps2" || key == "gal")
+        factor = 0.01/gravity;
+    else if(key == "mmps2")
+        factor = 0.001/gravity;
+    else if(key == "inps2" || key == "inchps2")
+        factor = 0.0254/gravity;
+    else if(key == "ftps2")
+        factor = 0.3048/gravity;
+    else
+        return -1;
+
+    return 0;
+}
+
+
+QStringList IntensityMeasureCalculator::getIntensityMeasureNames(void)
+{
+    return {"PGA", "PGV", "PGD", "AriasIntensity", "CAV", "D5-75", "D5-95", "SaAvg"};
+}
+
+
+QVector<double> IntensityMeasureCalculator::toVector(const IntensityMeasures& measures)
+{
+    return {measures.PGA, measures.PGV, measures.PGD, measures.AriasIntensity, measures.CAV, measures.D5_75, measures.D5_95, measures.SaAvg};
+}
+
+
+IntensityMeasures IntensityMeasureCalculator::scale(const IntensityMeasures& measures, const double factor)
+{
+    auto scaled = measures;
+
+    auto absFactor = std::fabs(factor);
+
+    scaled.PGA *= absFactor;
+    scaled.PGV *= absFactor;
+    scaled.PGD *= absFactor;
+    scaled.CAV *= absFactor;
+    scaled.SaAvg *= absFactor;
+    scaled.AriasIntensity *= factor*factor;
+
+    return scaled;
+}
+
+
+IntensityMeasures IntensityMeasureCalculator::horizontalGeometricMean(const RecordIntensityMeasures& measures)
+{
+    if(std::isnan(measures.y.PGA))
+        return measures.x;
+
+    if(std::isnan(measures.x.PGA))
+        return measures.y;
+
+    auto geoMean = [](const double a, const double b)
+    {
+        return std::sqrt(a*b);
+    };
+
+    IntensityMeasures result;
+    result.PGA = geoMean(measures.x.PGA, measures.y.PGA);
+    result.PGV = geoMean(measures.x.PGV, measures.y.PGV);
+    result.PGD = geoMean(measures.x.PGD, measures.y.PGD);
+    result.AriasIntensity = geoMean(measures.x.AriasIntensity, measures.y.AriasIntensity);
+    result.CAV = geoMean(measures.x.CAV, measures.y.CAV);
+    result.D5_75 = geoMean(measures.x.D5_75, measures.y.D5_75);
+    result.D5_95 = geoMean(measures.x.D5_95, measures.y.D5_95);
+    result.SaAvg = geoMean(measures.x.SaAvg, measures.y.SaAvg);
+
+    return result;
+}
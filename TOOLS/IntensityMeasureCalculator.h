@@ -0,0 +1,116 @@
+#ifndef INTENSITYMEASURECALCULATOR_H
+#define INTENSITYMEASURECALCULATOR_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "ResponseSpectrumCalculator.h"
+
+#include <QStringList>
+#include <QVector>
+
+class GroundMotionTimeHistory;
+struct GroundMotionRecord;
+
+// Intensity measures of one acceleration time history in g, a measure that could not be computed is NaN
+// PGA and SaAvg are in g, PGV in cm/s, PGD in cm, the Arias intensity in m/s, the CAV in g-s, and the significant durations in s
+// PGV and PGD are integrated from the acceleration as it is, i.e., without a baseline correction
+struct IntensityMeasures
+{
+    IntensityMeasures();
+
+    double PGA;
+    double PGV;
+    double PGD;
+    double AriasIntensity;
+    double CAV;
+    double D5_75;
+    double D5_95;
+    double SaAvg;
+};
+
+
+// The intensity measures of the components of a record, the measures of a component that is not in the record are NaN
+struct RecordIntensityMeasures
+{
+    QString name;
+
+    IntensityMeasures x;
+    IntensityMeasures y;
+    IntensityMeasures z;
+};
+
+
+// Intensity measures of ground motion time histories
+// The measures that come from the time history itself are computed in a single pass over the samples, with the integrals taken with the trapezoidal rule
+class IntensityMeasureCalculator
+{
+public:
+    IntensityMeasureCalculator();
+
+    int computeIntensityMeasures(const QVector<double>& acceleration, const double dT, IntensityMeasures& measures, QString& errMsg) const;
+
+    // The components of the record are not scaled, they are converted to g from the units of the record
+    int computeIntensityMeasures(const GroundMotionRecord& record, RecordIntensityMeasures& measures, QString& errMsg) const;
+
+    // The records and their components are processed in parallel and the time histories are multiplied by their scaling factors
+    int computeIntensityMeasures(const QVector<GroundMotionTimeHistory>& records, QVector<RecordIntensityMeasures>& measures, QString& errMsg) const;
+
+    // SaAvg is the geometric mean of the 5% damped pseudo-spectral acceleration over these periods, by default ten log spaced periods from 0.2 to 3 s
+    QVector<double> getSaAvgPeriods() const;
+    void setSaAvgPeriods(const QVector<double>& value);
+
+    static QStringList getIntensityMeasureNames(void);
+
+    // The factor that converts an acceleration in the given units to g, e.g., m/s2, cm/s^2 or in/sec2, returns -1 if the units are not known
+    static int getFactorToG(const QString& units, double& factor);
+
+    // The measures in the order of getIntensityMeasureNames
+    static QVector<double> toVector(const IntensityMeasures& measures);
+
+    // The measures of the record after it is multiplied by a scaling factor, the durations do not change and the Arias intensity scales with the square of the factor
+    static IntensityMeasures scale(const IntensityMeasures& measures, const double factor);
+
+    // The geometric mean of the measures of the two horizontal components, or the measures of the one horizontal component in the record
+    static IntensityMeasures horizontalGeometricMean(const RecordIntensityMeasures& measures);
+
+private:
+
+    ResponseSpectrumCalculator spectrumCalculator;
+};
+
+#endif // INTENSITYMEASURECALCULATOR_H
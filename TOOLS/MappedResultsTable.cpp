@@ -0,0 +1,342 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "MappedResultsTable.h"
+#include "ResultsTable.h"
+
+#include <cstring>
+
+namespace
+{
+const char magic[8] = {'R','2','D','C','O','L','S','2'};
+
+// The sections are aligned so that the values can be read in place
+qint64 alignedOffset(const qint64 offset)
+{
+    return (offset + 7)/8*8;
+}
+}
+
+
+MappedResultsTable::MappedResultsTable()
+{
+    mappedData = nullptr;
+    rows = 0;
+    IDsOffset = 0;
+}
+
+
+MappedResultsTable::~MappedResultsTable()
+{
+    this->close();
+}
+
+
+int MappedResultsTable::write(const ResultsTable& table, const QString& pathToFile, QString& errMsg, const qint64 sourceSize, const qint64 sourceModified)
+{
+    // Layout: magic, the size and the modification time of the source, number of rows, number of columns, the offset of each column, the offset and the size of the headers, then the headers, the IDs and the columns
+    const qint64 numRows = table.numRows();
+    const qint64 numCols = table.numColumns();
+
+    auto headerBytes = table.getHeaders().join("\n").toUtf8();
+
+    qint64 offset = sizeof(magic) + 4*sizeof(qint64) + numCols*sizeof(qint64) + 2*sizeof(qint64);
+
+    const qint64 headersOffset = offset;
+    const qint64 headersSize = headerBytes.size();
+
+    offset = alignedOffset(offset + headersSize);
+
+    const qint64 IDsOffset = offset;
+
+    offset = alignedOffset(offset + numRows*static_cast<qint64>(sizeof(qint32)));
+
+    QVector<qint64> columnOffsets(static_cast<int>(numCols), -1);
+
+    // Column 0 is the asset ID
+    for(int col = 1; col<numCols; ++col)
+    {
+        if(!table.hasColumn(col))
+            continue;
+
+        columnOffsets[col] = offset;
+        offset += numRows*static_cast<qint64>(sizeof(double));
+    }
+
+    const auto fileSize = offset;
+
+    // Write to a temporary file that replaces the old one when it is complete, so that an interrupted write does not leave a valid looking file
+    auto tempPath = pathToFile + ".tmp";
+
+    QFile file(tempPath);
+
+    if(!file.open(QIODevice::ReadWrite | QIODevice::Truncate))
+    {
+        errMsg = "Could not open the file " + tempPath + " for writing: " + file.errorString();
+        return -1;
+    }
+
+    if(!file.resize(fileSize))
+    {
+        errMsg = "Could not allocate the file " + pathToFile + ": " + file.errorString();
+        return -1;
+    }
+
+    auto data = file.map(0, fileSize);
+
+    if(data == nullptr)
+    {
+        errMsg = "Could not map the file " + pathToFile + ": " + file.errorString();
+        return -1;
+    }
+
+    std::memcpy(data, magic, sizeof(magic));
+
+    qint64 pos = sizeof(magic);
+
+    auto writeInt64 = [&](const qint64 value)
+    {
+        std::memcpy(data + pos, &value, sizeof(qint64));
+        pos += sizeof(qint64);
+    };
+
+    writeInt64(sourceSize);
+    writeInt64(sourceModified);
+    writeInt64(numRows);
+    writeInt64(numCols);
+
+    for(auto&& it : columnOffsets)
+        writeInt64(it);
+
+    writeInt64(headersOffset);
+    writeInt64(headersSize);
+
+    std::memcpy(data + headersOffset, headerBytes.constData(), static_cast<size_t>(headersSize));
+
+    const auto& IDs = table.getIDs();
+
+    auto IDsData = reinterpret_cast<qint32*>(data + IDsOffset);
+    for(int i = 0; i<numRows; ++i)
+        IDsData[i] = IDs.at(i);
+
+    for(int col = 1; col<numCols; ++col)
+    {
+        if(columnOffsets.at(col) == -1)
+            continue;
+
+        std::memcpy(data + columnOffsets.at(col), table.getColumn(col).constData(), static_cast<size_t>(numRows)*sizeof(double));
+    }
+
+    file.unmap(data);
+    file.close();
+
+    QFile::remove(pathToFile);
+
+    if(!file.rename(pathToFile))
+    {
+        errMsg = "Could not rename the file " + tempPath + " to " + pathToFile + ": " + file.errorString();
+        return -1;
+    }
+
+    return 0;
+}
+
+
+int MappedResultsTable::readSourceStamp(const QString& pathToFile, qint64& sourceSize, qint64& sourceModified)
+{
+    QFile theFile(pathToFile);
+
+    if(!theFile.open(QIODevice::ReadOnly))
+        return -1;
+
+    char header[sizeof(magic) + 2*sizeof(qint64)];
+
+    if(theFile.read(header, sizeof(header)) != static_cast<qint64>(sizeof(header)) || std::memcmp(header, magic, sizeof(magic)) != 0)
+        return -1;
+
+    std::memcpy(&sourceSize, header + sizeof(magic), sizeof(qint64));
+    std::memcpy(&sourceModified, header + sizeof(magic) + sizeof(qint64), sizeof(qint64));
+
+    return 0;
+}
+
+
+int MappedResultsTable::open(const QString& pathToFile, QString& errMsg)
+{
+    this->close();
+
+    file.setFileName(pathToFile);
+
+    if(!file.open(QIODevice::ReadOnly))
+    {
+        errMsg = "Could not open the file " + pathToFile + ": " + file.errorString();
+        return -1;
+    }
+
+    auto fileSize = file.size();
+
+    const qint64 minSize = sizeof(magic) + 6*sizeof(qint64);
+
+    if(fileSize >= minSize)
+        mappedData = file.map(0, fileSize);
+
+    if(mappedData == nullptr || std::memcmp(mappedData, magic, sizeof(magic)) != 0)
+    {
+        errMsg = "The file " + pathToFile + " is not a columnar results file";
+        this->close();
+        return -1;
+    }
+
+    // Skip the size and the modification time of the source
+    qint64 pos = sizeof(magic) + 2*sizeof(qint64);
+
+    auto readInt64 = [&]()
+    {
+        qint64 value = 0;
+
+        if(pos + static_cast<qint64>(sizeof(qint64)) <= fileSize)
+            std::memcpy(&value, mappedData + pos, sizeof(qint64));
+
+        pos += sizeof(qint64);
+
+        return value;
+    };
+
+    rows = readInt64();
+    auto numCols = readInt64();
+
+    if(rows < 0 || numCols < 0 || numCols > (fileSize - pos)/static_cast<qint64>(sizeof(qint64)))
+    {
+        errMsg = "The header of the file " + pathToFile + " is corrupt";
+        this->close();
+        return -1;
+    }
+
+    columnOffsets.resize(static_cast<int>(numCols));
+    for(auto&& it : columnOffsets)
+        it = readInt64();
+
+    auto headersOffset = readInt64();
+    auto headersSize = readInt64();
+
+    IDsOffset = alignedOffset(headersOffset + headersSize);
+
+    // Check that every section is inside of the file
+    auto valid = headersOffset >= pos && headersSize >= 0 && IDsOffset + rows*static_cast<qint64>(sizeof(qint32)) <= fileSize;
+
+    for(auto&& it : columnOffsets)
+    {
+        if(it != -1 && (it < IDsOffset || it % 8 != 0 || it + rows*static_cast<qint64>(sizeof(double)) > fileSize))
+            valid = false;
+    }
+
+    if(!valid)
+    {
+        errMsg = "The file " + pathToFile + " is truncated or corrupt";
+        this->close();
+        return -1;
+    }
+
+    headers = QString::fromUtf8(reinterpret_cast<const char*>(mappedData + headersOffset), static_cast<int>(headersSize)).split("\n");
+
+    return 0;
+}
+
+
+void MappedResultsTable::close(void)
+{
+    if(mappedData != nullptr)
+        file.unmap(mappedData);
+
+    if(file.isOpen())
+        file.close();
+
+    mappedData = nullptr;
+    rows = 0;
+    IDsOffset = 0;
+    headers.clear();
+    columnOffsets.clear();
+}
+
+
+bool MappedResultsTable::isOpen(void) const
+{
+    return mappedData != nullptr;
+}
+
+
+int MappedResultsTable::numRows(void) const
+{
+    return static_cast<int>(rows);
+}
+
+
+int MappedResultsTable::numColumns(void) const
+{
+    return columnOffsets.size();
+}
+
+
+QStringList MappedResultsTable::getHeaders(void) const
+{
+    return headers;
+}
+
+
+const qint32* MappedResultsTable::getIDs(void) const
+{
+    if(mappedData == nullptr)
+        return nullptr;
+
+    return reinterpret_cast<const qint32*>(mappedData + IDsOffset);
+}
+
+
+bool MappedResultsTable::hasColumn(const int col) const
+{
+    return mappedData != nullptr && col >= 0 && col < columnOffsets.size() && columnOffsets.at(col) != -1;
+}
+
+
+const double* MappedResultsTable::getColumn(const int col) const
+{
+    if(!this->hasColumn(col))
+        return nullptr;
+
+    return reinterpret_cast<const double*>(mappedData + columnOffsets.at(col));
+}
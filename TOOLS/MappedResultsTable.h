@@ -0,0 +1,98 @@
+#ifndef MAPPEDRESULTSTABLE_H
+#define MAPPEDRESULTSTABLE_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include <QFile>
+#include <QStringList>
+#include <QVector>
+
+class ResultsTable;
+
+// Read only view of a results table that is stored column by column in a binary file and memory mapped
+// Only the pages of the columns that are used are read from the disk, so many large tables can be open at once without a copy of each in memory
+// The file holds the IDs and each column as contiguous native values, i.e., it is a cache on the same machine and not an exchange format
+class MappedResultsTable
+{
+public:
+    MappedResultsTable();
+    ~MappedResultsTable();
+
+    // Writes the table in the columnar format, the size and the modification time of the file that the table was read from are stored with it
+    static int write(const ResultsTable& table, const QString& pathToFile, QString& errMsg, const qint64 sourceSize = -1, const qint64 sourceModified = -1);
+
+    // Reads the size and the modification time of the source file from the header without mapping the file, returns -1 if the file is not a columnar results file
+    static int readSourceStamp(const QString& pathToFile, qint64& sourceSize, qint64& sourceModified);
+
+    int open(const QString& pathToFile, QString& errMsg);
+
+    void close(void);
+
+    bool isOpen(void) const;
+
+    int numRows(void) const;
+
+    int numColumns(void) const;
+
+    QStringList getHeaders(void) const;
+
+    // The asset IDs, in the order of the rows
+    const qint32* getIDs(void) const;
+
+    bool hasColumn(const int col) const;
+
+    // Returns the values of the column, or a null pointer if the column is not in the table
+    const double* getColumn(const int col) const;
+
+private:
+
+    QFile file;
+
+    uchar* mappedData;
+
+    qint64 rows;
+
+    QStringList headers;
+
+    qint64 IDsOffset;
+
+    // The offset of each column in the file, or -1 if the column is not in the table
+    QVector<qint64> columnOffsets;
+};
+
+#endif // MAPPEDRESULTSTABLE_H
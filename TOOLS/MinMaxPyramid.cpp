@@ -0,0 +1,259 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "MinMaxPyramid.h"
+
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cmath>
+
+MinMaxPyramid::MinMaxPyramid()
+{
+    this->clear();
+}
+
+
+void MinMaxPyramid::build(const QVector<double>& values, const double timeStep, const double start)
+{
+    this->clear();
+
+    if(values.isEmpty() || timeStep <= 0.0)
+        return;
+
+    samples = values;
+    dT = timeStep;
+    startTime = start;
+
+    // The first level above the samples holds pairs of samples
+    Level first;
+
+    auto numBuckets = (samples.size() + 1)/2;
+
+    first.minValues.resize(numBuckets);
+    first.maxValues.resize(numBuckets);
+    first.minFirst.resize(numBuckets);
+
+    for(int i = 0; i<numBuckets; ++i)
+    {
+        auto a = samples.at(2*i);
+        auto b = 2*i + 1 < samples.size() ? samples.at(2*i + 1) : a;
+
+        first.minValues[i] = std::min(a, b);
+        first.maxValues[i] = std::max(a, b);
+        first.minFirst[i] = a <= b;
+    }
+
+    levels.push_back(first);
+
+    // Halve the number of buckets until there is only one left
+    while(levels.last().minValues.size() > 1)
+    {
+        const auto& below = levels.last();
+
+        Level next;
+
+        auto numBelow = below.minValues.size();
+        numBuckets = (numBelow + 1)/2;
+
+        next.minValues.resize(numBuckets);
+        next.maxValues.resize(numBuckets);
+        next.minFirst.resize(numBuckets);
+
+        for(int i = 0; i<numBuckets; ++i)
+        {
+            auto a = 2*i;
+            auto b = std::min(2*i + 1, numBelow - 1);
+
+            auto minIndex = below.minValues.at(b) < below.minValues.at(a) ? b : a;
+            auto maxIndex = below.maxValues.at(b) > below.maxValues.at(a) ? b : a;
+
+            next.minValues[i] = below.minValues.at(minIndex);
+            next.maxValues[i] = below.maxValues.at(maxIndex);
+
+            // The order within the bucket follows the sub-buckets, and the order inside the sub-bucket if both come from the same one
+            next.minFirst[i] = minIndex != maxIndex ? minIndex < maxIndex : below.minFirst.at(minIndex);
+        }
+
+        levels.push_back(next);
+    }
+}
+
+
+QVector<MinMaxPyramid> MinMaxPyramid::buildPyramids(const QVector<QVector<double>>& signalValues, const QVector<double>& timeSteps)
+{
+    QVector<MinMaxPyramid> pyramids(signalValues.size());
+
+    auto pyramidsData = pyramids.data();
+
+    QVector<int> indices(signalValues.size());
+    for(int i = 0; i<indices.size(); ++i)
+        indices[i] = i;
+
+    // Each signal is handled by one thread and writes only to its own pyramid
+    QtConcurrent::blockingMap(indices, [&](const int i)
+    {
+        pyramidsData[i].build(signalValues.at(i), timeSteps.value(i, 0.0));
+    });
+
+    return pyramids;
+}
+
+
+void MinMaxPyramid::clear(void)
+{
+    samples.clear();
+    levels.clear();
+    dT = 0.0;
+    startTime = 0.0;
+}
+
+
+bool MinMaxPyramid::isEmpty(void) const
+{
+    return samples.isEmpty();
+}
+
+
+int MinMaxPyramid::getNumberOfLevels(void) const
+{
+    return samples.isEmpty() ? 0 : levels.size() + 1;
+}
+
+
+int MinMaxPyramid::getNumberOfPoints(void) const
+{
+    return samples.size();
+}
+
+
+double MinMaxPyramid::getStartTime(void) const
+{
+    return startTime;
+}
+
+
+double MinMaxPyramid::getEndTime(void) const
+{
+    return samples.isEmpty() ? startTime : startTime + (samples.size() - 1)*dT;
+}
+
+
+double MinMaxPyramid::getMinimum(void) const
+{
+    if(samples.isEmpty())
+        return 0.0;
+
+    return levels.isEmpty() ? samples.first() : levels.last().minValues.first();
+}
+
+
+double MinMaxPyramid::getMaximum(void) const
+{
+    if(samples.isEmpty())
+        return 0.0;
+
+    return levels.isEmpty() ? samples.first() : levels.last().maxValues.first();
+}
+
+
+QVector<QPointF> MinMaxPyramid::getPoints(const double fromTime, const double toTime, const int pixelWidth) const
+{
+    QVector<QPointF> points;
+
+    if(samples.isEmpty() || toTime < fromTime)
+        return points;
+
+    auto numSamples = samples.size();
+
+    // The samples in view, plus one on each side so that the line runs to the edges of the plot
+    auto first = std::max(static_cast<int>(std::floor((fromTime - startTime)/dT)) - 1, 0);
+    auto last = std::min(static_cast<int>(std::ceil((toTime - startTime)/dT)) + 1, numSamples - 1);
+
+    if(first > last)
+        return points;
+
+    auto numInView = last - first + 1;
+
+    // Each level halves the number of points, pick the coarsest level that still has a bucket for every pixel
+    int level = 0;
+    while(level < levels.size() && (numInView >> (level + 1)) >= std::max(pixelWidth, 1))
+        ++level;
+
+    if(level == 0)
+    {
+        points.reserve(numInView);
+
+        for(int i = first; i<=last; ++i)
+            points.push_back(QPointF(startTime + i*dT, samples.at(i)));
+
+        return points;
+    }
+
+    const auto& buckets = levels.at(level - 1);
+
+    auto bucketSize = 1 << level;
+
+    auto firstBucket = first/bucketSize;
+    auto lastBucket = std::min(last/bucketSize, buckets.minValues.size() - 1);
+
+    points.reserve(2*(lastBucket - firstBucket + 1));
+
+    for(int b = firstBucket; b<=lastBucket; ++b)
+    {
+        // The minimum and maximum are drawn a quarter of a bucket apart, at the middle of the bucket
+        auto center = startTime + (b*bucketSize + 0.5*(bucketSize - 1))*dT;
+        auto offset = 0.25*bucketSize*dT;
+
+        auto minPoint = buckets.minFirst.at(b) ? QPointF(center - offset, buckets.minValues.at(b)) : QPointF(center + offset, buckets.minValues.at(b));
+        auto maxPoint = buckets.minFirst.at(b) ? QPointF(center + offset, buckets.maxValues.at(b)) : QPointF(center - offset, buckets.maxValues.at(b));
+
+        if(buckets.minFirst.at(b))
+        {
+            points.push_back(minPoint);
+            points.push_back(maxPoint);
+        }
+        else
+        {
+            points.push_back(maxPoint);
+            points.push_back(minPoint);
+        }
+    }
+
+    return points;
+}
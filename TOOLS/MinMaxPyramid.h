@@ -0,0 +1,96 @@
+#ifndef MINMAXPYRAMID_H
+#define MINMAXPYRAMID_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include <QPointF>
+#include <QVector>
+
+// Multi-resolution min/max summary of a sampled signal for plotting
+// Level 0 is the signal itself and each level above it holds the minimum and maximum of pairs of buckets of the level below, so that a level can be picked to match the number of pixels on screen
+class MinMaxPyramid
+{
+public:
+    MinMaxPyramid();
+
+    void build(const QVector<double>& values, const double dT, const double startTime = 0.0);
+
+    // Builds the pyramids of several signals in parallel
+    static QVector<MinMaxPyramid> buildPyramids(const QVector<QVector<double>>& signalValues, const QVector<double>& timeSteps);
+
+    void clear(void);
+
+    bool isEmpty(void) const;
+
+    int getNumberOfLevels(void) const;
+
+    int getNumberOfPoints(void) const;
+
+    double getStartTime(void) const;
+
+    double getEndTime(void) const;
+
+    // The minimum and maximum of the whole signal
+    double getMinimum(void) const;
+    double getMaximum(void) const;
+
+    // The points to draw between the start and end times on a plot that is the given number of pixels wide
+    // The coarsest level with at least one bucket per pixel is used, each bucket gives its minimum and its maximum in the order in which they occur
+    QVector<QPointF> getPoints(const double fromTime, const double toTime, const int pixelWidth) const;
+
+private:
+
+    struct Level
+    {
+        QVector<double> minValues;
+        QVector<double> maxValues;
+
+        // Whether the minimum of a bucket occurs before its maximum
+        QVector<bool> minFirst;
+    };
+
+    QVector<double> samples;
+
+    QVector<Level> levels;
+
+    double dT;
+
+    double startTime;
+};
+
+#endif // MINMAXPYRAMID_H
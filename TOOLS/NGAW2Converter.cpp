@@ -38,6 +38,9 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 #include "NGAW2Converter.h"
 #include "CSVReaderWriter.h"
+#include "GroundMotionRecordFile.h"
+#include "GroundMotionSignalProcessor.h"
+#include "PeerRecordParser.h"
 
 #include <QDir>
 #include <QJsonDocument>
@@ -45,7 +48,9 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <QFile>
 #include <QFileInfo>
 #include <QVariant>
+#include <QtConcurrent>
 
+#include <algorithm>
 #include <math.h>
 
 NGAW2Converter::NGAW2Converter()
@@ -53,6 +58,9 @@ NGAW2Converter::NGAW2Converter()
     directionH1 = true;
     directionH2 = true;
     directionVert = false;
+
+    // The records are written as they are downloaded unless the processing is turned on
+    processingEnabled = false;
 }
 
 
@@ -90,6 +98,13 @@ int NGAW2Converter::convertToSimCenterEvent(const QString& pathToOutputDirectory
 
     auto records = metaData.keys();
 
+    const bool directions[3] = {directionH1, directionH2, directionVert};
+
+    QStringList recordNames;
+
+    // The files of the three components of each record, the file of a component that is not converted is empty
+    QStringList componentFiles;
+
     for(auto&& it : records)
     {
         auto recordObj = metaData[it].toObject();
@@ -102,8 +117,6 @@ int NGAW2Converter::convertToSimCenterEvent(const QString& pathToOutputDirectory
             return -1;
         }
 
-        auto name = "RSN"+RSNNumber;
-
         auto H1FileName = recordObj.value("Horizontal-1 Acc. Filename").toString();
         auto H2FileName = recordObj.value("Horizontal-2 Acc. Filename").toString();
         auto VFileName = recordObj.value("Vertical Acc. Filename").toString();
@@ -114,126 +127,168 @@ int NGAW2Converter::convertToSimCenterEvent(const QString& pathToOutputDirectory
             return -1;
         }
 
-        QJsonObject recordJsonObj;
+        recordNames.append("RSN"+RSNNumber);
 
-        recordJsonObj.insert("name",name);
+        componentFiles.append(directionH1 ? pathToOutputDirectory + H1FileName : QString());
+        componentFiles.append(directionH2 ? pathToOutputDirectory + H2FileName : QString());
+        componentFiles.append(directionVert ? pathToOutputDirectory + VFileName : QString());
+    }
 
-        auto dT = -1.0;
+    auto numRecords = recordNames.size();
 
-        if(directionH1)
+    // Parse all of the components of all of the records in parallel, each task writes only to its own entries
+    QVector<PeerRecord> components(componentFiles.size());
+    QVector<QString> errors(componentFiles.size());
+
+    auto componentsData = components.data();
+    auto errorsData = errors.data();
+
+    QVector<int> tasks(componentFiles.size());
+    for(int i = 0; i<tasks.size(); ++i)
+        tasks[i] = i;
+
+    QtConcurrent::blockingMap(tasks, [&](const int i)
+    {
+        if(!componentFiles.at(i).isEmpty())
+            PeerRecordParser::parse(componentFiles.at(i), componentsData[i], errorsData[i]);
+    });
+
+    for(auto&& it : errors)
+    {
+        if(!it.isEmpty())
         {
-            auto filePathH1 = pathToOutputDirectory + H1FileName;
-            QJsonObject H1Obj;
-            auto res1 = this->convertRecordToJson(filePathH1,H1Obj,errorMsg);
-            if(res1 != 0)
-            {
-                errorMsg = "Error importing file " + filePathH1;
-                return -1;
-            }
+            errorMsg = it;
+            return -1;
+        }
+    }
+
+    // Assemble and write the records in parallel
+    QVector<QJsonObject> recordJsonObjs(numRecords);
+    QVector<QString> recordErrors(numRecords);
+
+    auto recordJsonData = recordJsonObjs.data();
+    auto recordErrorsData = recordErrors.data();
+
+    const QStringList directionNames = {"x", "y", "z"};
+
+    tasks.resize(numRecords);
+
+    QtConcurrent::blockingMap(tasks, [&](const int i)
+    {
+        const auto& name = recordNames.at(i);
+
+        auto& recordJsonObj = recordJsonData[i];
+        auto& recordErrMsg = recordErrorsData[i];
+
+        recordJsonObj.insert("name",name);
 
-            // Get the time step
-            auto dTTs = H1Obj.value("dT").toDouble();
-            dT = dTTs;
+        // The same record in the binary format that is loaded by the application
+        GroundMotionRecord record;
+        record.name = name;
 
-            // Get the time history data points
-            auto TH = H1Obj.value("TimeHistoryData").toArray();
-            recordJsonObj.insert("data_x",TH);
+        // The components are brought to the smallest of their time steps, instead of rejecting a record with inconsistent time steps
+        auto dT = -1.0;
 
-            auto PGA = this->getPGA(&TH);
-            recordJsonObj.insert("PGA_x",PGA);
+        for(int k = 0; k<3; ++k)
+        {
+            if(directions[k] && (dT < 0.0 || components.at(3*i + k).dT < dT))
+                dT = components.at(3*i + k).dT;
         }
 
-        if(directionH2)
+        if(dT <= 0.0)
         {
-            auto filePathH2 = pathToOutputDirectory + H2FileName;
-            QJsonObject H2Obj;
-            auto res2 = this->convertRecordToJson(filePathH2,H2Obj,errorMsg);
-            if(res2 != 0)
-            {
-                errorMsg = "Error importing file " + filePathH2;
-                return -1;
-            }
+            recordErrMsg = "Error getting the time step from the time history files";
+            return;
+        }
+
+        auto numPoints = -1;
+        auto isSameLength = true;
+
+        for(int k = 0; k<3; ++k)
+        {
+            if(!directions[k])
+                continue;
+
+            const auto& component = components.at(3*i + k);
 
-            // Set the time step if not already set
-            auto dTTs = H2Obj.value("dT").toDouble();
-            if(dT < 0.0)
-                dT = dTTs;
+            if(fabs(component.dT-dT) > 1.0e-6)
+                record.channels[k] = GroundMotionSignalProcessor::resample(component.values, component.dT, dT);
             else
-            {
-                // Check if the time step is the same for all time history files
-                if(fabs(dTTs-dT) > 1.0e-6)
-                {
-                    errorMsg = "Error, inconsistent time step size in the time history files.";
-                    return -1;
-                }
-            }
+                record.channels[k] = component.values;
 
-            // Get the time history data points
-            auto TH = H2Obj.value("TimeHistoryData").toArray();
-            recordJsonObj.insert("data_y",TH);
+            if(numPoints >= 0 && record.channels.at(k).size() != numPoints)
+                isSameLength = false;
 
-            auto PGA = this->getPGA(&TH);
-            recordJsonObj.insert("PGA_y",PGA);
+            numPoints = std::max(numPoints, record.channels.at(k).size());
         }
 
-        if(directionVert)
-        {
-            auto filePathV = pathToOutputDirectory + VFileName;
-            QJsonObject VObj;
-            auto res3 = this->convertRecordToJson(filePathV,VObj,errorMsg);
-            if(res3 != 0)
-            {
-                errorMsg = "Error importing file " + filePathV;
-                return -1;
-            }
+        record.dT = dT;
 
-            auto dTTs = VObj.value("dT").toDouble();
+        // The components are also given the same number of points by the processor
+        if(processingEnabled || !isSameLength)
+        {
+            auto processor = signalProcessor;
 
-            if(dT < 0.0)
-                dT = dTTs;
-            else
+            if(!processingEnabled)
             {
-                // Check if the time step is the same for all time history files
-                if(fabs(dTTs-dT) > 1.0e-6)
-                {
-                    errorMsg = "Error, inconsistent time step size in the time history files.";
-                    return -1;
-                }
+                processor.setBaselineOrder(-1);
+                processor.setFilterEnabled(false);
+                processor.setTargetTimeStep(0.0);
             }
 
-            // Get the time history data points
-            auto TH = VObj.value("TimeHistoryData").toArray();
-            recordJsonObj.insert("data_z",TH);
-
-            auto PGA = this->getPGA(&TH);
-            recordJsonObj.insert("PGA_z",PGA);
+            if(processor.processRecord(record, recordErrMsg) != 0)
+                return;
         }
 
-        if(dT <= 0.0)
+        for(int k = 0; k<3; ++k)
         {
-            errorMsg = "Error getting the time step from the time history files";
-            return -1;
+            if(!directions[k])
+                continue;
+
+            const auto& values = record.channels.at(k);
+
+            QJsonArray TH;
+            for(auto&& it : values)
+                TH.append(it);
+
+            recordJsonObj.insert("data_" + directionNames.at(k),TH);
+
+            auto PGA = this->getPGA(values);
+            recordJsonObj.insert("PGA_" + directionNames.at(k),PGA);
+
+            record.peakValues[k] = PGA;
         }
 
-        recordJsonObj.insert("dT",dT);
+        recordJsonObj.insert("dT",record.dT);
 
         QString outputFile = pathToOutputDirectory + name + ".json";
 
         QFile file(outputFile);
         if (!file.open(QFile::WriteOnly | QFile::Text))
         {
-            errorMsg = "Error creating the output json file";
-            return -1;
+            recordErrMsg = "Error creating the output json file";
+            return;
         }
 
-        // Write the file to the folder
+        // Write the file to the folder, the json file is still read by the backend applications
         QJsonDocument doc(recordJsonObj);
-        file.write(doc.toJson());
+        file.write(doc.toJson(QJsonDocument::Compact));
         file.close();
 
+        GroundMotionRecordFile::write(pathToOutputDirectory + name + GroundMotionRecordFile::extension(), record, recordErrMsg);
+    });
+
+    for(int i = 0; i<numRecords; ++i)
+    {
+        if(!recordErrors.at(i).isEmpty())
+        {
+            errorMsg = recordNames.at(i) + ": " + recordErrors.at(i);
+            return -1;
+        }
+
         if(createdRecords)
         {
-            createdRecords->insert("name",recordJsonObj);
+            createdRecords->insert("name",recordJsonObjs.at(i));
         }
     }
 
@@ -333,142 +388,39 @@ int NGAW2Converter::parseNGAW2SearchResults(const QString& filesDirectoryPath, Q
 }
 
 
-int NGAW2Converter::convertRecordToJson(const QString& inputFile, QJsonObject& recordJson, QString& errorMsg)
+double NGAW2Converter::getPGA(const QVector<double>& timeHistory)
 {
-    // Open the raw file
-    QFile theRecordFile = QFile(inputFile);
+    auto PGAmax = 0.0;
 
-    if (!theRecordFile.exists())
+    for(auto&& val : timeHistory)
     {
-        errorMsg = QString("No file ") +  inputFile + QString(" exists");
-        return -1;
+        if(fabs(val) > PGAmax)
+           PGAmax = fabs(val);
     }
 
-    if (theRecordFile.open(QIODevice::ReadOnly))
-    {
-        auto firstLine = theRecordFile.readLine();
-
-        if(firstLine.compare("PEER NGA STRONG MOTION DATABASE RECORD\r\n") != 0)
-        {
-            errorMsg = "Only PEER NGA files supported";
-            return -1;
-        }
-
-        // Get the second line -> event name, event date, station ID, direction
-        auto secondLine = theRecordFile.readLine();
-
-        auto secondLineValues = secondLine.split(',');
-
-        if(secondLineValues.size() != 4)
-        {
-            errorMsg = "Error importing the time series raw data";
-            return -1;
-        }
-
-        auto eventName = QString::fromLocal8Bit(secondLineValues.at(0)).trimmed();
-
-        auto eventDate = QString::fromLocal8Bit(secondLineValues.at(1)).trimmed();
-
-        auto stationID = QString::fromLocal8Bit(secondLineValues.at(2)).trimmed();
-
-        auto direction = QString::fromLocal8Bit(secondLineValues.at(3)).trimmed();
-
-        // Get the third line - type of time history, acceleration, velocity, displacement, etc.
-        auto timeHistoryType = QString::fromLocal8Bit(theRecordFile.readLine()).trimmed();
-
-        // Get the fourth line - number of points and time step (Dt)
-        auto fourthLine = QString::fromLocal8Bit(theRecordFile.readLine()).trimmed();
-
-        QRegExp rx = QRegExp("NPTS=\\s*([1-9][0-9]*)\\s*,\\s*DT=\\s*(\\d*\\.\\d+)\\s*SEC");
-
-        rx.indexIn(fourthLine);
-
-        QStringList qsl = rx.capturedTexts();
-
-        if(qsl.size() != 3)
-            return -1;
-
-        bool OK = true;
-
-        auto numPtnsStr = qsl[1];
-        auto numPnts = numPtnsStr.toInt(&OK);
-
-        if(!OK)
-        {
-            errorMsg = "Error converting string to integer";
-            return -1;
-        }
-
-        auto dTStr = qsl[2];
-        auto dT = dTStr.toDouble(&OK);
-
-        if(!OK)
-        {
-            errorMsg = "Error converting string to double";
-            return -1;
-        }
-
-        QJsonArray timeHistoryArray;
-
-        QRegExp delim("\\s+");
-
-        // File opened successfully, parse csv file for records
-        while (!theRecordFile.atEnd())
-        {
-            auto line =  QString::fromLocal8Bit(theRecordFile.readLine()).trimmed();
-
-            foreach (const QString &item, line.split(delim, QString::SkipEmptyParts))
-            {
-                bool OK = true;
-                auto dataPointValue = item.toDouble(&OK);
-
-                if(!OK)
-                {
-                    errorMsg = "Error converting to double ";
-                    return -1;
-                }
-
-                timeHistoryArray.append(dataPointValue);
-
-            }
-        }
-
-        if(timeHistoryArray.size() != numPnts)
-        {
-            errorMsg = "Error, the number of imported points should match the number of points in the time-history input file";
-            return -1;
-        }
-
-        recordJson.insert("NumberPoints", numPnts);
-        recordJson.insert("EventName", eventName);
-        recordJson.insert("EventDate", eventDate);
-        recordJson.insert("StationID", stationID);
-        recordJson.insert("Direction", direction);
-        recordJson.insert("TimeHistoryType", timeHistoryType);
-        recordJson.insert("dT", dT);
-        recordJson.insert("TimeHistoryData",timeHistoryArray);
-    }
+    return PGAmax;
+}
 
 
-    return 0;
+bool NGAW2Converter::getProcessingEnabled() const
+{
+    return processingEnabled;
 }
 
 
-double NGAW2Converter::getPGA(const QJsonArray* timeHistory)
+void NGAW2Converter::setProcessingEnabled(const bool value)
 {
+    processingEnabled = value;
+}
 
-    auto variantList = timeHistory->toVariantList();
-
-    auto PGAmax = 0.0;
 
-    for(auto&& it : variantList)
-    {
-        auto val = it.toDouble();
+GroundMotionSignalProcessor NGAW2Converter::getSignalProcessor() const
+{
+    return signalProcessor;
+}
 
-        if(fabs(val) > PGAmax)
-           PGAmax = val;
-    }
 
-    return PGAmax;
+void NGAW2Converter::setSignalProcessor(const GroundMotionSignalProcessor& value)
+{
+    signalProcessor = value;
 }
-
@@ -40,7 +40,10 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 // Written by: Stevan Gavrilovic
 
+#include "GroundMotionSignalProcessor.h"
+
 #include <QJsonObject>
+#include <QVector>
 
 class NGAW2Converter
 {
@@ -51,15 +54,24 @@ public:
 
     int parseNGAW2SearchResults(const QString& filesDirectoryPath, QJsonObject& resultsJson, QString& errorMsg);
 
-private:
-    int convertRecordToJson(const QString& inputFile, QJsonObject& recordJson, QString& errorMsg);
+    // When the processing is on, the records go through the signal processor before they are written
+    bool getProcessingEnabled() const;
+    void setProcessingEnabled(const bool value);
+
+    GroundMotionSignalProcessor getSignalProcessor() const;
+    void setSignalProcessor(const GroundMotionSignalProcessor& value);
 
-    double getPGA(const QJsonArray* timeHistory);
+private:
+    double getPGA(const QVector<double>& timeHistory);
 
     bool directionH1;
     bool directionH2;
     bool directionVert;
 
+    bool processingEnabled;
+
+    GroundMotionSignalProcessor signalProcessor;
+
 };
 
 #endif // NGAW2CONVERTER_H
@@ -0,0 +1,341 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "PDFReportWriter.h"
+
+#include <QDateTime>
+#include <QFontMetrics>
+#include <QPrinter>
+#include <QTextCursor>
+#include <QTextDocument>
+#include <QTextTable>
+#include <QtConcurrent>
+
+#include <algorithm>
+
+PDFReportWriter::PDFReportWriter(QObject* parent) : QObject(parent)
+{
+    cancelled = false;
+    rowsPerTable = 250;
+    maxTableRows = 10000;
+}
+
+
+int PDFReportWriter::write(const PDFReportContents& contents, QString& errMsg)
+{
+    emit progressChanged(0);
+
+    // The printer
+    QPrinter printer(QPrinter::HighResolution);
+    printer.setOutputFormat(QPrinter::PdfFormat);
+    printer.setPaperSize(QPrinter::Letter);
+    printer.setPageMargins(25.4, 25.4, 25.4, 25.4, QPrinter::Millimeter);
+    printer.setFullPage(true);
+    qreal leftMargin, topMargin;
+    printer.getPageMargins(&leftMargin,&topMargin,nullptr,nullptr,QPrinter::Point);
+    printer.setOutputFileName(contents.outputFilePath);
+
+    // Ratio of the page width that is printable
+    auto useablePageWidth = printer.pageRect(QPrinter::Point).width()-(1.5*leftMargin);
+
+    // The map is cropped to the map view and the figures are scaled to twice their width in points, in parallel
+    QVector<PDFReportFigure> figures;
+
+    PDFReportFigure mapFigure;
+    mapFigure.image = contents.mapImage.copy(contents.mapRect);
+    mapFigure.caption = "Regional map visualization.";
+    mapFigure.width = static_cast<int>(useablePageWidth);
+
+    figures.push_back(mapFigure);
+    figures.append(contents.figures);
+
+    QtConcurrent::blockingMap(figures, [](PDFReportFigure& figure)
+    {
+        if(!figure.image.isNull() && figure.image.width() > 2*figure.width)
+            figure.image = figure.image.scaledToWidth(2*figure.width, Qt::SmoothTransformation);
+    });
+
+    if(cancelled)
+        return -1;
+
+    emit progressChanged(20);
+
+    // Create a new document
+    QTextDocument document;
+    QTextCursor cursor(&document);
+    document.setDocumentMargin(25.4);
+    document.setDefaultFont(QFont("Helvetica"));
+
+    // Define font styles
+    QTextCharFormat normalFormat;
+    normalFormat.setFontWeight(QFont::Normal);
+
+    QTextCharFormat titleFormat;
+    titleFormat.setFontWeight(QFont::Bold);
+    titleFormat.setFontCapitalization(QFont::AllUppercase);
+    titleFormat.setFontPointSize(normalFormat.fontPointSize() * 2.0);
+
+    QTextCharFormat captionFormat;
+    captionFormat.setFontWeight(QFont::Light);
+    captionFormat.setFontPointSize(normalFormat.fontPointSize() / 2.0);
+    captionFormat.setFontItalic(true);
+
+    QTextCharFormat boldFormat;
+    boldFormat.setFontWeight(QFont::Bold);
+
+    QFontMetrics normMetrics(normalFormat.font());
+    auto lineSpacing = normMetrics.lineSpacing();
+
+    // Define alignment formats
+    QTextBlockFormat alignCenter;
+    alignCenter.setLineHeight(lineSpacing, QTextBlockFormat::LineDistanceHeight) ;
+    alignCenter.setAlignment(Qt::AlignCenter);
+
+    QTextBlockFormat alignLeft;
+    alignLeft.setAlignment(Qt::AlignLeft);
+    alignLeft.setLineHeight(lineSpacing, QTextBlockFormat::LineDistanceHeight) ;
+
+    cursor.movePosition(QTextCursor::Start);
+
+    cursor.insertBlock(alignCenter);
+
+    // Insert the simcenter logo at the top
+    QImage simCenterLogo(":resources/SimCenter@1x.png");
+    document.addResource(QTextDocument::ImageResource, QUrl("Logo"), simCenterLogo);
+    QTextImageFormat imageFormatSimCenterLogo;
+    imageFormatSimCenterLogo.setName("Logo");
+    imageFormatSimCenterLogo.setWidth(250);
+    imageFormatSimCenterLogo.setQuality(600);
+
+    cursor.insertImage(imageFormatSimCenterLogo);
+
+    cursor.insertText("\nRegional Resilience Determination (R2D) Tool\n",titleFormat);
+
+    cursor.insertText("Results Summary\n",boldFormat);
+
+    cursor.setBlockFormat(alignLeft);
+
+    cursor.insertText("Employing Pelicun loss methodology to calculate seismic losses.\n",normalFormat);
+
+    QString currentDT = "Timestamp: " + QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss") + "\n";
+    cursor.insertText(currentDT,normalFormat);
+
+    QString analysisNameLabel = "Analysis name: " + contents.analysisName + "\n";
+    cursor.insertText(analysisNameLabel,normalFormat);
+
+    cursor.insertText("Estimated Regional Totals\n",boldFormat);
+
+    QTextTableFormat tableFormat;
+    tableFormat.setPadding(5.0);
+    tableFormat.setCellPadding(5.0);
+    tableFormat.setBorder(0.0);
+    tableFormat.setAlignment(Qt::AlignVCenter);
+
+    tableFormat.setBackground(QColor("#f0f0f0"));
+    QVector<QTextLength> constraints;
+    constraints << QTextLength(QTextLength::PercentageLength, 25);
+    constraints << QTextLength(QTextLength::PercentageLength, 25);
+    constraints << QTextLength(QTextLength::PercentageLength, 25);
+    constraints << QTextLength(QTextLength::PercentageLength, 25);
+    tableFormat.setColumnWidthConstraints(constraints);
+
+    if(!contents.totals.isEmpty())
+    {
+        // rows, columns, tableFormat
+        QTextTable *table = cursor.insertTable(contents.totals.size(), 4, tableFormat);
+
+        for(int i = 0; i<contents.totals.size(); ++i)
+        {
+            for(int j = 0; j<4; ++j)
+            {
+                QTextTableCell cell = table->cellAt(i, j);
+                cell.setFormat(normalFormat);
+                QTextCursor cellCursor = cell.firstCursorPosition();
+                cellCursor.insertText(contents.totals.at(i).value(j));
+            }
+        }
+    }
+
+    cursor.movePosition( QTextCursor::End );
+
+    cursor.insertText("\n\n",normalFormat);
+
+    cursor.setBlockFormat(alignCenter);
+
+    for(int i = 0; i<figures.size(); ++i)
+    {
+        const auto& figure = figures.at(i);
+
+        if(figure.image.isNull())
+            continue;
+
+        auto name = "Figure" + QString::number(i+1);
+
+        document.addResource(QTextDocument::ImageResource,QUrl(name),figure.image);
+
+        QTextImageFormat imageFormat;
+        imageFormat.setName(name);
+        imageFormat.setQuality(600);
+        imageFormat.setWidth(figure.width);
+
+        if(i == 0)
+            cursor.insertImage(imageFormat);
+        else
+        {
+            cursor.insertImage(imageFormat,QTextFrameFormat::InFlow);
+            cursor.insertText("\n",captionFormat);
+        }
+
+        cursor.insertText(figure.caption + "\n",captionFormat);
+    }
+
+    emit progressChanged(30);
+
+    cursor.insertText(contents.tableTitle + "\n",boldFormat);
+
+    // The asset results are split into tables of a limited number of rows, the header row is repeated at the top of every page
+    QTextTableFormat resultsTableFormat;
+    resultsTableFormat.setBorder(1.0);
+    resultsTableFormat.setCellSpacing(0.0);
+    resultsTableFormat.setCellPadding(2.0);
+    resultsTableFormat.setHeaderRowCount(1);
+
+    QTextCharFormat headerFormat = normalFormat;
+    headerFormat.setBackground(QColor("#f0f0f0"));
+
+    auto numRows = contents.tableRows.size();
+    auto numCols = contents.tableHeaders.size();
+
+    for(int begin = 0; begin<numRows && numCols > 0; begin += rowsPerTable)
+    {
+        if(cancelled)
+            return -1;
+
+        auto count = std::min(rowsPerTable, numRows - begin);
+
+        QTextTable *table = cursor.insertTable(count + 1, numCols, resultsTableFormat);
+
+        for(int j = 0; j<numCols; ++j)
+        {
+            QTextCursor cellCursor = table->cellAt(0, j).firstCursorPosition();
+            cellCursor.insertText(contents.tableHeaders.at(j),headerFormat);
+        }
+
+        for(int i = 0; i<count; ++i)
+        {
+            const auto& row = contents.tableRows.at(begin + i);
+
+            for(int j = 0; j<numCols; ++j)
+            {
+                QTextCursor cellCursor = table->cellAt(i + 1, j).firstCursorPosition();
+                cellCursor.insertText(row.value(j),normalFormat);
+            }
+        }
+
+        cursor.movePosition( QTextCursor::End );
+
+        emit progressChanged(30 + 50*(begin + count)/numRows);
+    }
+
+    if(contents.numAssets > numRows)
+    {
+        auto note = "\nOnly the first " + QString::number(numRows) + " of the " + QString::number(contents.numAssets) + " assets are listed, the results of all of the assets are in the results folder.\n";
+        cursor.insertText(note,captionFormat);
+    }
+
+    if(cancelled)
+        return -1;
+
+    emit progressChanged(80);
+
+    document.print(&printer);
+
+    if(printer.printerState() == QPrinter::Error)
+    {
+        errMsg = "Error printing the PDF report to " + contents.outputFilePath;
+        return -1;
+    }
+
+    emit progressChanged(100);
+
+    return 0;
+}
+
+
+void PDFReportWriter::resetCancel(void)
+{
+    cancelled = false;
+}
+
+
+bool PDFReportWriter::isCancelled(void) const
+{
+    return cancelled;
+}
+
+
+void PDFReportWriter::cancel(void)
+{
+    cancelled = true;
+}
+
+
+int PDFReportWriter::getRowsPerTable() const
+{
+    return rowsPerTable;
+}
+
+
+void PDFReportWriter::setRowsPerTable(const int value)
+{
+    if(value > 0)
+        rowsPerTable = value;
+}
+
+
+int PDFReportWriter::getMaxTableRows() const
+{
+    return maxTableRows;
+}
+
+
+void PDFReportWriter::setMaxTableRows(const int value)
+{
+    if(value >= 0)
+        maxTableRows = value;
+}
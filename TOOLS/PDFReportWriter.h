@@ -0,0 +1,127 @@
+#ifndef PDFREPORTWRITER_H
+#define PDFREPORTWRITER_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include <QImage>
+#include <QObject>
+#include <QRect>
+#include <QStringList>
+#include <QVector>
+
+#include <atomic>
+
+// A figure of the report, the image is scaled to the width in points
+struct PDFReportFigure
+{
+    QImage image;
+    QString caption;
+    int width = 400;
+};
+
+
+// A snapshot of everything that goes into the report, taken on the UI thread so that the report can be written on a worker thread
+struct PDFReportContents
+{
+    QString outputFilePath;
+
+    QString analysisName;
+
+    // The cells of the table of regional totals, four per row
+    QVector<QStringList> totals;
+
+    // The screenshot of the map and the part of it that is the map view
+    QImage mapImage;
+    QRect mapRect;
+
+    QVector<PDFReportFigure> figures;
+
+    QString tableTitle;
+    QStringList tableHeaders;
+    QVector<QStringList> tableRows;
+
+    // The number of assets in the results, the table may only hold the first rows
+    int numAssets = 0;
+};
+
+
+// Writes the PDF report of the results
+// The figures are scaled in parallel and the asset table is split into a series of tables so that the document is laid out incrementally, rather than as one large HTML string
+class PDFReportWriter : public QObject
+{
+    Q_OBJECT
+
+public:
+    PDFReportWriter(QObject* parent = nullptr);
+
+    // Builds the document and prints it to the output file, can be run on a worker thread
+    // Returns -1 with an empty message if the report was cancelled
+    int write(const PDFReportContents& contents, QString& errMsg);
+
+    // Clears a previous cancellation before a new report is started
+    void resetCancel(void);
+
+    bool isCancelled(void) const;
+
+    // The number of rows in each table of the asset results
+    int getRowsPerTable() const;
+    void setRowsPerTable(const int value);
+
+    // The maximum number of assets that are listed in the report, the rest are summarized in a note
+    int getMaxTableRows() const;
+    void setMaxTableRows(const int value);
+
+public slots:
+
+    void cancel(void);
+
+signals:
+
+    // The progress in percent, emitted from the thread that writes the report
+    void progressChanged(int percent);
+
+private:
+
+    std::atomic<bool> cancelled;
+
+    int rowsPerTable;
+
+    int maxTableRows;
+};
+
+#endif // PDFREPORTWRITER_H
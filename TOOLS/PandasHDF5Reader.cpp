@@ -0,0 +1,932 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "PandasHDF5Reader.h"
+#include "ResultsTable.h"
+
+#include <QHash>
+#include <QMap>
+#include <QMutexLocker>
+#include <QRecursiveMutex>
+
+#include "hdf5.h"
+
+namespace
+{
+
+// The HDF5 library is built without thread safety, all of the calls into the library from any reader on any thread go through this lock
+QRecursiveMutex& getLibraryMutex(void)
+{
+    static QRecursiveMutex mutex;
+    return mutex;
+}
+
+
+// Reads an attribute that is stored as a string, returns false if the attribute does not exist or is not a string
+bool readStringAttribute(hid_t objID, const char* name, QString& value)
+{
+    if(H5Aexists(objID, name) <= 0)
+        return false;
+
+    auto attrID = H5Aopen(objID, name, H5P_DEFAULT);
+    if(attrID < 0)
+        return false;
+
+    auto typeID = H5Aget_type(attrID);
+
+    bool res = false;
+
+    if(H5Tget_class(typeID) == H5T_STRING)
+    {
+        auto memTypeID = H5Tcopy(H5T_C_S1);
+
+        if(H5Tis_variable_str(typeID) > 0)
+        {
+            char* buffer = nullptr;
+            H5Tset_size(memTypeID, H5T_VARIABLE);
+
+            if(H5Aread(attrID, memTypeID, &buffer) >= 0)
+            {
+                value = QString::fromUtf8(buffer);
+                res = true;
+            }
+
+            if(buffer)
+                H5free_memory(buffer);
+        }
+        else
+        {
+            auto size = H5Tget_size(typeID);
+            QByteArray buffer(static_cast<int>(size) + 1, '\0');
+            H5Tset_size(memTypeID, size);
+            H5Tset_strpad(memTypeID, H5T_STR_NULLPAD);
+
+            if(H5Aread(attrID, memTypeID, buffer.data()) >= 0)
+            {
+                value = QString::fromUtf8(buffer.constData());
+                res = true;
+            }
+        }
+
+        H5Tclose(memTypeID);
+    }
+
+    H5Tclose(typeID);
+    H5Aclose(attrID);
+
+    return res;
+}
+
+
+bool readIntAttribute(hid_t objID, const char* name, qint64& value)
+{
+    if(H5Aexists(objID, name) <= 0)
+        return false;
+
+    auto attrID = H5Aopen(objID, name, H5P_DEFAULT);
+    if(attrID < 0)
+        return false;
+
+    long long buffer = 0;
+    auto res = H5Aread(attrID, H5T_NATIVE_LLONG, &buffer) >= 0;
+
+    H5Aclose(attrID);
+
+    if(res)
+        value = buffer;
+
+    return res;
+}
+
+
+// Collects the paths of all of the groups that contain a pandas frame
+herr_t collectFrameKeys(hid_t groupID, const char* name, const H5L_info_t* /*info*/, void* opData)
+{
+    auto keys = static_cast<QStringList*>(opData);
+
+    if(H5Aexists_by_name(groupID, name, "pandas_type", H5P_DEFAULT) > 0)
+        keys->append("/" + QString::fromUtf8(name));
+
+    return 0;
+}
+
+
+// Returns the number of elements in a one dimensional dataset
+hsize_t getNumberOfElements(hid_t datasetID)
+{
+    auto spaceID = H5Dget_space(datasetID);
+
+    hsize_t numElements = 0;
+
+    if(H5Sget_simple_extent_type(spaceID) == H5S_SIMPLE)
+        numElements = H5Sget_simple_extent_npoints(spaceID);
+
+    H5Sclose(spaceID);
+
+    return numElements;
+}
+
+}
+
+
+PandasHDF5Reader::PandasHDF5Reader()
+{
+    fileID = -1;
+}
+
+
+PandasHDF5Reader::~PandasHDF5Reader()
+{
+    this->close();
+}
+
+
+int PandasHDF5Reader::open(const QString& pathToFile, QString& errMsg)
+{
+    QMutexLocker locker(&getLibraryMutex());
+
+    this->close();
+
+    // Turn off the automatic printing of the HDF5 error stack, the errors are returned in the error message instead
+    H5Eset_auto2(H5E_DEFAULT, nullptr, nullptr);
+
+    if(H5Fis_hdf5(pathToFile.toLocal8Bit().constData()) <= 0)
+    {
+        errMsg = "The file " + pathToFile + " is not an HDF5 file";
+        return -1;
+    }
+
+    fileID = H5Fopen(pathToFile.toLocal8Bit().constData(), H5F_ACC_RDONLY, H5P_DEFAULT);
+
+    if(fileID < 0)
+    {
+        errMsg = "Could not open the HDF5 file " + pathToFile;
+        return -1;
+    }
+
+    filePath = pathToFile;
+
+    return 0;
+}
+
+
+void PandasHDF5Reader::close(void)
+{
+    QMutexLocker locker(&getLibraryMutex());
+
+    if(fileID >= 0)
+        H5Fclose(fileID);
+
+    fileID = -1;
+    filePath.clear();
+}
+
+
+bool PandasHDF5Reader::isOpen(void) const
+{
+    return fileID >= 0;
+}
+
+
+QStringList PandasHDF5Reader::getKeys(void) const
+{
+    QMutexLocker locker(&getLibraryMutex());
+
+    QStringList keys;
+
+    if(fileID < 0)
+        return keys;
+
+    H5Lvisit(fileID, H5_INDEX_NAME, H5_ITER_INC, collectFrameKeys, &keys);
+
+    return keys;
+}
+
+
+int PandasHDF5Reader::readFrameInfo(const QString& key, PandasFrameInfo& info, QString& errMsg)
+{
+    QMutexLocker locker(&getLibraryMutex());
+
+    if(fileID < 0)
+    {
+        errMsg = "The HDF5 file is not open";
+        return -1;
+    }
+
+    auto groupID = H5Gopen2(fileID, key.toUtf8().constData(), H5P_DEFAULT);
+
+    if(groupID < 0)
+    {
+        errMsg = "Could not find the key " + key + " in the file " + filePath;
+        return -1;
+    }
+
+    // Use a lambda to close the group on all of the return paths
+    auto res = [&]()
+    {
+        QString pandasType;
+        if(!readStringAttribute(groupID, "pandas_type", pandasType) || pandasType.compare("frame") != 0)
+        {
+            errMsg = "The key " + key + " is not a data frame in the 'fixed' format, the type is '" + pandasType + "'";
+            return -1;
+        }
+
+        qint64 numBlocks = 0;
+        if(!readIntAttribute(groupID, "nblocks", numBlocks))
+        {
+            errMsg = "Could not read the number of blocks of the frame " + key;
+            return -1;
+        }
+
+        info = PandasFrameInfo();
+        info.key = key;
+
+        // The column labels
+        if(this->readLabels(groupID, "axis0", info.columnLabels, info.levelNames, errMsg) != 0)
+            return -1;
+
+        // The row index
+        QString indexVariety;
+        readStringAttribute(groupID, "axis1_variety", indexVariety);
+
+        if(indexVariety.compare("regular") != 0)
+        {
+            errMsg = "Only a regular row index is supported in the frame " + key;
+            return -1;
+        }
+
+        if(this->readIntegerArray(groupID, "axis1", info.index, errMsg) != 0)
+            return -1;
+
+        auto indexID = H5Dopen2(groupID, "axis1", H5P_DEFAULT);
+        readStringAttribute(indexID, "name", info.indexName);
+        H5Dclose(indexID);
+
+        info.numRows = info.index.size();
+
+        auto numCols = info.columnLabels.size();
+
+        info.columnBlock.fill(-1, numCols);
+        info.columnBlockPosition.fill(-1, numCols);
+
+        // Map the column labels to the column positions
+        QMultiHash<QString, int> columnMap;
+        for(int i = 0; i<numCols; ++i)
+            columnMap.insert(info.columnLabels.at(i).join("-"), i);
+
+        // Find the block and the position within the block of each column
+        for(int i = 0; i<numBlocks; ++i)
+        {
+            auto blockName = "block" + QString::number(i);
+
+            QVector<QStringList> itemLabels;
+            QStringList itemLevelNames;
+            if(this->readLabels(groupID, blockName + "_items", itemLabels, itemLevelNames, errMsg) != 0)
+                return -1;
+
+            for(int j = 0; j<itemLabels.size(); ++j)
+            {
+                auto itemLabel = itemLabels.at(j).join("-");
+
+                // Take the first column with this label that is not yet assigned to a block
+                auto positions = columnMap.values(itemLabel);
+
+                int col = -1;
+                for(auto&& pos : positions)
+                {
+                    if(info.columnBlock.at(pos) == -1 && (col == -1 || pos < col))
+                        col = pos;
+                }
+
+                if(col == -1)
+                {
+                    errMsg = "The item " + itemLabel + " in the block " + blockName + " is not a column of the frame " + key;
+                    return -1;
+                }
+
+                info.columnBlock[col] = i;
+                info.columnBlockPosition[col] = j;
+            }
+
+            // Check the dimensions of the values
+            auto valuesName = blockName + "_values";
+            auto datasetID = H5Dopen2(groupID, valuesName.toUtf8().constData(), H5P_DEFAULT);
+
+            if(datasetID < 0)
+            {
+                errMsg = "Could not find the values " + valuesName + " of the frame " + key;
+                return -1;
+            }
+
+            // pandas transposes the values so that they are stored as (rows, columns)
+            qint64 transposed = 0;
+            readIntAttribute(datasetID, "transposed", transposed);
+            info.blockTransposed.push_back(transposed != 0);
+
+            auto spaceID = H5Dget_space(datasetID);
+
+            hsize_t dims[2] = {0, 0};
+            auto rank = H5Sget_simple_extent_ndims(spaceID);
+            H5Sget_simple_extent_dims(spaceID, dims, nullptr);
+
+            H5Sclose(spaceID);
+            H5Dclose(datasetID);
+
+            hsize_t expectedRows = transposed ? dims[0] : dims[1];
+            hsize_t expectedItems = transposed ? dims[1] : dims[0];
+
+            if(rank != 2 || expectedRows != static_cast<hsize_t>(info.numRows) || expectedItems != static_cast<hsize_t>(itemLabels.size()))
+            {
+                errMsg = "The dimensions of the values " + valuesName + " do not match the index and the items of the frame " + key;
+                return -1;
+            }
+        }
+
+        if(info.columnBlock.contains(-1))
+        {
+            errMsg = "Some of the columns of the frame " + key + " are not stored in any block";
+            return -1;
+        }
+
+        return 0;
+    }();
+
+    H5Gclose(groupID);
+
+    return res;
+}
+
+
+int PandasHDF5Reader::readColumns(const PandasFrameInfo& info, const QVector<int>& columns, const int startRow, const int numRows, QVector<QVector<double>>& values, QString& errMsg)
+{
+    QMutexLocker locker(&getLibraryMutex());
+
+    if(fileID < 0)
+    {
+        errMsg = "The HDF5 file is not open";
+        return -1;
+    }
+
+    if(startRow < 0 || numRows < 0 || startRow + numRows > info.numRows)
+    {
+        errMsg = "The rows to read are out of the bounds of the frame " + info.key;
+        return -1;
+    }
+
+    auto groupID = H5Gopen2(fileID, info.key.toUtf8().constData(), H5P_DEFAULT);
+
+    if(groupID < 0)
+    {
+        errMsg = "Could not find the key " + info.key + " in the file " + filePath;
+        return -1;
+    }
+
+    // A larger chunk cache so that a compressed chunk is decompressed only once when its columns are read one after another
+    auto accessPropID = H5Pcreate(H5P_DATASET_ACCESS);
+    H5Pset_chunk_cache(accessPropID, 12421, 64*1024*1024, 1.0);
+
+    QMap<int, hid_t> openDatasets;
+
+    values.resize(columns.size());
+
+    int res = 0;
+
+    for(int i = 0; i<columns.size(); ++i)
+    {
+        auto col = columns.at(i);
+
+        if(col < 0 || col >= info.columnBlock.size())
+        {
+            errMsg = "The column " + QString::number(col) + " is out of the bounds of the frame " + info.key;
+            res = -1;
+            break;
+        }
+
+        auto block = info.columnBlock.at(col);
+        auto position = static_cast<hsize_t>(info.columnBlockPosition.at(col));
+
+        if(!openDatasets.contains(block))
+        {
+            auto valuesName = "block" + QString::number(block) + "_values";
+            auto newDatasetID = H5Dopen2(groupID, valuesName.toUtf8().constData(), accessPropID);
+
+            if(newDatasetID < 0)
+            {
+                errMsg = "Could not find the values " + valuesName + " of the frame " + info.key;
+                res = -1;
+                break;
+            }
+
+            openDatasets.insert(block, newDatasetID);
+        }
+
+        auto datasetID = openDatasets.value(block);
+
+        auto& columnValues = values[i];
+        columnValues.resize(numRows);
+
+        if(numRows == 0)
+            continue;
+
+        // Select the part of the column to read
+        hsize_t start[2];
+        hsize_t count[2];
+
+        if(info.blockTransposed.at(block))
+        {
+            start[0] = static_cast<hsize_t>(startRow);
+            start[1] = position;
+            count[0] = static_cast<hsize_t>(numRows);
+            count[1] = 1;
+        }
+        else
+        {
+            start[0] = position;
+            start[1] = static_cast<hsize_t>(startRow);
+            count[0] = 1;
+            count[1] = static_cast<hsize_t>(numRows);
+        }
+
+        auto fileSpaceID = H5Dget_space(datasetID);
+        H5Sselect_hyperslab(fileSpaceID, H5S_SELECT_SET, start, nullptr, count, nullptr);
+
+        hsize_t memDims[1] = {static_cast<hsize_t>(numRows)};
+        auto memSpaceID = H5Screate_simple(1, memDims, nullptr);
+
+        // HDF5 converts the stored type, e.g., float16 or int64, to double
+        auto status = H5Dread(datasetID, H5T_NATIVE_DOUBLE, memSpaceID, fileSpaceID, H5P_DEFAULT, columnValues.data());
+
+        H5Sclose(memSpaceID);
+        H5Sclose(fileSpaceID);
+
+        if(status < 0)
+        {
+            if(this->checkFilters(datasetID, info.key, errMsg) == 0)
+                errMsg = "Error reading the values of the column " + info.columnLabels.at(col).join("-") + " in the frame " + info.key;
+
+            res = -1;
+            break;
+        }
+    }
+
+    for(auto&& it : openDatasets)
+        H5Dclose(it);
+
+    H5Pclose(accessPropID);
+    H5Gclose(groupID);
+
+    return res;
+}
+
+
+int PandasHDF5Reader::readRows(const PandasFrameInfo& info, const int startRow, const int numRows, QVector<double>& values, QString& errMsg)
+{
+    QMutexLocker locker(&getLibraryMutex());
+
+    if(fileID < 0)
+    {
+        errMsg = "The HDF5 file is not open";
+        return -1;
+    }
+
+    if(startRow < 0 || numRows < 0 || startRow + numRows > info.numRows)
+    {
+        errMsg = "The rows to read are out of the bounds of the frame " + info.key;
+        return -1;
+    }
+
+    auto numCols = info.columnLabels.size();
+
+    values.resize(numRows*numCols);
+
+    if(numRows == 0 || numCols == 0)
+        return 0;
+
+    auto groupID = H5Gopen2(fileID, info.key.toUtf8().constData(), H5P_DEFAULT);
+
+    if(groupID < 0)
+    {
+        errMsg = "Could not find the key " + info.key + " in the file " + filePath;
+        return -1;
+    }
+
+    auto accessPropID = H5Pcreate(H5P_DATASET_ACCESS);
+    H5Pset_chunk_cache(accessPropID, 12421, 64*1024*1024, 1.0);
+
+    int res = 0;
+
+    for(int block = 0; block<info.blockTransposed.size(); ++block)
+    {
+        // The columns that are stored in this block, in the order of the items
+        QVector<int> blockColumns;
+        for(int col = 0; col<numCols; ++col)
+        {
+            if(info.columnBlock.at(col) != block)
+                continue;
+
+            auto position = info.columnBlockPosition.at(col);
+
+            if(position >= blockColumns.size())
+                blockColumns.resize(position+1);
+
+            blockColumns[position] = col;
+        }
+
+        auto numItems = blockColumns.size();
+
+        if(numItems == 0)
+            continue;
+
+        auto valuesName = "block" + QString::number(block) + "_values";
+        auto datasetID = H5Dopen2(groupID, valuesName.toUtf8().constData(), accessPropID);
+
+        if(datasetID < 0)
+        {
+            errMsg = "Could not find the values " + valuesName + " of the frame " + info.key;
+            res = -1;
+            break;
+        }
+
+        auto transposed = info.blockTransposed.at(block);
+
+        // The values are read straight into their columns of the output with a selection of the memory space, so that no buffer of the block is needed
+        // When the block stores the rows and its items are consecutive columns, one read covers the whole block, otherwise each item is read into its column
+        auto consecutive = transposed;
+        for(int j = 1; consecutive && j<numItems; ++j)
+            consecutive = blockColumns.at(j) == blockColumns.at(0) + j;
+
+        auto numReads = consecutive ? 1 : numItems;
+        auto itemsPerRead = consecutive ? numItems : 1;
+
+        hsize_t memDims[2] = {static_cast<hsize_t>(numRows), static_cast<hsize_t>(numCols)};
+
+        auto memSpaceID = H5Screate_simple(2, memDims, nullptr);
+        auto fileSpaceID = H5Dget_space(datasetID);
+
+        herr_t status = 0;
+
+        for(int j = 0; j<numReads && status >= 0; ++j)
+        {
+            hsize_t fileStart[2];
+            hsize_t fileCount[2];
+
+            if(transposed)
+            {
+                fileStart[0] = static_cast<hsize_t>(startRow);
+                fileStart[1] = static_cast<hsize_t>(j);
+                fileCount[0] = static_cast<hsize_t>(numRows);
+                fileCount[1] = static_cast<hsize_t>(itemsPerRead);
+            }
+            else
+            {
+                fileStart[0] = static_cast<hsize_t>(j);
+                fileStart[1] = static_cast<hsize_t>(startRow);
+                fileCount[0] = 1;
+                fileCount[1] = static_cast<hsize_t>(numRows);
+            }
+
+            hsize_t memStart[2] = {0, static_cast<hsize_t>(blockColumns.at(j))};
+            hsize_t memCount[2] = {static_cast<hsize_t>(numRows), static_cast<hsize_t>(itemsPerRead)};
+
+            H5Sselect_hyperslab(fileSpaceID, H5S_SELECT_SET, fileStart, nullptr, fileCount, nullptr);
+            H5Sselect_hyperslab(memSpaceID, H5S_SELECT_SET, memStart, nullptr, memCount, nullptr);
+
+            status = H5Dread(datasetID, H5T_NATIVE_DOUBLE, memSpaceID, fileSpaceID, H5P_DEFAULT, values.data());
+        }
+
+        H5Sclose(memSpaceID);
+        H5Sclose(fileSpaceID);
+
+        if(status < 0)
+        {
+            if(this->checkFilters(datasetID, info.key, errMsg) == 0)
+                errMsg = "Error reading the values " + valuesName + " in the frame " + info.key;
+
+            H5Dclose(datasetID);
+            res = -1;
+            break;
+        }
+
+        H5Dclose(datasetID);
+    }
+
+    H5Pclose(accessPropID);
+    H5Gclose(groupID);
+
+    return res;
+}
+
+
+int PandasHDF5Reader::readTable(const QString& key, ResultsTable& table, QString& errMsg, const QVector<int>& columns, const int chunkSize)
+{
+    QMutexLocker locker(&getLibraryMutex());
+
+    PandasFrameInfo info;
+
+    if(this->readFrameInfo(key, info, errMsg) != 0)
+        return -1;
+
+    auto columnsToRead = columns;
+
+    if(columnsToRead.isEmpty())
+    {
+        for(int i = 0; i<info.columnLabels.size(); ++i)
+            columnsToRead.push_back(i);
+    }
+
+    // The first column of the table is the asset ID
+    QStringList headers;
+    headers.append(info.levelNames.size() > 1 ? info.levelNames.join("-") : info.indexName);
+
+    for(auto&& it : info.columnLabels)
+        headers.append(it.join("-"));
+
+    QVector<int> IDs(info.numRows);
+    for(int i = 0; i<info.numRows; ++i)
+        IDs[i] = static_cast<int>(info.index.at(i));
+
+    QVector<QVector<double>> columnValues(columnsToRead.size());
+    for(auto&& it : columnValues)
+        it.reserve(info.numRows);
+
+    auto stride = chunkSize > 0 ? chunkSize : info.numRows;
+
+    for(int startRow = 0; startRow < info.numRows; startRow += stride)
+    {
+        auto numRows = std::min(stride, info.numRows - startRow);
+
+        QVector<QVector<double>> chunk;
+        if(this->readColumns(info, columnsToRead, startRow, numRows, chunk, errMsg) != 0)
+            return -1;
+
+        for(int i = 0; i<chunk.size(); ++i)
+            columnValues[i].append(chunk.at(i));
+    }
+
+    table.clear();
+    table.setHeaders(headers);
+    table.setIDs(IDs);
+
+    for(int i = 0; i<columnsToRead.size(); ++i)
+        table.setColumn(columnsToRead.at(i) + 1, columnValues.at(i));
+
+    return 0;
+}
+
+
+int PandasHDF5Reader::readLabels(long long groupID, const QString& name, QVector<QStringList>& labels, QStringList& levelNames, QString& errMsg)
+{
+    labels.clear();
+    levelNames.clear();
+
+    QString variety;
+    readStringAttribute(groupID, (name + "_variety").toUtf8().constData(), variety);
+
+    // Reads the values of a level according to the kind of the index
+    auto readLevel = [&](const QString& levelName, QStringList& levelValues, QString& nameOfLevel)
+    {
+        auto datasetID = H5Dopen2(groupID, levelName.toUtf8().constData(), H5P_DEFAULT);
+
+        if(datasetID < 0)
+        {
+            errMsg = "Could not find the labels " + levelName;
+            return -1;
+        }
+
+        QString kind;
+        readStringAttribute(datasetID, "kind", kind);
+        readStringAttribute(datasetID, "name", nameOfLevel);
+        H5Dclose(datasetID);
+
+        if(kind.compare("string") == 0)
+            return this->readStringArray(groupID, levelName, levelValues, errMsg);
+
+        if(kind.compare("integer") == 0)
+        {
+            QVector<qint64> intValues;
+            if(this->readIntegerArray(groupID, levelName, intValues, errMsg) != 0)
+                return -1;
+
+            for(auto&& it : intValues)
+                levelValues.append(QString::number(it));
+
+            return 0;
+        }
+
+        errMsg = "The labels " + levelName + " of the kind '" + kind + "' are not supported";
+        return -1;
+    };
+
+    if(variety.compare("regular") == 0)
+    {
+        QStringList levelValues;
+        QString levelName;
+        if(readLevel(name, levelValues, levelName) != 0)
+            return -1;
+
+        levelNames.append(levelName);
+
+        for(auto&& it : levelValues)
+            labels.append(QStringList(it));
+
+        return 0;
+    }
+
+    if(variety.compare("multi") == 0)
+    {
+        qint64 numLevels = 0;
+        if(!readIntAttribute(groupID, (name + "_nlevels").toUtf8().constData(), numLevels))
+        {
+            errMsg = "Could not read the number of levels of the labels " + name;
+            return -1;
+        }
+
+        for(int i = 0; i<numLevels; ++i)
+        {
+            QStringList levelValues;
+            QString levelName;
+            if(readLevel(name + "_level" + QString::number(i), levelValues, levelName) != 0)
+                return -1;
+
+            levelNames.append(levelName);
+
+            // The codes point to the values of the level
+            QVector<qint64> codes;
+            if(this->readIntegerArray(groupID, name + "_label" + QString::number(i), codes, errMsg) != 0)
+                return -1;
+
+            if(i == 0)
+                labels.resize(codes.size());
+            else if(codes.size() != labels.size())
+            {
+                errMsg = "Inconsistent number of labels in the levels of " + name;
+                return -1;
+            }
+
+            for(int j = 0; j<codes.size(); ++j)
+                labels[j].append(levelValues.value(static_cast<int>(codes.at(j))));
+        }
+
+        return 0;
+    }
+
+    errMsg = "The labels " + name + " of the variety '" + variety + "' are not supported";
+    return -1;
+}
+
+
+int PandasHDF5Reader::readStringArray(long long groupID, const QString& name, QStringList& values, QString& errMsg)
+{
+    values.clear();
+
+    auto datasetID = H5Dopen2(groupID, name.toUtf8().constData(), H5P_DEFAULT);
+
+    if(datasetID < 0)
+    {
+        errMsg = "Could not find the dataset " + name;
+        return -1;
+    }
+
+    auto typeID = H5Dget_type(datasetID);
+
+    auto numElements = getNumberOfElements(datasetID);
+
+    int res = 0;
+
+    if(H5Tget_class(typeID) != H5T_STRING || H5Tis_variable_str(typeID) > 0)
+    {
+        errMsg = "The dataset " + name + " does not contain fixed length strings";
+        res = -1;
+    }
+    else if(numElements > 0)
+    {
+        auto size = H5Tget_size(typeID);
+
+        // The strings are padded with nulls, i.e., a string that fills the entire size is not null terminated
+        auto memTypeID = H5Tcopy(H5T_C_S1);
+        H5Tset_size(memTypeID, size);
+        H5Tset_strpad(memTypeID, H5T_STR_NULLPAD);
+
+        QByteArray buffer(static_cast<int>(numElements*size), '\0');
+
+        if(H5Dread(datasetID, memTypeID, H5S_ALL, H5S_ALL, H5P_DEFAULT, buffer.data()) < 0)
+        {
+            if(this->checkFilters(datasetID, name, errMsg) == 0)
+                errMsg = "Error reading the strings in the dataset " + name;
+            res = -1;
+        }
+        else
+        {
+            for(hsize_t i = 0; i<numElements; ++i)
+            {
+                auto str = buffer.constData() + i*size;
+                values.append(QString::fromUtf8(str, static_cast<int>(qstrnlen(str, static_cast<uint>(size)))));
+            }
+        }
+
+        H5Tclose(memTypeID);
+    }
+
+    H5Tclose(typeID);
+    H5Dclose(datasetID);
+
+    return res;
+}
+
+
+int PandasHDF5Reader::readIntegerArray(long long groupID, const QString& name, QVector<qint64>& values, QString& errMsg)
+{
+    values.clear();
+
+    auto datasetID = H5Dopen2(groupID, name.toUtf8().constData(), H5P_DEFAULT);
+
+    if(datasetID < 0)
+    {
+        errMsg = "Could not find the dataset " + name;
+        return -1;
+    }
+
+    auto numElements = getNumberOfElements(datasetID);
+
+    values.resize(static_cast<int>(numElements));
+
+    int res = 0;
+
+    if(numElements > 0 && H5Dread(datasetID, H5T_NATIVE_LLONG, H5S_ALL, H5S_ALL, H5P_DEFAULT, values.data()) < 0)
+    {
+        if(this->checkFilters(datasetID, name, errMsg) == 0)
+            errMsg = "Error reading the integers in the dataset " + name;
+        res = -1;
+    }
+
+    H5Dclose(datasetID);
+
+    return res;
+}
+
+
+int PandasHDF5Reader::checkFilters(long long datasetID, const QString& name, QString& errMsg)
+{
+    auto createPropID = H5Dget_create_plist(datasetID);
+
+    auto numFilters = H5Pget_nfilters(createPropID);
+
+    int res = 0;
+
+    for(int i = 0; i<numFilters; ++i)
+    {
+        unsigned int flags = 0;
+        size_t numValues = 0;
+        unsigned int filterConfig = 0;
+        char filterName[256] = "";
+
+        auto filterID = H5Pget_filter2(createPropID, static_cast<unsigned>(i), &flags, &numValues, nullptr, sizeof(filterName), filterName, &filterConfig);
+
+        if(H5Zfilter_avail(filterID) <= 0)
+        {
+            // PyTables compresses with blosc by default, the filter is provided by the hdf5-blosc plugin
+            errMsg = "The dataset " + name + " is compressed with the filter '" + QString::fromUtf8(filterName) + "' (ID " + QString::number(filterID) + ") that is not available. Add the directory of the filter plugin to the HDF5_PLUGIN_PATH environment variable";
+            res = -1;
+            break;
+        }
+    }
+
+    H5Pclose(createPropID);
+
+    return res;
+}
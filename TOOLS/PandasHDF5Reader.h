@@ -0,0 +1,124 @@
+#ifndef PANDASHDF5READER_H
+#define PANDASHDF5READER_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+// Reads data frames that pandas saved in the 'fixed' PyTables format, e.g., the DM.hdf, DV.hdf, EDP.hdf, and realizations.hdf files from pelicun
+// Each frame is a group that contains the column labels (axis0), the row index (axis1), and one or more blocks of values. The values are read with hyperslabs so that only the requested rows and columns are pulled into memory
+// The HDF5 library is not thread safe, so every call into it is serialized with one process-wide lock and readers on different threads take turns
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class ResultsTable;
+
+struct PandasFrameInfo
+{
+    // The path to the group of the frame in the file, e.g., '/data'
+    QString key;
+
+    int numRows = 0;
+
+    // The labels of each column, a column with a multi-level label has one entry per level
+    QVector<QStringList> columnLabels;
+
+    // The names of the column label levels, e.g., 'DV', 'comp_type', 'DSG_DS', 'stat'
+    QStringList levelNames;
+
+    // The name of the row index
+    QString indexName;
+
+    // The row index, pelicun uses the asset ID as the index
+    QVector<qint64> index;
+
+    // The block and the position within the block of each column
+    QVector<int> columnBlock;
+    QVector<int> columnBlockPosition;
+
+    // Whether the values of each block are stored with the rows first, i.e., (rows, columns)
+    QVector<bool> blockTransposed;
+};
+
+
+class PandasHDF5Reader
+{
+public:
+    PandasHDF5Reader();
+    ~PandasHDF5Reader();
+
+    int open(const QString& pathToFile, QString& errMsg);
+
+    void close(void);
+
+    bool isOpen(void) const;
+
+    // Returns the keys of all of the frames stored in the file
+    QStringList getKeys(void) const;
+
+    // Reads the row index and the column labels of a frame, the values are not read
+    int readFrameInfo(const QString& key, PandasFrameInfo& info, QString& errMsg);
+
+    // Reads the values of the given columns for the rows [startRow, startRow + numRows)
+    // The values are returned column by column, i.e., values[i] contains the values of the column columns[i]
+    int readColumns(const PandasFrameInfo& info, const QVector<int>& columns, const int startRow, const int numRows, QVector<QVector<double>>& values, QString& errMsg);
+
+    // Reads all of the columns for the rows [startRow, startRow + numRows) with one hyperslab per block
+    // The values are returned row by row, i.e., the value of row i and column j is at values[i*numColumns + j], they are read in place so that no more than the rows are held in memory
+    int readRows(const PandasFrameInfo& info, const int startRow, const int numRows, QVector<double>& values, QString& errMsg);
+
+    // Reads a frame into a results table, the asset ID is taken from the index and the columns are shifted by one so that they follow the numbering of the csv files
+    // If columns is empty then all of the columns are read. The rows are read in chunks of chunkSize to limit the size of the hyperslabs
+    int readTable(const QString& key, ResultsTable& table, QString& errMsg, const QVector<int>& columns = QVector<int>(), const int chunkSize = 65536);
+
+private:
+
+    int readLabels(long long groupID, const QString& name, QVector<QStringList>& labels, QStringList& levelNames, QString& errMsg);
+
+    int readStringArray(long long groupID, const QString& name, QStringList& values, QString& errMsg);
+
+    int readIntegerArray(long long groupID, const QString& name, QVector<qint64>& values, QString& errMsg);
+
+    int checkFilters(long long datasetID, const QString& name, QString& errMsg);
+
+    QString filePath;
+
+    long long fileID;
+};
+
+#endif // PANDASHDF5READER_H
@@ -0,0 +1,353 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "PeerRecordParser.h"
+
+#include <QByteArray>
+#include <QFile>
+
+#include <cstring>
+
+namespace
+{
+bool isSpace(const char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == ',';
+}
+
+
+bool isDigit(const char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+
+// Returns the line starting at pos without the line ending and moves pos to the start of the next line
+QByteArray nextLine(const QByteArray& contents, int& pos)
+{
+    auto end = contents.indexOf('\n', pos);
+
+    if(end < 0)
+        end = contents.size();
+
+    auto line = contents.mid(pos, end - pos);
+
+    pos = end + 1;
+
+    return line.trimmed();
+}
+
+
+// Returns the position right after the key in the line, or -1 if the key is not in the line
+int findValue(const QByteArray& line, const char* key)
+{
+    auto pos = line.indexOf(key);
+
+    if(pos < 0)
+        return -1;
+
+    return pos + static_cast<int>(std::strlen(key));
+}
+}
+
+
+int PeerRecordParser::parse(const QString& pathToFile, PeerRecord& record, QString& errMsg)
+{
+    QFile theRecordFile(pathToFile);
+
+    if (!theRecordFile.exists())
+    {
+        errMsg = QString("No file ") +  pathToFile + QString(" exists");
+        return -1;
+    }
+
+    if (!theRecordFile.open(QIODevice::ReadOnly))
+    {
+        errMsg = "Could not open the file at: " + pathToFile;
+        return -1;
+    }
+
+    auto contents = theRecordFile.readAll();
+
+    theRecordFile.close();
+
+    if(parse(contents, record, errMsg) != 0)
+    {
+        errMsg = "Error importing the file " + pathToFile + ": " + errMsg;
+        return -1;
+    }
+
+    return 0;
+}
+
+
+int PeerRecordParser::parse(const QByteArray& contents, PeerRecord& record, QString& errMsg)
+{
+    record = PeerRecord();
+
+    int pos = 0;
+
+    auto firstLine = nextLine(contents, pos);
+
+    if(!firstLine.startsWith("PEER NGA STRONG MOTION DATABASE RECORD"))
+    {
+        errMsg = "Only PEER NGA files supported";
+        return -1;
+    }
+
+    // Get the second line -> event name, event date, station ID, direction
+    auto secondLineValues = nextLine(contents, pos).split(',');
+
+    if(secondLineValues.size() != 4)
+    {
+        errMsg = "Error importing the time series raw data";
+        return -1;
+    }
+
+    record.eventName = QString::fromLocal8Bit(secondLineValues.at(0)).trimmed();
+    record.eventDate = QString::fromLocal8Bit(secondLineValues.at(1)).trimmed();
+    record.stationID = QString::fromLocal8Bit(secondLineValues.at(2)).trimmed();
+    record.direction = QString::fromLocal8Bit(secondLineValues.at(3)).trimmed();
+
+    // Get the third line - type of time history, acceleration, velocity, displacement, etc.
+    record.timeHistoryType = QString::fromLocal8Bit(nextLine(contents, pos));
+
+    // Get the fourth line - number of points and time step, e.g., NPTS=  5590, DT=   .0050 SEC
+    auto fourthLine = nextLine(contents, pos);
+
+    auto nptsPos = findValue(fourthLine, "NPTS=");
+    auto dtPos = findValue(fourthLine, "DT=");
+
+    if(nptsPos < 0 || dtPos < 0)
+    {
+        errMsg = "Could not find the number of points and the time step in the header";
+        return -1;
+    }
+
+    auto lineEnd = fourthLine.constData() + fourthLine.size();
+
+    auto nptsStart = fourthLine.constData() + nptsPos;
+    while(nptsStart != lineEnd && isSpace(*nptsStart))
+        ++nptsStart;
+
+    double numPointsValue = 0.0;
+    double dT = 0.0;
+
+    auto nptsEnd = parseDouble(nptsStart, lineEnd, numPointsValue);
+    auto dtEnd = parseDouble(fourthLine.constData() + dtPos, lineEnd, dT);
+
+    auto numPoints = static_cast<int>(numPointsValue);
+
+    if(nptsEnd == nullptr || numPoints <= 0 || numPoints != numPointsValue)
+    {
+        errMsg = "Error converting the number of points to an integer";
+        return -1;
+    }
+
+    if(dtEnd == nullptr || dT <= 0.0)
+    {
+        errMsg = "Error converting the time step to a double";
+        return -1;
+    }
+
+    record.dT = dT;
+    record.values.resize(numPoints);
+
+    auto values = record.values.data();
+
+    auto p = contents.constData() + std::min(pos, contents.size());
+    auto end = contents.constData() + contents.size();
+
+    int count = 0;
+
+    while(true)
+    {
+        while(p != end && isSpace(*p))
+            ++p;
+
+        if(p == end)
+            break;
+
+        if(count == numPoints)
+        {
+            errMsg = "Error, the number of imported points should match the number of points in the time-history input file";
+            return -1;
+        }
+
+        p = parseDouble(p, end, values[count]);
+
+        if(p == nullptr)
+        {
+            errMsg = "Error converting to double ";
+            return -1;
+        }
+
+        ++count;
+    }
+
+    if(count != numPoints)
+    {
+        errMsg = "Error, the number of imported points should match the number of points in the time-history input file";
+        return -1;
+    }
+
+    return 0;
+}
+
+
+const char* PeerRecordParser::parseDouble(const char* begin, const char* end, double& value)
+{
+    static const double powersOfTen[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                         1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+    auto p = begin;
+
+    while(p != end && (*p == ' ' || *p == '\t'))
+        ++p;
+
+    auto start = p;
+
+    bool negative = false;
+
+    if(p != end && (*p == '-' || *p == '+'))
+    {
+        negative = (*p == '-');
+        ++p;
+    }
+
+    unsigned long long mantissa = 0;
+    int numDigits = 0;
+    int exponent = 0;
+    bool hasDigits = false;
+
+    // Leading zeros do not count towards the significant digits
+    while(p != end && isDigit(*p))
+    {
+        hasDigits = true;
+
+        if(mantissa != 0 || *p != '0')
+        {
+            mantissa = mantissa*10 + static_cast<unsigned long long>(*p - '0');
+            ++numDigits;
+        }
+
+        ++p;
+    }
+
+    if(p != end && *p == '.')
+    {
+        ++p;
+
+        while(p != end && isDigit(*p))
+        {
+            hasDigits = true;
+
+            if(mantissa != 0 || *p != '0')
+            {
+                mantissa = mantissa*10 + static_cast<unsigned long long>(*p - '0');
+                ++numDigits;
+            }
+
+            --exponent;
+            ++p;
+        }
+    }
+
+    if(!hasDigits)
+        return nullptr;
+
+    if(p != end && (*p == 'e' || *p == 'E'))
+    {
+        auto q = p + 1;
+
+        bool negativeExponent = false;
+
+        if(q != end && (*q == '-' || *q == '+'))
+        {
+            negativeExponent = (*q == '-');
+            ++q;
+        }
+
+        if(q == end || !isDigit(*q))
+            return nullptr;
+
+        int explicitExponent = 0;
+
+        while(q != end && isDigit(*q))
+        {
+            if(explicitExponent < 10000)
+                explicitExponent = explicitExponent*10 + (*q - '0');
+
+            ++q;
+        }
+
+        exponent += negativeExponent ? -explicitExponent : explicitExponent;
+
+        p = q;
+    }
+
+    // The number has to end at a separator
+    if(p != end && !isSpace(*p))
+        return nullptr;
+
+    // Exact when both the mantissa and the power of ten are exactly representable
+    if(numDigits <= 19 && mantissa < (1ULL << 53) && exponent >= -22 && exponent <= 22)
+    {
+        auto result = static_cast<double>(mantissa);
+
+        if(exponent < 0)
+            result /= powersOfTen[-exponent];
+        else
+            result *= powersOfTen[exponent];
+
+        value = negative ? -result : result;
+
+        return p;
+    }
+
+    // QByteArray::toDouble always uses the C locale, strtod would follow the locale that QCoreApplication sets, e.g., a comma as the decimal separator
+    bool ok = false;
+    auto result = QByteArray(start, static_cast<int>(p - start)).toDouble(&ok);
+
+    if(!ok)
+        return nullptr;
+
+    value = result;
+
+    return p;
+}
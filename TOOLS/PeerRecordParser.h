@@ -0,0 +1,76 @@
+#ifndef PEERRECORDPARSER_H
+#define PEERRECORDPARSER_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include <QString>
+#include <QVector>
+
+// A time history from the PEER NGA database, i.e., the contents of an AT2, VT2, or DT2 file
+struct PeerRecord
+{
+    QString eventName;
+    QString eventDate;
+    QString stationID;
+    QString direction;
+
+    // The type of time history, e.g., acceleration
+    QString timeHistoryType;
+
+    double dT;
+
+    QVector<double> values;
+};
+
+
+// Parses the PEER NGA time history files straight from the bytes of the file
+// The values are written into a buffer of NPTS points that is allocated once, and the numbers are scanned without going through QString
+class PeerRecordParser
+{
+public:
+
+    static int parse(const QString& pathToFile, PeerRecord& record, QString& errMsg);
+
+    static int parse(const QByteArray& contents, PeerRecord& record, QString& errMsg);
+
+    // Scans a number in fixed or scientific notation starting at begin, e.g., -.1234E-02, returns nullptr if there is no number
+    // Numbers with up to 19 significant digits and a decimal exponent within +-22 are converted exactly with one multiplication or division, the rest fall back to the conversion of QByteArray, which does not depend on the locale
+    static const char* parseDouble(const char* begin, const char* end, double& value);
+};
+
+#endif // PEERRECORDPARSER_H
@@ -36,13 +36,21 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 // Written by: Stevan Gavrilovic
 
+#include "BootstrapEngine.h"
 #include "CSVReaderWriter.h"
 #include "ComponentInputWidget.h"
+#include "DVResultsAggregator.h"
+#include "DamageStateChartWidget.h"
 #include "GeneralInformationWidget.h"
 #include "MainWindowWorkflowApp.h"
+#include "PDFReportWriter.h"
+#include "PandasHDF5Reader.h"
 #include "PelicunPostProcessor.h"
+#include "PivotTableWidget.h"
 #include "REmpiricalProbabilityDistribution.h"
-#include "TablePrinter.h"
+#include "RealizationFields.h"
+#include "ResultsTableModel.h"
+#include "SpatialAggregationWidget.h"
 #include "VisualizationWidget.h"
 #include "WorkflowAppR2D.h"
 
@@ -54,6 +62,7 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <QComboBox>
 #include <QDir>
 #include <QDockWidget>
+#include <QDoubleSpinBox>
 #include <QFileInfo>
 #include <QFontMetrics>
 #include <QGraphicsLayout>
@@ -62,17 +71,22 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <QHeaderView>
 #include <QLabel>
 #include <QLineSeries>
+#include <QLogValueAxis>
 #include <QMenuBar>
+#include <QPainter>
 #include <QPixmap>
-#include <QPrinter>
+#include <QProgressDialog>
 #include <QStackedBarSeries>
 #include <QStringList>
 #include <QTabWidget>
-#include <QTableWidget>
+#include <QTableView>
 #include <QTextCursor>
 #include <QTextTable>
 #include <QValueAxis>
 
+#include <algorithm>
+#include <limits>
+
 // GIS headers
 #include "Basemap.h"
 #include "FeatureTable.h"
@@ -86,6 +100,8 @@ PelicunPostProcessor::PelicunPostProcessor(QWidget *parent, VisualizationWidget*
     casualtiesChart = nullptr;
     RFDiagChart = nullptr;
     Losseschart = nullptr;
+    exceedanceChart = nullptr;
+    exceedanceChartView = nullptr;
 
     // Create a view menu for the dockable windows
     auto mainWindow = WorkflowAppR2D::getInstance()->getTheMainWindow();
@@ -95,6 +111,29 @@ PelicunPostProcessor::PelicunPostProcessor(QWidget *parent, VisualizationWidget*
 
     connect(theVisualizationWidget,&VisualizationWidget::emitScreenshot,this,&PelicunPostProcessor::assemblePDF);
 
+    // The PDF report is written on a worker thread
+    reportWriter = new PDFReportWriter(this);
+    reportWatcher = new QFutureWatcher<QString>(this);
+
+    connect(reportWatcher, &QFutureWatcher<QString>::finished, this, &PelicunPostProcessor::handleReportFinished);
+
+    intervalsWatcher = new QFutureWatcher<QVector<BootstrapInterval>>(this);
+
+    connect(intervalsWatcher, &QFutureWatcher<QVector<BootstrapInterval>>::finished, this, &PelicunPostProcessor::handleIntervalsFinished);
+
+    // The realizations are streamed on a worker thread
+    numRealizationJobsDone = 0;
+    realizationReader = new RealizationStreamReader(this);
+    realizationsWatcher = new QFutureWatcher<int>(this);
+
+    connect(realizationsWatcher, &QFutureWatcher<int>::finished, this, &PelicunPostProcessor::handleRealizationsFinished);
+
+    connect(realizationReader, &RealizationStreamReader::progressChanged, this, [this](int percent)
+    {
+        if(realizationsProgressDialog)
+            realizationsProgressDialog->setValue(100*numRealizationJobsDone + percent);
+    });
+
     // Summary group box
     QWidget* totalsWidget = new QWidget(this);
     totalsWidget->setSizePolicy(QSizePolicy::Minimum, QSizePolicy::Maximum);
@@ -114,6 +153,22 @@ PelicunPostProcessor::PelicunPostProcessor(QWidget *parent, VisualizationWidget*
     structLossValueLabel = new QLabel("", this);
     nonStructLossValueLabel = new QLabel("", this);
 
+    // Statistics of the portfolio losses over the realizations, only available when every realization is saved
+    lossStdDevLabel = new QLabel("Losses Std. Dev.:", this);
+    lossQuantileLabel = new QLabel("Losses P90:", this);
+    lossStdDevValueLabel = new QLabel("", this);
+    lossQuantileValueLabel = new QLabel("", this);
+    lossVaRLabel = new QLabel("Losses VaR:", this);
+    lossTVaRLabel = new QLabel("Losses TVaR:", this);
+    lossVaRValueLabel = new QLabel("", this);
+    lossTVaRValueLabel = new QLabel("", this);
+
+    // Bootstrap confidence intervals of the totals
+    lossCILabel = new QLabel("Losses CI:", this);
+    fatalitiesCILabel = new QLabel("Fatalities CI:", this);
+    lossCIValueLabel = new QLabel("", this);
+    fatalitiesCIValueLabel = new QLabel("", this);
+
     totalsLayout->addWidget(totalCasLabel,0,0);
     totalsLayout->addWidget(totalCasValueLabel,0,1,1,1,Qt::AlignLeft);
     totalsLayout->addWidget(totalFatalitiesLabel,0,2);
@@ -126,6 +181,25 @@ PelicunPostProcessor::PelicunPostProcessor(QWidget *parent, VisualizationWidget*
     totalsLayout->addWidget(structLossValueLabel,2,1,1,1,Qt::AlignLeft);
     totalsLayout->addWidget(nonStructLossLabel,2,2);
     totalsLayout->addWidget(nonStructLossValueLabel,2,3,1,1,Qt::AlignLeft);
+    totalsLayout->addWidget(lossStdDevLabel,3,0);
+    totalsLayout->addWidget(lossStdDevValueLabel,3,1,1,1,Qt::AlignLeft);
+    totalsLayout->addWidget(lossQuantileLabel,3,2);
+    totalsLayout->addWidget(lossQuantileValueLabel,3,3,1,1,Qt::AlignLeft);
+    totalsLayout->addWidget(lossVaRLabel,4,0);
+    totalsLayout->addWidget(lossVaRValueLabel,4,1,1,1,Qt::AlignLeft);
+    totalsLayout->addWidget(lossTVaRLabel,4,2);
+    totalsLayout->addWidget(lossTVaRValueLabel,4,3,1,1,Qt::AlignLeft);
+    totalsLayout->addWidget(lossCILabel,5,0);
+    totalsLayout->addWidget(lossCIValueLabel,5,1,1,1,Qt::AlignLeft);
+    totalsLayout->addWidget(fatalitiesCILabel,5,2);
+    totalsLayout->addWidget(fatalitiesCIValueLabel,5,3,1,1,Qt::AlignLeft);
+
+    lossStdDevLabel->setVisible(false);
+    lossQuantileLabel->setVisible(false);
+    lossVaRLabel->setVisible(false);
+    lossTVaRLabel->setVisible(false);
+    lossCILabel->setVisible(false);
+    fatalitiesCILabel->setVisible(false);
 
     QDockWidget* summaryDock = new QDockWidget("Estimated Regional Totals",this);
     summaryDock->setObjectName("SummaryDock");
@@ -146,14 +220,58 @@ PelicunPostProcessor::PelicunPostProcessor(QWidget *parent, VisualizationWidget*
     chartsDock3->setObjectName("Relative Freq. Losses");
     chartsDock3->setContentsMargins(5,5,5,5);
 
+    // The relative frequency chart can be a histogram with one of the binning rules or a kernel density estimate
+    histogramWidget = new QWidget(this);
+
+    auto histogramLayout = new QVBoxLayout(histogramWidget);
+    histogramLayout->setContentsMargins(0,0,0,0);
+
+    QHBoxLayout *histogramControlsLayout = new QHBoxLayout();
+
+    histogramTypeComboBox = new QComboBox();
+    histogramTypeComboBox->insertItems(0,{"Histogram","Freedman-Diaconis Bins","Log-spaced Bins","Kernel Density"});
+
+    bandwidthSpinBox = new QDoubleSpinBox();
+    bandwidthSpinBox->setRange(0.1,10.0);
+    bandwidthSpinBox->setSingleStep(0.1);
+    bandwidthSpinBox->setValue(1.0);
+    bandwidthSpinBox->setToolTip("The bandwidth of the kernel density estimate as a multiple of the normal reference bandwidth");
+    bandwidthSpinBox->setEnabled(false);
+
+    connect(histogramTypeComboBox,QOverload<int>::of(&QComboBox::currentIndexChanged),this, &PelicunPostProcessor::updateHistogramChart);
+    connect(bandwidthSpinBox,QOverload<double>::of(&QDoubleSpinBox::valueChanged),this, &PelicunPostProcessor::updateHistogramChart);
+
+    histogramControlsLayout->addWidget(new QLabel("Plot:", this));
+    histogramControlsLayout->addWidget(histogramTypeComboBox);
+    histogramControlsLayout->addWidget(new QLabel("Bandwidth Factor:", this));
+    histogramControlsLayout->addWidget(bandwidthSpinBox);
+    histogramControlsLayout->addStretch(0);
+
+    histogramLayout->addLayout(histogramControlsLayout);
+
+    chartsDock4 = new QDockWidget(tr("Loss Exceedance"), this);
+    chartsDock4->setObjectName("Loss Exceedance");
+    chartsDock4->setContentsMargins(5,5,5,5);
+
+    damageStateChartWidget = new DamageStateChartWidget(this);
+
+    damageStateDock = new QDockWidget(tr("Damage States"), this);
+    damageStateDock->setObjectName("Damage States");
+    damageStateDock->setContentsMargins(5,5,5,5);
+    damageStateDock->setWidget(damageStateChartWidget);
+
     viewMenu->addAction(chartsDock1->toggleViewAction());
     viewMenu->addAction(chartsDock2->toggleViewAction());
     viewMenu->addAction(chartsDock3->toggleViewAction());
+    viewMenu->addAction(chartsDock4->toggleViewAction());
+    viewMenu->addAction(damageStateDock->toggleViewAction());
 
     this->addDockWidget(Qt::RightDockWidgetArea,chartsDock1);
 
     this->tabifyDockWidget(chartsDock1,chartsDock2);
     this->tabifyDockWidget(chartsDock1,chartsDock3);
+    this->tabifyDockWidget(chartsDock1,chartsDock4);
+    this->tabifyDockWidget(chartsDock1,damageStateDock);
 
     chartsDock1->setFocus();
 
@@ -162,17 +280,25 @@ PelicunPostProcessor::PelicunPostProcessor(QWidget *parent, VisualizationWidget*
 
     auto tableWidgetLayout = new QVBoxLayout(tableWidget);
 
-    pelicunResultsTableWidget = new QTableWidget(this);
-    pelicunResultsTableWidget->verticalHeader()->setVisible(false);
-    pelicunResultsTableWidget->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    // The model holds the typed results, the view only renders the visible rows
+    resultsTableModel = new ResultsTableModel(this);
 
-    pelicunResultsTableWidget->setSizeAdjustPolicy(QAbstractScrollArea::SizeAdjustPolicy::AdjustToContents);
-    pelicunResultsTableWidget->setSizePolicy(QSizePolicy::Maximum,QSizePolicy::Maximum);
+    // Asset ID, repair cost, repair time, replacement probability, fatalities, and loss ratio
+    resultsTableModel->setPrecisions({0, 2, 2, 3, 2, 3});
 
-    pelicunResultsTableWidget->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-    pelicunResultsTableWidget->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOn);
+    pelicunResultsTableView = new QTableView(this);
+    pelicunResultsTableView->setModel(resultsTableModel);
+    pelicunResultsTableView->verticalHeader()->setVisible(false);
+    pelicunResultsTableView->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    pelicunResultsTableView->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
 
-    pelicunResultsTableWidget->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    pelicunResultsTableView->setSizeAdjustPolicy(QAbstractScrollArea::SizeAdjustPolicy::AdjustToContents);
+    pelicunResultsTableView->setSizePolicy(QSizePolicy::Maximum,QSizePolicy::Maximum);
+
+    pelicunResultsTableView->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    pelicunResultsTableView->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOn);
+
+    pelicunResultsTableView->setEditTriggers(QAbstractItemView::NoEditTriggers);
 
     // Combo box to select how to sort the table
     QHBoxLayout *comboLayout = new QHBoxLayout();
@@ -191,7 +317,7 @@ PelicunPostProcessor::PelicunPostProcessor(QWidget *parent, VisualizationWidget*
     comboLayout->addStretch(0);
 
     tableWidgetLayout->addLayout(comboLayout);
-    tableWidgetLayout->addWidget(pelicunResultsTableWidget);
+    tableWidgetLayout->addWidget(pelicunResultsTableView);
     tableWidgetLayout->addStretch(0);
 
     QDockWidget* tableDock = new QDockWidget("Detailed Results",this);
@@ -202,6 +328,32 @@ PelicunPostProcessor::PelicunPostProcessor(QWidget *parent, VisualizationWidget*
 
     viewMenu->addAction(tableDock->toggleViewAction());
 
+    // Aggregation of the results to grid cells or to regions such as census tracts
+    spatialAggregationWidget = new SpatialAggregationWidget(this, theVisualizationWidget);
+
+    QDockWidget* aggregationDock = new QDockWidget("Spatial Aggregation",this);
+    aggregationDock->setObjectName("AggregationDock");
+    aggregationDock->setWidget(spatialAggregationWidget);
+    addDockWidget(Qt::RightDockWidgetArea, aggregationDock);
+
+    this->tabifyDockWidget(tableDock,aggregationDock);
+    tableDock->raise();
+
+    viewMenu->addAction(aggregationDock->toggleViewAction());
+
+    // Breakdown of the results by the asset attributes, e.g., the loss by occupancy class and structure type
+    pivotTableWidget = new PivotTableWidget(this);
+
+    QDockWidget* pivotDock = new QDockWidget("Breakdown by Attribute",this);
+    pivotDock->setObjectName("PivotDock");
+    pivotDock->setWidget(pivotTableWidget);
+    addDockWidget(Qt::RightDockWidgetArea, pivotDock);
+
+    this->tabifyDockWidget(tableDock,pivotDock);
+    tableDock->raise();
+
+    viewMenu->addAction(pivotDock->toggleViewAction());
+
     // Create a map view that will be used for selecting the grid points
     mapViewMainWidget = theVisualizationWidget->getMapViewWidget();
 
@@ -228,10 +380,29 @@ PelicunPostProcessor::PelicunPostProcessor(QWidget *parent, VisualizationWidget*
 }
 
 
+PelicunPostProcessor::~PelicunPostProcessor()
+{
+    // The worker thread uses the realization reader and writes to the members
+    realizationReader->cancel();
+    realizationsWatcher->waitForFinished();
+
+    // The report writer is a child of this widget and is deleted with it, so the report must be finished first
+    reportWriter->cancel();
+    reportWatcher->waitForFinished();
+
+    // The bootstrap uses the engine, which is a member
+    theBootstrap.cancel();
+    intervalsWatcher->waitForFinished();
+}
+
+
 void PelicunPostProcessor::importResults(const QString& pathToResults)
 {
     qDebug() << "PelicunPostProcessor: " << pathToResults;
 
+    // The summary of the previous results would otherwise keep reading their HDF5 files while the new ones are imported
+    this->cancelRealizations();
+
     // Remove old csv files in the output pathToResults
     QDir resultsDir(pathToResults);
 
@@ -242,9 +413,12 @@ void PelicunPostProcessor::importResults(const QString& pathToResults)
     QStringList acceptableFileExtensions = {"*.csv"};
     QStringList existingCSVFiles = resultsDir.entryList(acceptableFileExtensions, QDir::Files);
 
+    // pelicun also saves the results as pandas data frames in HDF5 files
+    QStringList existingHDFFiles = resultsDir.entryList(QStringList({"*.hdf","*.h5"}), QDir::Files);
+
     QString errMsg;
 
-    if(existingCSVFiles.empty())
+    if(existingCSVFiles.empty() && existingHDFFiles.empty())
     {
         QStringList acceptableFileExtensions = {"*.*"};
         QStringList existingFiles = existingFilesInfo.dir().entryList(acceptableFileExtensions, QDir::Files);
@@ -253,101 +427,710 @@ void PelicunPostProcessor::importResults(const QString& pathToResults)
         throw errMsg;
     }
 
-    QString DMResultsSheet;
-    QString DVResultsSheet;
-    QString EDPreultsSheet;
+    QString DMResultsSheet;
+    QString DVResultsSheet;
+    QString EDPreultsSheet;
+
+    for(auto&& it : existingCSVFiles)
+    {
+        if(it.startsWith("DM_"))
+            DMResultsSheet = it;
+        else if(it.startsWith("DV_"))
+            DVResultsSheet = it;
+        else if(it.startsWith("EDP_"))
+            EDPreultsSheet = it;
+    }
+
+    if(!this->loadResultsTable(pathToResults, DVResultsSheet, existingHDFFiles, "DV", numHeaderRows, DVdata))
+    {
+        errMsg = "Could not find the DV results in the folder " + pathToResults;
+        throw errMsg;
+    }
+
+    if(!DVdata.isEmpty())
+        this->processDVResults(DVdata);
+    else
+    {
+        errMsg = "The DV results are empty";
+        throw errMsg;
+    }
+
+    // The demands and the damage are optional, the number of header rows follows the number of levels of their columns
+    if(this->loadResultsTable(pathToResults, EDPreultsSheet, existingHDFFiles, "EDP", -1, EDPdata) && !EDPdata.isEmpty())
+        this->processEDPResults(EDPdata);
+
+    if(this->loadResultsTable(pathToResults, DMResultsSheet, existingHDFFiles, "DM", -1, DMdata) && !DMdata.isEmpty())
+        this->processDMResults(DMdata);
+
+    spatialAggregationWidget->setResults(DVdata.getIDs(), resultNames, resultColumns);
+
+    pivotTableWidget->setData(attributeNames, attributeColumns, resultNames, resultColumns);
+
+    // The results of every realization are too large to load at once, they are streamed and summarized instead
+    QStringList realizationFiles;
+    for(auto&& it : existingHDFFiles)
+    {
+        if(it.startsWith("realizations"))
+            realizationFiles.append(pathToResults + QDir::separator() + it);
+    }
+
+    this->processRealizations(realizationFiles);
+
+}
+
+
+int PelicunPostProcessor::processDVResults(const ResultsTable& DVResults)
+{
+    if(DVResults.isEmpty())
+    {
+        QString msg = "No results to import!";
+        throw msg;
+    }
+
+    // Sum up the regional totals on the worker threads while the table and the map are populated below
+    DVResultsAggregator theAggregator(DVResultsAggregator::hasNSLosses(DVResults));
+
+    auto totalsFuture = theAggregator.run(DVResults);
+
+    QVector<int> rows(DVResults.numRows());
+    for(int i = 0; i<rows.size(); ++i)
+        rows[i] = i;
+
+    lossRatios.clear();
+
+    this->updateAssets(DVResults, rows);
+
+    this->updateResultViews(DVResults);
+
+    // Wait for the worker threads to finish and display the totals
+    auto totals = totalsFuture.result();
+
+    if(!totals.errMsg.isEmpty())
+        throw totals.errMsg;
+
+    runningTotals = totals;
+
+    this->displayTotals(totals);
+
+    this->displayConfidenceIntervals(DVResults);
+
+    return 0;
+}
+
+
+void PelicunPostProcessor::appendResults(const ResultsTable& newRows)
+{
+    if(newRows.isEmpty())
+        return;
+
+    auto numRowsBefore = DVdata.numRows();
+
+    QVector<int> rows;
+    QString errMsg;
+
+    if(DVdata.append(newRows, rows, errMsg) != 0)
+        throw errMsg;
+
+    // Only the rows of the assets that were completed since the last refresh are written to the database and the map
+    this->updateAssets(DVdata, rows);
+
+    if(numRowsBefore == 0)
+    {
+        this->updateResultViews(DVdata);
+
+        spatialAggregationWidget->setResults(DVdata.getIDs(), resultNames, resultColumns);
+
+        pivotTableWidget->setData(attributeNames, attributeColumns, resultNames, resultColumns);
+    }
+    else
+    {
+        this->appendResultViews(DVdata, rows, numRowsBefore);
+    }
+
+    // The totals of the new rows are merged into the running totals, they are summed again from the start if an asset was updated
+    auto onlyNewRows = std::all_of(rows.begin(), rows.end(), [numRowsBefore](const int row)
+    {
+        return row >= numRowsBefore;
+    });
+
+    DVResultsAggregator theAggregator(DVResultsAggregator::hasNSLosses(DVdata));
+
+    if(numRowsBefore > 0 && onlyNewRows)
+        runningTotals.merge(theAggregator.compute(DVdata, rows));
+    else
+        runningTotals = theAggregator.compute(DVdata);
+
+    if(!runningTotals.errMsg.isEmpty())
+        throw runningTotals.errMsg;
+
+    this->displayTotals(runningTotals);
+}
+
+
+void PelicunPostProcessor::updateAssets(const ResultsTable& DVResults, const QVector<int>& rows)
+{
+    auto numHeaderColumns = DVResults.numColumns();
+
+    auto headerStrings = DVResults.getHeaders();
+
+    // Get the buildings database
+    auto theBuildingDB = theVisualizationWidget->getBuildingWidget()->getComponentDatabase();
+
+    if(theBuildingDB == nullptr)
+    {
+        QString msg = "Error getting the building database from the input widget!";
+        throw msg;
+    }
+
+    if(!DVResults.hasColumn(1))
+        throw QString("The DV results are missing the column " + headerStrings.value(1, QString::number(1)));
+
+    const auto& IDs = DVResults.getIDs();
+    const auto& repairCosts = DVResults.getColumn(1);   // Aggregate repair cost (mean)
+
+    lossRatios.resize(DVResults.numRows());
+
+    for(auto&& i : rows)
+    {
+        auto buildingID = IDs.at(i);
+
+        auto building = theBuildingDB->getComponent(buildingID);
+
+        if(building.ID == -1)
+            throw QString("Could not find the building ID " + QString::number(buildingID) + " in the database");
+
+        for(int j = 1; j<numHeaderColumns; ++j)
+        {
+            if(DVResults.hasColumn(j))
+                building.ResultsValues.insert(headerStrings.at(j),DVResults.value(i,j));
+        }
+
+        // Defaults to 1.0 if no replacement cost is given, i.e., it assumes the repair cost is the loss ratio
+        auto replacementCostVar = building.ComponentAttributes.value("ReplacementCost",QVariant(1.0));
+
+        auto replacementCost = objectToDouble(replacementCostVar);
+
+        building.ID = buildingID;
+
+        // The buildings are in the order of the rows of the results
+        if(i < buildingsVec.size())
+            buildingsVec[i] = building;
+        else
+            buildingsVec.push_back(building);
+
+        auto lossRatio = repairCosts.at(i)/replacementCost;
+
+        lossRatios[i] = lossRatio;
+
+        auto buildingFeature = building.ComponentFeature;
+
+        auto atrb = "LossRatio";
+        auto atrbVal = QVariant(lossRatio);
+
+        buildingFeature->attributes()->replaceAttribute("LossRatio",lossRatio);
+        buildingFeature->featureTable()->updateFeature(buildingFeature);
+
+        // Get the feature UID
+        auto uid = building.UID;
+        theVisualizationWidget->updateSelectedComponent(uid,atrb,atrbVal);
+    }
+}
+
+
+void PelicunPostProcessor::updateResultViews(const ResultsTable& DVResults)
+{
+    QStringList tableHeadings = {"Asset ID","Repair\nCost","Repair\nTime","Replacement\nProbability","Fatalities","Loss\nRatio"};
+
+    this->setResultColumns(DVResults);
+
+    // The columns are shared with the results
+    resultsTableModel->setResults(tableHeadings, DVResults.getIDs(), resultColumns);
+
+    // The attributes of the assets as columns for the breakdown
+    attributeNames.clear();
+
+    if(!buildingsVec.isEmpty())
+        attributeNames = buildingsVec.first().ComponentAttributes.keys();
+
+    attributeColumns = QVector<QStringList>(attributeNames.size());
+
+    for(auto&& building : buildingsVec)
+    {
+        for(int k = 0; k<attributeNames.size(); ++k)
+            attributeColumns[k].append(building.ComponentAttributes.value(attributeNames.at(k)).toString());
+    }
+
+    // Keep the sorting that is selected
+    this->sortTable(sortComboBox->currentIndex());
+}
+
+
+void PelicunPostProcessor::appendResultViews(const ResultsTable& DVResults, const QVector<int>& rows, const int numRowsBefore)
+{
+    this->setResultColumns(DVResults);
+
+    // The model merges the changed rows into its sorting and inserts the new ones
+    resultsTableModel->updateResults(DVResults.getIDs(), resultColumns, rows);
+
+    // Only the attributes of the new assets are added to the breakdown
+    QVector<QStringList> newAttributeColumns(attributeNames.size());
+
+    for(int i = numRowsBefore; i<buildingsVec.size(); ++i)
+    {
+        const auto& attributes = buildingsVec.at(i).ComponentAttributes;
+
+        for(int k = 0; k<attributeNames.size(); ++k)
+        {
+            auto value = attributes.value(attributeNames.at(k)).toString();
+
+            newAttributeColumns[k].append(value);
+            attributeColumns[k].append(value);
+        }
+    }
+
+    spatialAggregationWidget->updateResults(DVResults.getIDs(), resultNames, resultColumns);
+
+    pivotTableWidget->appendData(newAttributeColumns, resultNames, resultColumns);
+}
+
+
+void PelicunPostProcessor::setResultColumns(const ResultsTable& DVResults)
+{
+    auto withNSLosses = DVResultsAggregator::hasNSLosses(DVResults);
+
+    auto headerStrings = DVResults.getHeaders();
+
+    // This assumes that the output from pelicun will not change
+    auto repairTimeCol = withNSLosses ? 28 : 13;    // Aggregate repair time (mean)
+    auto fatalitiesCol = withNSLosses ? 48 : 33;    // Injuries severity level 4 (mean)
+
+    for(auto&& col : {1, 6, repairTimeCol, fatalitiesCol})
+    {
+        if(!DVResults.hasColumn(col))
+            throw QString("The DV results are missing the column " + headerStrings.value(col, QString::number(col)));
+    }
+
+    const auto& repairCosts = DVResults.getColumn(1);   // Aggregate repair cost (mean)
+    const auto& replacementProbs = DVResults.getColumn(6);  // Replacement probability, i.e., repair impractical probability
+    const auto& repairTimes = DVResults.getColumn(repairTimeCol);
+    const auto& fatalitiesVec = DVResults.getColumn(fatalitiesCol);
+
+    // The results for the table, the spatial aggregation and the breakdown, only the loss ratios are new, the demands and the damage are added once they are processed
+    resultNames = QStringList({"Repair Cost","Repair Time","Replacement Probability","Fatalities","Loss Ratio"});
+    resultColumns = {repairCosts, repairTimes, replacementProbs, fatalitiesVec, lossRatios};
+}
+
+
+int PelicunPostProcessor::displayTotals(const DVResultsTotals& totals)
+{
+    //  CASUALTIES
+    QBarSet *casualtiesSet = new QBarSet("Casualties");
+
+    for(auto&& it : totals.injuries)
+        *casualtiesSet << it;
+
+    this->createCasualtiesChart(casualtiesSet);
+
+    totalCasValueLabel->setText(QString::number(casualtiesSet->sum()));
+    totalFatalitiesValueLabel->setText(QString::number(casualtiesSet->at(3)));
+
+    //  LOSSES
+    QBarSet *structLossSet = new QBarSet("Structural");
+    QBarSet *NSAccLossSet = new QBarSet("Non-structural Acc.");
+    QBarSet *NSDriftLossSet = new QBarSet("Non-structural Drift");
+
+    for(int i = 0; i<4; ++i)
+    {
+        *structLossSet << totals.structLosses.at(i);
+        *NSAccLossSet << totals.NSAccLosses.at(i);
+        *NSDriftLossSet << totals.NSDriftLosses.at(i);
+    }
+
+    this->createLossesChart(structLossSet, NSAccLossSet, NSDriftLossSet);
+
+    auto sumStruct = structLossSet->sum();
+    auto sumNonStruct = NSAccLossSet->sum() + NSDriftLossSet->sum();
+
+    auto sumLosses = sumStruct + sumNonStruct;
+    totalLossValueLabel->setText(QString::number(sumLosses));
+
+    structLossValueLabel->setText(QString::number(sumStruct));
+    nonStructLossValueLabel->setText(QString::number(sumNonStruct));
+
+    // Repair time
+    totalRepairTimeValueLabel->setText(QString::number(totals.repairTime));
+
+    // The distribution is merged from the blocks of the reduction
+    lossDistribution = totals.repairCostDistribution;
+
+    this->createHistogramChart(&lossDistribution);
+
+    if(lossDistribution.getNumberSamples() < 2)
+        lossesRFDiagram->setProperty("ToPlot",false);
+    else
+        lossesRFDiagram->setProperty("ToPlot",true);
+
+    // Set a default size to the charts
+    chartsDock1->setWidget(casualtiesChartView);
+    chartsDock2->setWidget(lossesChartView);
+    chartsDock3->setWidget(histogramWidget);
+
+    return 0;
+}
+
+
+int PelicunPostProcessor::displayConfidenceIntervals(const ResultsTable& DVResults, const QVector<int>& rows)
+{
+    // This assumes that the output from pelicun will not change
+    auto fatalitiesCol = DVResultsAggregator::hasNSLosses(DVResults) ? 48 : 33;    // Injuries severity level 4 (mean)
+
+    if(!DVResults.hasColumn(1) || !DVResults.hasColumn(fatalitiesCol))
+        return -1;
+
+    const auto& repairCosts = DVResults.getColumn(1);   // Aggregate repair cost (mean)
+    const auto& fatalitiesVec = DVResults.getColumn(fatalitiesCol);
+
+    QVector<QVector<double>> samples;
+
+    if(rows.isEmpty())
+        samples = {repairCosts, fatalitiesVec};
+    else
+    {
+        samples.fill(QVector<double>(rows.size()), 2);
+
+        for(int i = 0; i<rows.size(); ++i)
+        {
+            samples[0][i] = repairCosts.at(rows.at(i));
+            samples[1][i] = fatalitiesVec.at(rows.at(i));
+        }
+    }
+
+    // The intervals of the previous selection are hidden until the new ones are computed
+    this->clearConfidenceIntervals();
+
+    // The intervals need at least two assets
+    if(samples.first().size() < 2)
+        return 0;
+
+    theBootstrap.resetCancel();
+
+    auto bootstrap = &theBootstrap;
+
+    intervalsWatcher->setFuture(QtConcurrent::run([bootstrap, samples]()
+    {
+        return bootstrap->sumIntervals(samples);
+    }));
+
+    return 0;
+}
+
+
+void PelicunPostProcessor::clearConfidenceIntervals(void)
+{
+    // Stop a bootstrap that is still running, it uses the engine, and drop its result so that it is not shown
+    theBootstrap.cancel();
+    intervalsWatcher->waitForFinished();
+    intervalsWatcher->setFuture(QFuture<QVector<BootstrapInterval>>());
+
+    lossCIValueLabel->clear();
+    fatalitiesCIValueLabel->clear();
+    lossCILabel->setVisible(false);
+    fatalitiesCILabel->setVisible(false);
+}
+
+
+void PelicunPostProcessor::handleIntervalsFinished(void)
+{
+    // A finished signal of a future that was replaced may still arrive, only the result of the current one is shown
+    if(!intervalsWatcher->isFinished() || intervalsWatcher->isCanceled())
+        return;
+
+    auto intervals = intervalsWatcher->result();
+
+    if(intervals.size() < 2)
+        return;
+
+    auto levelText = QString::number(qRound(theBootstrap.getConfidenceLevel()*100.0)) + "% CI:";
+
+    auto intervalText = [](const BootstrapInterval& interval)
+    {
+        return "[" + QString::number(interval.lower) + ", " + QString::number(interval.upper) + "]";
+    };
+
+    lossCILabel->setText("Losses " + levelText);
+    lossCIValueLabel->setText(intervalText(intervals.at(0)));
+    lossCILabel->setVisible(true);
+
+    fatalitiesCILabel->setText("Fatalities " + levelText);
+    fatalitiesCIValueLabel->setText(intervalText(intervals.at(1)));
+    fatalitiesCILabel->setVisible(true);
+}
+
+
+void PelicunPostProcessor::processRealizations(const QStringList& pathsToFiles)
+{
+    this->cancelRealizations();
+
+    // The frames that are summarized and the names of their summary columns
+    QVector<QPair<QString, QString>> frames = {{"/reconstruction/cost", "RepairCost"}, {"/reconstruction/time", "RepairTime"}};
+
+    for(auto&& file : pathsToFiles)
+    {
+        for(auto&& frame : frames)
+            realizationJobs.push_back({file, frame.first, frame.second});
+    }
+
+    if(realizationJobs.isEmpty())
+        return;
+
+    numRealizationJobsDone = 0;
+
+    realizationsProgressDialog = new QProgressDialog("Summarizing the results of every realization...", "Cancel", 0, 100*realizationJobs.size(), this);
+    realizationsProgressDialog->setWindowTitle("Realizations");
+    realizationsProgressDialog->setMinimumDuration(0);
+    realizationsProgressDialog->setAutoClose(false);
+    realizationsProgressDialog->setAutoReset(false);
+    realizationsProgressDialog->setAttribute(Qt::WA_DeleteOnClose);
+
+    connect(realizationsProgressDialog, &QProgressDialog::canceled, realizationReader, &RealizationStreamReader::cancel);
+
+    realizationReader->resetCancel();
+
+    this->summarizeNextRealizations();
+}
+
+
+void PelicunPostProcessor::summarizeNextRealizations(void)
+{
+    if(realizationJobs.isEmpty())
+    {
+        if(realizationsProgressDialog)
+            realizationsProgressDialog->close();
+
+        return;
+    }
+
+    auto job = realizationJobs.first();
+    auto reader = realizationReader;
+    auto summary = &pendingSummary;
+    auto errMsg = &realizationsErrMsg;
+
+    errMsg->clear();
+
+    // Returns 1 if the file does not have the frame
+    realizationsWatcher->setFuture(QtConcurrent::run([job, reader, summary, errMsg]()
+    {
+        if(reader->open(job.pathToFile, *errMsg) != 0)
+            return -1;
+
+        auto res = 1;
+
+        if(reader->getKeys().contains(job.key))
+            res = reader->summarize(job.key, *summary, *errMsg);
+
+        reader->close();
+
+        return res;
+    }));
+}
+
+
+void PelicunPostProcessor::handleRealizationsFinished(void)
+{
+    // The summary was stopped by a clear
+    if(realizationsWatcher->isCanceled() || realizationJobs.isEmpty())
+        return;
+
+    auto res = realizationsWatcher->result();
+
+    auto job = realizationJobs.takeFirst();
+
+    try
+    {
+        if(res == -1)
+            throw realizationsErrMsg;
+
+        if(res == 0)
+            this->applyRealizationSummary(pendingSummary, job.name);
+    }
+    catch (const QString& errMsg)
+    {
+        realizationJobs.clear();
+
+        if(realizationsProgressDialog)
+            realizationsProgressDialog->close();
+
+        // An empty message means that it was cancelled
+        if(errMsg.isEmpty())
+            WorkflowAppR2D::getInstance()->statusMessage("The summary of the realizations was cancelled");
+        else
+            WorkflowAppR2D::getInstance()->errorMessage(errMsg);
+
+        return;
+    }
+
+    ++numRealizationJobsDone;
+
+    if(realizationsProgressDialog)
+        realizationsProgressDialog->setValue(100*numRealizationJobsDone);
+
+    this->summarizeNextRealizations();
+}
+
+
+void PelicunPostProcessor::cancelRealizations(void)
+{
+    realizationJobs.clear();
+
+    realizationReader->cancel();
+    realizationsWatcher->waitForFinished();
+
+    // Drop the result so that it is not written to the assets
+    realizationsWatcher->setFuture(QFuture<int>());
+
+    if(realizationsProgressDialog)
+        realizationsProgressDialog->close();
+}
+
+
+int PelicunPostProcessor::applyRealizationSummary(const RealizationSummary& summary, const QString& name)
+{
+    auto theBuildingDB = theVisualizationWidget->getBuildingWidget()->getComponentDatabase();
+
+    if(theBuildingDB == nullptr)
+    {
+        QString msg = "Error getting the building database from the input widget!";
+        throw msg;
+    }
+
+    auto fields = RealizationFields::getSummaryFields(name, summary.quantileLevels);
+
+    // Write the summary columns to the assets so that they can be mapped
+    for(int i = 0; i<summary.assetIDs.size(); ++i)
+    {
+        auto& building = theBuildingDB->getComponent(summary.assetIDs.at(i));
+
+        if(building.ID == -1)
+            throw QString("Could not find the building ID " + QString::number(summary.assetIDs.at(i)) + " in the database");
+
+        QVector<double> values = {summary.mean.at(i), summary.stdDev.at(i)};
+
+        for(auto&& it : summary.quantiles)
+            values.push_back(it.at(i));
+
+        auto buildingFeature = building.ComponentFeature;
+
+        for(int j = 0; j<fields.size(); ++j)
+        {
+            building.addResult(fields.at(j), values.at(j));
 
-    for(auto&& it : existingCSVFiles)
-    {
-        if(it.startsWith("DM_"))
-            DMResultsSheet = it;
-        else if(it.startsWith("DV_"))
-            DVResultsSheet = it;
-        else if(it.startsWith("EDP_"))
-            EDPreultsSheet = it;
+            if(buildingFeature)
+                buildingFeature->attributes()->replaceAttribute(fields.at(j), values.at(j));
+        }
+
+        if(buildingFeature)
+            buildingFeature->featureTable()->updateFeature(buildingFeature);
     }
 
-    CSVReaderWriter csvTool;
+    if(name == "RepairCost")
+    {
+        lossStdDevValueLabel->setText(QString::number(summary.portfolioStdDev));
+        lossStdDevLabel->setVisible(true);
 
-    DMdata = csvTool.parseCSVFile(pathToResults + QDir::separator() + DMResultsSheet,errMsg);
-    if(!errMsg.isEmpty())
-        throw errMsg;
+        if(!summary.portfolioQuantiles.isEmpty())
+        {
+            lossQuantileLabel->setText("Losses " + fields.last().mid(name.size()) + ":");
+            lossQuantileValueLabel->setText(QString::number(summary.portfolioQuantiles.last()));
+            lossQuantileLabel->setVisible(true);
+        }
 
-    DVdata = csvTool.parseCSVFile(pathToResults + QDir::separator() + DVResultsSheet,errMsg);
-    if(!errMsg.isEmpty())
-        throw errMsg;
+        // The tail statistics at the highest tail level
+        if(!summary.tailLevels.isEmpty())
+        {
+            auto tailLevel = QString::number(qRound(summary.tailLevels.last()*100.0)) + "%";
+
+            lossVaRLabel->setText("Losses VaR " + tailLevel + ":");
+            lossTVaRLabel->setText("Losses TVaR " + tailLevel + ":");
+            lossVaRValueLabel->setText(QString::number(summary.valueAtRisk.last()));
+            lossTVaRValueLabel->setText(QString::number(summary.tailValueAtRisk.last()));
+            lossVaRLabel->setVisible(true);
+            lossTVaRLabel->setVisible(true);
+        }
 
-    EDPdata = csvTool.parseCSVFile(pathToResults + QDir::separator() + EDPreultsSheet,errMsg);
-    if(!errMsg.isEmpty())
-        throw errMsg;
+        this->createExceedanceChart(summary);
 
-    if(!DVdata.empty())
-        this->processDVResults(DVdata);
-    else
-    {
-        errMsg = "The DV results are empty";
-        throw errMsg;
+        chartsDock4->setWidget(exceedanceChartView);
     }
 
+    realizationSummaries.push_back(summary);
+
+    return 0;
 }
 
 
-int PelicunPostProcessor::processDVResults(const QVector<QStringList>& DVResults)
+bool PelicunPostProcessor::loadResultsTable(const QString& pathToResults, const QString& csvFile, const QStringList& hdfFiles, const QString& prefix, const int headerRows, ResultsTable& table)
 {
-    if(DVResults.size() < numHeaderRows)
+    QString errMsg;
+
+    if(!csvFile.isEmpty())
     {
-        QString msg = "No results to import!";
-        throw msg;
-    }
+        CSVReaderWriter csvTool;
 
-    bool withNSLosses = true;
+        auto rows = csvTool.parseCSVFile(pathToResults + QDir::separator() + csvFile,errMsg);
+        if(!errMsg.isEmpty())
+            throw errMsg;
 
-    auto numHeaderColumns = DVResults.at(0).size();
+        auto numRows = headerRows > 0 ? headerRows : ResultsTable::countHeaderRows(rows);
 
-    if(numHeaderColumns == 38)
-        withNSLosses = false;
+        if(table.fromCSV(rows, numRows, errMsg) != 0)
+            throw errMsg;
 
-    QVector<QString> headerStrings(numHeaderColumns);
+        return true;
+    }
 
-    for(int i = 0; i<numHeaderColumns; ++i)
+    // Fall back to the HDF5 file when the csv files were not written
+    QString HDFFile;
+    for(auto&& it : hdfFiles)
     {
-        QString headerStr =  DVResults.at(0).at(i)  +"-"+ DVResults.at(1).at(i)  +"-"+  DVResults.at(2).at(i)  +"-"+  DVResults.at(3).at(i);
-
-        headerStrings[i] = headerStr;
+        if(it.startsWith(prefix))
+            HDFFile = it;
     }
 
-    QStringList tableHeadings = {"Asset ID","Repair\nCost","Repair\nTime","Replacement\nProbability","Fatalities","Loss\nRatio"};
+    if(HDFFile.isEmpty())
+        return false;
 
-    pelicunResultsTableWidget->setColumnCount(tableHeadings.size());
-    pelicunResultsTableWidget->setHorizontalHeaderLabels(tableHeadings);
+    PandasHDF5Reader theReader;
 
-    pelicunResultsTableWidget->setRowCount(DVResults.size()-numHeaderRows);
+    if(theReader.open(pathToResults + QDir::separator() + HDFFile, errMsg) != 0)
+        throw errMsg;
 
-    auto cumulativeStructDS1 = 0.0;
-    auto cumulativeStructDS2 = 0.0;
-    auto cumulativeStructDS3 = 0.0;
-    auto cumulativeStructDS4 = 0.0;
+    auto keys = theReader.getKeys();
 
-    auto cumulativeNSAccDS1 = 0.0;
-    auto cumulativeNSAccDS2 = 0.0;
-    auto cumulativeNSAccDS3 = 0.0;
-    auto cumulativeNSAccDS4 = 0.0;
+    if(keys.isEmpty())
+    {
+        errMsg = "The file " + HDFFile + " does not contain any data frames";
+        throw errMsg;
+    }
 
-    auto cumulativeNSDriftDS1 = 0.0;
-    auto cumulativeNSDriftDS2 = 0.0;
-    auto cumulativeNSDriftDS3 = 0.0;
-    auto cumulativeNSDriftDS4 = 0.0;
+    // pandas saves a single frame under the key 'data' by default
+    auto key = keys.contains("/data") ? QString("/data") : keys.first();
 
-    auto cumulativeinjSevLvl1 = 0.0;
-    auto cumulativeinjSevLvl2 = 0.0;
-    auto cumulativeinjSevLvl3 = 0.0;
-    auto cumulativeinjSevLvl4 = 0.0;
+    if(theReader.readTable(key, table, errMsg) != 0)
+        throw errMsg;
 
-    auto cumulativeRepairTime = 0.0;
+    return true;
+}
 
-    REmpiricalProbabilityDistribution theProbDist;
 
-    // Get the buildings database
+int PelicunPostProcessor::processEDPResults(const ResultsTable& EDPResults)
+{
+    EDPResultsProcessor theProcessor;
+
+    QString errMsg;
+
+    if(theProcessor.process(EDPResults, EDPsummary, errMsg) != 0)
+        throw errMsg;
+
     auto theBuildingDB = theVisualizationWidget->getBuildingWidget()->getComponentDatabase();
 
     if(theBuildingDB == nullptr)
@@ -356,179 +1139,131 @@ int PelicunPostProcessor::processDVResults(const QVector<QStringList>& DVResults
         throw msg;
     }
 
-    // 4 rows of headers in the results file
-    for(int i = numHeaderRows, count = 0; i<DVResults.size(); ++i, ++count)
-    {
-        auto inputRow = DVResults.at(i);
+    // Only the demands that have a field in the building layers can be mapped
+    auto mapFields = EDPResultsProcessor::getDemandFields();
 
-        auto buildingID = objectToInt(inputRow.at(0));
+    QStringList fields;
+    for(auto&& it : EDPsummary.demandTypes)
+        fields.append(EDPResultsProcessor::getDemandField(it));
 
-        auto building = theBuildingDB->getComponent(buildingID);
+    for(int i = 0; i<EDPsummary.IDs.size(); ++i)
+    {
+        auto& building = theBuildingDB->getComponent(EDPsummary.IDs.at(i));
 
         if(building.ID == -1)
-            throw QString("Could not find the building ID " + QString::number(buildingID) + " in the database");
-
-        for(int j = 1; j<numHeaderColumns; ++j)
-        {
-            building.ResultsValues.insert(headerStrings.at(j),inputRow.at(j).toDouble());
-        }
+            throw QString("Could not find the building ID " + QString::number(EDPsummary.IDs.at(i)) + " in the database");
 
-        // Defaults to 1.0 if no replacement cost is given, i.e., it assumes the repair cost is the loss ratio
-        auto replacementCostVar = building.ComponentAttributes.value("ReplacementCost",QVariant(1.0));
+        auto buildingFeature = building.ComponentFeature;
 
-        auto replacementCost = objectToDouble(replacementCostVar);
+        for(int k = 0; k<fields.size(); ++k)
+        {
+            auto val = EDPsummary.peakDemands.at(k).at(i);
 
-        building.ID = buildingID;
+            building.addResult(fields.at(k), val);
 
-        buildingsVec.push_back(building);
+            if(buildingFeature && mapFields.contains(fields.at(k)))
+                buildingFeature->attributes()->replaceAttribute(fields.at(k), val);
+        }
 
-        // This assumes that the output from pelicun will not change
-        auto IDStr = inputRow.at(0);            // ID
-        auto totalRepairCost = inputRow.at(1);  // Aggregate repair cost (mean)
-        auto replaceMentProb = inputRow.at(6);  // Replacement probability, i.e., repair impractical probability
+        if(buildingFeature)
+            buildingFeature->featureTable()->updateFeature(buildingFeature);
+    }
 
-        auto repairTime = 0.0;
-        auto fatalities = 0.0;
-        auto injSevLvl1 = 0.0;
-        auto injSevLvl2 = 0.0;
-        auto injSevLvl3 = 0.0;
+    for(int k = 0; k<fields.size(); ++k)
+        this->addResultColumn("Peak " + EDPsummary.demandTypes.at(k), EDPsummary.IDs, EDPsummary.peakDemands.at(k));
 
-        // Aggregate repair time (mean)
-        if(withNSLosses)
-            repairTime = objectToDouble(inputRow.at(28));
-        else
-            repairTime= objectToDouble(inputRow.at(13));
+    return 0;
+}
 
-        cumulativeRepairTime += repairTime;
 
-        auto StructDS1 = objectToDouble(inputRow.at(8));    // Structural losses damage state 1 (mean)
-        auto StructDS2 = objectToDouble(inputRow.at(9));    // Structural losses damage state 2 (mean)
-        auto StructDS3 = objectToDouble(inputRow.at(10));   // Structural losses damage state 3 (mean)
-        auto StructDS4 = objectToDouble(inputRow.at(11));   // Structural losses damage state 4 (mean)
+int PelicunPostProcessor::processDMResults(const ResultsTable& DMResults)
+{
+    DMResultsProcessor theProcessor;
 
-        cumulativeStructDS1 += StructDS1;
-        cumulativeStructDS2 += StructDS2;
-        cumulativeStructDS3 += StructDS3;
-        cumulativeStructDS4 += StructDS4;
+    QString errMsg;
 
-        if(withNSLosses)
-        {
-            auto NSAccDS1 = objectToDouble(inputRow.at(19));    // Non-structural acceleration sensitive losses damage state 1 (mean)
-            auto NSAccDS2 = objectToDouble(inputRow.at(20));    // Non-structural acceleration sensitive losses damage state 2 (mean)
-            auto NSAccDS3 = objectToDouble(inputRow.at(21));    // Non-structural acceleration sensitive losses damage state 3 (mean)
-            auto NSAccDS4 = objectToDouble(inputRow.at(22));    // Non-structural acceleration sensitive losses damage state 4 (mean)
-
-            cumulativeNSAccDS1 += NSAccDS1;
-            cumulativeNSAccDS2 += NSAccDS2;
-            cumulativeNSAccDS3 += NSAccDS3;
-            cumulativeNSAccDS4 += NSAccDS4;
-
-            auto NSDriftDS1 = objectToDouble(inputRow.at(24));  // Non-structural drift sensitive losses damage state 1 (mean)
-            auto NSDriftDS2 = objectToDouble(inputRow.at(25));  // Non-structural drift sensitive losses damage state 2 (mean)
-            auto NSDriftDS3 = objectToDouble(inputRow.at(26));  // Non-structural drift sensitive losses damage state 3 (mean)
-            auto NSDriftDS4 = objectToDouble(inputRow.at(27));  // Non-structural drift sensitive losses damage state 4 (mean)
-
-            cumulativeNSDriftDS1 += NSDriftDS1;
-            cumulativeNSDriftDS2 += NSDriftDS2;
-            cumulativeNSDriftDS3 += NSDriftDS3;
-            cumulativeNSDriftDS4 += NSDriftDS4;
-
-            injSevLvl1 = objectToDouble(inputRow.at(33));  // Injuries severity level 1 (mean)
-            injSevLvl2 = objectToDouble(inputRow.at(38));  // Injuries severity level 2 (mean)
-            injSevLvl3 = objectToDouble(inputRow.at(43));  // Injuries severity level 3 (mean)
-            fatalities = objectToDouble(inputRow.at(48));  // Injuries severity level 4 (mean)
-        }
-        else
-        {
-            injSevLvl1 = objectToDouble(inputRow.at(18));  // Injuries severity level 1 (mean)
-            injSevLvl2 = objectToDouble(inputRow.at(23));  // Injuries severity level 2 (mean)
-            injSevLvl3 = objectToDouble(inputRow.at(28));  // Injuries severity level 3 (mean)
-            fatalities = objectToDouble(inputRow.at(33));  // Injuries severity level 4 (mean)
-        }
+    if(theProcessor.process(DMResults, DMsummary, errMsg) != 0)
+        throw errMsg;
 
-        cumulativeinjSevLvl1 += injSevLvl1;
-        cumulativeinjSevLvl2 += injSevLvl2;
-        cumulativeinjSevLvl3 += injSevLvl3;
-        cumulativeinjSevLvl4 += fatalities;
+    auto theBuildingDB = theVisualizationWidget->getBuildingWidget()->getComponentDatabase();
 
-        auto repairCost = objectToDouble(totalRepairCost);
-        auto lossRatio = repairCost/replacementCost;
+    if(theBuildingDB == nullptr)
+    {
+        QString msg = "Error getting the building database from the input widget!";
+        throw msg;
+    }
 
-        theProbDist.addSample(repairCost);
+    // The damage of the first group, i.e., the structural components, is written to the building layers
+    auto fields = DMResultsProcessor::getDamageFields();
 
-        auto IDItem = new QTableWidgetItem(IDStr);
-        auto RepCostItem = new QTableWidgetItem(totalRepairCost);
-        auto RepProbItem = new QTableWidgetItem(replaceMentProb);
-        auto RepairTimeItem = new QTableWidgetItem(QString::number(repairTime));
-        auto fatalitiesItem = new QTableWidgetItem(QString::number(fatalities));
-        auto lossRatioItem = new QTableWidgetItem(QString::number(lossRatio));
+    if(DMsummary.groups.isEmpty() || DMsummary.expectedDamageStates.isEmpty() || DMsummary.mostLikelyDamageStates.isEmpty())
+        throw QString("The DM results do not contain any component groups");
 
-        pelicunResultsTableWidget->setItem(count,0, IDItem);
-        pelicunResultsTableWidget->setItem(count,1, RepCostItem);
-        pelicunResultsTableWidget->setItem(count,2, RepairTimeItem);
-        pelicunResultsTableWidget->setItem(count,3, RepProbItem);
-        pelicunResultsTableWidget->setItem(count,4, fatalitiesItem);
-        pelicunResultsTableWidget->setItem(count,5, lossRatioItem);
+    const auto& group = DMsummary.groups.first();
+    const auto& expectedDS = DMsummary.expectedDamageStates.first();
+    const auto& mostLikelyDS = DMsummary.mostLikelyDamageStates.first();
 
-        auto buildingFeature = building.ComponentFeature;
+    // The attributes of the assets in the order of the DM results for the classes of the damage state chart
+    QStringList DMAttributeNames;
+    QVector<QStringList> DMAttributeColumns;
 
-        auto atrb = "LossRatio";
-        auto atrbVal = QVariant(lossRatio);
+    for(int i = 0; i<DMsummary.IDs.size(); ++i)
+    {
+        auto& building = theBuildingDB->getComponent(DMsummary.IDs.at(i));
 
-        buildingFeature->attributes()->replaceAttribute("LossRatio",lossRatio);
-        buildingFeature->featureTable()->updateFeature(buildingFeature);
+        if(building.ID == -1)
+            throw QString("Could not find the building ID " + QString::number(DMsummary.IDs.at(i)) + " in the database");
 
-        // Get the feature UID
-        auto uid = building.UID;
-        theVisualizationWidget->updateSelectedComponent(uid,atrb,atrbVal);
-    }
+        if(i == 0)
+        {
+            DMAttributeNames = building.ComponentAttributes.keys();
+            DMAttributeColumns.resize(DMAttributeNames.size());
+        }
 
-    //  CASUALTIES
-    QBarSet *casualtiesSet = new QBarSet("Casualties");
+        for(int k = 0; k<DMAttributeNames.size(); ++k)
+            DMAttributeColumns[k].append(building.ComponentAttributes.value(DMAttributeNames.at(k)).toString());
 
-    *casualtiesSet << cumulativeinjSevLvl1 << cumulativeinjSevLvl2 << cumulativeinjSevLvl3 << cumulativeinjSevLvl4;
+        auto mostLikely = mostLikelyDS.at(i) != -1 ? group.damageStateValues.at(mostLikelyDS.at(i)) : 0.0;
 
-    this->createCasualtiesChart(casualtiesSet);
+        QVector<double> values = {expectedDS.at(i), mostLikely};
 
-    totalCasValueLabel->setText(QString::number(casualtiesSet->sum()));
-    totalFatalitiesValueLabel->setText(QString::number(casualtiesSet->at(3)));
+        auto buildingFeature = building.ComponentFeature;
 
-    //  LOSSES
-    QBarSet *structLossSet = new QBarSet("Structural");
-    QBarSet *NSAccLossSet = new QBarSet("Non-structural Acc.");
-    QBarSet *NSDriftLossSet = new QBarSet("Non-structural Drift");
+        for(int j = 0; j<fields.size(); ++j)
+        {
+            building.addResult(fields.at(j), values.at(j));
 
-    *structLossSet << cumulativeStructDS1 << cumulativeStructDS2 << cumulativeStructDS3 << cumulativeStructDS4 ;
-    *NSAccLossSet << cumulativeNSAccDS1 << cumulativeNSAccDS2 << cumulativeNSAccDS3 << cumulativeNSAccDS4 ;
-    *NSDriftLossSet << cumulativeNSDriftDS1 << cumulativeNSDriftDS2 << cumulativeNSDriftDS3 << cumulativeNSDriftDS4;
+            if(buildingFeature)
+                buildingFeature->attributes()->replaceAttribute(fields.at(j), values.at(j));
+        }
 
-    this->createLossesChart(structLossSet, NSAccLossSet, NSDriftLossSet);
+        if(buildingFeature)
+            buildingFeature->featureTable()->updateFeature(buildingFeature);
+    }
 
-    auto sumStruct = structLossSet->sum();
-    auto sumNonStruct = NSAccLossSet->sum() + NSDriftLossSet->sum();
+    for(int g = 0; g<DMsummary.groups.size(); ++g)
+        this->addResultColumn("Expected Damage State " + DMsummary.groups.at(g).name, DMsummary.IDs, DMsummary.expectedDamageStates.at(g));
 
-    auto sumLosses = sumStruct + sumNonStruct;
-    totalLossValueLabel->setText(QString::number(sumLosses));
+    damageStateChartWidget->setData(DMResults, DMsummary, DMAttributeNames, DMAttributeColumns);
 
-    structLossValueLabel->setText(QString::number(sumStruct));
-    nonStructLossValueLabel->setText(QString::number(sumNonStruct));
+    return 0;
+}
 
-    // Repair time
-    totalRepairTimeValueLabel->setText(QString::number(cumulativeRepairTime));
 
-    this->createHistogramChart(&theProbDist);
+void PelicunPostProcessor::addResultColumn(const QString& name, const QVector<int>& IDs, const QVector<double>& values)
+{
+    QVector<double> alignedValues(DVdata.numRows(), std::numeric_limits<double>::quiet_NaN());
 
-    if(theProbDist.getNumberSamples() < 2)
-        lossesRFDiagram->setProperty("ToPlot",false);
-    else
-        lossesRFDiagram->setProperty("ToPlot",true);
+    for(int i = 0; i<IDs.size(); ++i)
+    {
+        auto row = DVdata.findRow(IDs.at(i));
 
-    // Set a default size to the charts
-    chartsDock1->setWidget(casualtiesChartView);
-    chartsDock2->setWidget(lossesChartView);
-    chartsDock3->setWidget(lossesRFDiagram);
+        if(row != -1)
+            alignedValues[row] = values.at(i);
+    }
 
-    return 0;
+    resultNames.append(name);
+    resultColumns.append(alignedValues);
 }
 
 
@@ -592,11 +1327,19 @@ int PelicunPostProcessor::createHistogramChart(REmpiricalProbabilityDistribution
     if(probDist->getNumberSamples() < 2)
     {
         xValues = probDist->getValues();
-        yValues.push_back(1.0);
+        yValues.fill(1.0, xValues.size());
+
+    }
+    else if(histogramTypeComboBox->currentIndex() == 3)
+    {
+        auto bandwidth = bandwidthSpinBox->value()*probDist->getDefaultBandwidth();
 
+        probDist->getKernelDensity(bandwidth, xValues, yValues);
     }
     else
     {
+        probDist->setBinningRule(static_cast<REmpiricalProbabilityDistribution::BinningRule>(histogramTypeComboBox->currentIndex()));
+
         xValues = probDist->getHistogramTicks();
         yValues = probDist->getRelativeFrequencyDiagram();
     }
@@ -620,6 +1363,8 @@ int PelicunPostProcessor::createHistogramChart(REmpiricalProbabilityDistribution
         lossesRFDiagram->setRenderHint(QPainter::Antialiasing);
         lossesRFDiagram->setContentsMargins(0,0,0,0);
         lossesRFDiagram->setSizePolicy(QSizePolicy::Expanding,QSizePolicy::Expanding);
+
+        histogramWidget->layout()->addWidget(lossesRFDiagram);
     }
     else
     {
@@ -633,7 +1378,14 @@ int PelicunPostProcessor::createHistogramChart(REmpiricalProbabilityDistribution
 
     RFDiagChart->addSeries(series);
 
-    QValueAxis *axisX = new QValueAxis();
+    // The log-spaced bins are shown on a log scale
+    QAbstractAxis *axisX = nullptr;
+
+    if(probDist->getNumberSamples() >= 2 && histogramTypeComboBox->currentIndex() == REmpiricalProbabilityDistribution::Logarithmic)
+        axisX = new QLogValueAxis();
+    else
+        axisX = new QValueAxis();
+
     axisX->setGridLineVisible(false);
     axisX->setLabelsVisible(true);
     RFDiagChart->addAxis(axisX, Qt::AlignBottom);
@@ -644,6 +1396,69 @@ int PelicunPostProcessor::createHistogramChart(REmpiricalProbabilityDistribution
 }
 
 
+void PelicunPostProcessor::updateHistogramChart(void)
+{
+    bandwidthSpinBox->setEnabled(histogramTypeComboBox->currentIndex() == 3);
+
+    // Nothing to plot until the results are loaded
+    if(lossDistribution.getNumberSamples() == 0)
+        return;
+
+    this->createHistogramChart(&lossDistribution);
+}
+
+
+int PelicunPostProcessor::createExceedanceChart(const RealizationSummary& summary)
+{
+    QLineSeries *series = new QLineSeries();
+
+    for(int i = 0; i<summary.exceedanceLosses.size(); ++i)
+        series->append(summary.exceedanceLosses.at(i),summary.exceedanceProbabilities.at(i));
+
+    if(exceedanceChart == nullptr)
+    {
+        exceedanceChart = new QChart();
+        exceedanceChart->setDropShadowEnabled(false);
+        exceedanceChart->setMargins(QMargins(5,5,5,5));
+        exceedanceChart->layout()->setContentsMargins(0, 0, 0, 0);
+        exceedanceChart->legend()->setVisible(false);
+
+        exceedanceChartView = new QChartView(exceedanceChart);
+        exceedanceChartView->setRenderHint(QPainter::Antialiasing);
+        exceedanceChartView->setContentsMargins(0,0,0,0);
+        exceedanceChartView->setSizePolicy(QSizePolicy::Expanding,QSizePolicy::Expanding);
+    }
+    else
+    {
+        exceedanceChart->removeAllSeries();
+
+        auto axes = exceedanceChart->axes();
+
+        for(auto&& it : axes)
+            exceedanceChart->removeAxis(it);
+    }
+
+    exceedanceChart->addSeries(series);
+
+    QValueAxis *axisX = new QValueAxis();
+    axisX->setTitleText("Portfolio Loss");
+    axisX->setLabelsVisible(true);
+    exceedanceChart->addAxis(axisX, Qt::AlignBottom);
+    series->attachAxis(axisX);
+
+    // The probabilities span several orders of magnitude
+    QLogValueAxis *axisY = new QLogValueAxis();
+    axisY->setTitleText("Probability of Exceedance");
+    axisY->setLabelFormat("%.0e");
+    axisY->setBase(10.0);
+    axisY->setMinorTickCount(-1);
+    exceedanceChart->addAxis(axisY, Qt::AlignLeft);
+    series->attachAxis(axisY);
+
+    return 0;
+}
+
+
 int PelicunPostProcessor::createLossesChart(QBarSet *structLossSet, QBarSet *NSAccLossSet, QBarSet *NSDriftLossSet)
 {
     QStackedBarSeries *series = new QStackedBarSeries();
@@ -699,6 +1514,10 @@ int PelicunPostProcessor::createLossesChart(QBarSet *structLossSet, QBarSet *NSA
 
 int PelicunPostProcessor::printToPDF(const QString& outputPath)
 {
+    // Only one report is written at a time
+    if(reportWatcher->isRunning())
+        return 1;
+
     outputFilePath = outputPath;
 
     theVisualizationWidget->takeScreenShot();
@@ -713,346 +1532,163 @@ void PelicunPostProcessor::processResultsSubset(const std::set<int>& selectedCom
     if(selectedComponentIDs.empty())
         return;
 
-    if(DVdata.size() < numHeaderRows)
+    if(DVdata.isEmpty())
     {
         QString msg = "No results to import!";
         throw msg;
     }
 
-    if(DVdata.at(numHeaderRows).isEmpty() || DVdata.last().isEmpty())
-    {
-        QString msg = "No values in the cells";
-        throw msg;
-    }
-
-    auto firstID = objectToInt(DVdata.at(numHeaderRows).at(0));
+    // Gather the rows of the selection through the ID index
+    QVector<int> selectedIDs(selectedComponentIDs.begin(), selectedComponentIDs.end());
+    QVector<int> missingIDs;
 
-    auto lastID = objectToInt(DVdata.last().at(0));
+    auto subsetRows = DVdata.findRows(selectedIDs, missingIDs);
 
-    QVector<QStringList> DVsubset(&DVdata[0],&DVdata[numHeaderRows]);
-
-    for(auto&& id : selectedComponentIDs)
+    if(!missingIDs.isEmpty())
     {
-        // Check that the ID falls within the bounds of the data
-        if(id<firstID || id>lastID)
-        {
-            QString msg = "ID " + QString::number(id) + " is out of bounds of the results";
-            throw msg;
-        }
+        QString msg = "ID " + QString::number(missingIDs.first()) + " cannot be found in the results";
+        throw msg;
+    }
 
-        auto found = false;
-        for(int i = numHeaderRows; i<DVdata.size(); ++i)
-        {
-            auto inputRow = DVdata.at(i);
+    // Only the totals are recomputed, the table and the map keep the results of all of the assets
+    DVResultsAggregator theAggregator(DVResultsAggregator::hasNSLosses(DVdata));
 
-            auto buildingID = objectToInt(inputRow.at(0));
+    auto totals = theAggregator.compute(DVdata, subsetRows);
 
-            if(id == buildingID)
-            {
-                DVsubset << inputRow;
-                found = true;
-                break;
-            }
-        }
+    if(!totals.errMsg.isEmpty())
+        throw totals.errMsg;
 
-        if(!found)
-        {
-            QString msg = "ID " + QString::number(id) + " cannot be found in the results";
-            throw msg;
-        }
-    }
+    this->displayTotals(totals);
 
-    this->processDVResults(DVsubset);
+    this->displayConfidenceIntervals(DVdata, subsetRows);
 }
 
 
 int PelicunPostProcessor::assemblePDF(QImage screenShot)
 {
-    // The printer
-    QPrinter printer(QPrinter::HighResolution);
-    printer.setOutputFormat(QPrinter::PdfFormat);
-    printer.setPaperSize(QPrinter::Letter);
-    printer.setPageMargins(25.4, 25.4, 25.4, 25.4, QPrinter::Millimeter);
-    printer.setFullPage(true);
-    qreal leftMargin, topMargin;
-    printer.getPageMargins(&leftMargin,&topMargin,nullptr,nullptr,QPrinter::Point);
-    printer.setOutputFileName(outputFilePath);
-
-    // Create a new document
-    QTextDocument* document = new QTextDocument();
-    QTextCursor cursor(document);
-    document->setDocumentMargin(25.4);
-    document->setDefaultFont(QFont("Helvetica"));
-
-    // Define font styles
-    QTextCharFormat normalFormat;
-    normalFormat.setFontWeight(QFont::Normal);
-
-    QTextCharFormat titleFormat;
-    titleFormat.setFontWeight(QFont::Bold);
-    titleFormat.setFontCapitalization(QFont::AllUppercase);
-    titleFormat.setFontPointSize(normalFormat.fontPointSize() * 2.0);
-
-    QTextCharFormat captionFormat;
-    captionFormat.setFontWeight(QFont::Light);
-    captionFormat.setFontPointSize(normalFormat.fontPointSize() / 2.0);
-    captionFormat.setFontItalic(true);
+    // Everything that depends on the widgets is gathered here on the UI thread, the report is then written on a worker thread
+    PDFReportContents contents;
 
-    QTextCharFormat boldFormat;
-    boldFormat.setFontWeight(QFont::Bold);
-
-    QFontMetrics normMetrics(normalFormat.font());
-    auto lineSpacing = normMetrics.lineSpacing();
-
-    // Define alignment formats
-    QTextBlockFormat alignCenter;
-    alignCenter.setLineHeight(lineSpacing, QTextBlockFormat::LineDistanceHeight) ;
-    alignCenter.setAlignment(Qt::AlignCenter);
-
-    QTextBlockFormat alignLeft;
-    alignLeft.setAlignment(Qt::AlignLeft);
-    alignLeft.setLineHeight(lineSpacing, QTextBlockFormat::LineDistanceHeight) ;
-
-    cursor.movePosition(QTextCursor::Start);
-
-    cursor.insertBlock(alignCenter);
-
-    // Insert the simcenter logo at the top
-    QImage simCenterLogo(":resources/SimCenter@1x.png");
-    document->addResource(QTextDocument::ImageResource, QUrl("Logo"), simCenterLogo);
-    QTextImageFormat imageFormatSimCenterLogo;
-    imageFormatSimCenterLogo.setName("Logo");
-    imageFormatSimCenterLogo.setWidth(250);
-    imageFormatSimCenterLogo.setQuality(600);
-
-    cursor.insertImage(imageFormatSimCenterLogo);
-
-    cursor.insertText("\nRegional Resilience Determination (R2D) Tool\n",titleFormat);
-
-    cursor.insertText("Results Summary\n",boldFormat);
-
-    cursor.setBlockFormat(alignLeft);
-
-    cursor.insertText("Employing Pelicun loss methodology to calculate seismic losses.\n",normalFormat);
-
-    QString currentDT = "Timestamp: " + QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss") + "\n";
-    cursor.insertText(currentDT,normalFormat);
+    contents.outputFilePath = outputFilePath;
 
     auto workflowApp = WorkflowAppR2D::getInstance();
-    auto analysisName = workflowApp->getGeneralInformationWidget()->getAnalysisName();
+    contents.analysisName = workflowApp->getGeneralInformationWidget()->getAnalysisName();
 
-    QString analysisNameLabel = "Analysis name: " + analysisName + "\n";
-    cursor.insertText(analysisNameLabel,normalFormat);
+    contents.totals.push_back({totalCasLabel->text(), totalCasValueLabel->text(), totalFatalitiesLabel->text(), totalFatalitiesValueLabel->text()});
+    contents.totals.push_back({totalLossLabel->text(), totalLossValueLabel->text(), totalRepairTimeLabel->text(), totalRepairTimeValueLabel->text()});
+    contents.totals.push_back({structLossLabel->text(), structLossValueLabel->text(), nonStructLossLabel->text(), nonStructLossValueLabel->text()});
 
-    cursor.insertText("Estimated Regional Totals\n",boldFormat);
+    // The confidence intervals are in a fourth row if they were computed
+    if(!lossCIValueLabel->text().isEmpty())
+        contents.totals.push_back({lossCILabel->text(), lossCIValueLabel->text(), fatalitiesCILabel->text(), fatalitiesCIValueLabel->text()});
 
-    QTextTableFormat tableFormat;
-    tableFormat.setPadding(5.0);
-    tableFormat.setCellPadding(5.0);
-    tableFormat.setBorder(0.0);
-    tableFormat.setAlignment(Qt::AlignVCenter);
+    contents.mapImage = screenShot;
+    contents.mapRect = QRect(0, mapViewMainWidget->height() - mapViewSubWidget->height(), mapViewSubWidget->width(), mapViewSubWidget->height());
 
-    tableFormat.setBackground(QColor("#f0f0f0"));
-    QVector<QTextLength> constraints;
-    constraints << QTextLength(QTextLength::PercentageLength, 25);
-    constraints << QTextLength(QTextLength::PercentageLength, 25);
-    constraints << QTextLength(QTextLength::PercentageLength, 25);
-    constraints << QTextLength(QTextLength::PercentageLength, 25);
-    tableFormat.setColumnWidthConstraints(constraints);
-
-    // rows, columns, tableFormat
-    QTextTable *table = cursor.insertTable(3, 4, tableFormat);
-
-    {
-        QTextTableCell cell = table->cellAt(0, 0);
-        cell.setFormat(normalFormat);
-        QTextCursor cellCursor = cell.firstCursorPosition();
-        cellCursor.insertText(totalCasLabel->text());
-    }
+    contents.figures.push_back({this->renderChart(casualtiesChartView), "Estimated casualties.", 400});
+    contents.figures.push_back({this->renderChart(lossesChartView), "Estimated economic losses.", 400});
 
-    {
-        QTextTableCell cell = table->cellAt(0, 1);
-        cell.setFormat(normalFormat);
-        QTextCursor cellCursor = cell.firstCursorPosition();
-        cellCursor.insertText(totalCasValueLabel->text());
-    }
+    if(lossesRFDiagram->property("ToPlot").toBool())
+        contents.figures.push_back({this->renderChart(lossesRFDiagram), "Relative frequency diagram of expected losses.", 400});
 
-    {
-        QTextTableCell cell = table->cellAt(0, 2);
-        cell.setFormat(normalFormat);
-        QTextCursor cellCursor = cell.firstCursorPosition();
-        cellCursor.insertText(totalFatalitiesLabel->text());
-    }
+    if(exceedanceChartView != nullptr && !realizationSummaries.isEmpty())
+        contents.figures.push_back({this->renderChart(exceedanceChartView), "Exceedance probability of the portfolio losses.", 400});
 
-    {
-        QTextTableCell cell = table->cellAt(0, 3);
-        cell.setFormat(normalFormat);
-        QTextCursor cellCursor = cell.firstCursorPosition();
-        cellCursor.insertText(totalFatalitiesValueLabel->text());
-    }
+    // The rows of the table in the order that is shown, up to the maximum number of rows in the report
+    contents.tableTitle = "Individual Asset Results - Sorted According to the " + sortComboBox->currentText();
 
-    {
-        QTextTableCell cell = table->cellAt(1, 0);
-        cell.setFormat(normalFormat);
-        QTextCursor cellCursor = cell.firstCursorPosition();
-        cellCursor.insertText(totalLossLabel->text());
-    }
+    auto numCols = resultsTableModel->columnCount();
 
-    {
-        QTextTableCell cell = table->cellAt(1, 1);
-        cell.setFormat(normalFormat);
-        QTextCursor cellCursor = cell.firstCursorPosition();
-        cellCursor.insertText(totalLossValueLabel->text());
-    }
+    for(int j = 0; j<numCols; ++j)
+        contents.tableHeaders.append(resultsTableModel->headerData(j, Qt::Horizontal).toString());
 
-    {
-        QTextTableCell cell = table->cellAt(1, 2);
-        cell.setFormat(normalFormat);
-        QTextCursor cellCursor = cell.firstCursorPosition();
-        cellCursor.insertText(totalRepairTimeLabel->text());
-    }
+    contents.numAssets = resultsTableModel->rowCount();
 
-    {
-        QTextTableCell cell = table->cellAt(1, 3);
-        cell.setFormat(normalFormat);
-        QTextCursor cellCursor = cell.firstCursorPosition();
-        cellCursor.insertText(totalRepairTimeValueLabel->text());
-    }
+    auto numRows = std::min(contents.numAssets, reportWriter->getMaxTableRows());
 
-    {
-        QTextTableCell cell = table->cellAt(2, 0);
-        cell.setFormat(normalFormat);
-        QTextCursor cellCursor = cell.firstCursorPosition();
-        cellCursor.insertText(structLossLabel->text());
-    }
+    contents.tableRows.reserve(numRows);
 
+    for(int i = 0; i<numRows; ++i)
     {
-        QTextTableCell cell = table->cellAt(2, 1);
-        cell.setFormat(normalFormat);
-        QTextCursor cellCursor = cell.firstCursorPosition();
-        cellCursor.insertText(structLossValueLabel->text());
-    }
+        QStringList row;
 
-    {
-        QTextTableCell cell = table->cellAt(2, 2);
-        cell.setFormat(normalFormat);
-        QTextCursor cellCursor = cell.firstCursorPosition();
-        cellCursor.insertText(nonStructLossLabel->text());
-    }
+        for(int j = 0; j<numCols; ++j)
+            row.append(resultsTableModel->data(resultsTableModel->index(i, j)).toString());
 
-    {
-        QTextTableCell cell = table->cellAt(2, 3);
-        cell.setFormat(normalFormat);
-        QTextCursor cellCursor = cell.firstCursorPosition();
-        cellCursor.insertText(nonStructLossValueLabel->text());
+        contents.tableRows.push_back(row);
     }
 
-    cursor.movePosition( QTextCursor::End );
-
-    cursor.insertText("\n\n",normalFormat);
-
-    // Ratio of the page width that is printable
-    auto useablePageWidth = printer.pageRect(QPrinter::Point).width()-(1.5*leftMargin);
-
-    QRect viewPortRect(0, mapViewMainWidget->height() - mapViewSubWidget->height(), mapViewSubWidget->width(), mapViewSubWidget->height());
-    QImage cropped = screenShot.copy(viewPortRect);
-    document->addResource(QTextDocument::ImageResource,QUrl("Figure1"),cropped);
-    QTextImageFormat imageFormatFig1;
-    imageFormatFig1.setName("Figure1");
-    imageFormatFig1.setQuality(600);
-    imageFormatFig1.setWidth(useablePageWidth);
+    reportProgressDialog = new QProgressDialog("Writing the PDF report...", "Cancel", 0, 100, this);
+    reportProgressDialog->setWindowTitle("PDF Report");
+    reportProgressDialog->setMinimumDuration(0);
+    reportProgressDialog->setAutoClose(false);
+    reportProgressDialog->setAutoReset(false);
+    reportProgressDialog->setAttribute(Qt::WA_DeleteOnClose);
 
-    cursor.setBlockFormat(alignCenter);
+    connect(reportWriter, &PDFReportWriter::progressChanged, reportProgressDialog, &QProgressDialog::setValue);
+    connect(reportProgressDialog, &QProgressDialog::canceled, reportWriter, &PDFReportWriter::cancel);
 
-    cursor.insertImage(imageFormatFig1);
+    reportWriter->resetCancel();
 
-    cursor.insertText("Regional map visualization.\n",captionFormat);
+    auto writer = reportWriter;
 
-    auto origSize = casualtiesChartView->size();
-
-    casualtiesChartView->resize(QSize(640,480));
+    reportWatcher->setFuture(QtConcurrent::run([writer, contents]()
+    {
+        QString errMsg;
+        writer->write(contents, errMsg);
 
-    casualtiesChartView->setVisible(true);
-    auto rectFig2 = casualtiesChartView->viewport()->rect();
-    QPixmap pixmapFig2(rectFig2.size());
-    QPainter painterFig2(&pixmapFig2);
-    painterFig2.setRenderHints(QPainter::Antialiasing | QPainter::SmoothPixmapTransform);
-    casualtiesChartView->render(&painterFig2, pixmapFig2.rect(), rectFig2);
-    auto figure2 = pixmapFig2.toImage();
+        return errMsg;
+    }));
 
-    casualtiesChartView->resize(origSize);
+    emit reportRunningChanged(true);
 
-    QTextImageFormat imageFormatFig2;
-    imageFormatFig2.setName("Figure2");
-    imageFormatFig2.setQuality(600);
-    imageFormatFig2.setWidth(400);
+    return 0;
+}
 
-    document->addResource(QTextDocument::ImageResource,QUrl("Figure2"),figure2);
 
-    cursor.insertImage(imageFormatFig2,QTextFrameFormat::InFlow);
+void PelicunPostProcessor::handleReportFinished(void)
+{
+    if(reportProgressDialog)
+        reportProgressDialog->close();
 
-    cursor.insertText("\nEstimated casualties.\n",captionFormat);
+    emit reportRunningChanged(false);
 
-    auto origSize2 = lossesChartView->size();
-    lossesChartView->resize(QSize(640,480));
-    auto rectFig3 = lossesChartView->viewport()->rect();
-    QPixmap pixmapFig3(rectFig3.size());
-    QPainter painterFig3(&pixmapFig3);
-    painterFig3.setRenderHints(QPainter::Antialiasing | QPainter::SmoothPixmapTransform);
-    lossesChartView->render(&painterFig3, pixmapFig3.rect(), rectFig3);
-    auto figure3 = pixmapFig3.toImage();
-    lossesChartView->resize(origSize2);
+    auto errMsg = reportWatcher->result();
 
-    QTextImageFormat imageFormatFig3;
-    imageFormatFig3.setName("Figure3");
-    imageFormatFig3.setQuality(600);
-    imageFormatFig3.setWidth(400);
+    if(!errMsg.isEmpty())
+        WorkflowAppR2D::getInstance()->errorMessage(errMsg);
+}
 
-    document->addResource(QTextDocument::ImageResource,QUrl("Figure3"),figure3);
-    cursor.insertImage(imageFormatFig3,QTextFrameFormat::InFlow);
 
-    cursor.insertText("\nEstimated economic losses.\n",captionFormat);
+QImage PelicunPostProcessor::renderChart(QChartView* chartView)
+{
+    // Render at a fixed size so that the figures in the report do not depend on the size of the docks
+    auto origSize = chartView->size();
+    chartView->resize(QSize(640,480));
 
-    if(lossesRFDiagram->property("ToPlot").toBool())
-    {
-        auto origSize3 = lossesRFDiagram->size();
-        lossesRFDiagram->resize(QSize(640,480));
-        auto rectFig4 = lossesRFDiagram->viewport()->rect();
-        QPixmap pixmapFig4(rectFig4.size());
-        QPainter painterFig4(&pixmapFig4);
-        painterFig4.setRenderHints(QPainter::Antialiasing | QPainter::SmoothPixmapTransform);
-        lossesRFDiagram->render(&painterFig4, pixmapFig4.rect(), rectFig4);
-        auto figure4 = pixmapFig4.toImage();
-        lossesRFDiagram->resize(origSize3);
-
-        QTextImageFormat imageFormatFig4;
-        imageFormatFig4.setName("Figure4");
-        imageFormatFig4.setQuality(600);
-        imageFormatFig4.setWidth(400);
-
-        document->addResource(QTextDocument::ImageResource,QUrl("Figure4"),figure4);
-        cursor.insertImage(imageFormatFig4,QTextFrameFormat::InFlow);
-
-        cursor.insertText("\nRelative frequency diagram of expected losses.\n",captionFormat);
-    }
+    auto rect = chartView->viewport()->rect();
 
-    cursor.insertText("Individual Asset Results - Sorted According to the " + sortComboBox->currentText() + "\n",boldFormat);
+    QImage image(rect.size(), QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::white);
 
-    TablePrinter prettyTablePrinter;
-    prettyTablePrinter.printToTable(&cursor, pelicunResultsTableWidget,"Asset Results");
+    QPainter painter(&image);
+    painter.setRenderHints(QPainter::Antialiasing);
+    chartView->render(&painter, image.rect(), rect);
+    painter.end();
 
-    document->print(&printer);
+    chartView->resize(origSize);
 
-    return 0;
+    return image;
 }
 
 
 void PelicunPostProcessor::sortTable(int index)
 {
+    // The permutations are precomputed by the model so a sort only reorders the view
     if(index == 0)
-        pelicunResultsTableWidget->sortByColumn(index,Qt::AscendingOrder);
+        resultsTableModel->sort(index,Qt::AscendingOrder);
     else
-        pelicunResultsTableWidget->sortByColumn(index,Qt::DescendingOrder);
+        resultsTableModel->sort(index,Qt::DescendingOrder);
 
 }
 
@@ -1085,8 +1721,43 @@ void PelicunPostProcessor::clear(void)
     totalFatalitiesValueLabel->clear();
     structLossValueLabel->clear();
     nonStructLossValueLabel->clear();
+    lossStdDevValueLabel->clear();
+    lossQuantileValueLabel->clear();
+
+    lossVaRValueLabel->clear();
+    lossTVaRValueLabel->clear();
+
+    lossStdDevLabel->setVisible(false);
+    lossQuantileLabel->setVisible(false);
+    lossVaRLabel->setVisible(false);
+    lossTVaRLabel->setVisible(false);
+
+    this->clearConfidenceIntervals();
+
+    this->cancelRealizations();
+
+    realizationSummaries.clear();
+
+    lossRatios.clear();
+    runningTotals = DVResultsTotals();
+
+    EDPsummary = EDPSummary();
+    DMsummary = DMSummary();
+
+    resultNames.clear();
+    resultColumns.clear();
+    attributeNames.clear();
+    attributeColumns.clear();
+
+    lossDistribution = REmpiricalProbabilityDistribution();
+
+    resultsTableModel->clear();
+
+    spatialAggregationWidget->clear();
+
+    pivotTableWidget->clear();
 
-    pelicunResultsTableWidget->clear();
+    damageStateChartWidget->clear();
 
     sortComboBox->setCurrentIndex(0);
 }
@@ -38,24 +38,39 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 // Written by: Stevan Gavrilovic
 
+#include "BootstrapEngine.h"
 #include "ComponentDatabase.h"
+#include "DMResultsProcessor.h"
+#include "DVResultsAggregator.h"
+#include "EDPResultsProcessor.h"
+#include "REmpiricalProbabilityDistribution.h"
+#include "RealizationStreamReader.h"
 #include "ResultsMapViewWidget.h"
+#include "ResultsTable.h"
 
-#include <QString>
+#include <QFutureWatcher>
 #include <QMainWindow>
+#include <QPointer>
+#include <QString>
 
 #include <memory>
 #include <set>
 
-class REmpiricalProbabilityDistribution;
+class DamageStateChartWidget;
+class PDFReportWriter;
+class PivotTableWidget;
 class ResultsMapViewWidget;
+class ResultsTableModel;
+class SpatialAggregationWidget;
 class VisualizationWidget;
 
 class QDockWidget;
-class QTableWidget;
+class QTableView;
 class QGridLayout;
 class QLabel;
 class QComboBox;
+class QProgressDialog;
+class QDoubleSpinBox;
 
 namespace QtCharts
 {
@@ -81,9 +96,14 @@ class PelicunPostProcessor : public QMainWindow
 public:
 
     PelicunPostProcessor(QWidget *parent, VisualizationWidget* visWidget);
+    ~PelicunPostProcessor();
 
     void importResults(const QString& pathToResults);
 
+    // Adds the rows that were appended to the DV results while the workflow is running, only the new rows are written to the assets
+    void appendResults(const ResultsTable& newRows);
+
+    // Returns 1 without doing anything if a report is still being written
     int printToPDF(const QString& outputPath);
 
     // Function to convert a QString and QVariant to double
@@ -129,21 +149,117 @@ public:
 
     void setIsVisible(const bool value);
 
+    // Stops the summary of the realizations and waits for the worker thread, since it writes to the pending summary and reads the HDF5 files
+    void cancelRealizations(void);
+
+signals:
+
+    // Emitted when the writing of a PDF report starts and when it finishes
+    void reportRunningChanged(bool running);
+
 private slots:
 
     int assemblePDF(QImage screenShot);
 
+    void handleReportFinished(void);
+
+    // Shows the confidence intervals once the bootstrap of the current selection is finished
+    void handleIntervalsFinished(void);
+
+    // Writes the summary of a frame of realizations once it is finished and starts the next one
+    void handleRealizationsFinished(void);
+
     void sortTable(int index);
 
+    // Redraws the loss distribution chart when the binning or the bandwidth is changed
+    void updateHistogramChart(void);
+
     void restoreUI(void);
 
 private:
 
-    int processDVResults(const QVector<QStringList>& DVResults);
+    int processDVResults(const ResultsTable& DVResults);
+
+    // Writes the DV results of the given rows to the building database and the map, and computes their loss ratios
+    void updateAssets(const ResultsTable& DVResults, const QVector<int>& rows);
+
+    // Sets the results of all of the assets to the table, the spatial aggregation and the breakdown
+    void updateResultViews(const ResultsTable& DVResults);
+
+    // Passes the rows that changed after an append to the table, the spatial aggregation and the breakdown, the assets past the given number of rows are new
+    void appendResultViews(const ResultsTable& DVResults, const QVector<int>& rows, const int numRowsBefore);
+
+    // Sets the result names and columns from the DV results, the loss ratios must be up to date
+    void setResultColumns(const ResultsTable& DVResults);
+
+    int displayTotals(const DVResultsTotals& totals);
+
+    // Bootstraps the per asset results of the given rows, or of all of the rows if empty, on a worker thread, the confidence intervals of the totals are shown once it is finished
+    // A bootstrap that is still running for a previous selection is cancelled
+    int displayConfidenceIntervals(const ResultsTable& DVResults, const QVector<int>& rows = QVector<int>());
+
+    // Streams the results of every realization in the files on a worker thread, one frame at a time, with a progress dialog that can cancel it
+    // The per asset summaries are written to the building database as each frame is finished
+    void processRealizations(const QStringList& pathsToFiles);
+
+    // Starts the summary of the next frame of realizations, or closes the progress dialog if there are none left
+    void summarizeNextRealizations(void);
+
+    // Writes the per asset summaries to the building database and shows the statistics of the portfolio losses
+    int applyRealizationSummary(const RealizationSummary& summary, const QString& name);
+
+    // Writes the peak demands of each asset to the building database and adds them to the results
+    int processEDPResults(const ResultsTable& EDPResults);
+
+    // Writes the expected damage state of each asset to the building database and shows the damage states of each class of assets
+    int processDMResults(const ResultsTable& DMResults);
+
+    // Loads the results from the csv file if there is one, otherwise from the HDF5 file that starts with the prefix, returns false if there are neither
+    bool loadResultsTable(const QString& pathToResults, const QString& csvFile, const QStringList& hdfFiles, const QString& prefix, const int headerRows, ResultsTable& table);
+
+    // Adds a per asset result to the spatial aggregation and the breakdown, the values are aligned with the DV results by the asset IDs
+    void addResultColumn(const QString& name, const QVector<int>& IDs, const QVector<double>& values);
 
-    QVector<QStringList> DMdata;
-    QVector<QStringList> DVdata;
-    QVector<QStringList> EDPdata;
+    ResultsTable DMdata;
+    ResultsTable DVdata;
+    ResultsTable EDPdata;
+
+    // The loss ratio of each asset in the order of the DV results
+    QVector<double> lossRatios;
+
+    // The regional totals of the rows that were processed so far, new rows are merged into the totals while the workflow is running
+    DVResultsTotals runningTotals;
+
+    EDPSummary EDPsummary;
+    DMSummary DMsummary;
+
+    // The per asset results and attributes in the order of the DV results, shared by the spatial aggregation and the breakdown
+    QStringList resultNames;
+    QVector<QVector<double>> resultColumns;
+    QStringList attributeNames;
+    QVector<QStringList> attributeColumns;
+
+    QVector<RealizationSummary> realizationSummaries;
+
+    // A frame of realizations that is summarized, and the name of its summary columns
+    struct RealizationJob
+    {
+        QString pathToFile;
+        QString key;
+        QString name;
+    };
+
+    // The frames that are left to summarize, the first one is on the worker thread
+    QVector<RealizationJob> realizationJobs;
+    int numRealizationJobsDone;
+
+    RealizationStreamReader* realizationReader;
+    QFutureWatcher<int>* realizationsWatcher;
+    QPointer<QProgressDialog> realizationsProgressDialog;
+
+    // Written by the worker thread
+    RealizationSummary pendingSummary;
+    QString realizationsErrMsg;
 
     QString outputFilePath;
 
@@ -161,19 +277,52 @@ private:
     QLabel* totalFatalitiesValueLabel;
     QLabel* structLossValueLabel;
     QLabel* nonStructLossValueLabel;
+    QLabel* lossStdDevLabel;
+    QLabel* lossQuantileLabel;
+    QLabel* lossStdDevValueLabel;
+    QLabel* lossQuantileValueLabel;
+    QLabel* lossVaRLabel;
+    QLabel* lossTVaRLabel;
+    QLabel* lossVaRValueLabel;
+    QLabel* lossTVaRValueLabel;
+    QLabel* lossCILabel;
+    QLabel* fatalitiesCILabel;
+    QLabel* lossCIValueLabel;
+    QLabel* fatalitiesCIValueLabel;
 
     QWidget *tableWidget;
 
-    QTableWidget* pelicunResultsTableWidget;
+    QTableView* pelicunResultsTableView;
+
+    ResultsTableModel* resultsTableModel;
+
+    // Aggregates the per asset results to grid cells or to the polygons of a layer
+    SpatialAggregationWidget* spatialAggregationWidget;
+
+    // Breakdown of the results by the attributes of the assets
+    PivotTableWidget* pivotTableWidget;
+
+    // The distribution of the damage states in each class of assets
+    DamageStateChartWidget* damageStateChartWidget;
+    QDockWidget* damageStateDock;
 
     QDockWidget* chartsDock1;
     QDockWidget* chartsDock2;
     QDockWidget* chartsDock3;
+    QDockWidget* chartsDock4;
 
     VisualizationWidget* theVisualizationWidget;
 
     QComboBox* sortComboBox;
 
+    // The loss distribution chart with the controls of the binning rule and the kernel density bandwidth
+    QWidget* histogramWidget;
+    QComboBox* histogramTypeComboBox;
+    QDoubleSpinBox* bandwidthSpinBox;
+
+    // Distribution of the repair costs of the assets in the last results, kept so that the chart can be redrawn
+    REmpiricalProbabilityDistribution lossDistribution;
+
     std::unique_ptr<ResultsMapViewWidget> mapViewSubWidget;
     Esri::ArcGISRuntime::MapGraphicsView* mapViewMainWidget;
 
@@ -185,12 +334,32 @@ private:
     QtCharts::QChartView *lossesChartView;
     QtCharts::QChartView *lossesRFDiagram;
 
+    // Exceedance probability curve of the portfolio losses over the realizations
+    QtCharts::QChart *exceedanceChart;
+    QtCharts::QChartView *exceedanceChartView;
+
     int createHistogramChart(REmpiricalProbabilityDistribution* probDist);
 
     int createLossesChart(QtCharts::QBarSet *structLossSet, QtCharts::QBarSet *NSAccLossSet, QtCharts::QBarSet *NSDriftLossSet);
 
     int createCasualtiesChart(QtCharts::QBarSet *casualtiesSet);
 
+    int createExceedanceChart(const RealizationSummary& summary);
+
+    // Renders a chart into an image for the report
+    QImage renderChart(QtCharts::QChartView* chartView);
+
+    // The bootstrap of the confidence intervals of the totals runs on a worker thread
+    BootstrapEngine theBootstrap;
+    QFutureWatcher<QVector<BootstrapInterval>>* intervalsWatcher;
+
+    // Hides the confidence intervals, and cancels a bootstrap that is still running
+    void clearConfidenceIntervals(void);
+
+    PDFReportWriter* reportWriter;
+    QFutureWatcher<QString>* reportWatcher;
+    QPointer<QProgressDialog> reportProgressDialog;
+
     QVector<Component> buildingsVec;
 
     QByteArray uiState;
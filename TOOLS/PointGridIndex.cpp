@@ -0,0 +1,216 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "PointGridIndex.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+PointGridIndex::PointGridIndex()
+{
+    this->clear();
+}
+
+
+void PointGridIndex::build(const QVector<QPointF>& pts)
+{
+    this->clear();
+
+    points = pts;
+
+    auto numPoints = points.size();
+
+    if(numPoints == 0)
+        return;
+
+    auto minX = std::numeric_limits<double>::max();
+    auto maxX = std::numeric_limits<double>::lowest();
+    auto minY = minX;
+    auto maxY = maxX;
+
+    // Points without a valid location are kept out of the cells and are never returned
+    for(auto&& it : points)
+    {
+        if(!std::isfinite(it.x()) || !std::isfinite(it.y()))
+            continue;
+
+        minX = std::min(minX, it.x());
+        maxX = std::max(maxX, it.x());
+        minY = std::min(minY, it.y());
+        maxY = std::max(maxY, it.y());
+    }
+
+    if(minX > maxX)
+    {
+        this->clear();
+        return;
+    }
+
+    bounds = QRectF(QPointF(minX, minY), QPointF(maxX, maxY));
+
+    // About four points per cell, the cells are square in the units of the points where possible
+    auto numCells = std::max(1, numPoints/4);
+
+    auto width = std::max(maxX - minX, 1.0e-12);
+    auto height = std::max(maxY - minY, 1.0e-12);
+
+    auto cellSize = std::sqrt(width*height/numCells);
+
+    numColumns = std::min(std::max(1, static_cast<int>(std::ceil(width/cellSize))), 4096);
+    numRows = std::min(std::max(1, static_cast<int>(std::ceil(height/cellSize))), 4096);
+
+    cellWidth = width/numColumns;
+    cellHeight = height/numRows;
+
+    // Counting sort of the points into the cells
+    QVector<int> cellOfPoint(numPoints);
+
+    cellStart.fill(0, numColumns*numRows + 1);
+
+    for(int i = 0; i<numPoints; ++i)
+    {
+        const auto& point = points.at(i);
+
+        if(!std::isfinite(point.x()) || !std::isfinite(point.y()))
+        {
+            cellOfPoint[i] = -1;
+            continue;
+        }
+
+        auto cell = this->cellRow(point.y())*numColumns + this->cellColumn(point.x());
+
+        cellOfPoint[i] = cell;
+
+        ++cellStart[cell+1];
+    }
+
+    for(int k = 0; k<numColumns*numRows; ++k)
+        cellStart[k+1] += cellStart[k];
+
+    pointIndices.resize(cellStart.last());
+
+    auto next = cellStart;
+
+    for(int i = 0; i<numPoints; ++i)
+    {
+        if(cellOfPoint.at(i) >= 0)
+            pointIndices[next[cellOfPoint.at(i)]++] = i;
+    }
+}
+
+
+void PointGridIndex::clear(void)
+{
+    points.clear();
+    bounds = QRectF();
+    numColumns = 0;
+    numRows = 0;
+    cellWidth = 0.0;
+    cellHeight = 0.0;
+    cellStart.clear();
+    pointIndices.clear();
+}
+
+
+QVector<int> PointGridIndex::query(const QRectF& rect) const
+{
+    QVector<int> result;
+
+    if(points.isEmpty())
+        return result;
+
+    auto minX = std::max(rect.left(), bounds.left());
+    auto maxX = std::min(rect.right(), bounds.right());
+    auto minY = std::max(rect.top(), bounds.top());
+    auto maxY = std::min(rect.bottom(), bounds.bottom());
+
+    if(minX > maxX || minY > maxY)
+        return result;
+
+    auto firstColumn = this->cellColumn(minX);
+    auto lastColumn = this->cellColumn(maxX);
+    auto firstRow = this->cellRow(minY);
+    auto lastRow = this->cellRow(maxY);
+
+    for(int row = firstRow; row<=lastRow; ++row)
+    {
+        for(int col = firstColumn; col<=lastColumn; ++col)
+        {
+            auto cell = row*numColumns + col;
+
+            for(int k = cellStart.at(cell); k<cellStart.at(cell+1); ++k)
+            {
+                auto i = pointIndices.at(k);
+
+                const auto& point = points.at(i);
+
+                if(point.x() >= minX && point.x() <= maxX && point.y() >= minY && point.y() <= maxY)
+                    result.push_back(i);
+            }
+        }
+    }
+
+    std::sort(result.begin(), result.end());
+
+    return result;
+}
+
+
+QRectF PointGridIndex::getBounds() const
+{
+    return bounds;
+}
+
+
+int PointGridIndex::getNumberOfPoints() const
+{
+    return points.size();
+}
+
+
+int PointGridIndex::cellColumn(const double x) const
+{
+    return std::min(std::max(static_cast<int>((x - bounds.left())/cellWidth), 0), numColumns - 1);
+}
+
+
+int PointGridIndex::cellRow(const double y) const
+{
+    return std::min(std::max(static_cast<int>((y - bounds.top())/cellHeight), 0), numRows - 1);
+}
@@ -0,0 +1,84 @@
+#ifndef POINTGRIDINDEX_H
+#define POINTGRIDINDEX_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include <QPointF>
+#include <QRectF>
+#include <QVector>
+
+// Spatial index of a set of points on a uniform grid
+// The points of each cell are stored contiguously, i.e., in compressed row format, so that a query only touches the cells that overlap its rectangle
+class PointGridIndex
+{
+public:
+    PointGridIndex();
+
+    // Builds the index, the grid is sized so that a cell holds a few points on average
+    void build(const QVector<QPointF>& points);
+
+    void clear(void);
+
+    // Returns the indices of the points that are inside of the rectangle, in ascending order
+    QVector<int> query(const QRectF& rect) const;
+
+    QRectF getBounds() const;
+
+    int getNumberOfPoints() const;
+
+private:
+
+    int cellColumn(const double x) const;
+    int cellRow(const double y) const;
+
+    QVector<QPointF> points;
+
+    QRectF bounds;
+
+    int numColumns;
+    int numRows;
+
+    double cellWidth;
+    double cellHeight;
+
+    // The points of cell k are pointIndices[cellStart[k]] to pointIndices[cellStart[k+1]-1]
+    QVector<int> cellStart;
+    QVector<int> pointIndices;
+};
+
+#endif // POINTGRIDINDEX_H
@@ -55,34 +55,108 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 *************************************************************************** */
 
+#include "FFT.h"
 #include "REmpiricalProbabilityDistribution.h"
 
 #include "QDebug"
 
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
 REmpiricalProbabilityDistribution::REmpiricalProbabilityDistribution(QString objectName) : name(objectName)
 {
     numBins = 60;
+    histogramNumBins = numBins;
+    binningRule = MeanStdDev;
     n = 0;
+    sortedValuesValid = false;
     histogramMin = 0.0;
     histogramMax = 0.0;
     histogramHeight = 0.0;
     histPlotHeight = 0.0;
     histogramArea = 0.0;
     binSize = 0.0;
-    parameterSum = 0.0;
-    parameterSquaredSum = 0.0;
-    max = 0.0;
-    min = 0.0;
+    meanVal = 0.0;
+    M2 = 0.0;
+    sum = 0.0;
+    sumCompensation = 0.0;
+    max = -std::numeric_limits<double>::infinity();
+    min = std::numeric_limits<double>::infinity();
+}
+
+
+template <typename F>
+QVector<double> REmpiricalProbabilityDistribution::accumulateSamples(const int numEntries, F addSample) const
+{
+    // The samples are split into chunks that are accumulated on separate threads, the results of the chunks are then summed in order
+    const int chunkSize = 65536;
+
+    QVector<int> chunks;
+    for(int i = 0; i<values.size(); i += chunkSize)
+        chunks.push_back(i);
+
+    QVector<QVector<double>> chunkCounts(chunks.size(), QVector<double>(numEntries, 0.0));
+
+    // Each thread writes to its own counts, the vectors are detached up front
+    QVector<double*> chunkCountsData;
+    for(auto&& it : chunkCounts)
+        chunkCountsData.push_back(it.data());
+
+    const auto valuesData = values.constData();
+    const auto numValues = values.size();
+
+    QVector<int> chunkIndices;
+    for(int i = 0; i<chunks.size(); ++i)
+        chunkIndices.push_back(i);
+
+    QtConcurrent::blockingMap(chunkIndices, [&](const int chunk)
+    {
+        auto counts = chunkCountsData[chunk];
+
+        auto begin = chunks.at(chunk);
+        auto end = std::min(begin + chunkSize, numValues);
+
+        for(int j = begin; j<end; ++j)
+            addSample(valuesData[j], counts);
+    });
+
+    QVector<double> result(numEntries, 0.0);
+
+    for(auto&& counts : chunkCounts)
+    {
+        for(int k = 0; k<numEntries; ++k)
+            result[k] += counts.at(k);
+    }
+
+    return result;
 }
 
 
 void REmpiricalProbabilityDistribution::addSample(const double& val)
 {
+    // Non-finite samples, e.g., failed realizations, are dropped so that they do not enter the range, the moments, or the normalization
+    if(!std::isfinite(val))
+        return;
+
     values.push_back(val);
-    parameterSum += val;
-    parameterSquaredSum += val*val;
     ++n;
 
+    sortedValuesValid = false;
+
+    // Welford update of the mean and the sum of the squared differences
+    auto delta = val - meanVal;
+    meanVal += delta/static_cast<double>(n);
+    M2 += delta*(val - meanVal);
+
+    // Kahan summation
+    auto y = val - sumCompensation;
+    auto t = sum + y;
+    sumCompensation = (t - sum) - y;
+    sum = t;
+
     if(val > max)
         max = val;
 
@@ -91,11 +165,57 @@ void REmpiricalProbabilityDistribution::addSample(const double& val)
 }
 
 
-double REmpiricalProbabilityDistribution::mean(void)
+void REmpiricalProbabilityDistribution::addSamples(const QVector<double>& vals)
 {
-    auto num = static_cast<double>(n);
+    values.reserve(values.size() + vals.size());
+
+    for(auto&& it : vals)
+        this->addSample(it);
+}
+
+
+void REmpiricalProbabilityDistribution::merge(const REmpiricalProbabilityDistribution& other)
+{
+    if(other.n == 0)
+        return;
+
+    if(n == 0)
+    {
+        auto otherName = name;
+        *this = other;
+        name = otherName;
+        return;
+    }
+
+    // Combine the moments with the algorithm of Chan et al.
+    auto numA = static_cast<double>(n);
+    auto numB = static_cast<double>(other.n);
+    auto numTotal = numA + numB;
+
+    auto delta = other.meanVal - meanVal;
+
+    meanVal += delta*numB/numTotal;
+    M2 += other.M2 + delta*delta*numA*numB/numTotal;
 
-    return  parameterSum/num;
+    auto y = (other.sum - other.sumCompensation) - sumCompensation;
+    auto t = sum + y;
+    sumCompensation = (t - sum) - y;
+    sum = t;
+
+    n += other.n;
+
+    max = std::max(max, other.max);
+    min = std::min(min, other.min);
+
+    values.append(other.values);
+
+    sortedValuesValid = false;
+}
+
+
+double REmpiricalProbabilityDistribution::mean(void)
+{
+    return meanVal;
 }
 
 
@@ -105,11 +225,9 @@ double REmpiricalProbabilityDistribution::stdDev(void)
     if(n<=1)
         return 0.0;
 
-    double meanVal = this->mean();
-
     auto num = static_cast<double>(n);
 
-    return sqrt(1.0/(num-1.0) * (parameterSquaredSum - num * meanVal * meanVal));
+    return sqrt(M2/(num-1.0));
 }
 
 
@@ -128,7 +246,10 @@ QVector<double>  REmpiricalProbabilityDistribution::getRelativeFrequencyDiagram(
 
     auto theHistogram = this->updateHistogram();
 
-    auto factor = 1.0/histogramArea;
+    if(n < 1)
+        return theHistogram;
+
+    auto num = static_cast<double>(n);
 
     // Get sizes
     int vSize = theHistogram.size();
@@ -136,17 +257,14 @@ QVector<double>  REmpiricalProbabilityDistribution::getRelativeFrequencyDiagram(
     //resize the frequency diagram
     theFrequencyDiagram.resize(vSize);
 
-
-    // double area = 0.0;
+    // The bins can have different widths, e.g., log-spaced bins, so each bin is scaled by its own width
     for (int i=0; i<vSize; ++i)
     {
-        theFrequencyDiagram[i] = factor * theHistogram[i];
+        auto area = num*this->getBinWidth(i);
 
-        // area += theFrequencyDiagram[i] * binSize;
+        theFrequencyDiagram[i] = area > 0.0 ? theHistogram[i]/area : 0.0;
     }
 
-    // qDebug()<<"area"<<area;
-
     return theFrequencyDiagram;
 }
 
@@ -156,25 +274,149 @@ QVector<double>  REmpiricalProbabilityDistribution::getHistogramTicks(void)
 
     QVector<double> theHistogramTicks;
 
-    auto meanVal = this->mean();
+    this->updateHistogramRange();
+
+    theHistogramTicks.resize(histogramNumBins);
+
+    // Set bin ticks at the centers of the bins
+    for (int k=0; k<histogramNumBins; ++k)
+    {
+        if(binningRule == Logarithmic)
+            theHistogramTicks[k] = pow(10.0, log10(histogramMin) + (k + 0.5) * binSize);
+        else if(binningRule == FreedmanDiaconis)
+            theHistogramTicks[k] = histogramMin + (k + 0.5) * binSize;
+        else
+            theHistogramTicks[k] = histogramMin + k * binSize - 0.5 * binSize;
+    }
+
+    return theHistogramTicks;
+}
+
+
+double REmpiricalProbabilityDistribution::quantile(const double p)
+{
+    if(!std::isfinite(p))
+        return std::numeric_limits<double>::quiet_NaN();
+
+    // The samples are sorted once per change of the samples, so that the quartiles of the histogram and the bandwidth do not each select over all of the samples
+    if(!sortedValuesValid)
+    {
+        sortedValues.clear();
+        sortedValues.reserve(values.size());
+
+        for(auto&& it : values)
+        {
+            if(std::isfinite(it))
+                sortedValues.push_back(it);
+        }
+
+        std::sort(sortedValues.begin(), sortedValues.end());
+
+        sortedValuesValid = true;
+    }
+
+    auto numSorted = sortedValues.size();
+
+    if(numSorted < 1)
+        return 0.0;
+
+    auto pos = std::min(std::max(p, 0.0), 1.0)*static_cast<double>(numSorted - 1);
 
-    theHistogramTicks.resize(numBins);
+    auto lower = static_cast<int>(pos);
+
+    auto lowerVal = sortedValues.at(lower);
+
+    if(lower + 1 >= numSorted)
+        return lowerVal;
+
+    return lowerVal + (pos - lower)*(sortedValues.at(lower + 1) - lowerVal);
+}
+
+
+double REmpiricalProbabilityDistribution::getDefaultBandwidth(void)
+{
+    if(n < 2)
+        return 1.0;
 
     auto stdv = this->stdDev();
+    auto IQR = this->quantile(0.75) - this->quantile(0.25);
 
-    // Get size of histogram
-    histogramMin = meanVal - 5.0 * stdv;
-    histogramMax = meanVal + 5.0 * stdv;
-    binSize = (histogramMax - histogramMin) / numBins;
+    // The IQR is zero if more than half of the samples are the same, e.g., no loss
+    auto spread = IQR > 0.0 ? std::min(stdv, IQR/1.34) : stdv;
+
+    if(spread <= 0.0)
+        spread = fabs(meanVal) > 0.0 ? 0.01*fabs(meanVal) : 1.0;
+
+    return 0.9*spread*pow(static_cast<double>(n), -0.2);
+}
+
+
+int REmpiricalProbabilityDistribution::getKernelDensity(const double bandwidth, QVector<double>& xValues, QVector<double>& yValues, const int numPoints)
+{
+    if(n < 1 || bandwidth <= 0.0 || numPoints < 2)
+        return -1;
+
+    auto gridMin = min - 3.0*bandwidth;
+    auto gridMax = max + 3.0*bandwidth;
+
+    auto delta = (gridMax - gridMin)/static_cast<double>(numPoints - 1);
+    auto invDelta = 1.0/delta;
 
-    // Set bin ticks
-    for (int k=0; k<numBins; ++k)
+    // Linear binning, each sample is split between the two grid points on either side of it
+    auto gridWeights = this->accumulateSamples(numPoints, [=](const double x, double* weights)
     {
+        auto pos = (x - gridMin)*invDelta;
+
+        // The check in double also rejects NaN and infinite samples before the cast
+        if(!(pos >= 0.0 && pos < static_cast<double>(numPoints)))
+            return;
+
+        auto j = static_cast<int>(pos);
+
+        auto fraction = pos - j;
+
+        weights[j] += 1.0 - fraction;
+
+        if(j + 1 < numPoints)
+            weights[j+1] += fraction;
+    });
+
+    // The kernel is truncated at 4 bandwidths, beyond which it is negligible
+    auto halfWidth = std::min(numPoints - 1, static_cast<int>(ceil(4.0*bandwidth*invDelta)));
 
-        theHistogramTicks[k] = histogramMin + k * binSize - 0.5 * binSize;
+    QVector<double> kernel(2*halfWidth + 1);
+
+    auto kernelSum = 0.0;
+
+    for(int i = -halfWidth; i<=halfWidth; ++i)
+    {
+        auto u = i*delta/bandwidth;
+
+        kernel[i + halfWidth] = exp(-0.5*u*u);
+
+        kernelSum += kernel[i + halfWidth];
     }
 
-    return theHistogramTicks;
+    // Normalize the sampled kernel so that the density integrates to one even if the grid is coarse compared to the bandwidth
+    auto norm = 1.0/(kernelSum*static_cast<double>(n)*delta);
+
+    for(auto&& it : kernel)
+        it *= norm;
+
+    auto density = FFT::convolve(gridWeights, kernel);
+
+    xValues.resize(numPoints);
+    yValues.resize(numPoints);
+
+    for(int i = 0; i<numPoints; ++i)
+    {
+        xValues[i] = gridMin + i*delta;
+
+        // Remove the round-off of the transform around zero
+        yValues[i] = std::max(density.at(i + halfWidth), 0.0);
+    }
+
+    return 0;
 }
 
 
@@ -238,49 +480,199 @@ double REmpiricalProbabilityDistribution::getMin() const
 }
 
 
-QVector<double>  REmpiricalProbabilityDistribution::updateHistogram()
+double REmpiricalProbabilityDistribution::getSum() const
+{
+    return sum - sumCompensation;
+}
+
+
+int REmpiricalProbabilityDistribution::getNumBins() const
 {
-    QVector<double> theHistogram(numBins);
+    return numBins;
+}
+
+
+void REmpiricalProbabilityDistribution::setNumBins(int value)
+{
+    if(value > 0)
+        numBins = value;
+}
+
 
+REmpiricalProbabilityDistribution::BinningRule REmpiricalProbabilityDistribution::getBinningRule() const
+{
+    return binningRule;
+}
+
+
+void REmpiricalProbabilityDistribution::setBinningRule(const BinningRule value)
+{
+    binningRule = value;
+}
+
+
+QVector<double>  REmpiricalProbabilityDistribution::updateHistogram()
+{
     if(n<1)
     {
         qDebug()<<"Error, need samples to create a histogram";
-        return theHistogram;
+        return QVector<double>(numBins);
     }
 
-    auto stdv = this->stdDev();
+    this->updateHistogramRange();
 
-    auto meanVal = this->mean();
+    auto invBinSize = 1.0/binSize;
+    auto numBinsLocal = histogramNumBins;
+    auto minLocal = histogramMin;
 
-    // Get size of histogram
-    histogramMin = meanVal - 5.0 * stdv;
-    histogramMax = meanVal + 5.0 * stdv;
-    binSize = (histogramMax - histogramMin) / numBins;
+    // One division per sample, the samples outside of the bins are not counted
+    QVector<double> theHistogram;
+
+    if(binningRule == FreedmanDiaconis)
+    {
+        // The bin k holds the samples in [histogramMin + k*binSize, histogramMin + (k+1)*binSize), the maximum goes into the last bin
+        theHistogram = this->accumulateSamples(histogramNumBins, [=](const double x, double* counts)
+        {
+            if(!std::isfinite(x))
+                return;
 
+            auto pos = (x - minLocal)*invBinSize;
 
-    // Create histogram
-    for (int j=0; j<values.size(); ++j) {
+            if(pos < 0.0)
+                return;
 
-        for (int k=0; k<numBins; ++k) {
+            auto k = static_cast<int>(std::min(pos, static_cast<double>(numBinsLocal - 1)));
 
-            if (values.at(j) < histogramMin + static_cast<double>(k) * binSize) {
+            counts[k] += 1.0;
+        });
+    }
+    else if(binningRule == Logarithmic)
+    {
+        // The bins are evenly spaced in log10, the samples that are not positive cannot be shown on a log scale
+        auto logMin = log10(histogramMin);
 
-                theHistogram[k] += 1.0;
+        theHistogram = this->accumulateSamples(histogramNumBins, [=](const double x, double* counts)
+        {
+            if(!std::isfinite(x) || x <= 0.0)
+                return;
 
-                if (theHistogram[k] > histogramHeight) {
-                    histogramHeight += 1.0;
-                }
-                break;
-            }
-        }
+            auto pos = (log10(x) - logMin)*invBinSize;
+
+            if(pos < 0.0)
+                return;
+
+            auto k = static_cast<int>(std::min(pos, static_cast<double>(numBinsLocal - 1)));
+
+            counts[k] += 1.0;
+        });
     }
+    else
+    {
+        // The bin k holds the samples in [histogramMin + (k-1)*binSize, histogramMin + k*binSize), samples below the minimum go into the first bin
+        theHistogram = this->accumulateSamples(histogramNumBins, [=](const double x, double* counts)
+        {
+            if(!std::isfinite(x))
+                return;
+
+            auto pos = (x - minLocal)*invBinSize;
+
+            // Clamp in double so that the cast cannot overflow, the samples past the last bin are not counted
+            int k = pos < 0.0 ? 0 : static_cast<int>(std::min(pos, static_cast<double>(numBinsLocal))) + 1;
+
+            if(k < numBinsLocal)
+                counts[k] += 1.0;
+        });
+    }
+
+    histogramHeight = *std::max_element(theHistogram.begin(), theHistogram.end());
 
     histogramArea = static_cast<double>(n)*binSize;
 
-    if (histogramHeight/histogramArea > histPlotHeight) {
+    for(int k = 0; k<histogramNumBins; ++k)
+    {
+        auto area = static_cast<double>(n)*this->getBinWidth(k);
+
+        if (area > 0.0 && theHistogram.at(k)/area > histPlotHeight) {
 
-        histPlotHeight = histogramHeight/histogramArea*1.1;
+            histPlotHeight = theHistogram.at(k)/area*1.1;
+        }
     }
 
     return theHistogram;
 }
+
+
+void REmpiricalProbabilityDistribution::updateHistogramRange(void)
+{
+    histogramNumBins = numBins;
+
+    if(binningRule == FreedmanDiaconis)
+    {
+        // Limit the number of bins for heavy tailed samples where the IQR is small compared to the range
+        const int maxNumBins = 1000;
+
+        auto range = max - min;
+
+        auto IQR = n > 1 ? this->quantile(0.75) - this->quantile(0.25) : 0.0;
+
+        if(IQR > 0.0 && range > 0.0)
+        {
+            auto width = 2.0*IQR*pow(static_cast<double>(n), -1.0/3.0);
+
+            histogramNumBins = std::min(std::max(static_cast<int>(ceil(range/width)), 1), maxNumBins);
+        }
+
+        histogramMin = min;
+        histogramMax = range > 0.0 ? max : min + 1.0;
+        binSize = (histogramMax - histogramMin) / histogramNumBins;
+
+        return;
+    }
+
+    if(binningRule == Logarithmic)
+    {
+        auto minPositive = std::numeric_limits<double>::infinity();
+
+        for(auto&& it : values)
+        {
+            if(it > 0.0 && it < minPositive)
+                minPositive = it;
+        }
+
+        // Use one decade if there are no positive samples, or if all of them are the same
+        if(std::isinf(minPositive))
+            minPositive = 1.0;
+
+        histogramMin = minPositive;
+        histogramMax = max > minPositive ? max : 10.0*minPositive;
+
+        // The bin size is in log10 units
+        binSize = (log10(histogramMax) - log10(histogramMin)) / histogramNumBins;
+
+        return;
+    }
+
+    auto stdv = this->stdDev();
+
+    // Use a narrow range around the mean if all of the samples are the same
+    if(stdv <= 0.0)
+        stdv = fabs(meanVal) > 0.0 ? 0.01*fabs(meanVal) : 1.0;
+
+    // Get size of histogram
+    histogramMin = meanVal - 5.0 * stdv;
+    histogramMax = meanVal + 5.0 * stdv;
+    binSize = (histogramMax - histogramMin) / histogramNumBins;
+}
+
+
+double REmpiricalProbabilityDistribution::getBinWidth(const int k) const
+{
+    if(binningRule == Logarithmic)
+    {
+        auto logMin = log10(histogramMin);
+
+        return pow(10.0, logMin + (k + 1) * binSize) - pow(10.0, logMin + k * binSize);
+    }
+
+    return binSize;
+}
@@ -59,23 +59,50 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 #include <math.h>
 #include <vector>
+#include <QString>
 #include <QVector>
 
+// Empirical distribution of a set of samples
+// The moments are accumulated with the algorithm of Welford so that they are stable for large values, e.g., losses in dollars
+// Distributions that are built from separate blocks of samples, e.g., on separate threads, can be combined with merge()
 class REmpiricalProbabilityDistribution
 {
 public:
     REmpiricalProbabilityDistribution(QString objectName = QString());
 
+    // The rules for the bins of the histogram
+    // MeanStdDev: a fixed number of bins over the mean +/- 5 standard deviations
+    // FreedmanDiaconis: bins of width 2*IQR*n^(-1/3) over the range of the samples
+    // Logarithmic: a fixed number of bins that are evenly spaced in log10 over the range of the positive samples
+    enum BinningRule {MeanStdDev = 0, FreedmanDiaconis = 1, Logarithmic = 2};
+
+    // Non-finite samples are not added, the number of samples counts only the finite ones
     void addSample(const double& val);
 
+    void addSamples(const QVector<double>& vals);
+
+    // Adds the samples of another distribution, the result is the same as adding the samples one by one
+    void merge(const REmpiricalProbabilityDistribution& other);
+
     double mean(void);
 
     double stdDev(void);
 
     double CV(void);
 
+    // Returns the quantile at the probability level p, interpolated between the order statistics of the finite samples
+    double quantile(const double p);
+
+    // The histogram with the bins of the binning rule, each sample is put into its bin directly
     QVector<double>  updateHistogram();
 
+    // The normal reference bandwidth of Silverman, i.e., 0.9*min(std. dev., IQR/1.34)*n^(-1/5)
+    double getDefaultBandwidth(void);
+
+    // Gaussian kernel density estimate on a regular grid of numPoints over [min - 3*bandwidth, max + 3*bandwidth]
+    // The samples are linearly binned onto the grid and the grid is convolved with the kernel by FFT, i.e., O(n + numPoints*log(numPoints))
+    int getKernelDensity(const double bandwidth, QVector<double>& xValues, QVector<double>& yValues, const int numPoints = 1024);
+
     // For plotting
     QVector<double> getRelativeFrequencyDiagram(void);
     QVector<double> getHistogramTicks(void);
@@ -100,12 +127,39 @@ public:
 
     double getMin() const;
 
+    double getSum() const;
+
+    int getNumBins() const;
+    void setNumBins(int value);
+
+    BinningRule getBinningRule() const;
+    void setBinningRule(const BinningRule value);
+
 private:
 
+    // Sets the range, the number of bins, and the bin size of the histogram according to the binning rule
+    void updateHistogramRange(void);
+
+    // The width of the bin k in the units of the samples
+    double getBinWidth(const int k) const;
+
+    // Accumulates the samples into a vector of numEntries on the global thread pool, addSample(value, counts) adds a sample to the counts of a thread
+    template <typename F>
+    QVector<double> accumulateSamples(const int numEntries, F addSample) const;
+
     QString name;
 
     QVector<double> values;
 
+    // The finite samples in ascending order for the quantiles, sorted again when the samples change
+    QVector<double> sortedValues;
+    bool sortedValuesValid;
+
+    BinningRule binningRule;
+
+    // The number of bins of the last histogram, equal to numBins unless the rule sets the number of bins
+    int histogramNumBins;
+
     int numBins;
     QVector<double> theFrequencyDiagram;
     double histogramMin;
@@ -117,8 +171,15 @@ private:
 
     double max;
     double min;
-    double parameterSum;
-    double parameterSquaredSum;
+
+    // Running mean and sum of the squared differences from the mean
+    double meanVal;
+    double M2;
+
+    // Compensated sum of the samples
+    double sum;
+    double sumCompensation;
+
     int n;
 };
 
@@ -0,0 +1,68 @@
+#ifndef REALIZATIONFIELDS_H
+#define REALIZATIONFIELDS_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include <QStringList>
+#include <QVector>
+
+// The names of the columns that summarize the realization level results of each asset, kept apart from the reader so that the layers can be set up without the HDF5 library
+struct RealizationFields
+{
+    // The results that are summarized, i.e., the prefixes of the summary columns
+    static inline const QStringList results = {"RepairCost", "RepairTime"};
+
+    // The probability levels of the quantiles of each asset, in ascending order
+    static inline const QVector<double> quantileLevels = {0.1, 0.5, 0.9};
+
+    // The probability levels of the value at risk of the portfolio, in ascending order
+    static inline const QVector<double> tailLevels = {0.9, 0.95, 0.99};
+
+    // The names of the summary columns that are written to the assets for a result, e.g., RepairCostMean, RepairCostStdDev, RepairCostP90
+    static QStringList getSummaryFields(const QString& name, const QVector<double>& levels = quantileLevels)
+    {
+        QStringList fields = {name + "Mean", name + "StdDev"};
+
+        for(auto&& it : levels)
+            fields.append(name + "P" + QString::number(qRound(it*100.0)));
+
+        return fields;
+    }
+};
+
+#endif // REALIZATIONFIELDS_H
@@ -0,0 +1,462 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "RealizationFields.h"
+#include "RealizationStreamReader.h"
+
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cmath>
+
+RealizationStreamReader::RealizationStreamReader(QObject* parent) : QObject(parent)
+{
+    // Two blocks are in memory at a time, the one being processed and the one being read
+    memoryBudget = 512*1024*1024;
+
+    quantileLevels = RealizationFields::quantileLevels;
+
+    tailLevels = RealizationFields::tailLevels;
+
+    // pelicun saves one row per asset and one column per realization
+    assetsInRows = true;
+
+    cancelled = false;
+}
+
+
+int RealizationStreamReader::open(const QString& pathToFile, QString& errMsg)
+{
+    return theReader.open(pathToFile, errMsg);
+}
+
+
+void RealizationStreamReader::close(void)
+{
+    theReader.close();
+}
+
+
+QStringList RealizationStreamReader::getKeys(void) const
+{
+    return theReader.getKeys();
+}
+
+
+int RealizationStreamReader::summarize(const QString& key, RealizationSummary& summary, QString& errMsg)
+{
+    PandasFrameInfo info;
+
+    if(theReader.readFrameInfo(key, info, errMsg) != 0)
+        return -1;
+
+    auto numRows = info.numRows;
+    auto numCols = info.columnLabels.size();
+
+    auto numAssets = assetsInRows ? numRows : numCols;
+    auto numRealizations = assetsInRows ? numCols : numRows;
+
+    if(numAssets == 0 || numRealizations == 0)
+    {
+        errMsg = "The frame " + key + " does not contain any realizations";
+        return -1;
+    }
+
+    summary = RealizationSummary();
+    summary.key = key;
+    summary.numRealizations = numRealizations;
+    summary.quantileLevels = quantileLevels;
+    summary.tailLevels = tailLevels;
+
+    summary.assetIDs.resize(numAssets);
+    for(int i = 0; i<numAssets; ++i)
+    {
+        if(assetsInRows)
+            summary.assetIDs[i] = static_cast<int>(info.index.at(i));
+        else
+            summary.assetIDs[i] = info.columnLabels.at(i).join("-").toInt();
+    }
+
+    summary.mean.fill(0.0, numAssets);
+    summary.stdDev.fill(0.0, numAssets);
+    summary.quantiles.fill(QVector<double>(numAssets, 0.0), quantileLevels.size());
+
+    // When the rows are assets, the portfolio total of a realization is only complete after the last block so the totals are accumulated, with compensation terms for the running sums
+    QVector<double> portfolioTotals;
+    QVector<double> compensation;
+
+    // When the rows are realizations, the assets are accumulated over the blocks
+    QVector<AssetAccumulator> assets;
+
+    AssetAccumulator portfolio;
+    portfolio.sketch = TDigest(200.0);
+
+    if(assetsInRows)
+    {
+        portfolioTotals.fill(0.0, numRealizations);
+        compensation.fill(0.0, numRealizations);
+    }
+    else
+        assets.resize(numAssets);
+
+    // The number of rows in a block so that two blocks fit within the memory budget
+    auto rowBytes = static_cast<qint64>(numCols)*static_cast<qint64>(sizeof(double));
+    auto rowsPerBlock = static_cast<int>(std::max(qint64(1), memoryBudget/(2*rowBytes)));
+    rowsPerBlock = std::min(rowsPerBlock, numRows);
+
+    // Reads a block, the read holds the process-wide HDF5 lock of the reader so that it is serialized with the reads of the results and of the comparison on the other threads
+    auto readBlock = [this, &info, rowsPerBlock, numRows](const int firstRow, QVector<double>& values, QString& readErrMsg)
+    {
+        auto numRowsInBlock = std::min(rowsPerBlock, numRows - firstRow);
+        return theReader.readRows(info, firstRow, numRowsInBlock, values, readErrMsg);
+    };
+
+    QVector<double> currentBlock;
+    QVector<double> nextBlock;
+    QString readErrMsg;
+
+    if(readBlock(0, currentBlock, readErrMsg) != 0)
+    {
+        errMsg = readErrMsg;
+        return -1;
+    }
+
+    emit progressChanged(0);
+
+    for(int firstRow = 0; firstRow < numRows; firstRow += rowsPerBlock)
+    {
+        if(cancelled)
+        {
+            errMsg.clear();
+            return -1;
+        }
+
+        auto nextRow = firstRow + rowsPerBlock;
+
+        // Start reading the next block while this one is processed
+        QFuture<int> nextRead;
+        if(nextRow < numRows)
+            nextRead = QtConcurrent::run([&readBlock, nextRow, &nextBlock, &readErrMsg]()
+            {
+                return readBlock(nextRow, nextBlock, readErrMsg);
+            });
+
+        auto numRowsInBlock = std::min(rowsPerBlock, numRows - firstRow);
+
+        if(assetsInRows)
+            this->processAssetBlock(currentBlock, firstRow, numRowsInBlock, numCols, summary, portfolioTotals, compensation);
+        else
+            this->processRealizationBlock(currentBlock, numRowsInBlock, numCols, assets, portfolio);
+
+        if(nextRow < numRows)
+        {
+            if(nextRead.result() != 0)
+            {
+                errMsg = readErrMsg;
+                return -1;
+            }
+
+            currentBlock.swap(nextBlock);
+        }
+
+        emit progressChanged(static_cast<int>(100*static_cast<qint64>(firstRow + numRowsInBlock)/numRows));
+    }
+
+    if(assetsInRows)
+    {
+        for(auto&& it : portfolioTotals)
+            portfolio.add(it);
+    }
+    else
+    {
+        for(int i = 0; i<numAssets; ++i)
+        {
+            const auto& asset = assets.at(i);
+
+            summary.mean[i] = asset.mean;
+            summary.stdDev[i] = asset.count > 1.0 ? std::sqrt(asset.M2/(asset.count-1.0)) : 0.0;
+
+            for(int k = 0; k<quantileLevels.size(); ++k)
+                summary.quantiles[k][i] = asset.sketch.quantile(quantileLevels.at(k));
+        }
+    }
+
+    // Statistics of the portfolio totals
+    portfolio.sketch.compress();
+
+    summary.portfolioSketch = portfolio.sketch;
+    summary.portfolioMean = portfolio.mean;
+    summary.portfolioStdDev = portfolio.count > 1.0 ? std::sqrt(portfolio.M2/(portfolio.count-1.0)) : 0.0;
+
+    for(auto&& it : quantileLevels)
+        summary.portfolioQuantiles.push_back(portfolio.sketch.quantile(it));
+
+    for(auto&& it : tailLevels)
+    {
+        summary.valueAtRisk.push_back(portfolio.sketch.quantile(it));
+        summary.tailValueAtRisk.push_back(portfolio.sketch.tailMean(it));
+    }
+
+    // The exceedance probabilities are spaced logarithmically down to the probability of a single realization
+    const int numPoints = 100;
+
+    auto minProb = 1.0/numRealizations;
+
+    for(int i = 0; i<numPoints; ++i)
+    {
+        auto prob = std::pow(minProb, static_cast<double>(i)/(numPoints-1));
+
+        summary.exceedanceProbabilities.push_back(prob);
+        summary.exceedanceLosses.push_back(portfolio.sketch.quantile(1.0 - prob));
+    }
+
+    return 0;
+}
+
+
+void RealizationStreamReader::processAssetBlock(const QVector<double>& values, const int firstRow, const int numRows, const int numCols, RealizationSummary& summary, QVector<double>& portfolioTotals, QVector<double>& compensation) const
+{
+    auto numLevels = quantileLevels.size();
+
+    // Each asset is handled by one thread and writes only to its own entries, the vectors are detached up front
+    auto meanData = summary.mean.data();
+    auto stdDevData = summary.stdDev.data();
+
+    QVector<double*> quantileData;
+    for(auto&& it : summary.quantiles)
+        quantileData.push_back(it.data());
+
+    QVector<int> rows;
+    for(int i = 0; i<numRows; ++i)
+        rows.push_back(i);
+
+    QtConcurrent::blockingMap(rows, [&](const int i)
+    {
+        auto row = values.constData() + i*numCols;
+
+        AssetAccumulator asset;
+        asset.sketch = TDigest(200.0);
+
+        for(int j = 0; j<numCols; ++j)
+            asset.add(row[j]);
+
+        auto assetIndex = firstRow + i;
+
+        meanData[assetIndex] = asset.mean;
+        stdDevData[assetIndex] = asset.count > 1.0 ? std::sqrt(asset.M2/(asset.count-1.0)) : 0.0;
+
+        asset.sketch.compress();
+
+        for(int k = 0; k<numLevels; ++k)
+            quantileData[k][assetIndex] = asset.sketch.quantile(quantileLevels.at(k));
+    });
+
+    // Add the block to the portfolio totals, the realizations are split into ranges that are summed on separate threads
+    const int rangeSize = 1024;
+
+    QVector<int> ranges;
+    for(int j = 0; j<numCols; j += rangeSize)
+        ranges.push_back(j);
+
+    auto totalsData = portfolioTotals.data();
+    auto compensationData = compensation.data();
+
+    QtConcurrent::blockingMap(ranges, [&](const int begin)
+    {
+        auto end = std::min(begin + rangeSize, numCols);
+
+        QVector<double> blockSums(end - begin, 0.0);
+
+        for(int i = 0; i<numRows; ++i)
+        {
+            auto row = values.constData() + i*numCols;
+
+            for(int j = begin; j<end; ++j)
+                blockSums[j-begin] += row[j];
+        }
+
+        // Kahan summation so that the totals do not lose precision over a large number of blocks
+        for(int j = begin; j<end; ++j)
+        {
+            auto y = blockSums.at(j-begin) - compensationData[j];
+            auto t = totalsData[j] + y;
+            compensationData[j] = (t - totalsData[j]) - y;
+            totalsData[j] = t;
+        }
+    });
+}
+
+
+void RealizationStreamReader::processRealizationBlock(const QVector<double>& values, const int numRows, const int numCols, QVector<AssetAccumulator>& assets, AssetAccumulator& portfolio) const
+{
+    // The assets are split into ranges, each thread updates the accumulators of its own assets
+    const int rangeSize = 256;
+
+    QVector<int> ranges;
+    for(int j = 0; j<numCols; j += rangeSize)
+        ranges.push_back(j);
+
+    auto assetsData = assets.data();
+
+    QtConcurrent::blockingMap(ranges, [&](const int begin)
+    {
+        auto end = std::min(begin + rangeSize, numCols);
+
+        for(int j = begin; j<end; ++j)
+        {
+            auto& asset = assetsData[j];
+
+            for(int i = 0; i<numRows; ++i)
+                asset.add(values.at(i*numCols + j));
+
+            // Keep only the centroids between the blocks
+            asset.sketch.compress();
+        }
+    });
+
+    // The portfolio total of each realization in the block is complete
+    QVector<double> totals(numRows, 0.0);
+    auto totalsData = totals.data();
+
+    QVector<int> rows;
+    for(int i = 0; i<numRows; ++i)
+        rows.push_back(i);
+
+    QtConcurrent::blockingMap(rows, [&](const int i)
+    {
+        auto row = values.constData() + i*numCols;
+
+        // Kahan summation over the assets
+        auto sum = 0.0;
+        auto comp = 0.0;
+
+        for(int j = 0; j<numCols; ++j)
+        {
+            auto y = row[j] - comp;
+            auto t = sum + y;
+            comp = (t - sum) - y;
+            sum = t;
+        }
+
+        totalsData[i] = sum;
+    });
+
+    for(auto&& it : totals)
+        portfolio.add(it);
+}
+
+
+void RealizationStreamReader::AssetAccumulator::add(const double value)
+{
+    count += 1.0;
+
+    auto delta = value - mean;
+    mean += delta/count;
+    M2 += delta*(value - mean);
+
+    sketch.add(value);
+}
+
+
+void RealizationStreamReader::resetCancel(void)
+{
+    cancelled = false;
+}
+
+
+bool RealizationStreamReader::isCancelled(void) const
+{
+    return cancelled;
+}
+
+
+void RealizationStreamReader::cancel(void)
+{
+    cancelled = true;
+}
+
+
+qint64 RealizationStreamReader::getMemoryBudget() const
+{
+    return memoryBudget;
+}
+
+
+void RealizationStreamReader::setMemoryBudget(const qint64 value)
+{
+    if(value > 0)
+        memoryBudget = value;
+}
+
+
+QVector<double> RealizationStreamReader::getQuantileLevels() const
+{
+    return quantileLevels;
+}
+
+
+void RealizationStreamReader::setQuantileLevels(const QVector<double>& value)
+{
+    quantileLevels = value;
+    std::sort(quantileLevels.begin(), quantileLevels.end());
+}
+
+
+QVector<double> RealizationStreamReader::getTailLevels() const
+{
+    return tailLevels;
+}
+
+
+void RealizationStreamReader::setTailLevels(const QVector<double>& value)
+{
+    tailLevels = value;
+    std::sort(tailLevels.begin(), tailLevels.end());
+}
+
+
+bool RealizationStreamReader::getAssetsInRows() const
+{
+    return assetsInRows;
+}
+
+
+void RealizationStreamReader::setAssetsInRows(const bool value)
+{
+    assetsInRows = value;
+}
@@ -0,0 +1,170 @@
+#ifndef REALIZATIONSTREAMREADER_H
+#define REALIZATIONSTREAMREADER_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "PandasHDF5Reader.h"
+#include "TDigest.h"
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <atomic>
+
+// Summary of a frame of realization level results
+struct RealizationSummary
+{
+    // The key of the frame in the realizations file, e.g., '/reconstruction/cost'
+    QString key;
+
+    QVector<int> assetIDs;
+
+    int numRealizations = 0;
+
+    // The probability levels of the quantiles, in ascending order
+    QVector<double> quantileLevels;
+
+    // Per asset statistics over the realizations
+    QVector<double> mean;
+    QVector<double> stdDev;
+
+    // The quantiles of each asset, i.e., quantiles[i][j] is the quantile at quantileLevels[i] of asset j
+    QVector<QVector<double>> quantiles;
+
+    // Sketch of the distribution of the sum over all of the assets in a realization
+    TDigest portfolioSketch;
+
+    // Statistics of the portfolio totals over the realizations
+    double portfolioMean = 0.0;
+    double portfolioStdDev = 0.0;
+    QVector<double> portfolioQuantiles;
+
+    // The value at risk, i.e., the quantile, and the tail value at risk, i.e., the mean beyond the quantile, of the portfolio totals at each tail level
+    QVector<double> tailLevels;
+    QVector<double> valueAtRisk;
+    QVector<double> tailValueAtRisk;
+
+    // The exceedance probability curve of the portfolio totals
+    QVector<double> exceedanceLosses;
+    QVector<double> exceedanceProbabilities;
+};
+
+
+// Streams the realization level results of pelicun, i.e., the realizations.hdf file, in blocks of rows so that the memory use is bounded regardless of the size of the run
+// The next block is read from the file while the current block is being processed on the global thread pool, each read goes through the process-wide HDF5 lock of PandasHDF5Reader
+// The distributions are kept as mergeable quantile sketches so that the samples are not stored
+class RealizationStreamReader : public QObject
+{
+    Q_OBJECT
+
+public:
+    RealizationStreamReader(QObject* parent = nullptr);
+
+    int open(const QString& pathToFile, QString& errMsg);
+
+    void close(void);
+
+    QStringList getKeys(void) const;
+
+    // Streams through a frame and computes the per asset and the portfolio statistics, can be run on a worker thread
+    // Returns -1 with an empty message if it was cancelled
+    int summarize(const QString& key, RealizationSummary& summary, QString& errMsg);
+
+    // Clears a previous cancellation before a new frame is summarized
+    void resetCancel(void);
+
+    bool isCancelled(void) const;
+
+    // The maximum number of bytes of realizations that are held in memory at a time
+    qint64 getMemoryBudget() const;
+    void setMemoryBudget(const qint64 value);
+
+    QVector<double> getQuantileLevels() const;
+    void setQuantileLevels(const QVector<double>& value);
+
+    QVector<double> getTailLevels() const;
+    void setTailLevels(const QVector<double>& value);
+
+    // Whether the rows of the frames are the assets and the columns are the realizations, otherwise the rows are the realizations
+    bool getAssetsInRows() const;
+    void setAssetsInRows(const bool value);
+
+public slots:
+
+    void cancel(void);
+
+signals:
+
+    // The progress through the rows of the frame in percent, emitted from the thread that summarizes the frame
+    void progressChanged(int percent);
+
+private:
+
+    // Running statistics of an asset, the mean and the variance are updated with the algorithm of Welford
+    struct AssetAccumulator
+    {
+        double count = 0.0;
+        double mean = 0.0;
+        double M2 = 0.0;
+        TDigest sketch = TDigest(50.0);
+
+        void add(const double value);
+    };
+
+    // Processes a block where each row is an asset, the statistics of the assets are complete after the block
+    void processAssetBlock(const QVector<double>& values, const int firstRow, const int numRows, const int numCols, RealizationSummary& summary, QVector<double>& portfolioTotals, QVector<double>& compensation) const;
+
+    // Processes a block where each row is a realization
+    void processRealizationBlock(const QVector<double>& values, const int numRows, const int numCols, QVector<AssetAccumulator>& assets, AssetAccumulator& portfolio) const;
+
+    PandasHDF5Reader theReader;
+
+    qint64 memoryBudget;
+
+    QVector<double> quantileLevels;
+
+    QVector<double> tailLevels;
+
+    bool assetsInRows;
+
+    std::atomic<bool> cancelled;
+};
+
+#endif // REALIZATIONSTREAMREADER_H
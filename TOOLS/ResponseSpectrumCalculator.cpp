@@ -0,0 +1,585 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "ResponseSpectrumCalculator.h"
+#include "GroundMotionTimeHistory.h"
+
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+struct Point2D
+{
+    double x;
+    double y;
+};
+
+
+double cross(const Point2D& o, const Point2D& a, const Point2D& b)
+{
+    return (a.x - o.x)*(b.y - o.y) - (a.y - o.y)*(b.x - o.x);
+}
+
+
+// Returns the vertices of the convex hull of the trajectory and its reflection through the origin
+// The points inside the octagon of the extreme points in eight directions are discarded first, which leaves only a small fraction of the points to sort
+QVector<Point2D> symmetricHull(const double* xs, const double* ys, const int numPoints, const int stride)
+{
+    const double s = std::sqrt(0.5);
+    const double dirX[8] = {1.0, s, 0.0, -s, -1.0, -s, 0.0, s};
+    const double dirY[8] = {0.0, s, 1.0, s, 0.0, -s, -1.0, -s};
+
+    // The set is symmetric, so the extreme point in a direction is the reflection of the extreme point in the opposite direction
+    Point2D extremes[8];
+    double extremeValues[4] = {-1.0, -1.0, -1.0, -1.0};
+
+    for(int i = 0; i<numPoints; ++i)
+    {
+        for(int j = 0; j<4; ++j)
+        {
+            auto x = xs[i*stride];
+            auto y = ys[i*stride];
+            auto val = x*dirX[j] + y*dirY[j];
+
+            if(std::fabs(val) > extremeValues[j])
+            {
+                extremeValues[j] = std::fabs(val);
+                extremes[j] = val >= 0.0 ? Point2D{x, y} : Point2D{-x, -y};
+            }
+        }
+    }
+
+    for(int j = 0; j<4; ++j)
+        extremes[j+4] = Point2D{-extremes[j].x, -extremes[j].y};
+
+    // The distinct vertices of the octagon in counter-clockwise order
+    QVector<Point2D> octagon;
+    for(int j = 0; j<8; ++j)
+    {
+        const auto& p = extremes[j];
+
+        if(octagon.isEmpty() || p.x != octagon.last().x || p.y != octagon.last().y)
+            octagon.push_back(p);
+    }
+
+    if(octagon.size() > 1 && octagon.first().x == octagon.last().x && octagon.first().y == octagon.last().y)
+        octagon.pop_back();
+
+    // The octagon is symmetric about the origin, so a point is inside if and only if its reflection is inside
+    // Each edge is stored as its outward normal and offset, a point is strictly inside if it is behind every edge
+    auto numEdges = octagon.size() >= 3 ? octagon.size() : 0;
+
+    QVector<double> normalX(numEdges), normalY(numEdges), offsets(numEdges);
+
+    for(int j = 0; j<numEdges; ++j)
+    {
+        const auto& a = octagon.at(j);
+        const auto& b = octagon.at((j+1) % numEdges);
+
+        normalX[j] = b.y - a.y;
+        normalY[j] = a.x - b.x;
+        offsets[j] = normalX.at(j)*a.x + normalY.at(j)*a.y;
+    }
+
+    auto isInside = [&](const double x, const double y)
+    {
+        if(numEdges == 0)
+            return false;
+
+        for(int j = 0; j<numEdges; ++j)
+        {
+            if(normalX.at(j)*x + normalY.at(j)*y >= offsets.at(j))
+                return false;
+        }
+
+        return true;
+    };
+
+    QVector<Point2D> candidates = octagon;
+
+    for(int i = 0; i<numPoints; ++i)
+    {
+        auto x = xs[i*stride];
+        auto y = ys[i*stride];
+
+        if(isInside(x, y))
+            continue;
+
+        candidates.push_back(Point2D{x, y});
+        candidates.push_back(Point2D{-x, -y});
+    }
+
+    std::sort(candidates.begin(), candidates.end(), [](const Point2D& a, const Point2D& b)
+    {
+        return a.x < b.x || (a.x == b.x && a.y < b.y);
+    });
+
+    // Andrew's monotone chain
+    auto numCandidates = candidates.size();
+
+    if(numCandidates < 3)
+        return candidates;
+
+    QVector<Point2D> hull(2*numCandidates);
+    int k = 0;
+
+    for(int i = 0; i<numCandidates; ++i)
+    {
+        while(k >= 2 && cross(hull.at(k-2), hull.at(k-1), candidates.at(i)) <= 0.0)
+            --k;
+
+        hull[k++] = candidates.at(i);
+    }
+
+    for(int i = numCandidates - 2, t = k + 1; i>=0; --i)
+    {
+        while(k >= t && cross(hull.at(k-2), hull.at(k-1), candidates.at(i)) <= 0.0)
+            --k;
+
+        hull[k++] = candidates.at(i);
+    }
+
+    hull.resize(k - 1);
+
+    return hull;
+}
+}
+
+
+ResponseSpectrumCalculator::ResponseSpectrumCalculator()
+{
+    periods = logSpacedPeriods(0.01, 10.0, 100);
+    dampingRatios = {0.05};
+    numAngles = 180;
+}
+
+
+int ResponseSpectrumCalculator::computeSpectrum(const QVector<double>& acceleration, const double dT, ResponseSpectrum& spectrum, QString& errMsg) const
+{
+    Coefficients coeffs;
+
+    if(this->getCoefficients(dT, coeffs, errMsg) != 0)
+        return -1;
+
+    if(acceleration.size() < 2)
+    {
+        errMsg = "The time history should have at least two points";
+        return -1;
+    }
+
+    // The response is followed for the longest period after the end of the record, so that the peak of the long period oscillators is not cut off
+    auto extended = acceleration;
+    extended.resize(acceleration.size() + static_cast<int>(std::ceil(periods.last()/dT)));
+
+    QVector<double> peakDisplacements;
+    this->integrate(coeffs, extended, peakDisplacements, 0, coeffs.omega.size(), nullptr);
+
+    spectrum = this->toSpectrum(coeffs, peakDisplacements);
+
+    return 0;
+}
+
+
+int ResponseSpectrumCalculator::computeRotDSpectra(const QVector<double>& accelerationX, const QVector<double>& accelerationY, const double dT, QVector<QVector<double>>& RotD50, QVector<QVector<double>>& RotD100, QString& errMsg) const
+{
+    Coefficients coeffs;
+
+    if(this->getCoefficients(dT, coeffs, errMsg) != 0)
+        return -1;
+
+    if(accelerationX.size() != accelerationY.size() || accelerationX.size() < 2)
+    {
+        errMsg = "The horizontal components should have the same number of points, and at least two points";
+        return -1;
+    }
+
+    auto numExtra = static_cast<int>(std::ceil(periods.last()/dT));
+
+    auto extendedX = accelerationX;
+    extendedX.resize(accelerationX.size() + numExtra);
+
+    auto extendedY = accelerationY;
+    extendedY.resize(accelerationY.size() + numExtra);
+
+    auto numSteps = extendedX.size();
+    auto numOscillators = coeffs.omega.size();
+    auto numPeriods = periods.size();
+
+    RotD50.fill(QVector<double>(numPeriods, 0.0), dampingRatios.size());
+    RotD100.fill(QVector<double>(numPeriods, 0.0), dampingRatios.size());
+
+    QVector<double> cosines(numAngles);
+    QVector<double> sines(numAngles);
+
+    for(int j = 0; j<numAngles; ++j)
+    {
+        auto theta = M_PI*j/numAngles;
+        cosines[j] = std::cos(theta);
+        sines[j] = std::sin(theta);
+    }
+
+    // The displacement histories are kept for a chunk of the oscillators at a time
+    const int chunkSize = 16;
+
+    QVector<double> historiesX(chunkSize*numSteps);
+    QVector<double> historiesY(chunkSize*numSteps);
+    QVector<double> peaks;
+    QVector<double> angularPeaks(numAngles);
+
+    for(int first = 0; first<numOscillators; first += chunkSize)
+    {
+        auto count = std::min(chunkSize, numOscillators - first);
+
+        this->integrate(coeffs, extendedX, peaks, first, count, historiesX.data());
+        this->integrate(coeffs, extendedY, peaks, first, count, historiesY.data());
+
+        for(int k = 0; k<count; ++k)
+        {
+            auto hull = symmetricHull(historiesX.constData() + k, historiesY.constData() + k, numSteps, count);
+
+            for(int j = 0; j<numAngles; ++j)
+            {
+                auto peak = 0.0;
+
+                for(auto&& p : hull)
+                    peak = std::max(peak, p.x*cosines.at(j) + p.y*sines.at(j));
+
+                angularPeaks[j] = peak;
+            }
+
+            std::sort(angularPeaks.begin(), angularPeaks.end());
+
+            auto median = numAngles % 2 == 1 ? angularPeaks.at(numAngles/2) : 0.5*(angularPeaks.at(numAngles/2 - 1) + angularPeaks.at(numAngles/2));
+
+            auto oscillator = first + k;
+            auto omega2 = coeffs.omega.at(oscillator)*coeffs.omega.at(oscillator);
+
+            RotD50[oscillator/numPeriods][oscillator % numPeriods] = omega2*median;
+            RotD100[oscillator/numPeriods][oscillator % numPeriods] = omega2*angularPeaks.last();
+        }
+    }
+
+    return 0;
+}
+
+
+int ResponseSpectrumCalculator::computeSpectra(const QVector<GroundMotionTimeHistory>& records, QVector<RecordSpectra>& spectra, QString& errMsg) const
+{
+    auto numRecords = records.size();
+
+    spectra.clear();
+    spectra.resize(numRecords);
+
+    QVector<QString> errors(numRecords);
+
+    auto spectraData = spectra.data();
+    auto errorsData = errors.data();
+
+    QVector<int> indices(numRecords);
+    for(int i = 0; i<numRecords; ++i)
+        indices[i] = i;
+
+    // Each record is processed by one thread and writes only to its own entries
+    QtConcurrent::blockingMap(indices, [&](const int i)
+    {
+        const auto& record = records.at(i);
+        auto& result = spectraData[i];
+
+        result.name = record.getName();
+
+        auto scale = [&record](QVector<double> values)
+        {
+            for(auto&& it : values)
+                it *= record.getScalingFactor();
+
+            return values;
+        };
+
+        auto x = scale(record.getX());
+        auto y = scale(record.getY());
+        auto z = scale(record.getZ());
+
+        QString err;
+
+        if(!x.isEmpty() && this->computeSpectrum(x, record.getDT(), result.x, err) != 0)
+            errorsData[i] = record.getName() + ": " + err;
+
+        if(!y.isEmpty() && this->computeSpectrum(y, record.getDT(), result.y, err) != 0)
+            errorsData[i] = record.getName() + ": " + err;
+
+        if(!z.isEmpty() && this->computeSpectrum(z, record.getDT(), result.z, err) != 0)
+            errorsData[i] = record.getName() + ": " + err;
+
+        if(x.isEmpty() || y.isEmpty() || !errorsData[i].isEmpty())
+            return;
+
+        if(this->computeRotDSpectra(x, y, record.getDT(), result.RotD50, result.RotD100, err) != 0)
+        {
+            errorsData[i] = record.getName() + ": " + err;
+            return;
+        }
+
+        result.geometricMean = result.x.PSA;
+
+        for(int d = 0; d<result.geometricMean.size(); ++d)
+        {
+            for(int p = 0; p<result.geometricMean.at(d).size(); ++p)
+                result.geometricMean[d][p] = std::sqrt(result.x.PSA.at(d).at(p)*result.y.PSA.at(d).at(p));
+        }
+    });
+
+    for(auto&& it : errors)
+    {
+        if(!it.isEmpty())
+        {
+            errMsg = it;
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+
+int ResponseSpectrumCalculator::getCoefficients(const double dT, Coefficients& coeffs, QString& errMsg) const
+{
+    if(dT <= 0.0)
+    {
+        errMsg = "The time step should be greater than zero";
+        return -1;
+    }
+
+    if(periods.isEmpty() || dampingRatios.isEmpty())
+    {
+        errMsg = "No periods or damping ratios are given for the response spectra";
+        return -1;
+    }
+
+    auto numOscillators = periods.size()*dampingRatios.size();
+
+    for(auto vec : {&coeffs.A11, &coeffs.A12, &coeffs.A21, &coeffs.A22, &coeffs.B11, &coeffs.B12, &coeffs.B21, &coeffs.B22, &coeffs.omega})
+        vec->resize(numOscillators);
+
+    int k = 0;
+
+    for(auto&& zeta : dampingRatios)
+    {
+        for(auto&& T : periods)
+        {
+            auto w = 2.0*M_PI/T;
+            auto sq = std::sqrt(1.0 - zeta*zeta);
+            auto wd = w*sq;
+
+            auto E = std::exp(-zeta*w*dT);
+            auto S = std::sin(wd*dT);
+            auto C = std::cos(wd*dT);
+
+            auto w2 = w*w;
+            auto w3 = w2*w;
+
+            auto c1 = (2.0*zeta*zeta - 1.0)/(w2*dT);
+            auto c2 = 2.0*zeta/(w3*dT);
+
+            coeffs.A11[k] = E*(zeta/sq*S + C);
+            coeffs.A12[k] = E*S/wd;
+            coeffs.A21[k] = -w/sq*E*S;
+            coeffs.A22[k] = E*(C - zeta/sq*S);
+
+            coeffs.B11[k] = E*((c1 + zeta/w)*S/wd + (c2 + 1.0/w2)*C) - c2;
+            coeffs.B12[k] = -E*(c1*S/wd + c2*C) - 1.0/w2 + c2;
+            coeffs.B21[k] = E*((c1 + zeta/w)*(C - zeta/sq*S) - (c2 + 1.0/w2)*(wd*S + zeta*w*C)) + 1.0/(w2*dT);
+            coeffs.B22[k] = -E*(c1*(C - zeta/sq*S) - c2*(wd*S + zeta*w*C)) - 1.0/(w2*dT);
+
+            coeffs.omega[k] = w;
+
+            ++k;
+        }
+    }
+
+    return 0;
+}
+
+
+void ResponseSpectrumCalculator::integrate(const Coefficients& coeffs, const QVector<double>& acceleration, QVector<double>& peakDisplacements, const int first, const int count, double* histories) const
+{
+    auto numSteps = acceleration.size();
+
+    peakDisplacements.fill(0.0, count);
+
+    QVector<double> displacements(count, 0.0);
+    QVector<double> velocities(count, 0.0);
+
+    auto A11 = coeffs.A11.constData() + first;
+    auto A12 = coeffs.A12.constData() + first;
+    auto A21 = coeffs.A21.constData() + first;
+    auto A22 = coeffs.A22.constData() + first;
+    auto B11 = coeffs.B11.constData() + first;
+    auto B12 = coeffs.B12.constData() + first;
+    auto B21 = coeffs.B21.constData() + first;
+    auto B22 = coeffs.B22.constData() + first;
+
+    auto x = displacements.data();
+    auto v = velocities.data();
+    auto peak = peakDisplacements.data();
+
+    auto acc = acceleration.constData();
+
+    if(histories != nullptr)
+    {
+        for(int k = 0; k<count; ++k)
+            histories[k] = 0.0;
+    }
+
+    for(int i = 0; i<numSteps-1; ++i)
+    {
+        const auto a0 = acc[i];
+        const auto a1 = acc[i+1];
+
+        // The loop over the oscillators has no dependencies between its iterations
+        for(int k = 0; k<count; ++k)
+        {
+            auto xNext = A11[k]*x[k] + A12[k]*v[k] + B11[k]*a0 + B12[k]*a1;
+            auto vNext = A21[k]*x[k] + A22[k]*v[k] + B21[k]*a0 + B22[k]*a1;
+
+            x[k] = xNext;
+            v[k] = vNext;
+
+            peak[k] = std::max(peak[k], std::fabs(xNext));
+        }
+
+        if(histories != nullptr)
+        {
+            for(int k = 0; k<count; ++k)
+                histories[(i+1)*count + k] = x[k];
+        }
+    }
+}
+
+
+ResponseSpectrum ResponseSpectrumCalculator::toSpectrum(const Coefficients& coeffs, const QVector<double>& peakDisplacements) const
+{
+    ResponseSpectrum spectrum;
+
+    auto numPeriods = periods.size();
+
+    spectrum.SD.fill(QVector<double>(numPeriods, 0.0), dampingRatios.size());
+    spectrum.PSV = spectrum.SD;
+    spectrum.PSA = spectrum.SD;
+
+    for(int k = 0; k<peakDisplacements.size(); ++k)
+    {
+        auto d = k/numPeriods;
+        auto p = k % numPeriods;
+
+        auto w = coeffs.omega.at(k);
+
+        spectrum.SD[d][p] = peakDisplacements.at(k);
+        spectrum.PSV[d][p] = w*peakDisplacements.at(k);
+        spectrum.PSA[d][p] = w*w*peakDisplacements.at(k);
+    }
+
+    return spectrum;
+}
+
+
+QVector<double> ResponseSpectrumCalculator::getPeriods() const
+{
+    return periods;
+}
+
+
+void ResponseSpectrumCalculator::setPeriods(const QVector<double>& value)
+{
+    periods.clear();
+
+    for(auto&& it : value)
+    {
+        if(it > 0.0)
+            periods.push_back(it);
+    }
+
+    std::sort(periods.begin(), periods.end());
+}
+
+
+QVector<double> ResponseSpectrumCalculator::getDampingRatios() const
+{
+    return dampingRatios;
+}
+
+
+void ResponseSpectrumCalculator::setDampingRatios(const QVector<double>& value)
+{
+    dampingRatios.clear();
+
+    for(auto&& it : value)
+    {
+        if(it >= 0.0 && it < 1.0)
+            dampingRatios.push_back(it);
+    }
+}
+
+
+int ResponseSpectrumCalculator::getNumberOfAngles() const
+{
+    return numAngles;
+}
+
+
+void ResponseSpectrumCalculator::setNumberOfAngles(const int value)
+{
+    if(value > 0)
+        numAngles = value;
+}
+
+
+QVector<double> ResponseSpectrumCalculator::logSpacedPeriods(const double minPeriod, const double maxPeriod, const int numPeriods)
+{
+    QVector<double> values;
+
+    if(numPeriods == 1)
+        values.push_back(minPeriod);
+
+    for(int i = 0; i<numPeriods && numPeriods > 1; ++i)
+        values.push_back(minPeriod*std::pow(maxPeriod/minPeriod, static_cast<double>(i)/(numPeriods-1)));
+
+    return values;
+}
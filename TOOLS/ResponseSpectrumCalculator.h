@@ -0,0 +1,125 @@
+#ifndef RESPONSESPECTRUMCALCULATOR_H
+#define RESPONSESPECTRUMCALCULATOR_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include <QString>
+#include <QVector>
+
+class GroundMotionTimeHistory;
+
+// Elastic response spectra of one acceleration time history
+// The spectra are indexed by [damping][period], the displacement and velocity are in the units of the acceleration times s^2 and s, respectively
+struct ResponseSpectrum
+{
+    QVector<QVector<double>> SD;
+    QVector<QVector<double>> PSV;
+    QVector<QVector<double>> PSA;
+};
+
+
+// The spectra of the components of a record, a component that is not in the record has empty spectra
+// The RotD and geometric mean pseudo-acceleration spectra combine the two horizontal components, and are empty if either one is missing
+struct RecordSpectra
+{
+    QString name;
+
+    ResponseSpectrum x;
+    ResponseSpectrum y;
+    ResponseSpectrum z;
+
+    QVector<QVector<double>> RotD50;
+    QVector<QVector<double>> RotD100;
+    QVector<QVector<double>> geometricMean;
+};
+
+
+// Response spectra of single degree of freedom oscillators that are integrated with the exact recurrence for a piecewise linear excitation (Nigam and Jennings, 1969)
+// All of the oscillators, i.e., every combination of period and damping ratio, are advanced together one time step at a time so that the inner loop over the oscillators is vectorized by the compiler
+class ResponseSpectrumCalculator
+{
+public:
+    ResponseSpectrumCalculator();
+
+    int computeSpectrum(const QVector<double>& acceleration, const double dT, ResponseSpectrum& spectrum, QString& errMsg) const;
+
+    // The RotD50 and RotD100 spectra of the two horizontal components, i.e., the median and the maximum over the rotation angles of the peak displacement
+    int computeRotDSpectra(const QVector<double>& accelerationX, const QVector<double>& accelerationY, const double dT, QVector<QVector<double>>& RotD50, QVector<QVector<double>>& RotD100, QString& errMsg) const;
+
+    // Spectra of all of the components of the records, the records are processed in parallel and the time histories are multiplied by their scaling factors
+    int computeSpectra(const QVector<GroundMotionTimeHistory>& records, QVector<RecordSpectra>& spectra, QString& errMsg) const;
+
+    // The default periods are logarithmically spaced from 0.01 to 10 s
+    QVector<double> getPeriods() const;
+    void setPeriods(const QVector<double>& value);
+
+    QVector<double> getDampingRatios() const;
+    void setDampingRatios(const QVector<double>& value);
+
+    // The number of rotation angles between 0 and 180 degrees used for the RotD spectra
+    int getNumberOfAngles() const;
+    void setNumberOfAngles(const int value);
+
+    static QVector<double> logSpacedPeriods(const double minPeriod, const double maxPeriod, const int numPeriods);
+
+private:
+
+    // The recurrence coefficients of every oscillator, the oscillators are ordered by damping and then by period
+    struct Coefficients
+    {
+        QVector<double> A11, A12, A21, A22;
+        QVector<double> B11, B12, B21, B22;
+        QVector<double> omega;
+    };
+
+    int getCoefficients(const double dT, Coefficients& coeffs, QString& errMsg) const;
+
+    // Integrates the oscillators from rest and returns the peak absolute displacement of each one
+    // If the histories are requested, the displacement of oscillator first + k at step i is stored at i*count + k
+    void integrate(const Coefficients& coeffs, const QVector<double>& acceleration, QVector<double>& peakDisplacements, const int first, const int count, double* histories) const;
+
+    ResponseSpectrum toSpectrum(const Coefficients& coeffs, const QVector<double>& peakDisplacements) const;
+
+    QVector<double> periods;
+
+    QVector<double> dampingRatios;
+
+    int numAngles;
+};
+
+#endif // RESPONSESPECTRUMCALCULATOR_H
@@ -0,0 +1,506 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "CSVReaderWriter.h"
+#include "PandasHDF5Reader.h"
+#include "ResultsComparison.h"
+#include "ResultsTable.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QtConcurrent>
+#include <QtNumeric>
+
+#include <algorithm>
+#include <cmath>
+
+ResultsComparison::ResultsComparison()
+{
+    baseline = 0;
+    numHeaderRows = 0;
+}
+
+
+int ResultsComparison::addRun(const QString& pathToResults, QString& errMsg, const QString& name)
+{
+    QString pathToCache;
+
+    if(this->getCachedResults(pathToResults, pathToCache, errMsg) != 0)
+        return -1;
+
+    auto table = std::make_unique<MappedResultsTable>();
+
+    if(table->open(pathToCache, errMsg) != 0)
+        return -1;
+
+    runs.push_back(std::move(table));
+    runNames.append(name.isEmpty() ? QDir(pathToResults).dirName() : name);
+    cachePaths.append(pathToCache);
+    rowMaps.push_back(QVector<int>());
+
+    if(runs.size() == 1)
+        baseline = 0;
+
+    this->alignRun(static_cast<int>(runs.size()) - 1);
+
+    return 0;
+}
+
+
+void ResultsComparison::removeRun(const int run)
+{
+    if(run < 0 || run >= static_cast<int>(runs.size()))
+        return;
+
+    runs.erase(runs.begin() + run);
+    runNames.removeAt(run);
+    cachePaths.removeAt(run);
+    rowMaps.removeAt(run);
+
+    if(baseline == run)
+        this->setBaseline(0);
+    else if(baseline > run)
+        --baseline;
+}
+
+
+void ResultsComparison::clear(void)
+{
+    runs.clear();
+    runNames.clear();
+    cachePaths.clear();
+    rowMaps.clear();
+    baseline = 0;
+}
+
+
+int ResultsComparison::relocateRuns(const QString& pathToFolder, const QString& pathToSnapshot, QString& errMsg)
+{
+    auto folderPath = QDir(pathToFolder).absolutePath() + "/";
+
+    for(int run = 0; run<static_cast<int>(runs.size()); ++run)
+    {
+        auto pathToCache = QFileInfo(cachePaths.at(run)).absoluteFilePath();
+
+        if(!pathToCache.startsWith(folderPath))
+            continue;
+
+        auto newPath = QDir(pathToSnapshot).filePath(QString::number(qHash(pathToCache)) + "_" + QFileInfo(pathToCache).fileName());
+
+        // The mapping is released before the copy so that the folder can be removed
+        runs.at(run)->close();
+
+        QFile::remove(newPath);
+
+        if(!QFile::copy(pathToCache, newPath))
+        {
+            errMsg = "Could not copy the results of the run " + runNames.at(run) + " to " + pathToSnapshot;
+            this->removeRun(run);
+            return -1;
+        }
+
+        if(runs.at(run)->open(newPath, errMsg) != 0)
+        {
+            this->removeRun(run);
+            return -1;
+        }
+
+        cachePaths[run] = newPath;
+    }
+
+    return 0;
+}
+
+
+int ResultsComparison::numRuns(void) const
+{
+    return static_cast<int>(runs.size());
+}
+
+
+QStringList ResultsComparison::getRunNames(void) const
+{
+    return runNames;
+}
+
+
+QStringList ResultsComparison::getHeaders(void) const
+{
+    if(runs.empty())
+        return QStringList();
+
+    return runs.at(baseline)->getHeaders();
+}
+
+
+int ResultsComparison::getBaseline() const
+{
+    return baseline;
+}
+
+
+void ResultsComparison::setBaseline(const int value)
+{
+    if(runs.empty())
+    {
+        baseline = 0;
+        return;
+    }
+
+    baseline = std::min(std::max(value, 0), static_cast<int>(runs.size()) - 1);
+
+    for(int run = 0; run<static_cast<int>(runs.size()); ++run)
+        this->alignRun(run);
+}
+
+
+int ResultsComparison::compare(const int column, ComparisonResult& result, QString& errMsg) const
+{
+    result = ComparisonResult();
+
+    if(runs.empty())
+    {
+        errMsg = "There are no runs to compare";
+        return -1;
+    }
+
+    const auto& baseTable = runs.at(baseline);
+
+    auto baseValues = baseTable->getColumn(column);
+
+    if(baseValues == nullptr)
+    {
+        errMsg = "The baseline run " + runNames.at(baseline) + " does not have the column " + QString::number(column);
+        return -1;
+    }
+
+    auto numRuns = static_cast<int>(runs.size());
+    auto numRows = baseTable->numRows();
+
+    result.column = column;
+    result.header = baseTable->getHeaders().value(column);
+    result.runNames = runNames;
+    result.baseline = baseline;
+
+    auto baseIDs = baseTable->getIDs();
+    result.IDs = QVector<int>(baseIDs, baseIDs + numRows);
+
+    result.deltas.resize(numRuns);
+    result.ratios.resize(numRuns);
+    result.totals.fill(0.0, numRuns);
+    result.totalDeltas.fill(0.0, numRuns);
+    result.numMatched.fill(0, numRuns);
+    result.numMissing.fill(0, numRuns);
+    result.numExtra.fill(0, numRuns);
+    result.hasColumn.fill(true, numRuns);
+
+    const int blockSize = 65536;
+
+    QVector<int> blocks;
+    for(int i = 0; i<numRows; i += blockSize)
+        blocks.push_back(i);
+
+    for(int run = 0; run<numRuns; ++run)
+    {
+        const auto& table = runs.at(run);
+
+        // The columns of the runs are matched by their header
+        auto runColumn = run == baseline ? column : table->getHeaders().indexOf(result.header);
+
+        auto values = table->getColumn(runColumn);
+
+        if(runColumn <= 0 || values == nullptr)
+        {
+            result.hasColumn[run] = false;
+            result.runsWithoutColumn.append(runNames.at(run));
+
+            result.deltas[run].fill(qQNaN(), numRows);
+            result.ratios[run].fill(qQNaN(), numRows);
+            result.totals[run] = qQNaN();
+            result.totalDeltas[run] = qQNaN();
+            result.numMissing[run] = numRows;
+
+            continue;
+        }
+
+        // The total over all of the rows of the run, summed in blocks so that only the pages of this column are touched
+        auto runRows = table->numRows();
+
+        QVector<int> runBlocks;
+        for(int i = 0; i<runRows; i += blockSize)
+            runBlocks.push_back(i);
+
+        QVector<double> blockTotals(runBlocks.size(), 0.0);
+        auto blockTotalsData = blockTotals.data();
+
+        QtConcurrent::blockingMap(runBlocks, [&](const int begin)
+        {
+            auto end = std::min(begin + blockSize, runRows);
+
+            auto sum = 0.0;
+            for(int i = begin; i<end; ++i)
+                sum += values[i];
+
+            blockTotalsData[begin/blockSize] = sum;
+        });
+
+        for(auto&& it : blockTotals)
+            result.totals[run] += it;
+
+        // The per asset differences to the baseline
+        const auto& rowMap = rowMaps.at(run);
+
+        QVector<double> deltas(numRows);
+        QVector<double> ratios(numRows);
+
+        auto deltasData = deltas.data();
+        auto ratiosData = ratios.data();
+
+        QVector<double> blockDeltas(blocks.size(), 0.0);
+        QVector<int> blockMatched(blocks.size(), 0);
+
+        auto blockDeltasData = blockDeltas.data();
+        auto blockMatchedData = blockMatched.data();
+
+        QtConcurrent::blockingMap(blocks, [&](const int begin)
+        {
+            auto end = std::min(begin + blockSize, numRows);
+
+            auto delta = deltasData + begin;
+            auto ratio = ratiosData + begin;
+            auto base = baseValues + begin;
+            auto map = rowMap.constData() + begin;
+            auto n = end - begin;
+
+            // Gather the values of the run in the order of the baseline
+            for(int i = 0; i<n; ++i)
+                delta[i] = map[i] >= 0 ? values[map[i]] : qQNaN();
+
+            // Element wise kernels without dependencies between the iterations so that they are vectorized
+            for(int i = 0; i<n; ++i)
+                ratio[i] = base[i] != 0.0 ? delta[i]/base[i] : qQNaN();
+
+            for(int i = 0; i<n; ++i)
+                delta[i] -= base[i];
+
+            auto sum = 0.0;
+            auto matched = 0;
+
+            for(int i = 0; i<n; ++i)
+            {
+                if(map[i] >= 0)
+                {
+                    sum += delta[i];
+                    ++matched;
+                }
+            }
+
+            blockDeltasData[begin/blockSize] = sum;
+            blockMatchedData[begin/blockSize] = matched;
+        });
+
+        for(int b = 0; b<blocks.size(); ++b)
+        {
+            result.totalDeltas[run] += blockDeltas.at(b);
+            result.numMatched[run] += blockMatched.at(b);
+        }
+
+        result.numMissing[run] = numRows - result.numMatched.at(run);
+        result.numExtra[run] = runRows - result.numMatched.at(run);
+
+        result.deltas[run] = deltas;
+        result.ratios[run] = ratios;
+    }
+
+    return 0;
+}
+
+
+int ResultsComparison::getNumHeaderRows() const
+{
+    return numHeaderRows;
+}
+
+
+void ResultsComparison::setNumHeaderRows(const int value)
+{
+    numHeaderRows = value;
+}
+
+
+int ResultsComparison::getCachedResults(const QString& pathToResults, QString& pathToCache, QString& errMsg) const
+{
+    QDir resultsDir(pathToResults);
+
+    if(!resultsDir.exists())
+    {
+        errMsg = "The results folder " + pathToResults + " does not exist";
+        return -1;
+    }
+
+    // The DV results are in a csv file, or in an HDF5 file when the csv files were not written
+    QString pathToSource;
+    bool isCSV = false;
+
+    for(auto&& it : resultsDir.entryList(QStringList({"*.csv"}), QDir::Files))
+    {
+        if(it.startsWith("DV_"))
+        {
+            pathToSource = resultsDir.filePath(it);
+            isCSV = true;
+        }
+    }
+
+    if(pathToSource.isEmpty())
+    {
+        for(auto&& it : resultsDir.entryList(QStringList({"*.hdf","*.h5"}), QDir::Files))
+        {
+            if(it.startsWith("DV"))
+                pathToSource = resultsDir.filePath(it);
+        }
+    }
+
+    if(pathToSource.isEmpty())
+    {
+        errMsg = "Could not find the DV results in the folder " + pathToResults;
+        return -1;
+    }
+
+    QFileInfo sourceInfo(pathToSource);
+
+    // Keep the cache next to the results, or in the temporary folder if the results folder is read only
+    pathToCache = resultsDir.filePath(sourceInfo.completeBaseName() + ".r2dcols");
+
+    if(!QFileInfo(resultsDir.absolutePath()).isWritable())
+        pathToCache = QDir::temp().filePath("R2D_" + QString::number(qHash(sourceInfo.absoluteFilePath())) + ".r2dcols");
+
+    // The cache is only reused if it was written from exactly this version of the results
+    const auto sourceSize = sourceInfo.size();
+    const auto sourceModified = sourceInfo.lastModified().toMSecsSinceEpoch();
+
+    qint64 cachedSize = -1;
+    qint64 cachedModified = -1;
+
+    if(MappedResultsTable::readSourceStamp(pathToCache, cachedSize, cachedModified) == 0 && cachedSize == sourceSize && cachedModified == sourceModified)
+        return 0;
+
+    ResultsTable table;
+
+    if(isCSV)
+    {
+        CSVReaderWriter csvTool;
+
+        auto rows = csvTool.parseCSVFile(pathToSource, errMsg);
+
+        if(!errMsg.isEmpty())
+            return -1;
+
+        auto headerRows = numHeaderRows > 0 ? numHeaderRows : ResultsTable::countHeaderRows(rows);
+
+        if(table.fromCSV(rows, headerRows, errMsg) != 0)
+            return -1;
+    }
+    else
+    {
+        PandasHDF5Reader theReader;
+
+        if(theReader.open(pathToSource, errMsg) != 0)
+            return -1;
+
+        auto keys = theReader.getKeys();
+
+        if(keys.isEmpty())
+        {
+            errMsg = "The file " + pathToSource + " does not contain any data frames";
+            return -1;
+        }
+
+        // pandas saves a single frame under the key 'data' by default
+        auto key = keys.contains("/data") ? QString("/data") : keys.first();
+
+        if(theReader.readTable(key, table, errMsg) != 0)
+            return -1;
+    }
+
+    return MappedResultsTable::write(table, pathToCache, errMsg, sourceSize, sourceModified);
+}
+
+
+void ResultsComparison::alignRun(const int run)
+{
+    const auto& baseTable = runs.at(baseline);
+    const auto& table = runs.at(run);
+
+    auto numRows = baseTable->numRows();
+
+    QVector<int> rowMap(numRows);
+
+    if(run == baseline)
+    {
+        for(int i = 0; i<numRows; ++i)
+            rowMap[i] = i;
+
+        rowMaps[run] = rowMap;
+        return;
+    }
+
+    // The ID index of the results table, dense when the IDs are compact
+    auto IDs = table->getIDs();
+
+    ResultsTable index;
+    index.setIDs(QVector<int>(IDs, IDs + table->numRows()));
+
+    auto baseIDs = baseTable->getIDs();
+    auto rowMapData = rowMap.data();
+
+    const int blockSize = 65536;
+
+    QVector<int> blocks;
+    for(int i = 0; i<numRows; i += blockSize)
+        blocks.push_back(i);
+
+    QtConcurrent::blockingMap(blocks, [&](const int begin)
+    {
+        auto end = std::min(begin + blockSize, numRows);
+
+        for(int i = begin; i<end; ++i)
+            rowMapData[i] = index.findRow(baseIDs[i]);
+    });
+
+    rowMaps[run] = rowMap;
+}
@@ -0,0 +1,140 @@
+#ifndef RESULTSCOMPARISON_H
+#define RESULTSCOMPARISON_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "MappedResultsTable.h"
+
+#include <QStringList>
+#include <QVector>
+
+#include <memory>
+#include <vector>
+
+// The comparison of a result column of several runs against a baseline run
+struct ComparisonResult
+{
+    int column = -1;
+    QString header;
+
+    QStringList runNames;
+    int baseline = 0;
+
+    // The asset IDs of the baseline run, the per asset results are in this order
+    QVector<int> IDs;
+
+    // The value of each run minus the baseline value, and the ratio of the value of each run to the baseline value, NaN where the asset is not in the run
+    QVector<QVector<double>> deltas;
+    QVector<QVector<double>> ratios;
+
+    // The total of each run over all of its assets
+    QVector<double> totals;
+
+    // The difference to the baseline summed over the assets that are in both runs
+    QVector<double> totalDeltas;
+
+    // The number of assets of the baseline that are in the run, that are missing from the run, and the number of assets of the run that are not in the baseline
+    QVector<int> numMatched;
+    QVector<int> numMissing;
+    QVector<int> numExtra;
+
+    // Whether each run has a column with the header of the compared column, the runs without it have NaN values
+    QVector<bool> hasColumn;
+    QStringList runsWithoutColumn;
+};
+
+
+// Side by side comparison of the results of several runs, e.g., of the same region under different scenarios or retrofit options
+// The DV results of each run are cached in a columnar file that is memory mapped, so that only the compared column of each run is paged in
+// The runs are aligned with the baseline by the asset ID once, the comparison of a column is then a gather and an element wise difference over blocks of rows in parallel
+class ResultsComparison
+{
+public:
+    ResultsComparison();
+
+    // Adds the run in the folder of the results, the name defaults to the name of the folder
+    int addRun(const QString& pathToResults, QString& errMsg, const QString& name = QString());
+
+    void removeRun(const int run);
+
+    void clear(void);
+
+    // Moves the caches of the runs that are inside of the folder to the snapshot folder and maps them from there, e.g., before the folder is removed for a new run
+    int relocateRuns(const QString& pathToFolder, const QString& pathToSnapshot, QString& errMsg);
+
+    int numRuns(void) const;
+
+    QStringList getRunNames(void) const;
+
+    // The headers of the columns of the baseline run
+    QStringList getHeaders(void) const;
+
+    int getBaseline() const;
+    void setBaseline(const int value);
+
+    // Compares the column of the baseline with the column of the same header in each run, the columns of the runs can be in a different order, e.g., when only some of the runs have non-structural losses
+    int compare(const int column, ComparisonResult& result, QString& errMsg) const;
+
+    // The number of header rows in the pelicun csv files, or 0 to count them in each file
+    int getNumHeaderRows() const;
+    void setNumHeaderRows(const int value);
+
+private:
+
+    // Returns the path to the columnar cache of the DV results of a run, the cache is rebuilt when the size or the modification time of the results differs from the ones stored in the cache
+    int getCachedResults(const QString& pathToResults, QString& pathToCache, QString& errMsg) const;
+
+    // Aligns a run with the baseline, i.e., finds the row in the run of each asset in the baseline
+    void alignRun(const int run);
+
+    std::vector<std::unique_ptr<MappedResultsTable>> runs;
+
+    QStringList runNames;
+
+    // The path to the columnar cache of each run
+    QStringList cachePaths;
+
+    // The row of each asset of the baseline in each run, or -1 if the asset is not in the run
+    QVector<QVector<int>> rowMaps;
+
+    int baseline;
+
+    int numHeaderRows;
+};
+
+#endif // RESULTSCOMPARISON_H
@@ -0,0 +1,397 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "CSVReaderWriter.h"
+#include "ResultsDirectoryWatcher.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QTimer>
+
+#include <algorithm>
+
+ResultsDirectoryWatcher::ResultsDirectoryWatcher(QObject* parent) : QObject(parent)
+{
+    theWatcher = new QFileSystemWatcher(this);
+
+    connect(theWatcher,&QFileSystemWatcher::directoryChanged,this,&ResultsDirectoryWatcher::handleDirectoryChanged);
+    connect(theWatcher,&QFileSystemWatcher::fileChanged,this,&ResultsDirectoryWatcher::handleFileChanged);
+
+    // The files change every time a row is written, the refreshes are throttled so that the interface stays responsive
+    refreshTimer = new QTimer(this);
+    refreshTimer->setSingleShot(true);
+    refreshTimer->setInterval(5000);
+
+    connect(refreshTimer,&QTimer::timeout,this,&ResultsDirectoryWatcher::refresh);
+
+    // pelicun saves the DV results of the assets as DV_*.csv
+    nameFilters = QStringList({"DV_*.csv"});
+
+    recursive = false;
+    rescan = false;
+
+    maxBytesPerRefresh = 8*1024*1024;
+}
+
+
+void ResultsDirectoryWatcher::start(const QString& pathToResults)
+{
+    this->stop();
+
+    resultsPath = QDir::cleanPath(pathToResults);
+
+    rescan = true;
+
+    this->scheduleRefresh();
+}
+
+
+void ResultsDirectoryWatcher::stop(void)
+{
+    refreshTimer->stop();
+
+    if(!theWatcher->files().isEmpty())
+        theWatcher->removePaths(theWatcher->files());
+
+    if(!theWatcher->directories().isEmpty())
+        theWatcher->removePaths(theWatcher->directories());
+
+    resultsPath.clear();
+    fileStates.clear();
+    changedFiles.clear();
+    rescan = false;
+}
+
+
+bool ResultsDirectoryWatcher::isWatching(void) const
+{
+    return !resultsPath.isEmpty();
+}
+
+
+void ResultsDirectoryWatcher::handleDirectoryChanged(const QString& /*path*/)
+{
+    rescan = true;
+
+    this->scheduleRefresh();
+}
+
+
+void ResultsDirectoryWatcher::handleFileChanged(const QString& path)
+{
+    changedFiles.insert(path);
+
+    this->scheduleRefresh();
+}
+
+
+void ResultsDirectoryWatcher::scheduleRefresh(void)
+{
+    // Changes that come in while a refresh is pending are picked up by that refresh
+    if(!refreshTimer->isActive())
+        refreshTimer->start();
+}
+
+
+void ResultsDirectoryWatcher::refresh(void)
+{
+    if(resultsPath.isEmpty())
+        return;
+
+    if(rescan)
+    {
+        rescan = false;
+
+        if(QFileInfo(resultsPath).isDir())
+            this->scanDirectory(resultsPath);
+        else
+            this->watchExistingParent();
+    }
+
+    if(changedFiles.isEmpty())
+        return;
+
+    // Read the files in a fixed order so that the rows come in the same order on every platform
+    auto paths = changedFiles.values();
+    std::sort(paths.begin(), paths.end());
+
+    changedFiles.clear();
+
+    ResultsTable newRows;
+
+    // A file that fails keeps its offset and does not hold back the rows of the others
+    QStringList errors;
+
+    qint64 bytesLeft = maxBytesPerRefresh;
+
+    for(auto&& it : paths)
+    {
+        // The files that are not read in this refresh are read in the next one
+        if(bytesLeft <= 0)
+        {
+            changedFiles.insert(it);
+            continue;
+        }
+
+        QString errMsg;
+        qint64 numBytesRead = 0;
+
+        auto res = this->readFile(it, bytesLeft, newRows, numBytesRead, errMsg);
+
+        bytesLeft -= numBytesRead;
+
+        if(res == 1)
+            changedFiles.insert(it);
+        else if(res != 0)
+            errors.append(errMsg);
+    }
+
+    if(!newRows.isEmpty())
+        emit resultsAppended(newRows);
+
+    if(!errors.isEmpty())
+        emit errorOccurred(errors.join("\n"));
+
+    // Continue with the bytes that are left once the events that came in were processed, a file that could not be opened is tried again after the refresh interval
+    if(bytesLeft <= 0 && !changedFiles.isEmpty())
+        QTimer::singleShot(0, this, &ResultsDirectoryWatcher::refresh);
+    else if(!changedFiles.isEmpty())
+        this->scheduleRefresh();
+}
+
+
+void ResultsDirectoryWatcher::watchExistingParent(void)
+{
+    auto watchedPath = resultsPath;
+
+    while(!QFileInfo(watchedPath).isDir())
+    {
+        auto parentPath = QFileInfo(watchedPath).path();
+
+        if(parentPath == watchedPath)
+            return;
+
+        watchedPath = parentPath;
+    }
+
+    if(!theWatcher->directories().contains(watchedPath))
+        theWatcher->addPath(watchedPath);
+}
+
+
+void ResultsDirectoryWatcher::scanDirectory(const QString& path)
+{
+    if(!theWatcher->directories().contains(path))
+        theWatcher->addPath(path);
+
+    QDir dir(path);
+
+    auto watchedFiles = theWatcher->files();
+
+    for(auto&& it : dir.entryList(nameFilters, QDir::Files))
+    {
+        auto filePath = dir.absoluteFilePath(it);
+
+        // A new file, or a file that was replaced and dropped from the watcher
+        if(!watchedFiles.contains(filePath))
+        {
+            theWatcher->addPath(filePath);
+            changedFiles.insert(filePath);
+        }
+    }
+
+    if(!recursive)
+        return;
+
+    for(auto&& it : dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot))
+        this->scanDirectory(dir.absoluteFilePath(it));
+}
+
+
+int ResultsDirectoryWatcher::readFile(const QString& path, const qint64 maxBytes, ResultsTable& newRows, qint64& numBytesRead, QString& errMsg)
+{
+    numBytesRead = 0;
+
+    QFile file(path);
+
+    // The file was removed, it is picked up again by the scan if it is created again
+    if(!file.exists())
+    {
+        fileStates.remove(path);
+        return 0;
+    }
+
+    // The file can be locked by the workflow for a moment, it is read again at the next refresh
+    if(!file.open(QIODevice::ReadOnly))
+        return 1;
+
+    // The state is only updated once the rows were parsed, so that they are read again if they could not be
+    auto state = fileStates.value(path);
+
+    // The file was written again from the start
+    if(file.size() < state.offset)
+        state = FileState();
+
+    if(!file.seek(state.offset))
+        return 1;
+
+    auto chunk = file.read(maxBytes);
+
+    numBytesRead = chunk.size();
+
+    auto bytesLeft = file.size() > file.pos();
+
+    auto bytes = state.partialRow + chunk;
+
+    state.offset = file.pos();
+
+    // Keep the last row back until its line ending was written
+    auto lastLineEnd = bytes.lastIndexOf('\n');
+
+    if(lastLineEnd == -1)
+    {
+        state.partialRow = bytes;
+        fileStates.insert(path, state);
+        return bytesLeft ? 1 : 0;
+    }
+
+    state.partialRow = bytes.mid(lastLineEnd + 1);
+
+    auto lines = QString::fromUtf8(bytes.left(lastLineEnd)).split('\n');
+
+    CSVReaderWriter csvTool;
+
+    QVector<QStringList> dataRows;
+
+    for(auto&& line : lines)
+    {
+        if(line.trimmed().isEmpty())
+            continue;
+
+        auto row = csvTool.parseLineCSV(line);
+
+        if(!state.headerComplete)
+        {
+            bool isID;
+            row.value(0).toInt(&isID);
+
+            if(!isID)
+            {
+                state.headerRows.append(row);
+                continue;
+            }
+
+            state.headerComplete = true;
+        }
+
+        dataRows.append(row);
+    }
+
+    if(!dataRows.isEmpty())
+    {
+        if(state.headerRows.isEmpty())
+        {
+            errMsg = "The results file " + path + " does not have a header";
+            return -1;
+        }
+
+        ResultsTable fileRows;
+
+        if(fileRows.fromCSV(state.headerRows + dataRows, state.headerRows.size(), errMsg) != 0)
+            return -1;
+
+        QVector<int> rows;
+
+        if(newRows.append(fileRows, rows, errMsg) != 0)
+            return -1;
+    }
+
+    fileStates.insert(path, state);
+
+    return bytesLeft ? 1 : 0;
+}
+
+
+QStringList ResultsDirectoryWatcher::getNameFilters() const
+{
+    return nameFilters;
+}
+
+
+void ResultsDirectoryWatcher::setNameFilters(const QStringList& value)
+{
+    nameFilters = value;
+}
+
+
+bool ResultsDirectoryWatcher::getRecursive() const
+{
+    return recursive;
+}
+
+
+void ResultsDirectoryWatcher::setRecursive(const bool value)
+{
+    recursive = value;
+}
+
+
+int ResultsDirectoryWatcher::getRefreshInterval() const
+{
+    return refreshTimer->interval();
+}
+
+
+void ResultsDirectoryWatcher::setRefreshInterval(const int value)
+{
+    refreshTimer->setInterval(value);
+}
+
+
+qint64 ResultsDirectoryWatcher::getMaxBytesPerRefresh() const
+{
+    return maxBytesPerRefresh;
+}
+
+
+void ResultsDirectoryWatcher::setMaxBytesPerRefresh(const qint64 value)
+{
+    maxBytesPerRefresh = value;
+}
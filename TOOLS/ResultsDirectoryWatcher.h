@@ -0,0 +1,146 @@
+#ifndef RESULTSDIRECTORYWATCHER_H
+#define RESULTSDIRECTORYWATCHER_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "ResultsTable.h"
+
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+
+class QFileSystemWatcher;
+class QTimer;
+
+// Tails the results files in a folder while the workflow is running, e.g., the DV results that pelicun appends to as the assets are completed
+// Only the bytes that were appended since the last read are parsed, and the folder is only read once per refresh interval no matter how often the files change
+class ResultsDirectoryWatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    ResultsDirectoryWatcher(QObject* parent = nullptr);
+
+    // Starts watching the folder, it is picked up once it is created if it does not exist yet
+    void start(const QString& pathToResults);
+
+    void stop(void);
+
+    bool isWatching(void) const;
+
+    // The patterns of the names of the results files, e.g., DV_*.csv, or *.csv for one file per asset
+    QStringList getNameFilters() const;
+    void setNameFilters(const QStringList& value);
+
+    // Whether the files in the sub-folders are watched too, e.g., when each asset has its own folder
+    bool getRecursive() const;
+    void setRecursive(const bool value);
+
+    // The minimum time between two refreshes in milliseconds
+    int getRefreshInterval() const;
+    void setRefreshInterval(const int value);
+
+    // The maximum number of bytes that are read in one refresh, the rest is read in the following ones so that the interface stays responsive
+    qint64 getMaxBytesPerRefresh() const;
+    void setMaxBytesPerRefresh(const qint64 value);
+
+signals:
+
+    // The rows that were appended to the results files since the last refresh
+    void resultsAppended(const ResultsTable& newRows);
+
+    void errorOccurred(const QString& errMsg);
+
+private slots:
+
+    void handleDirectoryChanged(const QString& path);
+
+    void handleFileChanged(const QString& path);
+
+    // Reads the new rows of the files that changed since the last refresh
+    void refresh(void);
+
+private:
+
+    // What is known about a results file from the previous reads
+    struct FileState
+    {
+        // The number of bytes that were read, and the bytes of a row that was only partly written
+        qint64 offset = 0;
+        QByteArray partialRow;
+
+        // The header rows, they are complete once the first row with an asset ID was read
+        QVector<QStringList> headerRows;
+        bool headerComplete = false;
+    };
+
+    // Watches the first parent of the results folder that exists, so that the results folder is picked up once it is created
+    void watchExistingParent(void);
+
+    // Adds the results files and the sub-folders in a folder to the watcher
+    void scanDirectory(const QString& path);
+
+    // Reads up to maxBytes of the rows that were appended to a file and adds them to the new rows, the read is only kept if the rows could be parsed
+    // Returns 1 if the file has to be read again, i.e., it could not be opened or there are bytes left, and -1 on an error
+    int readFile(const QString& path, const qint64 maxBytes, ResultsTable& newRows, qint64& numBytesRead, QString& errMsg);
+
+    void scheduleRefresh(void);
+
+    QFileSystemWatcher* theWatcher;
+
+    QTimer* refreshTimer;
+
+    QString resultsPath;
+
+    QStringList nameFilters;
+
+    bool recursive;
+
+    QHash<QString, FileState> fileStates;
+
+    // The files that changed since the last refresh
+    QSet<QString> changedFiles;
+
+    // Whether the folders need to be scanned for new files at the next refresh
+    bool rescan;
+
+    qint64 maxBytesPerRefresh;
+};
+
+#endif // RESULTSDIRECTORYWATCHER_H
@@ -0,0 +1,456 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "ResultsTable.h"
+
+#include <QtConcurrent>
+
+#include <algorithm>
+
+ResultsTable::ResultsTable()
+{
+    minID = 0;
+}
+
+
+int ResultsTable::fromCSV(const QVector<QStringList>& rows, const int numHeaderRows, QString& errMsg)
+{
+    this->clear();
+
+    if(rows.size() < numHeaderRows || numHeaderRows < 1)
+    {
+        errMsg = "No results to import!";
+        return -1;
+    }
+
+    auto numCols = rows.at(0).size();
+
+    // Join the header rows
+    for(int i = 0; i<numCols; ++i)
+    {
+        QStringList headerLevels;
+        for(int j = 0; j<numHeaderRows; ++j)
+            headerLevels.append(rows.at(j).value(i));
+
+        headers.append(headerLevels.join("-"));
+    }
+
+    auto numDataRows = rows.size() - numHeaderRows;
+
+    IDs.resize(numDataRows);
+
+    for(int i = 0; i<numDataRows; ++i)
+    {
+        const auto& row = rows.at(i + numHeaderRows);
+
+        if(row.size() != numCols)
+        {
+            errMsg = "The row " + QString::number(i + numHeaderRows) + " has " + QString::number(row.size()) + " columns, it should have " + QString::number(numCols);
+            return -1;
+        }
+
+        bool OK;
+        IDs[i] = row.at(0).toInt(&OK);
+
+        if(!OK)
+        {
+            errMsg = "Could not convert the asset ID " + row.at(0) + " to an integer";
+            return -1;
+        }
+    }
+
+    this->buildIndex();
+
+    // Convert the columns in parallel
+    columns.resize(numCols);
+
+    QVector<int> colIndices;
+    for(int i = 1; i<numCols; ++i)
+        colIndices.push_back(i);
+
+    QVector<QString> colErrors(numCols);
+
+    // Each thread writes to its own column, the vectors are detached up front
+    auto columnsData = columns.data();
+    auto colErrorsData = colErrors.data();
+
+    QtConcurrent::blockingMap(colIndices, [&](const int col)
+    {
+        QVector<double> values(numDataRows);
+
+        for(int i = 0; i<numDataRows; ++i)
+        {
+            const auto& str = rows.at(i + numHeaderRows).at(col);
+
+            // Assume a zero value if the string is empty
+            if(str.isEmpty())
+            {
+                values[i] = 0.0;
+                continue;
+            }
+
+            bool OK;
+            values[i] = str.toDouble(&OK);
+
+            if(!OK)
+            {
+                colErrorsData[col] = "Could not convert the value " + str + " in the column " + headers.at(col) + " to a double";
+                return;
+            }
+        }
+
+        columnsData[col] = values;
+    });
+
+    for(auto&& it : colErrors)
+    {
+        if(!it.isEmpty())
+        {
+            errMsg = it;
+            this->clear();
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+
+int ResultsTable::countHeaderRows(const QVector<QStringList>& rows)
+{
+    for(int i = 0; i<rows.size(); ++i)
+    {
+        bool OK;
+        rows.at(i).value(0).toInt(&OK);
+
+        if(OK)
+            return i;
+    }
+
+    return rows.size();
+}
+
+
+void ResultsTable::clear(void)
+{
+    headers.clear();
+    IDs.clear();
+    columns.clear();
+    denseIndex.clear();
+    sparseIndex.clear();
+    minID = 0;
+}
+
+
+bool ResultsTable::isEmpty(void) const
+{
+    return IDs.isEmpty();
+}
+
+
+int ResultsTable::numRows(void) const
+{
+    return IDs.size();
+}
+
+
+int ResultsTable::numColumns(void) const
+{
+    return headers.size();
+}
+
+
+QStringList ResultsTable::getHeaders(void) const
+{
+    return headers;
+}
+
+
+void ResultsTable::setHeaders(const QStringList& value)
+{
+    headers = value;
+    columns.resize(headers.size());
+}
+
+
+const QVector<int>& ResultsTable::getIDs(void) const
+{
+    return IDs;
+}
+
+
+void ResultsTable::setIDs(const QVector<int>& value)
+{
+    IDs = value;
+
+    this->buildIndex();
+}
+
+
+int ResultsTable::findRow(const int ID) const
+{
+    if(!denseIndex.isEmpty())
+    {
+        auto pos = static_cast<qint64>(ID) - minID;
+
+        if(pos < 0 || pos >= denseIndex.size())
+            return -1;
+
+        return denseIndex.at(static_cast<int>(pos));
+    }
+
+    return sparseIndex.value(ID, -1);
+}
+
+
+QVector<int> ResultsTable::findRows(const QVector<int>& IDsToFind, QVector<int>& missingIDs) const
+{
+    QVector<int> rows;
+    rows.reserve(IDsToFind.size());
+
+    for(auto&& ID : IDsToFind)
+    {
+        auto row = this->findRow(ID);
+
+        if(row == -1)
+            missingIDs.push_back(ID);
+        else
+            rows.push_back(row);
+    }
+
+    return rows;
+}
+
+
+void ResultsTable::buildIndex(void)
+{
+    denseIndex.clear();
+    sparseIndex.clear();
+    minID = 0;
+
+    if(IDs.isEmpty())
+        return;
+
+    auto minMax = std::minmax_element(IDs.begin(), IDs.end());
+
+    minID = *minMax.first;
+
+    auto range = static_cast<qint64>(*minMax.second) - minID + 1;
+
+    // Asset IDs are usually consecutive, fall back to a hash if the lookup table would be mostly empty
+    if(range <= 4*static_cast<qint64>(IDs.size()) + 1024)
+    {
+        denseIndex.fill(-1, static_cast<int>(range));
+
+        for(int i = 0; i<IDs.size(); ++i)
+        {
+            // Keep the first row of a duplicate ID
+            auto& row = denseIndex[IDs.at(i) - minID];
+            if(row == -1)
+                row = i;
+        }
+    }
+    else
+    {
+        sparseIndex.reserve(IDs.size());
+
+        for(int i = 0; i<IDs.size(); ++i)
+        {
+            if(!sparseIndex.contains(IDs.at(i)))
+                sparseIndex.insert(IDs.at(i), i);
+        }
+    }
+}
+
+
+bool ResultsTable::hasColumn(const int col) const
+{
+    if(col < 0 || col >= columns.size())
+        return false;
+
+    return columns.at(col).size() == IDs.size() && !IDs.isEmpty();
+}
+
+
+const QVector<double>& ResultsTable::getColumn(const int col) const
+{
+    return columns.at(col);
+}
+
+
+void ResultsTable::setColumn(const int col, const QVector<double>& values)
+{
+    if(col >= columns.size())
+        columns.resize(col+1);
+
+    columns[col] = values;
+}
+
+
+double ResultsTable::value(const int row, const int col) const
+{
+    return columns.at(col).at(row);
+}
+
+
+ResultsTable ResultsTable::subset(const QVector<int>& rows) const
+{
+    ResultsTable newTable;
+
+    newTable.headers = headers;
+    newTable.columns.resize(columns.size());
+
+    newTable.IDs.reserve(rows.size());
+    for(auto&& row : rows)
+        newTable.IDs.push_back(IDs.at(row));
+
+    newTable.buildIndex();
+
+    for(int i = 0; i<columns.size(); ++i)
+    {
+        if(!this->hasColumn(i))
+            continue;
+
+        const auto& col = columns.at(i);
+        auto& newCol = newTable.columns[i];
+        newCol.reserve(rows.size());
+
+        for(auto&& row : rows)
+            newCol.push_back(col.at(row));
+    }
+
+    return newTable;
+}
+
+
+int ResultsTable::append(const ResultsTable& other, QVector<int>& rows, QString& errMsg)
+{
+    rows.clear();
+
+    if(this->isEmpty())
+    {
+        *this = other;
+
+        rows.resize(IDs.size());
+        for(int i = 0; i<IDs.size(); ++i)
+            rows[i] = i;
+
+        return 0;
+    }
+
+    if(other.numColumns() != this->numColumns())
+    {
+        errMsg = "The rows to append have " + QString::number(other.numColumns()) + " columns, the results have " + QString::number(this->numColumns());
+        return -1;
+    }
+
+    for(int col = 1; col<columns.size(); ++col)
+    {
+        if(this->hasColumn(col) != other.hasColumn(col))
+        {
+            errMsg = "The rows to append do not have the same columns as the results, the column " + headers.at(col) + " differs";
+            return -1;
+        }
+    }
+
+    rows.reserve(other.numRows());
+
+    auto rebuildIndex = false;
+
+    for(int i = 0; i<other.numRows(); ++i)
+    {
+        auto ID = other.IDs.at(i);
+
+        auto row = this->findRow(ID);
+
+        if(row == -1)
+        {
+            row = IDs.size();
+            IDs.push_back(ID);
+
+            for(int col = 1; col<columns.size(); ++col)
+            {
+                if(!columns.at(col).isEmpty())
+                    columns[col].push_back(other.value(i, col));
+            }
+
+            // Update the index in place, the dense lookup table grows with IDs past its end as long as it stays compact
+            auto pos = static_cast<qint64>(ID) - minID;
+
+            if(denseIndex.isEmpty())
+                sparseIndex.insert(ID, row);
+            else if(pos >= 0 && pos < 4*static_cast<qint64>(IDs.size()) + 1024)
+            {
+                while(denseIndex.size() <= pos)
+                    denseIndex.push_back(-1);
+
+                denseIndex[static_cast<int>(pos)] = row;
+            }
+            else
+            {
+                // Move to the hash for the rest of the rows, the index is rebuilt once at the end
+                for(int j = 0; j<denseIndex.size(); ++j)
+                {
+                    if(denseIndex.at(j) != -1)
+                        sparseIndex.insert(minID + j, denseIndex.at(j));
+                }
+
+                denseIndex.clear();
+                sparseIndex.insert(ID, row);
+
+                rebuildIndex = true;
+            }
+        }
+        else
+        {
+            for(int col = 1; col<columns.size(); ++col)
+            {
+                if(!columns.at(col).isEmpty())
+                    columns[col][row] = other.value(i, col);
+            }
+        }
+
+        rows.push_back(row);
+    }
+
+    // The IDs may be compact again, e.g., if they were appended below the smallest ID
+    if(rebuildIndex)
+        this->buildIndex();
+
+    return 0;
+}
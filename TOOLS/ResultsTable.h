@@ -0,0 +1,111 @@
+#ifndef RESULTSTABLE_H
+#define RESULTSTABLE_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// Typed table of results where each row corresponds to an asset
+// The columns follow the numbering of the pelicun csv files, i.e., column 0 is the asset ID and the result columns start at 1
+// A column that was not loaded is empty
+class ResultsTable
+{
+public:
+    ResultsTable();
+
+    // Fills the table from the rows of a csv file, the first numHeaderRows rows are the column headers and the first column is the asset ID
+    int fromCSV(const QVector<QStringList>& rows, const int numHeaderRows, QString& errMsg);
+
+    // Returns the number of header rows at the top of a csv file, i.e., the rows before the first row with an integer asset ID
+    static int countHeaderRows(const QVector<QStringList>& rows);
+
+    void clear(void);
+
+    bool isEmpty(void) const;
+
+    int numRows(void) const;
+
+    int numColumns(void) const;
+
+    // The header of each column, the levels of the header are joined with a '-'
+    QStringList getHeaders(void) const;
+    void setHeaders(const QStringList& value);
+
+    const QVector<int>& getIDs(void) const;
+    void setIDs(const QVector<int>& value);
+
+    // Returns the row of the asset with the given ID, or -1 if the asset is not in the table
+    int findRow(const int ID) const;
+
+    // Returns the rows of the given IDs, the IDs that are not in the table are appended to missingIDs
+    QVector<int> findRows(const QVector<int>& IDs, QVector<int>& missingIDs) const;
+
+    bool hasColumn(const int col) const;
+
+    const QVector<double>& getColumn(const int col) const;
+    void setColumn(const int col, const QVector<double>& values);
+
+    double value(const int row, const int col) const;
+
+    // Returns a new table that only contains the given rows
+    ResultsTable subset(const QVector<int>& rows) const;
+
+    // Appends the rows of another table with the same columns, the row of an asset that is already in the table is replaced
+    // The rows of this table that were added or replaced are returned in rows
+    int append(const ResultsTable& other, QVector<int>& rows, QString& errMsg);
+
+private:
+
+    QStringList headers;
+
+    QVector<int> IDs;
+
+    // Builds the ID to row index, a dense lookup table is used when the IDs are compact, otherwise a hash
+    void buildIndex(void);
+
+    int minID;
+    QVector<int> denseIndex;
+    QHash<int, int> sparseIndex;
+
+    QVector<QVector<double>> columns;
+};
+
+#endif // RESULTSTABLE_H
@@ -0,0 +1,477 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "SpatialAggregator.h"
+
+#include <QHash>
+#include <QPair>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+SpatialAggregator::SpatialAggregator()
+{
+
+}
+
+
+void SpatialAggregator::setAssets(const QVector<int>& IDs, const QVector<QPointF>& locations)
+{
+    this->clear();
+
+    assetIDs = IDs;
+    assetLocations = locations;
+
+    assetIndex.build(assetLocations);
+}
+
+
+void SpatialAggregator::appendAssets(const QVector<int>& IDs, const QVector<QPointF>& locations)
+{
+    assetIDs.append(IDs);
+    assetLocations.append(locations);
+
+    assetIndex.build(assetLocations);
+
+    regions.clear();
+    assetRegions.clear();
+    regionStart.clear();
+    regionAssets.clear();
+    joinKey.clear();
+}
+
+
+int SpatialAggregator::joinToRegions(const QVector<AggregationRegion>& polygons, QString& errMsg)
+{
+    if(assetLocations.isEmpty())
+    {
+        errMsg = "There are no assets to aggregate";
+        return -1;
+    }
+
+    regions = polygons;
+
+    for(auto&& it : regions)
+    {
+        if(it.bounds.isNull())
+        {
+            for(auto&& ring : it.rings)
+                it.bounds = it.bounds.united(ring.boundingRect());
+        }
+    }
+
+    // Each region collects its assets on its own thread, the candidates come from the spatial index
+    QVector<QVector<int>> regionCandidates(regions.size());
+    auto candidatesData = regionCandidates.data();
+
+    QVector<int> regionIndices;
+    for(int i = 0; i<regions.size(); ++i)
+        regionIndices.push_back(i);
+
+    QtConcurrent::blockingMap(regionIndices, [&](const int k)
+    {
+        const auto& region = regions.at(k);
+
+        auto candidates = assetIndex.query(region.bounds);
+
+        QVector<int> inside;
+
+        for(auto&& i : candidates)
+        {
+            if(SpatialAggregator::contains(region, assetLocations.at(i)))
+                inside.push_back(i);
+        }
+
+        candidatesData[k] = inside;
+    });
+
+    // The regions are merged in order so that an asset on a shared boundary always goes to the same region
+    assetRegions.fill(-1, assetLocations.size());
+
+    for(int k = 0; k<regions.size(); ++k)
+    {
+        for(auto&& i : regionCandidates.at(k))
+        {
+            if(assetRegions.at(i) == -1)
+                assetRegions[i] = k;
+        }
+    }
+
+    this->groupAssets();
+
+    return 0;
+}
+
+
+int SpatialAggregator::joinToGrid(const double cellSize, const bool hexagonal, QString& errMsg)
+{
+    if(assetLocations.isEmpty())
+    {
+        errMsg = "There are no assets to aggregate";
+        return -1;
+    }
+
+    if(cellSize <= 0.0)
+    {
+        errMsg = "The size of the grid cells must be greater than zero";
+        return -1;
+    }
+
+    // Equirectangular projection about the center of the assets, in km
+    const double kmPerDegree = 111.32;
+
+    auto center = assetIndex.getBounds().center();
+
+    auto kmPerDegreeLon = kmPerDegree*std::cos(center.y()*3.14159265358979323846/180.0);
+
+    auto toLocation = [=](const double x, const double y)
+    {
+        return QPointF(x/kmPerDegreeLon + center.x(), y/kmPerDegree + center.y());
+    };
+
+    // The circumradius of a hexagon whose flat sides are the cell size apart
+    auto hexSize = cellSize/std::sqrt(3.0);
+
+    // The cell of each asset, computed in parallel
+    auto numAssets = assetLocations.size();
+
+    QVector<QPair<int,int>> assetCells(numAssets);
+    auto assetCellsData = assetCells.data();
+
+    QVector<int> assets;
+    for(int i = 0; i<numAssets; ++i)
+        assets.push_back(i);
+
+    QtConcurrent::blockingMap(assets, [&](const int i)
+    {
+        const auto& location = assetLocations.at(i);
+
+        if(!std::isfinite(location.x()) || !std::isfinite(location.y()))
+        {
+            assetCellsData[i] = qMakePair(std::numeric_limits<int>::min(), std::numeric_limits<int>::min());
+            return;
+        }
+
+        auto x = (location.x() - center.x())*kmPerDegreeLon;
+        auto y = (location.y() - center.y())*kmPerDegree;
+
+        if(!hexagonal)
+        {
+            assetCellsData[i] = qMakePair(static_cast<int>(std::floor(x/cellSize)), static_cast<int>(std::floor(y/cellSize)));
+            return;
+        }
+
+        // Axial coordinates of pointy top hexagons, rounded through the cube coordinates
+        auto q = (std::sqrt(3.0)/3.0*x - y/3.0)/hexSize;
+        auto r = (2.0/3.0*y)/hexSize;
+        auto s = -q - r;
+
+        auto rq = std::round(q);
+        auto rr = std::round(r);
+        auto rs = std::round(s);
+
+        auto dq = std::fabs(rq - q);
+        auto dr = std::fabs(rr - r);
+        auto ds = std::fabs(rs - s);
+
+        if(dq > dr && dq > ds)
+            rq = -rr - rs;
+        else if(dr > ds)
+            rr = -rq - rs;
+
+        assetCellsData[i] = qMakePair(static_cast<int>(rq), static_cast<int>(rr));
+    });
+
+    // Only the cells with assets become regions, sorted by their grid coordinates so that the order does not depend on the order of the assets
+    QVector<QPair<int,int>> cells = assetCells;
+    std::sort(cells.begin(), cells.end());
+    cells.erase(std::unique(cells.begin(), cells.end()), cells.end());
+
+    // The assets without a location sort first
+    const auto noCell = qMakePair(std::numeric_limits<int>::min(), std::numeric_limits<int>::min());
+
+    if(!cells.isEmpty() && cells.first() == noCell)
+        cells.erase(cells.begin());
+
+    QHash<QPair<int,int>, int> cellRegion;
+    cellRegion.reserve(cells.size());
+
+    regions.clear();
+    regions.reserve(cells.size());
+
+    for(auto&& cell : cells)
+    {
+        AggregationRegion region;
+
+        QPolygonF ring;
+
+        if(hexagonal)
+        {
+            region.name = "Hex " + QString::number(cell.first) + "," + QString::number(cell.second);
+
+            auto cx = hexSize*std::sqrt(3.0)*(cell.first + cell.second/2.0);
+            auto cy = hexSize*1.5*cell.second;
+
+            for(int v = 0; v<=6; ++v)
+            {
+                auto angle = (60.0*v - 30.0)*3.14159265358979323846/180.0;
+                ring.append(toLocation(cx + hexSize*std::cos(angle), cy + hexSize*std::sin(angle)));
+            }
+        }
+        else
+        {
+            region.name = "Cell " + QString::number(cell.first) + "," + QString::number(cell.second);
+
+            auto x0 = cell.first*cellSize;
+            auto y0 = cell.second*cellSize;
+
+            ring << toLocation(x0, y0) << toLocation(x0 + cellSize, y0) << toLocation(x0 + cellSize, y0 + cellSize) << toLocation(x0, y0 + cellSize) << toLocation(x0, y0);
+        }
+
+        region.bounds = ring.boundingRect();
+        region.rings.push_back(ring);
+
+        cellRegion.insert(cell, regions.size());
+        regions.push_back(region);
+    }
+
+    assetRegions.resize(numAssets);
+
+    for(int i = 0; i<numAssets; ++i)
+        assetRegions[i] = cellRegion.value(assetCells.at(i), -1);
+
+    this->groupAssets();
+
+    return 0;
+}
+
+
+QVector<double> SpatialAggregator::reduce(const QVector<double>& values, const Statistic stat, const double level) const
+{
+    auto numRegions = regions.size();
+
+    auto emptyValue = (stat == Sum || stat == Count) ? 0.0 : std::numeric_limits<double>::quiet_NaN();
+
+    QVector<double> result(numRegions, emptyValue);
+
+    if(values.size() != assetLocations.size() || regionStart.size() != numRegions + 1)
+        return result;
+
+    auto resultData = result.data();
+
+    QVector<int> regionIndices;
+    for(int i = 0; i<numRegions; ++i)
+        regionIndices.push_back(i);
+
+    // Each region is reduced on its own thread, the NaN values are skipped
+    QtConcurrent::blockingMap(regionIndices, [&](const int k)
+    {
+        auto begin = regionStart.at(k);
+        auto end = regionStart.at(k+1);
+
+        QVector<double> regionValues;
+        regionValues.reserve(end - begin);
+
+        for(int j = begin; j<end; ++j)
+        {
+            auto val = values.at(regionAssets.at(j));
+
+            if(!std::isnan(val))
+                regionValues.push_back(val);
+        }
+
+        auto num = regionValues.size();
+
+        if(stat == Count)
+        {
+            resultData[k] = num;
+            return;
+        }
+
+        if(num == 0)
+            return;
+
+        if(stat == Sum || stat == Mean)
+        {
+            auto sum = 0.0;
+
+            for(auto&& it : regionValues)
+                sum += it;
+
+            resultData[k] = stat == Sum ? sum : sum/num;
+            return;
+        }
+
+        // Quantile, interpolated between the order statistics
+        auto pos = std::min(std::max(level, 0.0), 1.0)*(num - 1);
+        auto lower = static_cast<int>(pos);
+
+        std::nth_element(regionValues.begin(), regionValues.begin() + lower, regionValues.end());
+
+        auto lowerVal = regionValues.at(lower);
+
+        if(lower + 1 >= num)
+        {
+            resultData[k] = lowerVal;
+            return;
+        }
+
+        auto upperVal = *std::min_element(regionValues.begin() + lower + 1, regionValues.end());
+
+        resultData[k] = lowerVal + (pos - lower)*(upperVal - lowerVal);
+    });
+
+    return result;
+}
+
+
+void SpatialAggregator::clear(void)
+{
+    assetIDs.clear();
+    assetLocations.clear();
+    assetIndex.clear();
+    regions.clear();
+    assetRegions.clear();
+    regionStart.clear();
+    regionAssets.clear();
+    joinKey.clear();
+}
+
+
+QString SpatialAggregator::getJoinKey() const
+{
+    return joinKey;
+}
+
+
+void SpatialAggregator::setJoinKey(const QString& value)
+{
+    joinKey = value;
+}
+
+
+const QVector<AggregationRegion>& SpatialAggregator::getRegions() const
+{
+    return regions;
+}
+
+
+QVector<int> SpatialAggregator::getNumberOfAssetsPerRegion() const
+{
+    QVector<int> numAssets(regions.size(), 0);
+
+    for(int k = 0; k<regions.size() && k+1 < regionStart.size(); ++k)
+        numAssets[k] = regionStart.at(k+1) - regionStart.at(k);
+
+    return numAssets;
+}
+
+
+const QVector<int>& SpatialAggregator::getAssetRegions() const
+{
+    return assetRegions;
+}
+
+
+const QVector<int>& SpatialAggregator::getAssetIDs() const
+{
+    return assetIDs;
+}
+
+
+bool SpatialAggregator::contains(const AggregationRegion& region, const QPointF& point)
+{
+    if(!region.bounds.isNull() && (point.x() < region.bounds.left() || point.x() > region.bounds.right() || point.y() < region.bounds.top() || point.y() > region.bounds.bottom()))
+        return false;
+
+    // Crossing number test over all of the rings
+    bool inside = false;
+
+    for(auto&& ring : region.rings)
+    {
+        auto numVertices = ring.size();
+
+        for(int i = 0, j = numVertices - 1; i<numVertices; j = i++)
+        {
+            const auto& a = ring.at(i);
+            const auto& b = ring.at(j);
+
+            if((a.y() > point.y()) != (b.y() > point.y()))
+            {
+                auto xCross = (b.x() - a.x())*(point.y() - a.y())/(b.y() - a.y()) + a.x();
+
+                if(point.x() < xCross)
+                    inside = !inside;
+            }
+        }
+    }
+
+    return inside;
+}
+
+
+void SpatialAggregator::groupAssets(void)
+{
+    // Counting sort of the assets by region, the assets that are not in a region are left out
+    auto numRegions = regions.size();
+
+    regionStart.fill(0, numRegions + 1);
+
+    for(auto&& k : assetRegions)
+    {
+        if(k >= 0)
+            ++regionStart[k+1];
+    }
+
+    for(int k = 0; k<numRegions; ++k)
+        regionStart[k+1] += regionStart[k];
+
+    regionAssets.resize(regionStart.last());
+
+    auto next = regionStart;
+
+    for(int i = 0; i<assetRegions.size(); ++i)
+    {
+        auto k = assetRegions.at(i);
+
+        if(k >= 0)
+            regionAssets[next[k]++] = i;
+    }
+}
@@ -0,0 +1,121 @@
+#ifndef SPATIALAGGREGATOR_H
+#define SPATIALAGGREGATOR_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "PointGridIndex.h"
+
+#include <QPolygonF>
+#include <QString>
+#include <QVector>
+
+// A region that the assets are aggregated to, e.g., a census tract or a cell of a grid
+// The coordinates are longitude and latitude, a point is inside if it is inside of an odd number of rings so that holes are excluded
+struct AggregationRegion
+{
+    QString name;
+    QVector<QPolygonF> rings;
+    QRectF bounds;
+};
+
+
+// Spatial join of the assets to a set of regions and the reduction of the asset results over each region
+// The join is kept so that a different result, or a different statistic, only re-runs the reduction
+class SpatialAggregator
+{
+public:
+    SpatialAggregator();
+
+    enum Statistic {Sum = 0, Mean = 1, Quantile = 2, Count = 3};
+
+    // Sets the locations of the assets, as longitude and latitude, and builds the spatial index
+    // The values that are reduced must be in the same order as the assets
+    void setAssets(const QVector<int>& IDs, const QVector<QPointF>& locations);
+
+    // Adds assets after the ones that were set, the join is cleared so that it is redone with all of the assets
+    void appendAssets(const QVector<int>& IDs, const QVector<QPointF>& locations);
+
+    // Joins the assets to the polygons, an asset that is in more than one region is assigned to the first one
+    int joinToRegions(const QVector<AggregationRegion>& regions, QString& errMsg);
+
+    // Joins the assets to a grid of square or hexagonal cells with the given spacing in km, only the cells that contain assets are kept
+    int joinToGrid(const double cellSize, const bool hexagonal, QString& errMsg);
+
+    // Returns the statistic of the values of the assets in each region, the level is the probability of the quantile
+    // Regions without assets are NaN, except for the sum and the count which are zero
+    QVector<double> reduce(const QVector<double>& values, const Statistic stat, const double level = 0.9) const;
+
+    void clear(void);
+
+    // The join is tagged with a key so that the caller can tell whether it needs to be redone, e.g., when the grid spacing is changed
+    QString getJoinKey() const;
+    void setJoinKey(const QString& value);
+
+    const QVector<AggregationRegion>& getRegions() const;
+
+    QVector<int> getNumberOfAssetsPerRegion() const;
+
+    // The index of the region of each asset, or -1 if the asset is not in any region
+    const QVector<int>& getAssetRegions() const;
+
+    const QVector<int>& getAssetIDs() const;
+
+    static bool contains(const AggregationRegion& region, const QPointF& point);
+
+private:
+
+    // Groups the assets by region in compressed row format
+    void groupAssets(void);
+
+    QVector<int> assetIDs;
+    QVector<QPointF> assetLocations;
+
+    PointGridIndex assetIndex;
+
+    QVector<AggregationRegion> regions;
+
+    QVector<int> assetRegions;
+
+    // The assets of region k are regionAssets[regionStart[k]] to regionAssets[regionStart[k+1]-1], in ascending order
+    QVector<int> regionStart;
+    QVector<int> regionAssets;
+
+    QString joinKey;
+};
+
+#endif // SPATIALAGGREGATOR_H
@@ -0,0 +1,331 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "TDigest.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+TDigest::TDigest(const double compression) : compression(compression)
+{
+    totalWeight = 0.0;
+    min = std::numeric_limits<double>::infinity();
+    max = -std::numeric_limits<double>::infinity();
+}
+
+
+void TDigest::add(const double value, const double weight)
+{
+    // Infinite values would make the interpolation between the centroids and the extremes NaN
+    if(!std::isfinite(value) || !std::isfinite(weight) || weight <= 0.0)
+        return;
+
+    buffer.push_back({value, weight});
+
+    totalWeight += weight;
+
+    if(value < min)
+        min = value;
+
+    if(value > max)
+        max = value;
+
+    // Merge when the buffer holds a few times the number of centroids
+    if(buffer.size() >= static_cast<int>(5.0*compression))
+        this->compress();
+}
+
+
+void TDigest::add(const double* values, const int numValues)
+{
+    for(int i = 0; i<numValues; ++i)
+        this->add(values[i]);
+}
+
+
+void TDigest::merge(const TDigest& other)
+{
+    if(other.isEmpty())
+        return;
+
+    buffer.append(other.centroids);
+    buffer.append(other.buffer);
+
+    totalWeight += other.totalWeight;
+    min = std::min(min, other.min);
+    max = std::max(max, other.max);
+
+    this->compress();
+}
+
+
+void TDigest::compress(void)
+{
+    if(buffer.isEmpty())
+        return;
+
+    buffer.append(centroids);
+    centroids.clear();
+
+    std::sort(buffer.begin(), buffer.end(), [](const Centroid& a, const Centroid& b)
+    {
+        return a.mean < b.mean;
+    });
+
+    auto current = buffer.first();
+
+    // The weight of the centroids that are completed
+    auto weightSoFar = 0.0;
+
+    for(int i = 1; i<buffer.size(); ++i)
+    {
+        const auto& next = buffer.at(i);
+
+        auto proposedWeight = current.weight + next.weight;
+
+        auto qLeft = weightSoFar/totalWeight;
+        auto qRight = (weightSoFar + proposedWeight)/totalWeight;
+
+        // A centroid can span at most one unit of the scale function
+        if(this->scale(qRight) - this->scale(qLeft) <= 1.0)
+        {
+            current.mean += (next.mean - current.mean)*next.weight/proposedWeight;
+            current.weight = proposedWeight;
+        }
+        else
+        {
+            weightSoFar += current.weight;
+            centroids.push_back(current);
+            current = next;
+        }
+    }
+
+    centroids.push_back(current);
+
+    buffer.clear();
+}
+
+
+double TDigest::quantile(const double q) const
+{
+    if(this->isEmpty())
+        return 0.0;
+
+    // Work on a compressed copy if there are buffered samples
+    if(!buffer.isEmpty())
+    {
+        auto copy = *this;
+        copy.compress();
+        return copy.quantile(q);
+    }
+
+    if(q <= 0.0)
+        return min;
+
+    if(q >= 1.0)
+        return max;
+
+    if(centroids.size() == 1)
+        return centroids.first().mean;
+
+    auto index = q*totalWeight;
+
+    // Interpolate from the minimum to the center of the first centroid
+    const auto& first = centroids.first();
+    if(index < first.weight/2.0)
+        return min + (first.mean - min)*index/(first.weight/2.0);
+
+    // Interpolate between the centers of the neighbouring centroids
+    auto weightSoFar = first.weight/2.0;
+
+    for(int i = 0; i<centroids.size()-1; ++i)
+    {
+        const auto& left = centroids.at(i);
+        const auto& right = centroids.at(i+1);
+
+        auto delta = (left.weight + right.weight)/2.0;
+
+        if(weightSoFar + delta > index)
+        {
+            auto fraction = (index - weightSoFar)/delta;
+            return left.mean + fraction*(right.mean - left.mean);
+        }
+
+        weightSoFar += delta;
+    }
+
+    // Interpolate from the center of the last centroid to the maximum
+    const auto& last = centroids.last();
+    auto fraction = (index - weightSoFar)/(last.weight/2.0);
+
+    return last.mean + std::min(fraction, 1.0)*(max - last.mean);
+}
+
+
+double TDigest::cdf(const double value) const
+{
+    if(this->isEmpty() || value < min)
+        return 0.0;
+
+    if(value >= max)
+        return 1.0;
+
+    if(!buffer.isEmpty())
+    {
+        auto copy = *this;
+        copy.compress();
+        return copy.cdf(value);
+    }
+
+    if(centroids.size() == 1)
+        return 0.5;
+
+    const auto& first = centroids.first();
+
+    if(value < first.mean)
+        return (first.weight/2.0)*(value - min)/(first.mean - min)/totalWeight;
+
+    auto weightSoFar = first.weight/2.0;
+
+    for(int i = 0; i<centroids.size()-1; ++i)
+    {
+        const auto& left = centroids.at(i);
+        const auto& right = centroids.at(i+1);
+
+        auto delta = (left.weight + right.weight)/2.0;
+
+        if(value < right.mean)
+        {
+            auto fraction = (right.mean > left.mean) ? (value - left.mean)/(right.mean - left.mean) : 0.5;
+            return (weightSoFar + fraction*delta)/totalWeight;
+        }
+
+        weightSoFar += delta;
+    }
+
+    const auto& last = centroids.last();
+    auto fraction = (max > last.mean) ? (value - last.mean)/(max - last.mean) : 1.0;
+
+    return (weightSoFar + fraction*last.weight/2.0)/totalWeight;
+}
+
+
+double TDigest::tailMean(const double q) const
+{
+    if(this->isEmpty())
+        return 0.0;
+
+    if(!buffer.isEmpty())
+    {
+        auto copy = *this;
+        copy.compress();
+        return copy.tailMean(q);
+    }
+
+    if(q >= 1.0)
+        return max;
+
+    auto threshold = std::max(q, 0.0)*totalWeight;
+
+    // Sum the part of each centroid that lies above the threshold
+    auto weightSoFar = 0.0;
+    auto tailSum = 0.0;
+    auto tailWeight = 0.0;
+
+    for(auto&& it : centroids)
+    {
+        auto upper = weightSoFar + it.weight;
+
+        if(upper > threshold)
+        {
+            auto weightAbove = std::min(it.weight, upper - threshold);
+            tailSum += weightAbove*it.mean;
+            tailWeight += weightAbove;
+        }
+
+        weightSoFar = upper;
+    }
+
+    if(tailWeight <= 0.0)
+        return max;
+
+    // The value at risk is a lower bound of the tail mean
+    return std::max(tailSum/tailWeight, this->quantile(q));
+}
+
+
+double TDigest::getTotalWeight() const
+{
+    return totalWeight;
+}
+
+
+double TDigest::getMin() const
+{
+    return min;
+}
+
+
+double TDigest::getMax() const
+{
+    return max;
+}
+
+
+bool TDigest::isEmpty() const
+{
+    return totalWeight <= 0.0;
+}
+
+
+int TDigest::getNumberOfCentroids() const
+{
+    return centroids.size() + buffer.size();
+}
+
+
+double TDigest::scale(const double q) const
+{
+    // The k2 scale function of Dunning and Ertl, the centroids shrink in proportion to q*(1-q) towards the tails
+    auto normalizer = 4.0*std::log(std::max(totalWeight/compression, 1.0)) + 24.0;
+
+    auto qClamped = std::min(std::max(q, 1.0e-15), 1.0 - 1.0e-15);
+
+    return compression/normalizer*std::log(qClamped/(1.0 - qClamped));
+}
@@ -0,0 +1,104 @@
+#ifndef TDIGEST_H
+#define TDIGEST_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include <QVector>
+
+// Mergeable sketch of a distribution for estimating quantiles from a stream of samples without storing them
+// This is the merging t-digest, the samples are kept as weighted centroids that are small near the tails and large near the median so that the extreme quantiles stay accurate
+// Sketches that are built on separate threads, or from separate blocks of samples, can be combined with merge()
+class TDigest
+{
+public:
+    // A larger compression keeps more centroids, i.e., more accuracy for more memory
+    TDigest(const double compression = 200.0);
+
+    // Values that are not finite and weights that are not positive are ignored
+    void add(const double value, const double weight = 1.0);
+
+    void add(const double* values, const int numValues);
+
+    void merge(const TDigest& other);
+
+    // Merges the buffered samples into the centroids
+    void compress(void);
+
+    // Returns the estimate of the value at the probability level q
+    double quantile(const double q) const;
+
+    // Returns the estimate of the probability that a sample is less than or equal to the value
+    double cdf(const double value) const;
+
+    // Returns the estimate of the mean of the samples above the quantile at the probability level q
+    double tailMean(const double q) const;
+
+    double getTotalWeight() const;
+
+    double getMin() const;
+
+    double getMax() const;
+
+    bool isEmpty() const;
+
+    int getNumberOfCentroids() const;
+
+private:
+
+    struct Centroid
+    {
+        double mean;
+        double weight;
+    };
+
+    // The scale function that limits the size of the centroids
+    double scale(const double q) const;
+
+    double compression;
+
+    QVector<Centroid> centroids;
+
+    // Samples that are not yet merged into the centroids
+    QVector<Centroid> buffer;
+
+    double totalWeight;
+    double min;
+    double max;
+};
+
+#endif // TDIGEST_H
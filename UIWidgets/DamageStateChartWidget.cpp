@@ -0,0 +1,188 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "DamageStateChartWidget.h"
+#include "WorkflowAppR2D.h"
+
+#include <QBarCategoryAxis>
+#include <QBarSet>
+#include <QChart>
+#include <QChartView>
+#include <QComboBox>
+#include <QGraphicsLayout>
+#include <QGridLayout>
+#include <QHorizontalPercentBarSeries>
+#include <QLabel>
+#include <QSignalBlocker>
+#include <QValueAxis>
+
+using namespace QtCharts;
+
+DamageStateChartWidget::DamageStateChartWidget(QWidget* parent) : QWidget(parent)
+{
+    auto layout = new QGridLayout(this);
+
+    classComboBox = new QComboBox(this);
+    groupComboBox = new QComboBox(this);
+
+    damageChart = new QChart();
+    damageChart->setDropShadowEnabled(false);
+    damageChart->setMargins(QMargins(5,5,5,5));
+    damageChart->layout()->setContentsMargins(0, 0, 0, 0);
+    damageChart->legend()->setAlignment(Qt::AlignBottom);
+
+    damageChartView = new QChartView(damageChart, this);
+    damageChartView->setRenderHint(QPainter::Antialiasing);
+    damageChartView->setMinimumHeight(250);
+
+    connect(classComboBox,QOverload<int>::of(&QComboBox::currentIndexChanged),this, &DamageStateChartWidget::updateChart);
+    connect(groupComboBox,QOverload<int>::of(&QComboBox::currentIndexChanged),this, &DamageStateChartWidget::updateChart);
+
+    layout->addWidget(new QLabel("Class:", this),0,0);
+    layout->addWidget(classComboBox,0,1);
+    layout->addWidget(new QLabel("Components:", this),0,2);
+    layout->addWidget(groupComboBox,0,3);
+    layout->addWidget(damageChartView,1,0,1,4);
+    layout->setRowStretch(1,1);
+}
+
+
+void DamageStateChartWidget::setData(const ResultsTable& DMResults, const DMSummary& summary, const QStringList& attributeNames, const QVector<QStringList>& attributes)
+{
+    this->clear();
+
+    DMdata = DMResults;
+    DMsummary = summary;
+    attributeColumns = attributes;
+
+    QSignalBlocker classBlocker(classComboBox);
+    QSignalBlocker groupBlocker(groupComboBox);
+
+    classComboBox->addItems(attributeNames);
+
+    // Default to the attribute that the building layers are split by
+    auto defaultClass = attributeNames.indexOf("OccupancyClass");
+    classComboBox->setCurrentIndex(defaultClass != -1 ? defaultClass : 0);
+
+    for(auto&& it : summary.groups)
+        groupComboBox->addItem(it.name);
+
+    classBlocker.unblock();
+    groupBlocker.unblock();
+
+    this->updateChart();
+}
+
+
+void DamageStateChartWidget::clear(void)
+{
+    QSignalBlocker classBlocker(classComboBox);
+    QSignalBlocker groupBlocker(groupComboBox);
+
+    classComboBox->clear();
+    groupComboBox->clear();
+
+    DMdata.clear();
+    DMsummary = DMSummary();
+    attributeColumns.clear();
+
+    damageChart->removeAllSeries();
+
+    for(auto&& it : damageChart->axes())
+        damageChart->removeAxis(it);
+}
+
+
+QChartView* DamageStateChartWidget::getChartView() const
+{
+    return damageChartView;
+}
+
+
+void DamageStateChartWidget::updateChart(void)
+{
+    damageChart->removeAllSeries();
+
+    for(auto&& it : damageChart->axes())
+        damageChart->removeAxis(it);
+
+    auto attribute = classComboBox->currentIndex();
+    auto groupIndex = groupComboBox->currentIndex();
+
+    if(attribute < 0 || attribute >= attributeColumns.size() || groupIndex < 0 || groupIndex >= DMsummary.groups.size())
+        return;
+
+    const auto& group = DMsummary.groups.at(groupIndex);
+
+    auto classColumn = DictionaryColumn::encode(classComboBox->currentText(), attributeColumns.at(attribute));
+
+    QVector<QVector<double>> distributions;
+    QString errMsg;
+
+    if(DMResultsProcessor::getClassDistributions(DMdata, group, classColumn, distributions, errMsg) != 0)
+    {
+        WorkflowAppR2D::getInstance()->errorMessage(errMsg);
+        return;
+    }
+
+    // One bar per class, stacked by the damage states
+    auto series = new QHorizontalPercentBarSeries();
+
+    for(int k = 0; k<group.damageStates.size(); ++k)
+    {
+        auto set = new QBarSet(group.damageStates.at(k));
+
+        for(auto&& it : distributions)
+            set->append(it.at(k));
+
+        series->append(set);
+    }
+
+    damageChart->addSeries(series);
+
+    auto axisY = new QBarCategoryAxis();
+    axisY->append(classColumn.dictionary);
+    damageChart->addAxis(axisY, Qt::AlignLeft);
+    series->attachAxis(axisY);
+
+    auto axisX = new QValueAxis();
+    axisX->setTitleText("Fraction of Assets in each Damage State [%]");
+    damageChart->addAxis(axisX, Qt::AlignBottom);
+    series->attachAxis(axisX);
+}
+
@@ -0,0 +1,90 @@
+#ifndef DAMAGESTATECHARTWIDGET_H
+#define DAMAGESTATECHARTWIDGET_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "DMResultsProcessor.h"
+#include "ResultsTable.h"
+
+#include <QStringList>
+#include <QVector>
+#include <QWidget>
+
+class QComboBox;
+
+namespace QtCharts
+{
+class QChart;
+class QChartView;
+}
+
+// Stacked chart of the distribution of the damage states in each class of assets, e.g., the fraction of the buildings of each occupancy class in each damage state
+class DamageStateChartWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    DamageStateChartWidget(QWidget* parent);
+
+    // Sets the DM results and the attributes of the assets, the attribute columns are in the order of the rows of the DM results
+    void setData(const ResultsTable& DMResults, const DMSummary& summary, const QStringList& attributeNames, const QVector<QStringList>& attributeColumns);
+
+    void clear(void);
+
+    QtCharts::QChartView* getChartView() const;
+
+private slots:
+
+    void updateChart(void);
+
+private:
+
+    ResultsTable DMdata;
+
+    DMSummary DMsummary;
+
+    QVector<QStringList> attributeColumns;
+
+    QComboBox* classComboBox;
+    QComboBox* groupComboBox;
+
+    QtCharts::QChart* damageChart;
+    QtCharts::QChartView* damageChartView;
+};
+
+#endif // DAMAGESTATECHARTWIDGET_H
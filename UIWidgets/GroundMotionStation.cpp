@@ -43,10 +43,8 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <QString>
 #include <QDir>
 #include <QStringList>
-#include <QJsonObject>
-#include <QJsonDocument>
-#include <QJsonArray>
-#include <QFile>
+
+#include <cmath>
 
 GroundMotionStation::GroundMotionStation(QString path, double lat, double lon) : stationFilePath(path), latitude(lat), longitude(lon)
 {
@@ -65,8 +63,11 @@ double GroundMotionStation::getLongitude() const
 }
 
 
-void GroundMotionStation::importGroundMotions(void)
+void GroundMotionStation::readRecordList(void)
 {
+    recordFiles.clear();
+    scalingFactors.clear();
+
     CSVReaderWriter csvTool;
 
     QString err;
@@ -115,126 +116,150 @@ void GroundMotionStation::importGroundMotions(void)
 
             auto GMFilePath = baseDir + QDir::separator() + GMFile + ".json";
 
-            this->importGroundMotionTimeHistory(GMFilePath, factor);
+            // Prefer the binary record when it is at least as new as the json file
+            QFileInfo binaryInfo(baseDir + QDir::separator() + GMFile + GroundMotionRecordFile::extension());
+            QFileInfo jsonInfo(GMFilePath);
+
+            auto useBinary = binaryInfo.exists() && (!jsonInfo.exists() || binaryInfo.lastModified() >= jsonInfo.lastModified());
+
+            // Fall back to the json file if the binary record cannot be read, e.g., when its conversion was interrupted
+            if(useBinary && jsonInfo.exists())
+            {
+                GroundMotionRecordInfo info;
+                QString errMsg;
+
+                if(GroundMotionRecordFile::readInfo(binaryInfo.absoluteFilePath(), info, errMsg) != 0)
+                    useBinary = false;
+            }
+
+            if(useBinary)
+                recordFiles.append(binaryInfo.absoluteFilePath());
+            else
+                recordFiles.append(GMFilePath);
+
+            scalingFactors.append(factor);
         }
     }
 
 }
 
 
-void GroundMotionStation::importGroundMotionTimeHistory(const QString& filePath,const double scalingFactor)
+QStringList GroundMotionStation::getRecordFiles() const
 {
-    QFile file(filePath);
-    if (!file.open(QFile::ReadOnly | QFile::Text))
-        throw "Could not open the file at: "+ filePath;
+    return recordFiles;
+}
 
 
-    // place contents of file into json object
-    QString val;
-    val=file.readAll();
-    QJsonDocument doc = QJsonDocument::fromJson(val.toUtf8());
-    QJsonObject jsonObj = doc.object();
+void GroundMotionStation::importGroundMotions(std::shared_ptr<GroundMotionRecordCache> recordCache)
+{
+    stationRecords.clear();
 
-    // close file
-    file.close();
+    for(auto&& it : recordFiles)
+    {
+        auto info = recordCache->getRecordInfo(it);
 
-    // Get the name
-    auto gmNameObj = jsonObj.value("name");
+        if(info == nullptr)
+            throw "The ground motion record " + it + " has not been loaded";
 
-    if(gmNameObj.isNull())
-        throw "NUll JSON object for field 'name'";
+        stationRecords.append(info);
+    }
 
-    QString gmName = gmNameObj.toString();
+    theRecordCache = recordCache;
+}
 
-    // Get the time=step size
-    auto dTObj = jsonObj.value("dT");
 
-    if(dTObj.isNull())
-        throw "NUll JSON object for field 'dT'";
+void GroundMotionStation::importGroundMotions(void)
+{
+    this->readRecordList();
 
-    double dT = dTObj.toDouble();
+    auto recordCache = std::make_shared<GroundMotionRecordCache>();
 
-    GroundMotionTimeHistory newGM(gmName);
+    QString err;
+    if(recordCache->loadRecords(recordFiles, err) != 0)
+        throw err;
 
-    newGM.setDT(dT);
+    this->importGroundMotions(recordCache);
+}
 
-    // Get the time history in the x-direction
-    if(!jsonObj.value("data_x").isNull())
-    {
-        auto xArray = jsonObj.value("data_x").toArray();
 
-        QVector<double> data_x(xArray.size());
+GroundMotionTimeHistory GroundMotionStation::getGroundMotion(const int i) const
+{
+    if(i < 0 || i >= stationRecords.size())
+        throw "The ground motion " + QString::number(i) + " is not in the station " + stationFilePath;
 
-        for(int i = 0; i<xArray.size(); ++i)
-        {
-            data_x[i] = xArray.at(i).toDouble(0.0);
-        }
+    QString err;
+    auto record = theRecordCache->getRecord(recordFiles.at(i), err);
 
-        newGM.setX(data_x);
-    }
+    if(record == nullptr)
+        throw err;
 
-    // Get the time history in the y-direction
-    if(!jsonObj.value("data_y").isNull())
-    {
-        auto yArray = jsonObj.value("data_y").toArray();
+    GroundMotionTimeHistory newGM(record->name);
 
-        QVector<double> data_y(yArray.size());
+    newGM.setDT(record->dT);
 
-        for(int i = 0; i<yArray.size(); ++i)
-        {
-            data_y[i] = yArray.at(i).toDouble(0.0);
-        }
+    // The time histories share the samples of the record in the cache
+    if(!record->channels.at(0).isEmpty())
+        newGM.setX(record->channels.at(0));
 
-        newGM.setY(data_y);
-    }
+    if(!record->channels.at(1).isEmpty())
+        newGM.setY(record->channels.at(1));
 
-    // Get the time history in the y-direction
-    if(!jsonObj.value("data_z").isNull())
-    {
-        auto zArray = jsonObj.value("data_z").toArray();
+    if(!record->channels.at(2).isEmpty())
+        newGM.setZ(record->channels.at(2));
 
-        QVector<double> data_z(zArray.size());
+    // The peak values are NaN for the components that are not in the record
+    if(!std::isnan(record->peakValues.at(0)))
+        newGM.setPeakIntensityMeasureX(record->peakValues.at(0));
 
-        for(int i = 0; i<zArray.size(); ++i)
-        {
-            data_z[i] = zArray.at(i).toDouble(0.0);
-        }
+    if(!std::isnan(record->peakValues.at(1)))
+        newGM.setPeakIntensityMeasureY(record->peakValues.at(1));
 
-        newGM.setZ(data_z);
-    }
+    if(!std::isnan(record->peakValues.at(2)))
+        newGM.setPeakIntensityMeasureZ(record->peakValues.at(2));
 
-    // Set PGA if avail.
-    if(!jsonObj.value("PGA_x").isNull())
-    {
-        double PGA_x = jsonObj.value("PGA_x").toDouble(0.0);
+    newGM.setScalingFactor(scalingFactors.at(i));
 
-        newGM.setPeakIntensityMeasureX(PGA_x);
-    }
+    return newGM;
+}
 
-    if(!jsonObj.value("PGA_y").isNull())
-    {
-        double PGA_y = jsonObj.value("PGA_y").toDouble(0.0);
 
-        newGM.setPeakIntensityMeasureY(PGA_y);
-    }
+QVector<GroundMotionTimeHistory> GroundMotionStation::getStationGroundMotions() const
+{
+    QVector<GroundMotionTimeHistory> stationGroundMotions;
 
-    if(!jsonObj.value("PGA_z").isNull())
-    {
-        double PGA_z = jsonObj.value("PGA_z").toDouble(0.0);
+    for(int i = 0; i<stationRecords.size(); ++i)
+        stationGroundMotions.push_back(this->getGroundMotion(i));
+
+    return stationGroundMotions;
+}
+
+
+int GroundMotionStation::getNumberOfGroundMotions() const
+{
+    return stationRecords.size();
+}
 
-        newGM.setPeakIntensityMeasureZ(PGA_z);
-    }
 
-    newGM.setScalingFactor(scalingFactor);
+QStringList GroundMotionStation::getGroundMotionNames() const
+{
+    QStringList names;
 
-    stationGroundMotions.push_back(std::move(newGM));
+    for(auto&& it : stationRecords)
+        names.append(it->name);
 
+    return names;
 }
 
 
-QVector<GroundMotionTimeHistory> GroundMotionStation::getStationGroundMotions() const
+std::shared_ptr<const GroundMotionRecordInfo> GroundMotionStation::getGroundMotionInfo(const int i) const
 {
-    return stationGroundMotions;
+    return stationRecords.value(i);
+}
+
+
+QVector<double> GroundMotionStation::getScalingFactors() const
+{
+    return scalingFactors;
 }
 
 
@@ -38,6 +38,7 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 // Written by: Stevan Gavrilovic
 
+#include "GroundMotionRecordCache.h"
 #include "GroundMotionTimeHistory.h"
 
 #include <QMap>
@@ -54,10 +55,33 @@ public:
 
     QString getStationFilePath() const;
 
+    // Reads the list of records and their scaling factors from the station file
+    void readRecordList(void);
+
+    // The record files of the station, with the binary record file in place of the json file where it is available
+    QStringList getRecordFiles() const;
+
+    // Attaches the station to the metadata of its records in the cache, readRecordList must be called first
+    void importGroundMotions(std::shared_ptr<GroundMotionRecordCache> recordCache);
+
+    // Reads the record list and the metadata of the records of this station alone
     void importGroundMotions(void);
 
+    // The time histories are read from the record cache when they are requested, throws an error message if the record cannot be read
+    GroundMotionTimeHistory getGroundMotion(const int i) const;
+
+    // Reads the time histories of all of the records of the station
     QVector<GroundMotionTimeHistory> getStationGroundMotions() const;
 
+    int getNumberOfGroundMotions() const;
+
+    QStringList getGroundMotionNames() const;
+
+    // The name, time step, number of points and peak values of a record, without its time histories
+    std::shared_ptr<const GroundMotionRecordInfo> getGroundMotionInfo(const int i) const;
+
+    QVector<double> getScalingFactors() const;
+
     // Function to convert a QString and QVariant to double
     // Throws an error exception if conversion fails
     template <typename T>
@@ -78,15 +102,20 @@ public:
 
 private:
 
-    void importGroundMotionTimeHistory(const QString& filePath, const double scalingFactor);
-
     QString stationFilePath;
 
     double latitude;
 
     double longitude;
 
-    QVector<GroundMotionTimeHistory> stationGroundMotions;
+    QStringList recordFiles;
+
+    QVector<double> scalingFactors;
+
+    // Handles to the metadata of the records, which are shared with the other stations
+    QVector<std::shared_ptr<const GroundMotionRecordInfo>> stationRecords;
+
+    std::shared_ptr<GroundMotionRecordCache> theRecordCache;
 
     QMap<QString,QVariant> attributes;
 
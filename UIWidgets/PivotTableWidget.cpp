@@ -0,0 +1,532 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "PivotTableWidget.h"
+#include "WorkflowAppR2D.h"
+
+#include <QBarCategoryAxis>
+#include <QBarSeries>
+#include <QBarSet>
+#include <QChart>
+#include <QChartView>
+#include <QComboBox>
+#include <QDoubleSpinBox>
+#include <QGraphicsLayout>
+#include <QGridLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QSignalBlocker>
+#include <QSplitter>
+#include <QTableWidget>
+#include <QValueAxis>
+#include <QtConcurrent>
+#include <QtNumeric>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace QtCharts;
+
+namespace
+{
+
+// Only the attributes where every value that is given is a number can be binned, otherwise the numbers are empty
+QVector<double> toNumbers(const QStringList& column)
+{
+    QVector<double> numbers(column.size());
+
+    for(int i = 0; i<column.size(); ++i)
+    {
+        if(column.at(i).isEmpty())
+        {
+            numbers[i] = qQNaN();
+            continue;
+        }
+
+        bool OK;
+        numbers[i] = column.at(i).toDouble(&OK);
+
+        if(!OK)
+            return QVector<double>();
+    }
+
+    return numbers;
+}
+
+}
+
+PivotTableWidget::PivotTableWidget(QWidget* parent) : QWidget(parent)
+{
+    auto layout = new QGridLayout(this);
+
+    rowKeyComboBox = new QComboBox(this);
+    columnKeyComboBox = new QComboBox(this);
+
+    binWidthSpinBox = new QDoubleSpinBox(this);
+    binWidthSpinBox->setRange(0.001,1.0e9);
+    binWidthSpinBox->setDecimals(3);
+    binWidthSpinBox->setValue(10.0);
+    binWidthSpinBox->setToolTip("The width of the bins of the numerical attributes, e.g., 10 groups the year built by decade");
+    binWidthSpinBox->setEnabled(false);
+
+    valueComboBox = new QComboBox(this);
+
+    aggregateComboBox = new QComboBox(this);
+    aggregateComboBox->insertItems(0,{"Count","Sum","Mean","Min","Max"});
+    aggregateComboBox->setCurrentIndex(GroupByEngine::Sum);
+
+    pivotTable = new QTableWidget(this);
+    pivotTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    pivotTable->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+
+    pivotChart = new QChart();
+    pivotChart->setDropShadowEnabled(false);
+    pivotChart->setMargins(QMargins(5,5,5,5));
+    pivotChart->layout()->setContentsMargins(0, 0, 0, 0);
+
+    pivotChartView = new QChartView(pivotChart, this);
+    pivotChartView->setRenderHint(QPainter::Antialiasing);
+    pivotChartView->setMinimumHeight(200);
+
+    auto splitter = new QSplitter(Qt::Vertical, this);
+    splitter->addWidget(pivotTable);
+    splitter->addWidget(pivotChartView);
+
+    connect(rowKeyComboBox,QOverload<int>::of(&QComboBox::currentIndexChanged),this, &PivotTableWidget::handleKeyChanged);
+    connect(columnKeyComboBox,QOverload<int>::of(&QComboBox::currentIndexChanged),this, &PivotTableWidget::handleKeyChanged);
+    connect(binWidthSpinBox,QOverload<double>::of(&QDoubleSpinBox::valueChanged),this, &PivotTableWidget::updatePivot);
+    connect(valueComboBox,QOverload<int>::of(&QComboBox::currentIndexChanged),this, &PivotTableWidget::updatePivot);
+    connect(aggregateComboBox,QOverload<int>::of(&QComboBox::currentIndexChanged),this, &PivotTableWidget::updatePivot);
+
+    layout->addWidget(new QLabel("Rows:", this),0,0);
+    layout->addWidget(rowKeyComboBox,0,1);
+    layout->addWidget(new QLabel("Columns:", this),0,2);
+    layout->addWidget(columnKeyComboBox,0,3);
+    layout->addWidget(new QLabel("Bin Width:", this),1,0);
+    layout->addWidget(binWidthSpinBox,1,1);
+    layout->addWidget(new QLabel("Value:", this),2,0);
+    layout->addWidget(valueComboBox,2,1);
+    layout->addWidget(new QLabel("Aggregate:", this),2,2);
+    layout->addWidget(aggregateComboBox,2,3);
+    layout->addWidget(splitter,3,0,1,4);
+    layout->setRowStretch(3,1);
+}
+
+
+void PivotTableWidget::setData(const QStringList& names, const QVector<QStringList>& attributeColumns, const QStringList& resNames, const QVector<QVector<double>>& resColumns)
+{
+    this->clear();
+
+    attributeNames = names;
+    resultNames = resNames;
+    resultColumns = resColumns;
+
+    auto numAttributes = attributeColumns.size();
+
+    // The attributes are encoded once, one attribute per thread
+    encodedAttributes.resize(numAttributes);
+    numericalAttributes.resize(numAttributes);
+
+    auto encodedData = encodedAttributes.data();
+    auto numericalData = numericalAttributes.data();
+
+    QVector<int> attributeIndices;
+    for(int i = 0; i<numAttributes; ++i)
+        attributeIndices.push_back(i);
+
+    QtConcurrent::blockingMap(attributeIndices, [&](const int k)
+    {
+        const auto& column = attributeColumns.at(k);
+
+        encodedData[k] = DictionaryColumn::encode(attributeNames.value(k), column);
+
+        numericalData[k] = toNumbers(column);
+    });
+
+    // Block the signals until all of the combo boxes are filled
+    QSignalBlocker rowBlocker(rowKeyComboBox);
+    QSignalBlocker columnBlocker(columnKeyComboBox);
+    QSignalBlocker valueBlocker(valueComboBox);
+
+    rowKeyComboBox->addItems(attributeNames);
+
+    columnKeyComboBox->addItem("None");
+    columnKeyComboBox->addItems(attributeNames);
+
+    valueComboBox->addItems(resultNames);
+
+    // Occupancy class is the most common breakdown
+    auto occupancyIndex = attributeNames.indexOf("OccupancyClass");
+
+    if(occupancyIndex != -1)
+        rowKeyComboBox->setCurrentIndex(occupancyIndex);
+
+    rowBlocker.unblock();
+    columnBlocker.unblock();
+    valueBlocker.unblock();
+
+    this->handleKeyChanged();
+}
+
+
+void PivotTableWidget::appendData(const QVector<QStringList>& newAttributeColumns, const QStringList& resNames, const QVector<QVector<double>>& resColumns)
+{
+    if(newAttributeColumns.size() != encodedAttributes.size())
+        return;
+
+    if(resNames != resultNames)
+    {
+        QSignalBlocker valueBlocker(valueComboBox);
+
+        valueComboBox->clear();
+        valueComboBox->addItems(resNames);
+
+        resultNames = resNames;
+    }
+
+    resultColumns = resColumns;
+
+    auto encodedData = encodedAttributes.data();
+    auto numericalData = numericalAttributes.data();
+
+    QVector<int> attributeIndices;
+    for(int i = 0; i<newAttributeColumns.size(); ++i)
+        attributeIndices.push_back(i);
+
+    QtConcurrent::blockingMap(attributeIndices, [&](const int k)
+    {
+        const auto& column = newAttributeColumns.at(k);
+
+        encodedData[k].append(column);
+
+        // An attribute stops being numerical as soon as one of its values is not a number
+        auto& numbers = numericalData[k];
+
+        if(numbers.isEmpty())
+            return;
+
+        auto newNumbers = toNumbers(column);
+
+        if(newNumbers.isEmpty() && !column.isEmpty())
+            numbers.clear();
+        else
+            numbers.append(newNumbers);
+    });
+
+    this->updatePivot();
+}
+
+
+void PivotTableWidget::clear(void)
+{
+    QSignalBlocker rowBlocker(rowKeyComboBox);
+    QSignalBlocker columnBlocker(columnKeyComboBox);
+    QSignalBlocker valueBlocker(valueComboBox);
+
+    rowKeyComboBox->clear();
+    columnKeyComboBox->clear();
+    valueComboBox->clear();
+
+    attributeNames.clear();
+    encodedAttributes.clear();
+    numericalAttributes.clear();
+    resultNames.clear();
+    resultColumns.clear();
+
+    rowLabels.clear();
+    columnLabels.clear();
+    pivotValues.clear();
+
+    pivotTable->clear();
+    pivotTable->setRowCount(0);
+    pivotTable->setColumnCount(0);
+
+    pivotChart->removeAllSeries();
+
+    for(auto&& it : pivotChart->axes())
+        pivotChart->removeAxis(it);
+}
+
+
+QStringList PivotTableWidget::getRowLabels() const
+{
+    return rowLabels;
+}
+
+
+QStringList PivotTableWidget::getColumnLabels() const
+{
+    return columnLabels;
+}
+
+
+QVector<QVector<double>> PivotTableWidget::getValues() const
+{
+    return pivotValues;
+}
+
+
+void PivotTableWidget::handleKeyChanged(void)
+{
+    // Find a bin width that gives about ten bins of the numerical attributes that are binned
+    auto binnedRange = 0.0;
+
+    for(auto&& key : {rowKeyComboBox->currentIndex(), columnKeyComboBox->currentIndex() - 1})
+    {
+        if(key < 0 || key >= encodedAttributes.size())
+            continue;
+
+        const auto& numbers = numericalAttributes.at(key);
+
+        if(numbers.isEmpty() || encodedAttributes.at(key).dictionary.size() <= maxCategories)
+            continue;
+
+        auto minVal = std::numeric_limits<double>::max();
+        auto maxVal = std::numeric_limits<double>::lowest();
+
+        for(auto&& it : numbers)
+        {
+            if(std::isnan(it))
+                continue;
+
+            minVal = std::min(minVal, it);
+            maxVal = std::max(maxVal, it);
+        }
+
+        if(maxVal > minVal)
+            binnedRange = std::max(binnedRange, maxVal - minVal);
+    }
+
+    binWidthSpinBox->setEnabled(binnedRange > 0.0);
+
+    if(binnedRange > 0.0)
+    {
+        // Round to 1, 2 or 5 times a power of ten
+        auto rawWidth = binnedRange/10.0;
+        auto magnitude = std::pow(10.0, std::floor(std::log10(rawWidth)));
+        auto fraction = rawWidth/magnitude;
+
+        auto niceFraction = fraction < 1.5 ? 1.0 : (fraction < 3.5 ? 2.0 : (fraction < 7.5 ? 5.0 : 10.0));
+
+        QSignalBlocker blocker(binWidthSpinBox);
+        binWidthSpinBox->setValue(niceFraction*magnitude);
+    }
+
+    this->updatePivot();
+}
+
+
+DictionaryColumn PivotTableWidget::getKeyColumn(const int attribute) const
+{
+    const auto& numbers = numericalAttributes.at(attribute);
+
+    const auto& encoded = encodedAttributes.at(attribute);
+
+    if(numbers.isEmpty() || encoded.dictionary.size() <= maxCategories)
+        return encoded;
+
+    return DictionaryColumn::encodeBins(encoded.name, numbers, binWidthSpinBox->value());
+}
+
+
+void PivotTableWidget::updatePivot(void)
+{
+    auto rowKey = rowKeyComboBox->currentIndex();
+    auto columnKey = columnKeyComboBox->currentIndex() - 1;
+    auto valueIndex = valueComboBox->currentIndex();
+
+    if(rowKey < 0 || rowKey >= encodedAttributes.size() || valueIndex < 0 || valueIndex >= resultColumns.size())
+        return;
+
+    auto aggregate = static_cast<GroupByEngine::Aggregate>(aggregateComboBox->currentIndex());
+
+    const auto& values = resultColumns.at(valueIndex);
+
+    auto rowColumn = this->getKeyColumn(rowKey);
+
+    // The totals of the rows
+    GroupByEngine rowEngine;
+    rowEngine.addKeyColumn(rowColumn);
+
+    GroupByResult rowResult;
+    QString errMsg;
+
+    if(rowEngine.groupBy(values, rowResult, errMsg) != 0)
+    {
+        WorkflowAppR2D::getInstance()->errorMessage(errMsg);
+        return;
+    }
+
+    auto rowTotals = GroupByEngine::getAggregate(rowResult, aggregate);
+
+    rowLabels.clear();
+
+    // The row of each code of the dictionary, only the groups with assets are shown
+    QVector<int> rowOfCode(rowColumn.dictionary.size(), -1);
+
+    for(int g = 0; g<rowResult.numGroups(); ++g)
+    {
+        rowOfCode[rowResult.keyCodes.at(g).first()] = rowLabels.size();
+        rowLabels.append(rowResult.keys.at(g).first());
+    }
+
+    columnLabels.clear();
+    pivotValues.clear();
+
+    if(columnKey >= 0 && columnKey < encodedAttributes.size())
+    {
+        auto columnColumn = this->getKeyColumn(columnKey);
+
+        GroupByEngine engine;
+        engine.addKeyColumn(rowColumn);
+        engine.addKeyColumn(columnColumn);
+
+        GroupByResult result;
+
+        if(engine.groupBy(values, result, errMsg) != 0)
+        {
+            WorkflowAppR2D::getInstance()->errorMessage(errMsg);
+            return;
+        }
+
+        auto cellValues = GroupByEngine::getAggregate(result, aggregate);
+
+        // Only the column groups that have assets are shown
+        QVector<int> columnOfCode(columnColumn.dictionary.size(), -1);
+
+        for(int g = 0; g<result.numGroups(); ++g)
+            columnOfCode[result.keyCodes.at(g).at(1)] = 0;
+
+        for(int code = 0; code<columnOfCode.size(); ++code)
+        {
+            if(columnOfCode.at(code) == -1)
+                continue;
+
+            columnOfCode[code] = columnLabels.size();
+            columnLabels.append(columnColumn.dictionary.at(code));
+        }
+
+        // Empty cells are NaN
+        pivotValues.fill(QVector<double>(columnLabels.size(), qQNaN()), rowLabels.size());
+
+        for(int g = 0; g<result.numGroups(); ++g)
+        {
+            const auto& codes = result.keyCodes.at(g);
+            pivotValues[rowOfCode.at(codes.at(0))][columnOfCode.at(codes.at(1))] = cellValues.at(g);
+        }
+    }
+    else
+    {
+        for(auto&& it : rowTotals)
+            pivotValues.push_back({it});
+
+        columnLabels.append(aggregateComboBox->currentText());
+    }
+
+    // Fill the table, with a column of the row totals when there is a column attribute
+    auto hasTotals = columnKey >= 0;
+
+    pivotTable->clear();
+    pivotTable->setRowCount(rowLabels.size());
+    pivotTable->setColumnCount(columnLabels.size() + (hasTotals ? 1 : 0));
+
+    auto headers = columnLabels;
+
+    if(hasTotals)
+        headers.append("Total");
+
+    pivotTable->setHorizontalHeaderLabels(headers);
+    pivotTable->setVerticalHeaderLabels(rowLabels);
+
+    for(int i = 0; i<rowLabels.size(); ++i)
+    {
+        for(int j = 0; j<columnLabels.size(); ++j)
+        {
+            auto val = pivotValues.at(i).at(j);
+
+            pivotTable->setItem(i, j, new QTableWidgetItem(std::isnan(val) ? QString() : QString::number(val)));
+        }
+
+        if(hasTotals)
+            pivotTable->setItem(i, columnLabels.size(), new QTableWidgetItem(QString::number(rowTotals.at(i))));
+    }
+
+    this->updateChart();
+}
+
+
+void PivotTableWidget::updateChart(void)
+{
+    pivotChart->removeAllSeries();
+
+    for(auto&& it : pivotChart->axes())
+        pivotChart->removeAxis(it);
+
+    if(rowLabels.isEmpty())
+        return;
+
+    auto series = new QBarSeries();
+
+    for(int j = 0; j<columnLabels.size(); ++j)
+    {
+        auto set = new QBarSet(columnLabels.at(j));
+
+        for(int i = 0; i<rowLabels.size(); ++i)
+        {
+            auto val = pivotValues.at(i).at(j);
+            set->append(std::isnan(val) ? 0.0 : val);
+        }
+
+        series->append(set);
+    }
+
+    pivotChart->addSeries(series);
+
+    pivotChart->legend()->setVisible(columnLabels.size() > 1);
+
+    auto axisX = new QBarCategoryAxis();
+    axisX->append(rowLabels);
+    pivotChart->addAxis(axisX, Qt::AlignBottom);
+    series->attachAxis(axisX);
+
+    auto axisY = new QValueAxis();
+    axisY->setTitleText(aggregateComboBox->currentText() + " of " + valueComboBox->currentText());
+    pivotChart->addAxis(axisY, Qt::AlignLeft);
+    series->attachAxis(axisY);
+}
@@ -0,0 +1,122 @@
+#ifndef PIVOTTABLEWIDGET_H
+#define PIVOTTABLEWIDGET_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "GroupByEngine.h"
+
+#include <QStringList>
+#include <QVector>
+#include <QWidget>
+
+class QComboBox;
+class QDoubleSpinBox;
+class QTableWidget;
+
+namespace QtCharts
+{
+class QChart;
+class QChartView;
+}
+
+// Breakdown of the results by the attributes of the assets, e.g., the repair cost by occupancy class and structure type
+// The breakdown is shown as a pivot table with the groups of the first attribute in the rows and of the second attribute in the columns, and as a bar chart
+class PivotTableWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    PivotTableWidget(QWidget* parent);
+
+    // Sets the attributes and the results of the assets, all of the columns are in the same order of the assets
+    void setData(const QStringList& attributeNames, const QVector<QStringList>& attributeColumns, const QStringList& resultNames, const QVector<QVector<double>>& resultColumns);
+
+    // Adds the attributes of the assets that were appended to the results, only the new rows are encoded and the selections are kept
+    // The result columns are those of all of the assets
+    void appendData(const QVector<QStringList>& newAttributeColumns, const QStringList& resultNames, const QVector<QVector<double>>& resultColumns);
+
+    void clear(void);
+
+    // The chart data of the last breakdown, i.e., getValues()[i][j] is the aggregate of the row group i and the column group j
+    QStringList getRowLabels() const;
+    QStringList getColumnLabels() const;
+    QVector<QVector<double>> getValues() const;
+
+private slots:
+
+    void updatePivot(void);
+
+    // Sets the default bin width of the numerical attributes when a different attribute is selected
+    void handleKeyChanged(void);
+
+private:
+
+    // Returns the encoded column of an attribute, numerical attributes with many distinct values are binned
+    DictionaryColumn getKeyColumn(const int attribute) const;
+
+    void updateChart(void);
+
+    // Attributes with more distinct numerical values than this are binned
+    const int maxCategories = 20;
+
+    QStringList attributeNames;
+
+    // The attributes encoded once as labels, and as numbers where every value is a number, otherwise the numerical column is empty
+    QVector<DictionaryColumn> encodedAttributes;
+    QVector<QVector<double>> numericalAttributes;
+
+    QStringList resultNames;
+    QVector<QVector<double>> resultColumns;
+
+    QStringList rowLabels;
+    QStringList columnLabels;
+    QVector<QVector<double>> pivotValues;
+
+    QComboBox* rowKeyComboBox;
+    QComboBox* columnKeyComboBox;
+    QDoubleSpinBox* binWidthSpinBox;
+    QComboBox* valueComboBox;
+    QComboBox* aggregateComboBox;
+
+    QTableWidget* pivotTable;
+
+    QtCharts::QChart* pivotChart;
+    QtCharts::QChartView* pivotChartView;
+};
+
+#endif // PIVOTTABLEWIDGET_H
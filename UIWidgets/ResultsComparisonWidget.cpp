@@ -0,0 +1,343 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "ResultsComparisonWidget.h"
+#include "WorkflowAppR2D.h"
+
+#include <QAbstractItemView>
+#include <QComboBox>
+#include <QFileDialog>
+#include <QGridLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QListView>
+#include <QListWidget>
+#include <QPushButton>
+#include <QSignalBlocker>
+#include <QTableWidget>
+#include <QTreeView>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+ResultsComparisonWidget::ResultsComparisonWidget(QWidget* parent) : QWidget(parent)
+{
+    auto layout = new QGridLayout(this);
+
+    runsListWidget = new QListWidget(this);
+    runsListWidget->setMaximumHeight(120);
+
+    addRunsButton = new QPushButton("Add Runs", this);
+    removeRunButton = new QPushButton("Remove Run", this);
+
+    connect(addRunsButton,&QPushButton::clicked,this,&ResultsComparisonWidget::chooseRunsDialog);
+    connect(removeRunButton,&QPushButton::clicked,this,&ResultsComparisonWidget::removeSelectedRun);
+
+    baselineComboBox = new QComboBox(this);
+    resultComboBox = new QComboBox(this);
+    assetRunComboBox = new QComboBox(this);
+
+    connect(baselineComboBox,QOverload<int>::of(&QComboBox::currentIndexChanged),this,&ResultsComparisonWidget::handleBaselineChanged);
+    connect(resultComboBox,QOverload<int>::of(&QComboBox::currentIndexChanged),this,&ResultsComparisonWidget::updateComparison);
+    connect(assetRunComboBox,QOverload<int>::of(&QComboBox::currentIndexChanged),this,&ResultsComparisonWidget::updateAssetTable);
+
+    totalsTable = new QTableWidget(this);
+    totalsTable->setColumnCount(7);
+    totalsTable->setHorizontalHeaderLabels({"Run","Total","Difference","Ratio","Matched","Missing","Extra"});
+    totalsTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    totalsTable->verticalHeader()->setVisible(false);
+    totalsTable->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+
+    assetsTable = new QTableWidget(this);
+    assetsTable->setColumnCount(3);
+    assetsTable->setHorizontalHeaderLabels({"Asset ID","Difference","Ratio"});
+    assetsTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    assetsTable->verticalHeader()->setVisible(false);
+    assetsTable->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+
+    layout->addWidget(new QLabel("Runs:", this),0,0);
+    layout->addWidget(runsListWidget,0,1,2,1);
+    layout->addWidget(addRunsButton,0,2);
+    layout->addWidget(removeRunButton,1,2);
+    layout->addWidget(new QLabel("Baseline:", this),2,0);
+    layout->addWidget(baselineComboBox,2,1,1,2);
+    layout->addWidget(new QLabel("Result:", this),3,0);
+    layout->addWidget(resultComboBox,3,1,1,2);
+    layout->addWidget(totalsTable,4,0,1,3);
+    layout->addWidget(new QLabel("Largest differences of:", this),5,0);
+    layout->addWidget(assetRunComboBox,5,1,1,2);
+    layout->addWidget(assetsTable,6,0,1,3);
+    layout->setRowStretch(6,1);
+
+    this->setWindowTitle("Compare Runs");
+    this->setMinimumSize(640,640);
+}
+
+
+int ResultsComparisonWidget::addRuns(const QStringList& resultsFolders)
+{
+    emit aboutToReadRuns();
+
+    for(auto&& it : resultsFolders)
+    {
+        QString errMsg;
+
+        if(theComparison.addRun(it, errMsg) != 0)
+        {
+            WorkflowAppR2D::getInstance()->errorMessage(errMsg);
+            this->updateRunLists();
+            return -1;
+        }
+    }
+
+    this->updateRunLists();
+
+    return 0;
+}
+
+
+void ResultsComparisonWidget::clear(void)
+{
+    theComparison.clear();
+    lastResult = ComparisonResult();
+
+    this->updateRunLists();
+}
+
+
+int ResultsComparisonWidget::relocateRuns(const QString& pathToFolder, const QString& pathToSnapshot)
+{
+    QString errMsg;
+
+    auto res = theComparison.relocateRuns(pathToFolder, pathToSnapshot, errMsg);
+
+    if(res != 0)
+    {
+        WorkflowAppR2D::getInstance()->errorMessage(errMsg);
+        this->updateRunLists();
+    }
+
+    return res;
+}
+
+
+void ResultsComparisonWidget::chooseRunsDialog(void)
+{
+    // The native dialogs only select one folder, use the Qt dialog with multiple selection in its views
+    QFileDialog dialog(this, tr("Results Folders"));
+    dialog.setFileMode(QFileDialog::Directory);
+    dialog.setOption(QFileDialog::DontUseNativeDialog, true);
+
+    for(auto&& view : dialog.findChildren<QListView*>("listView"))
+        view->setSelectionMode(QAbstractItemView::ExtendedSelection);
+
+    for(auto&& view : dialog.findChildren<QTreeView*>())
+        view->setSelectionMode(QAbstractItemView::ExtendedSelection);
+
+    if(dialog.exec() != QDialog::Accepted)
+        return;
+
+    this->addRuns(dialog.selectedFiles());
+}
+
+
+void ResultsComparisonWidget::removeSelectedRun(void)
+{
+    auto row = runsListWidget->currentRow();
+
+    if(row < 0)
+        return;
+
+    theComparison.removeRun(row);
+
+    this->updateRunLists();
+}
+
+
+void ResultsComparisonWidget::handleBaselineChanged(int index)
+{
+    if(index < 0)
+        return;
+
+    theComparison.setBaseline(index);
+
+    this->updateComparison();
+}
+
+
+void ResultsComparisonWidget::updateRunLists(void)
+{
+    QSignalBlocker baselineBlocker(baselineComboBox);
+    QSignalBlocker resultBlocker(resultComboBox);
+    QSignalBlocker assetRunBlocker(assetRunComboBox);
+
+    auto names = theComparison.getRunNames();
+
+    runsListWidget->clear();
+    runsListWidget->addItems(names);
+
+    baselineComboBox->clear();
+    baselineComboBox->addItems(names);
+    baselineComboBox->setCurrentIndex(theComparison.getBaseline());
+
+    auto assetRun = assetRunComboBox->currentIndex();
+    assetRunComboBox->clear();
+    assetRunComboBox->addItems(names);
+    assetRunComboBox->setCurrentIndex(assetRun >= 0 && assetRun < names.size() ? assetRun : names.size() - 1);
+
+    // Keep the selected result, the first column is the asset ID
+    auto column = resultComboBox->currentData().toInt();
+
+    resultComboBox->clear();
+
+    auto headers = theComparison.getHeaders();
+
+    for(int col = 1; col<headers.size(); ++col)
+        resultComboBox->addItem(headers.at(col), col);
+
+    auto index = resultComboBox->findData(column);
+    resultComboBox->setCurrentIndex(index != -1 ? index : 0);
+
+    baselineBlocker.unblock();
+    resultBlocker.unblock();
+    assetRunBlocker.unblock();
+
+    this->updateComparison();
+}
+
+
+void ResultsComparisonWidget::updateComparison(void)
+{
+    totalsTable->setRowCount(0);
+    lastResult = ComparisonResult();
+
+    if(theComparison.numRuns() == 0 || resultComboBox->currentIndex() < 0)
+    {
+        this->updateAssetTable();
+        return;
+    }
+
+    QString errMsg;
+
+    if(theComparison.compare(resultComboBox->currentData().toInt(), lastResult, errMsg) != 0)
+    {
+        WorkflowAppR2D::getInstance()->errorMessage(errMsg);
+        this->updateAssetTable();
+        return;
+    }
+
+    auto numRuns = lastResult.runNames.size();
+
+    totalsTable->setRowCount(numRuns);
+
+    auto baselineTotal = lastResult.totals.at(lastResult.baseline);
+
+    for(int run = 0; run<numRuns; ++run)
+    {
+        if(!lastResult.hasColumn.at(run))
+        {
+            totalsTable->setItem(run, 0, new QTableWidgetItem(lastResult.runNames.at(run)));
+            totalsTable->setItem(run, 1, new QTableWidgetItem("Missing"));
+            continue;
+        }
+
+        auto total = lastResult.totals.at(run);
+
+        QString ratio = baselineTotal != 0.0 ? QString::number(total/baselineTotal) : QString();
+
+        totalsTable->setItem(run, 0, new QTableWidgetItem(lastResult.runNames.at(run)));
+        totalsTable->setItem(run, 1, new QTableWidgetItem(QString::number(total)));
+        totalsTable->setItem(run, 2, new QTableWidgetItem(QString::number(lastResult.totalDeltas.at(run))));
+        totalsTable->setItem(run, 3, new QTableWidgetItem(ratio));
+        totalsTable->setItem(run, 4, new QTableWidgetItem(QString::number(lastResult.numMatched.at(run))));
+        totalsTable->setItem(run, 5, new QTableWidgetItem(QString::number(lastResult.numMissing.at(run))));
+        totalsTable->setItem(run, 6, new QTableWidgetItem(QString::number(lastResult.numExtra.at(run))));
+    }
+
+    if(!lastResult.runsWithoutColumn.isEmpty())
+        WorkflowAppR2D::getInstance()->statusMessage("The runs " + lastResult.runsWithoutColumn.join(", ") + " do not have the result " + lastResult.header);
+
+    this->updateAssetTable();
+}
+
+
+void ResultsComparisonWidget::updateAssetTable(void)
+{
+    assetsTable->setRowCount(0);
+
+    auto run = assetRunComboBox->currentIndex();
+
+    if(run < 0 || run >= lastResult.deltas.size())
+        return;
+
+    const auto& deltas = lastResult.deltas.at(run);
+    const auto& ratios = lastResult.ratios.at(run);
+
+    // Partial sort of the rows by the magnitude of the difference, the assets that are missing from the run go last
+    QVector<int> rows(deltas.size());
+    std::iota(rows.begin(), rows.end(), 0);
+
+    auto numToList = std::min(numAssetsToList, rows.size());
+
+    std::partial_sort(rows.begin(), rows.begin() + numToList, rows.end(), [&deltas](const int a, const int b)
+    {
+        auto valA = std::isnan(deltas.at(a)) ? -1.0 : std::fabs(deltas.at(a));
+        auto valB = std::isnan(deltas.at(b)) ? -1.0 : std::fabs(deltas.at(b));
+
+        if(valA != valB)
+            return valA > valB;
+
+        return a < b;
+    });
+
+    assetsTable->setRowCount(numToList);
+
+    for(int i = 0; i<numToList; ++i)
+    {
+        auto row = rows.at(i);
+
+        auto delta = deltas.at(row);
+        auto ratio = ratios.at(row);
+
+        assetsTable->setItem(i, 0, new QTableWidgetItem(QString::number(lastResult.IDs.at(row))));
+        assetsTable->setItem(i, 1, new QTableWidgetItem(std::isnan(delta) ? QString("Missing") : QString::number(delta)));
+        assetsTable->setItem(i, 2, new QTableWidgetItem(std::isnan(ratio) ? QString() : QString::number(ratio)));
+    }
+
+}
@@ -0,0 +1,104 @@
+#ifndef RESULTSCOMPARISONWIDGET_H
+#define RESULTSCOMPARISONWIDGET_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "ResultsComparison.h"
+
+#include <QWidget>
+
+class QComboBox;
+class QListWidget;
+class QPushButton;
+class QTableWidget;
+
+// Loads the results of several runs and compares a result of each run to a baseline run, both as portfolio totals and per asset
+class ResultsComparisonWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    ResultsComparisonWidget(QWidget* parent = nullptr);
+
+    int addRuns(const QStringList& resultsFolders);
+
+    void clear(void);
+
+    // Moves the runs that are inside of the folder to the snapshot folder, so that the folder can be removed
+    int relocateRuns(const QString& pathToFolder, const QString& pathToSnapshot);
+
+signals:
+
+    // Emitted before the results of the runs are read, so that other readers of the HDF5 files can be stopped
+    void aboutToReadRuns(void);
+
+private slots:
+
+    void chooseRunsDialog(void);
+
+    void removeSelectedRun(void);
+
+    void handleBaselineChanged(int index);
+
+    void updateComparison(void);
+
+    // Lists the assets with the largest differences of the selected run
+    void updateAssetTable(void);
+
+private:
+
+    void updateRunLists(void);
+
+    ResultsComparison theComparison;
+
+    ComparisonResult lastResult;
+
+    // The number of assets that are listed in the table of the largest differences
+    const int numAssetsToList = 100;
+
+    QListWidget* runsListWidget;
+    QPushButton* addRunsButton;
+    QPushButton* removeRunButton;
+    QComboBox* baselineComboBox;
+    QComboBox* resultComboBox;
+    QComboBox* assetRunComboBox;
+    QTableWidget* totalsTable;
+    QTableWidget* assetsTable;
+};
+
+#endif // RESULTSCOMPARISONWIDGET_H
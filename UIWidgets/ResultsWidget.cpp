@@ -39,6 +39,8 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include "AssetInputDelegate.h"
 #include "GeneralInformationWidget.h"
 #include "PelicunPostProcessor.h"
+#include "ResultsComparisonWidget.h"
+#include "ResultsDirectoryWatcher.h"
 #include "ResultsWidget.h"
 #include "SimCenterPreferences.h"
 #include "VisualizationWidget.h"
@@ -48,6 +50,7 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <QCheckBox>
 #include <QDebug>
 #include <QDir>
+#include <QFile>
 #include <QMenu>
 #include <QGridLayout>
 #include <QGroupBox>
@@ -68,6 +71,8 @@ ResultsWidget::ResultsWidget(QWidget *parent, VisualizationWidget* visWidget) :
 {
     DVApp = "Pelicun";
 
+    numSnapshots = 0;
+
     resultsMainLabel = new QLabel("No results to display", this);
 
     mainStackedWidget = new QStackedWidget(this);
@@ -123,6 +128,25 @@ ResultsWidget::ResultsWidget(QWidget *parent, VisualizationWidget* visWidget) :
 
     connect(exportPDFFileButton,&QPushButton::clicked,this,&ResultsWidget::printToPDF);
 
+    // Only one report is written at a time
+    connect(thePelicunPostProcessor.get(),&PelicunPostProcessor::reportRunningChanged,exportPDFFileButton,&QPushButton::setDisabled);
+
+    // Comparison of the results of several runs, shown in its own window
+    theComparisonWidget = new ResultsComparisonWidget(this);
+    theComparisonWidget->setWindowFlags(Qt::Window);
+    connect(theComparisonWidget,&ResultsComparisonWidget::aboutToReadRuns,thePelicunPostProcessor.get(),&PelicunPostProcessor::cancelRealizations);
+
+    compareRunsButton = new QPushButton(this);
+    compareRunsButton->setText(tr("Compare Runs"));
+
+    connect(compareRunsButton,&QPushButton::clicked,this,&ResultsWidget::showComparisonWidget);
+
+    theResultsWatcher = new ResultsDirectoryWatcher(this);
+    hasPartialResults = false;
+
+    connect(theResultsWatcher,&ResultsDirectoryWatcher::resultsAppended,this,&ResultsWidget::handleResultsAppended);
+    connect(theResultsWatcher,&ResultsDirectoryWatcher::errorOccurred,this,&ResultsWidget::handleWatcherError);
+
     selectComponentsText = new QLabel("Select a subset of buildings to display the results:",this);
     selectComponentsLineEdit = new AssetInputDelegate();
 
@@ -143,9 +167,10 @@ ResultsWidget::ResultsWidget(QWidget *parent, VisualizationWidget* visWidget) :
     theExportLayout->addWidget(exportPathLineEdit,     1,1);
     theExportLayout->addWidget(exportBrowseFileButton, 1,2);
     theExportLayout->addWidget(exportPDFFileButton,       2,0,1,3);
+    theExportLayout->addWidget(compareRunsButton,         3,0,1,3);
 
     // theExportLayout->addStretch();
-    theExportLayout->setRowStretch(3,1);
+    theExportLayout->setRowStretch(4,1);
 
     mainLayout->addLayout(theHeaderLayout);
     mainLayout->addWidget(mainStackedWidget);
@@ -221,12 +246,23 @@ int ResultsWidget::processResults(QString resultsDirectory)
 
     qDebug() << resultsDirectory;
 
+    // The final results replace the partial results of the running workflow
+    theResultsWatcher->stop();
+
+    if(hasPartialResults)
+    {
+        thePelicunPostProcessor->clear();
+        hasPartialResults = false;
+    }
+
     try
     {
         if(DVApp.compare("Pelicun") == 0)
         {
             thePelicunPostProcessor->importResults(resultsDirectory);
 
+            lastResultsDirectory = resultsDirectory;
+
             this->resultsShow(true);
         }
     }
@@ -257,7 +293,13 @@ int ResultsWidget::printToPDF(void)
     {
         auto res = thePelicunPostProcessor->printToPDF(outputFileName);
 
-        if(res != 0)
+        if(res == 1)
+        {
+            QString msg = "A PDF report is already being written, please wait until it is finished";
+            this->userMessageDialog(msg);
+            return 0;
+        }
+        else if(res != 0)
         {
             QString err = "Error printing the PDF";
             this->userMessageDialog(err);
@@ -332,9 +374,105 @@ void ResultsWidget::clear(void)
     exportPathLineEdit->setText(defaultOutput);
     selectComponentsLineEdit->clear();
 
+    theResultsWatcher->stop();
+    hasPartialResults = false;
+
     thePelicunPostProcessor->clear();
 
+    theComparisonWidget->clear();
+    lastResultsDirectory.clear();
+
     resultsShow(false);
 }
 
 
+void ResultsWidget::prepareForRun(const QString& runFolder)
+{
+    selectComponentsLineEdit->clear();
+
+    // Stop the watcher and the post processor, which closes the results and the realizations that they read
+    theResultsWatcher->stop();
+    hasPartialResults = false;
+
+    thePelicunPostProcessor->clear();
+
+    resultsShow(false);
+
+    auto folderPath = QDir(runFolder).absolutePath() + "/";
+
+    auto snapshotRoot = snapshotDir.isValid() ? snapshotDir.path() : QDir::tempPath();
+
+    // The DV results of the last run are copied out of the folder so that the last run stays the default baseline of the comparison
+    if(!lastResultsDirectory.isEmpty() && QDir(lastResultsDirectory).absolutePath().startsWith(folderPath))
+    {
+        QDir resultsDir(lastResultsDirectory);
+
+        auto snapshotPath = QDir(snapshotRoot).filePath("Run" + QString::number(++numSnapshots));
+        QDir().mkpath(snapshotPath);
+
+        auto DVFiles = resultsDir.entryList(QStringList({"DV*.csv", "DV*.hdf", "DV*.h5"}), QDir::Files);
+
+        for(auto&& it : DVFiles)
+            QFile::copy(resultsDir.filePath(it), QDir(snapshotPath).filePath(it));
+
+        lastResultsDirectory = DVFiles.isEmpty() ? QString() : snapshotPath;
+    }
+
+    // The runs of the comparison stay loaded, their mapped caches are moved out of the folder
+    theComparisonWidget->relocateRuns(runFolder, snapshotRoot);
+}
+
+
+void ResultsWidget::showComparisonWidget(void)
+{
+    // Start the comparison with the results of the last run as the baseline
+    if(!lastResultsDirectory.isEmpty())
+    {
+        theComparisonWidget->addRuns(QStringList(lastResultsDirectory));
+        lastResultsDirectory.clear();
+    }
+
+    theComparisonWidget->show();
+    theComparisonWidget->raise();
+    theComparisonWidget->activateWindow();
+}
+
+
+void ResultsWidget::watchResults(const QString& resultsDir)
+{
+    if(DVApp.compare("Pelicun") != 0)
+        return;
+
+    theResultsWatcher->start(resultsDir);
+}
+
+
+void ResultsWidget::handleResultsAppended(const ResultsTable& newRows)
+{
+    try
+    {
+        thePelicunPostProcessor->appendResults(newRows);
+    }
+    catch (const QString msg)
+    {
+        this->handleWatcherError(msg);
+        return;
+    }
+
+    if(!hasPartialResults)
+    {
+        hasPartialResults = true;
+        this->resultsShow(true);
+    }
+
+    WorkflowAppR2D::getInstance()->statusMessage("Showing the results of " + QString::number(newRows.numRows()) + " more assets, the analysis is still running");
+}
+
+
+void ResultsWidget::handleWatcherError(const QString& errMsg)
+{
+    // The final results are still processed once the workflow is complete
+    theResultsWatcher->stop();
+
+    WorkflowAppR2D::getInstance()->errorMessage("Stopped showing the results while the analysis is running: " + errMsg);
+}
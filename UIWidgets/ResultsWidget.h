@@ -40,8 +40,13 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 
 #include "SimCenterAppWidget.h"
 
+#include <QTemporaryDir>
+
 class AssetInputDelegate;
 class PelicunPostProcessor;
+class ResultsComparisonWidget;
+class ResultsDirectoryWatcher;
+class ResultsTable;
 class VisualizationWidget;
 
 class QStackedWidget;
@@ -64,10 +69,16 @@ public:
 
     virtual int processResults(QString resultsDir);
 
+    // Shows the results as they are written to the folder while the workflow is running, until the final results are processed
+    void watchResults(const QString& resultsDir);
+
     void setCurrentlyViewable(bool status);
 
     void clear(void);
 
+    // Releases the files in the folder of a run before it is removed for a new run, the runs of the comparison and the results of the last run are copied out of the folder
+    void prepareForRun(const QString& runFolder);
+
     void resultsShow(bool value);
 
 private slots:
@@ -76,6 +87,9 @@ private slots:
     void selectComponents(void);
     void handleComponentSelection(void);
     void chooseResultsDirDialog(void);
+    void showComparisonWidget(void);
+    void handleResultsAppended(const ResultsTable& newRows);
+    void handleWatcherError(const QString& errMsg);
 
 private:
 
@@ -86,6 +100,7 @@ private:
     QPushButton *selectComponentsButton;
     QPushButton *exportPDFFileButton;
     QPushButton *exportBrowseFileButton;
+    QPushButton *compareRunsButton;
     QLabel* exportLabel;
 
     QString DVApp;
@@ -98,6 +113,18 @@ private:
 
     std::unique_ptr<PelicunPostProcessor> thePelicunPostProcessor;
 
+    // The results of the last run are the default baseline of the comparison
+    ResultsComparisonWidget* theComparisonWidget;
+    QString lastResultsDirectory;
+
+    // The copies of the results of earlier runs that are kept for the comparison, removed when the application exits
+    QTemporaryDir snapshotDir;
+    int numSnapshots;
+
+    // Tails the results of a running workflow
+    ResultsDirectoryWatcher* theResultsWatcher;
+    bool hasPartialResults;
+
 };
 
 #endif // ResultsWidget
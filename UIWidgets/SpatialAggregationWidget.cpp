@@ -0,0 +1,530 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "ComponentInputWidget.h"
+#include "LayerTreeView.h"
+#include "SpatialAggregationWidget.h"
+#include "VisualizationWidget.h"
+#include "WorkflowAppR2D.h"
+
+// GIS headers
+#include "ClassBreaksRenderer.h"
+#include "FeatureCollection.h"
+#include "FeatureCollectionLayer.h"
+#include "FeatureCollectionTable.h"
+#include "FeatureLayer.h"
+#include "FeatureQueryResult.h"
+#include "GeometryEngine.h"
+#include "PolygonBuilder.h"
+#include "QueryParameters.h"
+#include "SimpleFillSymbol.h"
+#include "SimpleLineSymbol.h"
+
+#include <QComboBox>
+#include <QDoubleSpinBox>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QGridLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QPushButton>
+#include <QTableWidget>
+#include <QtNumeric>
+
+#include <cmath>
+#include <limits>
+#include <memory>
+
+using namespace Esri::ArcGISRuntime;
+
+SpatialAggregationWidget::SpatialAggregationWidget(QWidget* parent, VisualizationWidget* visWidget) : QWidget(parent), theVisualizationWidget(visWidget)
+{
+    auto layout = new QGridLayout(this);
+
+    regionTypeComboBox = new QComboBox(this);
+    regionTypeComboBox->insertItems(0,{"Square Grid","Hexagonal Grid","Polygon Layer"});
+
+    cellSizeSpinBox = new QDoubleSpinBox(this);
+    cellSizeSpinBox->setRange(0.01,1000.0);
+    cellSizeSpinBox->setDecimals(2);
+    cellSizeSpinBox->setValue(1.0);
+    cellSizeSpinBox->setSuffix(" km");
+
+    loadLayerButton = new QPushButton("Load Shapefile", this);
+    loadLayerButton->setEnabled(false);
+
+    layerLabel = new QLabel(this);
+
+    resultComboBox = new QComboBox(this);
+
+    statisticComboBox = new QComboBox(this);
+    statisticComboBox->insertItems(0,{"Sum","Mean","Quantile","Count"});
+
+    quantileSpinBox = new QDoubleSpinBox(this);
+    quantileSpinBox->setRange(0.0,1.0);
+    quantileSpinBox->setSingleStep(0.05);
+    quantileSpinBox->setValue(0.9);
+    quantileSpinBox->setToolTip("The probability level of the quantile");
+    quantileSpinBox->setEnabled(false);
+
+    aggregateButton = new QPushButton("Aggregate", this);
+
+    regionsTable = new QTableWidget(this);
+    regionsTable->setColumnCount(3);
+    regionsTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    regionsTable->verticalHeader()->setVisible(false);
+    regionsTable->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+
+    connect(regionTypeComboBox,QOverload<int>::of(&QComboBox::currentIndexChanged),this, &SpatialAggregationWidget::handleRegionTypeChanged);
+    connect(statisticComboBox,QOverload<int>::of(&QComboBox::currentIndexChanged),this, [this](int index)
+    {
+        quantileSpinBox->setEnabled(index == SpatialAggregator::Quantile);
+    });
+    connect(loadLayerButton,&QPushButton::clicked,this,&SpatialAggregationWidget::loadPolygonLayer);
+    connect(aggregateButton,&QPushButton::clicked,this,&SpatialAggregationWidget::aggregate);
+
+    layout->addWidget(new QLabel("Regions:", this),0,0);
+    layout->addWidget(regionTypeComboBox,0,1);
+    layout->addWidget(new QLabel("Cell Size:", this),1,0);
+    layout->addWidget(cellSizeSpinBox,1,1);
+    layout->addWidget(loadLayerButton,2,0);
+    layout->addWidget(layerLabel,2,1);
+    layout->addWidget(new QLabel("Result:", this),3,0);
+    layout->addWidget(resultComboBox,3,1);
+    layout->addWidget(new QLabel("Statistic:", this),4,0);
+    layout->addWidget(statisticComboBox,4,1);
+    layout->addWidget(new QLabel("Quantile Level:", this),5,0);
+    layout->addWidget(quantileSpinBox,5,1);
+    layout->addWidget(aggregateButton,6,0,1,2);
+    layout->addWidget(regionsTable,7,0,1,2);
+    layout->setRowStretch(7,1);
+}
+
+
+void SpatialAggregationWidget::setResults(const QVector<int>& IDs, const QStringList& headers, const QVector<QVector<double>>& columns)
+{
+    this->clear();
+
+    theAggregator.setAssets(IDs, this->getLocations(IDs));
+
+    resultColumns = columns;
+
+    resultComboBox->insertItems(0, headers);
+}
+
+
+void SpatialAggregationWidget::updateResults(const QVector<int>& IDs, const QStringList& headers, const QVector<QVector<double>>& columns)
+{
+    auto numAssets = theAggregator.getAssetIDs().size();
+
+    QStringList currentHeaders;
+    for(int i = 0; i<resultComboBox->count(); ++i)
+        currentHeaders.append(resultComboBox->itemText(i));
+
+    if(numAssets == 0 || IDs.size() < numAssets || currentHeaders != headers)
+    {
+        this->setResults(IDs, headers, columns);
+        return;
+    }
+
+    if(IDs.size() > numAssets)
+    {
+        auto newIDs = IDs.mid(numAssets);
+
+        theAggregator.appendAssets(newIDs, this->getLocations(newIDs));
+    }
+
+    resultColumns = columns;
+}
+
+
+QVector<QPointF> SpatialAggregationWidget::getLocations(const QVector<int>& IDs) const
+{
+    auto theComponentDB = theVisualizationWidget->getBuildingWidget()->getComponentDatabase();
+
+    // The buildings are points in longitude and latitude
+    QVector<QPointF> locations;
+    locations.reserve(IDs.size());
+
+    for(auto&& id : IDs)
+    {
+        auto feature = theComponentDB->getComponent(id).ComponentFeature;
+
+        if(feature == nullptr)
+        {
+            locations.push_back(QPointF(qQNaN(), qQNaN()));
+            continue;
+        }
+
+        auto point = geometry_cast<Point>(feature->geometry());
+
+        locations.push_back(QPointF(point.x(), point.y()));
+    }
+
+    return locations;
+}
+
+
+void SpatialAggregationWidget::clear(void)
+{
+    this->removeChoroplethLayer();
+
+    theAggregator.clear();
+    resultColumns.clear();
+    resultComboBox->clear();
+    regionsTable->clearContents();
+    regionsTable->setRowCount(0);
+}
+
+
+void SpatialAggregationWidget::aggregate(void)
+{
+    auto column = resultComboBox->currentIndex();
+
+    if(column < 0 || column >= resultColumns.size())
+        return;
+
+    auto regionType = regionTypeComboBox->currentIndex();
+
+    // The join is only redone when the regions change, a different result or statistic only reruns the reduction
+    QString joinKey;
+
+    if(regionType == 2)
+        joinKey = "Layer " + polygonLayerPath;
+    else
+        joinKey = regionTypeComboBox->currentText() + " " + QString::number(cellSizeSpinBox->value());
+
+    if(theAggregator.getJoinKey() != joinKey)
+    {
+        QString errMsg;
+
+        int res = 0;
+
+        if(regionType == 2)
+        {
+            if(polygonRegions.isEmpty())
+            {
+                WorkflowAppR2D::getInstance()->errorMessage("Load a shapefile with the polygons of the regions first");
+                return;
+            }
+
+            res = theAggregator.joinToRegions(polygonRegions, errMsg);
+        }
+        else
+            res = theAggregator.joinToGrid(cellSizeSpinBox->value(), regionType == 1, errMsg);
+
+        if(res != 0)
+        {
+            WorkflowAppR2D::getInstance()->errorMessage(errMsg);
+            return;
+        }
+
+        theAggregator.setJoinKey(joinKey);
+    }
+
+    auto stat = static_cast<SpatialAggregator::Statistic>(statisticComboBox->currentIndex());
+
+    auto values = theAggregator.reduce(resultColumns.at(column), stat, quantileSpinBox->value());
+
+    auto title = statisticComboBox->currentText() + " of " + resultComboBox->currentText();
+
+    if(stat == SpatialAggregator::Quantile)
+        title = "P" + QString::number(qRound(quantileSpinBox->value()*100.0)) + " of " + resultComboBox->currentText();
+
+    this->showTable(values, title);
+
+    this->showChoropleth(values, title);
+}
+
+
+void SpatialAggregationWidget::handleRegionTypeChanged(int index)
+{
+    cellSizeSpinBox->setEnabled(index != 2);
+    loadLayerButton->setEnabled(index == 2);
+}
+
+
+void SpatialAggregationWidget::loadPolygonLayer(void)
+{
+    auto pathToFile = QFileDialog::getOpenFileName(this, tr("Polygon Shapefile"), QString(), tr("Shapefiles (*.shp)"));
+
+    if(pathToFile.isEmpty())
+        return;
+
+    QFileInfo fileInfo(pathToFile);
+
+    auto layer = theVisualizationWidget->createAndAddShapefileLayer(pathToFile, fileInfo.baseName());
+
+    theVisualizationWidget->addLayerToMap(layer);
+
+    polygonRegions.clear();
+    polygonLayerPath = pathToFile;
+    layerLabel->setText("Loading " + fileInfo.fileName());
+
+    auto table = layer->featureTable();
+
+    connect(table, &FeatureTable::queryFeaturesCompleted, this, &SpatialAggregationWidget::polygonQueryCompleted, Qt::UniqueConnection);
+
+    // Query all of the features, this is done asynchronously
+    QueryParameters queryParams;
+    queryParams.setWhereClause("1=1");
+    queryParams.setReturnGeometry(true);
+
+    table->queryFeatures(queryParams);
+}
+
+
+void SpatialAggregationWidget::polygonQueryCompleted(QUuid /*taskID*/, FeatureQueryResult* rawResult)
+{
+    if(rawResult == nullptr)
+        return;
+
+    // The result is owned here
+    std::unique_ptr<FeatureQueryResult> result(rawResult);
+
+    QVector<AggregationRegion> regions;
+
+    auto iter = result->iterator();
+
+    while(iter.hasNext())
+    {
+        std::unique_ptr<Feature> feature(iter.next());
+
+        auto geometry = GeometryEngine::project(feature->geometry(), SpatialReference::wgs84());
+
+        if(geometry.geometryType() != GeometryType::Polygon)
+            continue;
+
+        auto polygon = geometry_cast<Polygon>(geometry);
+
+        AggregationRegion region;
+
+        // Use a name field if there is one, otherwise number the regions
+        auto attributes = feature->attributes()->attributesMap();
+
+        for(auto it = attributes.constBegin(); it != attributes.constEnd(); ++it)
+        {
+            if(it.key().compare("NAME", Qt::CaseInsensitive) == 0 || it.key().compare("GEOID", Qt::CaseInsensitive) == 0)
+            {
+                region.name = it.value().toString();
+                break;
+            }
+        }
+
+        if(region.name.isEmpty())
+            region.name = "Region " + QString::number(regions.size() + 1);
+
+        std::unique_ptr<ImmutablePartCollection> parts(polygon.parts());
+
+        for(int i = 0; i<parts->size(); ++i)
+        {
+            auto part = parts->part(i);
+
+            QPolygonF ring;
+
+            for(int j = 0; j<part->pointCount(); ++j)
+            {
+                auto point = part->point(j);
+                ring.append(QPointF(point.x(), point.y()));
+            }
+
+            region.rings.push_back(ring);
+        }
+
+        auto extent = polygon.extent();
+
+        region.bounds = QRectF(QPointF(extent.xMin(), extent.yMin()), QPointF(extent.xMax(), extent.yMax()));
+
+        regions.push_back(region);
+    }
+
+    polygonRegions = regions;
+
+    layerLabel->setText(QString::number(polygonRegions.size()) + " polygons in " + QFileInfo(polygonLayerPath).fileName());
+
+    // Force a new join with the new polygons
+    theAggregator.setJoinKey(QString());
+}
+
+
+void SpatialAggregationWidget::showTable(const QVector<double>& values, const QString& title)
+{
+    const auto& regions = theAggregator.getRegions();
+
+    auto numAssets = theAggregator.getNumberOfAssetsPerRegion();
+
+    regionsTable->clearContents();
+    regionsTable->setHorizontalHeaderLabels({"Region","Number of Assets",title});
+
+    // Only the regions that contain assets are listed
+    QVector<int> rows;
+    for(int k = 0; k<regions.size(); ++k)
+    {
+        if(numAssets.at(k) > 0)
+            rows.push_back(k);
+    }
+
+    regionsTable->setRowCount(rows.size());
+
+    for(int i = 0; i<rows.size(); ++i)
+    {
+        auto k = rows.at(i);
+
+        regionsTable->setItem(i, 0, new QTableWidgetItem(regions.at(k).name));
+        regionsTable->setItem(i, 1, new QTableWidgetItem(QString::number(numAssets.at(k))));
+        regionsTable->setItem(i, 2, new QTableWidgetItem(QString::number(values.at(k))));
+    }
+}
+
+
+void SpatialAggregationWidget::removeChoroplethLayer(void)
+{
+    if(!choroplethLayerID.isEmpty())
+        theVisualizationWidget->getLayersTree()->removeLayer(choroplethLayerID);
+
+    choroplethLayerID.clear();
+
+    // The map does not delete the layers that are removed from it
+    if(choroplethLayer)
+        choroplethLayer->deleteLater();
+
+    choroplethLayer = nullptr;
+}
+
+
+void SpatialAggregationWidget::showChoropleth(const QVector<double>& values, const QString& title)
+{
+    this->removeChoroplethLayer();
+
+    const auto& regions = theAggregator.getRegions();
+
+    auto numAssets = theAggregator.getNumberOfAssetsPerRegion();
+
+    QList<Field> tableFields;
+    tableFields.append(Field::createText("Region", "NULL",4));
+    tableFields.append(Field::createDouble("Value", "NULL"));
+    tableFields.append(Field::createInteger("Number of Assets", "NULL"));
+
+    // Everything below is owned by the feature collection, which is handed to the layer at the end
+    auto featureCollection = new FeatureCollection();
+
+    auto featureCollectionTable = new FeatureCollectionTable(tableFields, GeometryType::Polygon, SpatialReference::wgs84(), featureCollection);
+    featureCollection->tables()->append(featureCollectionTable);
+
+    auto minVal = std::numeric_limits<double>::max();
+    auto maxVal = std::numeric_limits<double>::lowest();
+
+    for(int k = 0; k<regions.size(); ++k)
+    {
+        auto val = values.at(k);
+
+        if(numAssets.at(k) == 0 || std::isnan(val))
+            continue;
+
+        minVal = std::min(minVal, val);
+        maxVal = std::max(maxVal, val);
+
+        QMap<QString, QVariant> featureAttributes;
+        featureAttributes.insert("Region", regions.at(k).name);
+        featureAttributes.insert("Value", val);
+        featureAttributes.insert("Number of Assets", numAssets.at(k));
+
+        auto parts = new PartCollection(SpatialReference::wgs84(), featureCollectionTable);
+
+        for(auto&& ring : regions.at(k).rings)
+        {
+            auto part = new Part(SpatialReference::wgs84(), parts);
+
+            for(auto&& point : ring)
+                part->addPoint(Point(point.x(), point.y(), SpatialReference::wgs84()));
+
+            parts->addPart(part);
+        }
+
+        PolygonBuilder polygonBuilder(SpatialReference::wgs84());
+        polygonBuilder.setParts(parts);
+
+        auto feature = featureCollectionTable->createFeature(featureAttributes, polygonBuilder.toGeometry(), featureCollectionTable);
+
+        featureCollectionTable->addFeature(feature);
+    }
+
+    if(minVal > maxVal)
+    {
+        delete featureCollection;
+        return;
+    }
+
+    // Five classes of equal width from light yellow to dark red
+    const QVector<QColor> colors = {QColor(255,255,178,180), QColor(254,204,92,180), QColor(253,141,60,180), QColor(240,59,32,180), QColor(189,0,38,180)};
+
+    auto lineSymbol = new SimpleLineSymbol(SimpleLineSymbolStyle::Solid, QColor(64,64,64), 0.5, featureCollectionTable);
+
+    auto width = (maxVal - minVal)/colors.size();
+
+    QList<ClassBreak*> classBreaks;
+
+    for(int i = 0; i<colors.size(); ++i)
+    {
+        auto lower = minVal + i*width;
+        auto upper = i == colors.size()-1 ? maxVal : lower + width;
+
+        auto label = QString::number(lower) + " - " + QString::number(upper);
+
+        auto fillSymbol = new SimpleFillSymbol(SimpleFillSymbolStyle::Solid, colors.at(i), lineSymbol, featureCollectionTable);
+
+        // The first class also holds the minimum
+        classBreaks.append(new ClassBreak(label, label, i == 0 ? lower - std::fabs(lower)*1.0e-9 - 1.0e-12 : lower, upper, fillSymbol, featureCollectionTable));
+    }
+
+    featureCollectionTable->setRenderer(new ClassBreaksRenderer("Value", classBreaks, featureCollectionTable));
+
+    auto layer = new FeatureCollectionLayer(featureCollection, this);
+    featureCollection->setParent(layer);
+
+    choroplethLayer = layer;
+
+    choroplethLayerID = theVisualizationWidget->createUniqueID();
+
+    layer->setName(title);
+    layer->setLayerId(choroplethLayerID);
+
+    theVisualizationWidget->getLayersTree()->addItemToTree(title, choroplethLayerID);
+
+    theVisualizationWidget->addLayerToMap(layer);
+}
@@ -0,0 +1,131 @@
+#ifndef SPATIALAGGREGATIONWIDGET_H
+#define SPATIALAGGREGATIONWIDGET_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "SpatialAggregator.h"
+
+#include <QMap>
+#include <QPointer>
+#include <QStringList>
+#include <QUuid>
+#include <QWidget>
+
+class VisualizationWidget;
+
+class QComboBox;
+class QDoubleSpinBox;
+class QLabel;
+class QPushButton;
+class QTableWidget;
+
+namespace Esri
+{
+namespace ArcGISRuntime
+{
+class FeatureCollectionLayer;
+class FeatureQueryResult;
+class FeatureTable;
+}
+}
+
+// Aggregates the per asset results to square or hexagonal grid cells, or to the polygons of a layer such as census tracts, and shows them as a choropleth layer
+class SpatialAggregationWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    SpatialAggregationWidget(QWidget* parent, VisualizationWidget* visWidget);
+
+    // Sets the results that can be aggregated, the columns are in the order of the asset IDs
+    void setResults(const QVector<int>& IDs, const QStringList& headers, const QVector<QVector<double>>& columns);
+
+    // Sets the results after rows were appended to them, only the assets past the ones that were set before are located, and the selections are kept
+    void updateResults(const QVector<int>& IDs, const QStringList& headers, const QVector<QVector<double>>& columns);
+
+    void clear(void);
+
+private slots:
+
+    void aggregate(void);
+
+    void handleRegionTypeChanged(int index);
+
+    void loadPolygonLayer(void);
+
+    void polygonQueryCompleted(QUuid taskID, Esri::ArcGISRuntime::FeatureQueryResult* rawResult);
+
+private:
+
+    // Draws the regions that contain assets colored by the aggregated values
+    void showChoropleth(const QVector<double>& values, const QString& title);
+
+    // Removes the choropleth layer from the map and the layers tree, and deletes it
+    void removeChoroplethLayer(void);
+
+    void showTable(const QVector<double>& values, const QString& title);
+
+    // The locations of the buildings, NaN if a building does not have a feature
+    QVector<QPointF> getLocations(const QVector<int>& IDs) const;
+
+    VisualizationWidget* theVisualizationWidget;
+
+    SpatialAggregator theAggregator;
+
+    QVector<QVector<double>> resultColumns;
+
+    // The regions from the polygon layer, in longitude and latitude
+    QVector<AggregationRegion> polygonRegions;
+    QString polygonLayerPath;
+
+    // The choropleth layer owns its feature collection, the features, the symbols and the renderer, it is deleted when it is replaced
+    QString choroplethLayerID;
+    QPointer<Esri::ArcGISRuntime::FeatureCollectionLayer> choroplethLayer;
+
+    QComboBox* regionTypeComboBox;
+    QDoubleSpinBox* cellSizeSpinBox;
+    QPushButton* loadLayerButton;
+    QLabel* layerLabel;
+    QComboBox* resultComboBox;
+    QComboBox* statisticComboBox;
+    QDoubleSpinBox* quantileSpinBox;
+    QPushButton* aggregateButton;
+    QTableWidget* regionsTable;
+};
+
+#endif // SPATIALAGGREGATIONWIDGET_H
@@ -0,0 +1,379 @@
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "TimeHistoryChartWidget.h"
+
+#include <QChart>
+#include <QChartView>
+#include <QComboBox>
+#include <QGraphicsLayout>
+#include <QGridLayout>
+#include <QLabel>
+#include <QLineSeries>
+#include <QMouseEvent>
+#include <QPushButton>
+#include <QValueAxis>
+#include <QWheelEvent>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+using namespace QtCharts;
+
+namespace
+{
+
+// Chart view that zooms the time axis with the scroll wheel and pans it by dragging
+class TimeHistoryChartView : public QChartView
+{
+public:
+    TimeHistoryChartView(QChart* chart, QWidget* parent) : QChartView(chart, parent), isPanning(false)
+    {
+
+    }
+
+    std::function<void(void)> resetView;
+
+protected:
+
+    void wheelEvent(QWheelEvent* event) override
+    {
+        auto plotArea = chart()->plotArea();
+
+        if(plotArea.width() <= 0.0)
+            return;
+
+        // Keep the time under the cursor in place
+        auto fraction = std::clamp((event->position().x() - plotArea.left())/plotArea.width(), 0.0, 1.0);
+
+        auto factor = event->angleDelta().y() > 0 ? 0.8 : 1.25;
+
+        auto zoomedWidth = plotArea.width()*factor;
+
+        chart()->zoomIn(QRectF(plotArea.left() + fraction*(plotArea.width() - zoomedWidth), plotArea.top(), zoomedWidth, plotArea.height()));
+
+        event->accept();
+    }
+
+    void mousePressEvent(QMouseEvent* event) override
+    {
+        if(event->button() == Qt::LeftButton)
+        {
+            isPanning = true;
+            lastPosition = event->pos();
+            event->accept();
+            return;
+        }
+
+        QChartView::mousePressEvent(event);
+    }
+
+    void mouseMoveEvent(QMouseEvent* event) override
+    {
+        if(isPanning)
+        {
+            auto delta = event->pos() - lastPosition;
+            lastPosition = event->pos();
+
+            chart()->scroll(-delta.x(), 0.0);
+
+            event->accept();
+            return;
+        }
+
+        QChartView::mouseMoveEvent(event);
+    }
+
+    void mouseReleaseEvent(QMouseEvent* event) override
+    {
+        if(event->button() == Qt::LeftButton)
+        {
+            isPanning = false;
+            event->accept();
+            return;
+        }
+
+        QChartView::mouseReleaseEvent(event);
+    }
+
+    void mouseDoubleClickEvent(QMouseEvent* event) override
+    {
+        if(resetView)
+            resetView();
+
+        event->accept();
+    }
+
+private:
+
+    bool isPanning;
+
+    QPoint lastPosition;
+};
+
+}
+
+
+TimeHistoryChartWidget::TimeHistoryChartWidget(QWidget* parent) : QWidget(parent)
+{
+    startTime = 0.0;
+    endTime = 0.0;
+
+    auto layout = new QGridLayout(this);
+
+    componentComboBox = new QComboBox(this);
+    componentComboBox->addItems({"X", "Y", "Z"});
+
+    auto resetButton = new QPushButton(tr("Reset Zoom"), this);
+
+    timeHistoryChart = new QChart();
+    timeHistoryChart->setDropShadowEnabled(false);
+    timeHistoryChart->setMargins(QMargins(5,5,5,5));
+    timeHistoryChart->layout()->setContentsMargins(0, 0, 0, 0);
+    timeHistoryChart->legend()->setAlignment(Qt::AlignBottom);
+
+    axisX = new QValueAxis();
+    axisX->setTitleText("Time [s]");
+    timeHistoryChart->addAxis(axisX, Qt::AlignBottom);
+
+    axisY = new QValueAxis();
+    axisY->setTitleText("Acceleration [g]");
+    timeHistoryChart->addAxis(axisY, Qt::AlignLeft);
+
+    auto chartView = new TimeHistoryChartView(timeHistoryChart, this);
+    chartView->setRenderHint(QPainter::Antialiasing);
+    chartView->setMinimumHeight(250);
+    chartView->resetView = [this]() { this->resetZoom(); };
+
+    timeHistoryChartView = chartView;
+
+    // Redraw from the matching level of the pyramids when the visible time range or the size of the plot changes
+    connect(axisX, &QValueAxis::rangeChanged, this, &TimeHistoryChartWidget::updateSeries);
+    connect(timeHistoryChart, &QChart::plotAreaChanged, this, &TimeHistoryChartWidget::updateSeries);
+
+    connect(componentComboBox,QOverload<int>::of(&QComboBox::currentIndexChanged),this, &TimeHistoryChartWidget::updateChart);
+    connect(resetButton,&QPushButton::clicked,this, &TimeHistoryChartWidget::resetZoom);
+
+    layout->addWidget(new QLabel("Component:", this),0,0);
+    layout->addWidget(componentComboBox,0,1);
+    layout->addWidget(resetButton,0,3);
+    layout->addWidget(timeHistoryChartView,1,0,1,4);
+    layout->setColumnStretch(2,1);
+    layout->setRowStretch(1,1);
+}
+
+
+void TimeHistoryChartWidget::setTimeHistories(const QVector<GroundMotionTimeHistory>& records, const QVector<double>& scalingFactors)
+{
+    this->clear();
+
+    auto numRecords = records.size();
+
+    recordScalingFactors = scalingFactors;
+    recordScalingFactors.resize(numRecords);
+
+    for(int i = scalingFactors.size(); i<numRecords; ++i)
+        recordScalingFactors[i] = 1.0;
+
+    // Build the pyramids of all of the components of all of the records together
+    QVector<QVector<double>> signalValues;
+    QVector<double> timeSteps;
+
+    signalValues.reserve(3*numRecords);
+    timeSteps.reserve(3*numRecords);
+
+    for(auto&& it : records)
+    {
+        recordNames.push_back(it.getName());
+
+        signalValues.push_back(it.getX());
+        signalValues.push_back(it.getY());
+        signalValues.push_back(it.getZ());
+
+        timeSteps.push_back(it.getDT());
+        timeSteps.push_back(it.getDT());
+        timeSteps.push_back(it.getDT());
+    }
+
+    auto pyramids = MinMaxPyramid::buildPyramids(signalValues, timeSteps);
+
+    componentPyramids.resize(3);
+
+    for(int k = 0; k<3; ++k)
+    {
+        componentPyramids[k].reserve(numRecords);
+
+        for(int i = 0; i<numRecords; ++i)
+            componentPyramids[k].push_back(pyramids.at(3*i + k));
+    }
+
+    this->updateChart();
+}
+
+
+void TimeHistoryChartWidget::setValueTitle(const QString& title)
+{
+    axisY->setTitleText(title);
+}
+
+
+void TimeHistoryChartWidget::clear(void)
+{
+    recordNames.clear();
+    recordScalingFactors.clear();
+    componentPyramids.clear();
+
+    recordSeries.clear();
+    timeHistoryChart->removeAllSeries();
+
+    startTime = 0.0;
+    endTime = 0.0;
+}
+
+
+QChartView* TimeHistoryChartWidget::getChartView() const
+{
+    return timeHistoryChartView;
+}
+
+
+void TimeHistoryChartWidget::resetZoom(void)
+{
+    timeHistoryChart->zoomReset();
+
+    if(endTime > startTime)
+        axisX->setRange(startTime, endTime);
+}
+
+
+void TimeHistoryChartWidget::updateChart(void)
+{
+    recordSeries.clear();
+    timeHistoryChart->removeAllSeries();
+
+    auto component = componentComboBox->currentIndex();
+
+    if(component < 0 || component >= componentPyramids.size())
+        return;
+
+    const auto& pyramids = componentPyramids.at(component);
+
+    startTime = 0.0;
+    endTime = 0.0;
+
+    auto minValue = 0.0;
+    auto maxValue = 0.0;
+
+    for(int i = 0; i<pyramids.size(); ++i)
+    {
+        const auto& pyramid = pyramids.at(i);
+
+        // Some records only have the horizontal components
+        if(pyramid.isEmpty())
+            continue;
+
+        auto factor = recordScalingFactors.at(i);
+
+        endTime = std::max(endTime, pyramid.getEndTime());
+        minValue = std::min(minValue, std::min(factor*pyramid.getMinimum(), factor*pyramid.getMaximum()));
+        maxValue = std::max(maxValue, std::max(factor*pyramid.getMinimum(), factor*pyramid.getMaximum()));
+
+        auto series = new QLineSeries();
+        series->setName(recordNames.at(i));
+
+        timeHistoryChart->addSeries(series);
+        series->attachAxis(axisX);
+        series->attachAxis(axisY);
+
+        recordSeries.push_back(series);
+    }
+
+    // The legend is of no use when many records are overlaid
+    timeHistoryChart->legend()->setVisible(recordSeries.size() <= 10);
+
+    auto margin = 0.05*std::max(maxValue - minValue, 1e-6);
+    axisY->setRange(minValue - margin, maxValue + margin);
+
+    timeHistoryChart->zoomReset();
+    axisX->setRange(startTime, std::max(endTime, startTime + 1.0));
+
+    // The series are also drawn when the time range changes, but not if the new range is the same as the previous one
+    this->updateSeries();
+}
+
+
+void TimeHistoryChartWidget::updateSeries(void)
+{
+    auto component = componentComboBox->currentIndex();
+
+    if(component < 0 || component >= componentPyramids.size())
+        return;
+
+    const auto& pyramids = componentPyramids.at(component);
+
+    auto fromTime = axisX->min();
+    auto toTime = axisX->max();
+
+    auto pixelWidth = static_cast<int>(std::ceil(timeHistoryChart->plotArea().width()));
+
+    int seriesIndex = 0;
+
+    for(int i = 0; i<pyramids.size() && seriesIndex < recordSeries.size(); ++i)
+    {
+        const auto& pyramid = pyramids.at(i);
+
+        if(pyramid.isEmpty())
+            continue;
+
+        auto points = pyramid.getPoints(fromTime, toTime, pixelWidth);
+
+        auto factor = recordScalingFactors.at(i);
+
+        if(factor != 1.0)
+        {
+            for(auto&& it : points)
+                it.setY(factor*it.y());
+        }
+
+        // Replacing all of the points at once redraws the series once
+        recordSeries.at(seriesIndex)->replace(points);
+
+        ++seriesIndex;
+    }
+}
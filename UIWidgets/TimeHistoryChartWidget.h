@@ -0,0 +1,111 @@
+#ifndef TIMEHISTORYCHARTWIDGET_H
+#define TIMEHISTORYCHARTWIDGET_H
+/* *****************************************************************************
+Copyright (c) 2016-2021, The Regents of the University of California (Regents).
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+The views and conclusions contained in the software and documentation are those
+of the authors and should not be interpreted as representing official policies,
+either expressed or implied, of the FreeBSD Project.
+
+REGENTS SPECIFICALLY DISCLAIMS ANY WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE.
+THE SOFTWARE AND ACCOMPANYING DOCUMENTATION, IF ANY, PROVIDED HEREUNDER IS
+PROVIDED "AS IS". REGENTS HAS NO OBLIGATION TO PROVIDE MAINTENANCE, SUPPORT,
+UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
+
+*************************************************************************** */
+
+// Written by: Stevan Gavrilovic
+
+#include "GroundMotionTimeHistory.h"
+#include "MinMaxPyramid.h"
+
+#include <QStringList>
+#include <QVector>
+#include <QWidget>
+
+class QComboBox;
+
+namespace QtCharts
+{
+class QChart;
+class QChartView;
+class QLineSeries;
+class QValueAxis;
+}
+
+// Overlay of the time histories of several ground motion records
+// A min/max pyramid of each component is built once when the records are set, and the series are redrawn from the level that matches the width of the plot whenever the view is zoomed, panned or resized
+// Scroll to zoom, drag to pan and double click to reset the view
+class TimeHistoryChartWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    TimeHistoryChartWidget(QWidget* parent);
+
+    // The scaling factors are in the order of the records, the records are not scaled if they are not given
+    void setTimeHistories(const QVector<GroundMotionTimeHistory>& records, const QVector<double>& scalingFactors = QVector<double>());
+
+    // The title of the vertical axis, e.g., Acceleration [g]
+    void setValueTitle(const QString& title);
+
+    void clear(void);
+
+    QtCharts::QChartView* getChartView() const;
+
+public slots:
+
+    void resetZoom(void);
+
+private slots:
+
+    void updateChart(void);
+
+    void updateSeries(void);
+
+private:
+
+    QStringList recordNames;
+
+    QVector<double> recordScalingFactors;
+
+    // The pyramids of each component, indexed by [component][record]
+    QVector<QVector<MinMaxPyramid>> componentPyramids;
+
+    QVector<QtCharts::QLineSeries*> recordSeries;
+
+    QComboBox* componentComboBox;
+
+    QtCharts::QChart* timeHistoryChart;
+    QtCharts::QChartView* timeHistoryChartView;
+
+    QtCharts::QValueAxis* axisX;
+    QtCharts::QValueAxis* axisY;
+
+    double startTime;
+    double endTime;
+};
+
+#endif // TIMEHISTORYCHARTWIDGET_H
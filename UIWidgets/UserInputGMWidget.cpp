@@ -37,7 +37,9 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 // Written by: Stevan Gavrilovic, Frank McKenna
 
 #include "CSVReaderWriter.h"
+#include "IntensityMeasureCalculator.h"
 #include "LayerTreeView.h"
+#include "TimeHistoryChartWidget.h"
 #include "UserInputGMWidget.h"
 #include "VisualizationWidget.h"
 #include "WorkflowAppR2D.h"
@@ -50,12 +52,13 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include "SimpleMarkerSymbol.h"
 #include "SimpleRenderer.h"
 
-#include <QApplication>
+#include <QComboBox>
 #include <QDialog>
 #include <QFile>
 #include <QFileDialog>
 #include <QFileInfo>
 #include <QGridLayout>
+#include <QHBoxLayout>
 #include <QLabel>
 #include <QLineEdit>
 #include <QProgressBar>
@@ -64,6 +67,10 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 #include <QStackedWidget>
 #include <QVBoxLayout>
 #include <QDir>
+#include <QHash>
+#include <QtConcurrent>
+
+#include <cmath>
 
 using namespace Esri::ArcGISRuntime;
 
@@ -74,20 +81,57 @@ UserInputGMWidget::UserInputGMWidget(VisualizationWidget* visWidget, QWidget *pa
     progressBarWidget = nullptr;
     userGMStackedWidget = nullptr;
     progressLabel = nullptr;
+    theTimeHistoryWidget = nullptr;
+    pendingTable = nullptr;
     eventFile = "";
     motionDir = "";
 
+    recordCache = std::make_shared<GroundMotionRecordCache>();
+
+    // Plot of the ground motions of a station once they are loaded
+    stationComboBox = new QComboBox(this);
+    stationComboBox->setSizeAdjustPolicy(QComboBox::AdjustToContents);
+
+    plotStationButton = new QPushButton(tr("Plot Ground Motions"), this);
+    plotStationButton->setEnabled(false);
+
+    connect(plotStationButton,&QPushButton::clicked,this,&UserInputGMWidget::plotStationGroundMotions);
+
+    auto plotLayout = new QHBoxLayout();
+    plotLayout->addWidget(new QLabel("Station:", this));
+    plotLayout->addWidget(stationComboBox);
+    plotLayout->addWidget(plotStationButton);
+    plotLayout->addStretch();
+
     QVBoxLayout *layout = new QVBoxLayout;
     layout->addWidget(this->getUserInputGMWidget());
+    layout->addLayout(plotLayout);
     layout->addStretch();
     this->setLayout(layout);
 
+    // The records are loaded on the worker threads, the progress bar follows the watchers
+    loadWatcher = new QFutureWatcher<void>(this);
+    measureWatcher = new QFutureWatcher<void>(this);
+
+    for(auto&& watcher : {loadWatcher, measureWatcher})
+    {
+        connect(watcher, &QFutureWatcher<void>::progressRangeChanged, progressBar, &QProgressBar::setRange);
+        connect(watcher, &QFutureWatcher<void>::progressValueChanged, progressBar, &QProgressBar::setValue);
+    }
+
+    connect(loadWatcher, &QFutureWatcher<void>::finished, this, &UserInputGMWidget::handleRecordsLoaded);
+    connect(measureWatcher, &QFutureWatcher<void>::finished, this, &UserInputGMWidget::handleMeasuresComputed);
 }
 
 
 UserInputGMWidget::~UserInputGMWidget()
 {
+    // The worker threads write to the members
+    loadWatcher->cancel();
+    measureWatcher->cancel();
 
+    loadWatcher->waitForFinished();
+    measureWatcher->waitForFinished();
 }
 
 
@@ -224,7 +268,7 @@ QStackedWidget* UserInputGMWidget::getUserInputGMWidget(void)
 
     QLabel* selectComponentsText = new QLabel("Event File Listing Motions");
     eventFileLineEdit = new QLineEdit();
-    QPushButton *browseFileButton = new QPushButton("Browse");
+    browseFileButton = new QPushButton("Browse");
 
     connect(browseFileButton,SIGNAL(clicked()),this,SLOT(chooseEventFileDialog()));
 
@@ -234,7 +278,7 @@ QStackedWidget* UserInputGMWidget::getUserInputGMWidget(void)
 
     QLabel* selectFolderText = new QLabel("Folder Containing Motions");
     motionDirLineEdit = new QLineEdit();
-    QPushButton *browseFolderButton = new QPushButton("Browse");
+    browseFolderButton = new QPushButton("Browse");
 
     connect(browseFolderButton,SIGNAL(clicked()),this,SLOT(chooseMotionDirDialog()));
 
@@ -295,6 +339,10 @@ void UserInputGMWidget::showUserGMSelectDialog(void)
 
 void UserInputGMWidget::loadUserGMData(void)
 {
+    // Only one set of records is loaded at a time
+    if(loadWatcher->isRunning() || measureWatcher->isRunning())
+        return;
+
     CSVReaderWriter csvTool;
 
     QString err;
@@ -312,51 +360,19 @@ void UserInputGMWidget::loadUserGMData(void)
     userGMStackedWidget->setCurrentWidget(progressBarWidget);
     progressBarWidget->setVisible(true);
 
-    QApplication::processEvents();
-
-    //progressBar->setRange(0,inputFiles.size());
-    progressBar->setRange(0, data.count());
-
-    progressBar->setValue(0);
-
-    // Create the table to store the fields
-    QList<Field> tableFields;
-    tableFields.append(Field::createText("AssetType", "NULL",4));
-    tableFields.append(Field::createText("TabName", "NULL",4));
-    tableFields.append(Field::createText("Station Name", "NULL",4));
-    tableFields.append(Field::createText("Latitude", "NULL",8));
-    tableFields.append(Field::createText("Longitude", "NULL",9));
-    tableFields.append(Field::createText("Number of Ground Motions","NULL",4));
-    tableFields.append(Field::createText("Ground Motions","",1));
-
-    auto gridFeatureCollection = new FeatureCollection(this);
-
-    // Create the feature collection table/layers
-    auto gridFeatureCollectionTable = new FeatureCollectionTable(tableFields, GeometryType::Point, SpatialReference::wgs84(), this);
-    gridFeatureCollection->tables()->append(gridFeatureCollectionTable);
-
-    auto gridLayer = new FeatureCollectionLayer(gridFeatureCollection,this);
-
-    // Create red cross SimpleMarkerSymbol
-    SimpleMarkerSymbol* crossSymbol = new SimpleMarkerSymbol(SimpleMarkerSymbolStyle::Cross, QColor("black"), 6, this);
-
-    // Create renderer and set symbol to crossSymbol
-    SimpleRenderer* renderer = new SimpleRenderer(crossSymbol, this);
-
-    // Set the renderer for the feature layer
-    gridFeatureCollectionTable->setRenderer(renderer);
-
-    // Set the scale at which the layer will become visible - if scale is too high, then the entire view will be filled with symbols
-    // gridLayer->setMinScale(80000);
+    this->setLoadControlsEnabled(false);
 
     // Pop off the row that contains the header information
     data.pop_front();
 
     auto numRows = data.size();
 
-    int count = 0;
+    // Read the list of records of each station first, the same record is typically assigned to many stations
+    pendingStations.clear();
+    pendingStationNames.clear();
+
+    QStringList recordFiles;
 
-    // Get the data
     for(int i = 0; i<numRows; ++i)
     {
         auto rowStr = data.at(i);
@@ -374,8 +390,7 @@ void UserInputGMWidget::loadUserGMData(void)
             QString errMsg = "Error longitude to a double, check the value";
             this->userMessageDialog(errMsg);
 
-            userGMStackedWidget->setCurrentWidget(fileInputWidget);
-            progressBarWidget->setVisible(false);
+            this->showFileInput();
 
             return;
         }
@@ -387,8 +402,7 @@ void UserInputGMWidget::loadUserGMData(void)
             QString errMsg = "Error latitude to a double, check the value";
             this->userMessageDialog(errMsg);
 
-            userGMStackedWidget->setCurrentWidget(fileInputWidget);
-            progressBarWidget->setVisible(false);
+            this->showFileInput();
 
             return;
         }
@@ -397,7 +411,7 @@ void UserInputGMWidget::loadUserGMData(void)
 
         try
         {
-            GMStation.importGroundMotions();
+            GMStation.readRecordList();
         }
         catch(QString msg)
         {
@@ -406,37 +420,146 @@ void UserInputGMWidget::loadUserGMData(void)
 
             this->userMessageDialog(errorMessage);
 
-            userGMStackedWidget->setCurrentWidget(fileInputWidget);
-            progressBarWidget->setVisible(false);
+            this->showFileInput();
 
             return;
         }
 
-        stationList.push_back(GMStation);
+        recordFiles.append(GMStation.getRecordFiles());
 
-        // create the feature attributes
-        QMap<QString, QVariant> featureAttributes;
+        pendingStations.push_back(GMStation);
+        pendingStationNames.append(stationName);
+    }
+
+    recordFiles.removeDuplicates();
+
+    pendingRecordFiles = recordFiles;
+
+    // Read the metadata of each unique record that is not already in the cache once, on the worker threads
+    newRecordFiles = recordCache->getNewRecordFiles(recordFiles);
+
+    auto numFiles = newRecordFiles.size();
+
+    pendingRecordIndices.resize(numFiles);
+    for(int i = 0; i<numFiles; ++i)
+        pendingRecordIndices[i] = i;
 
-        //  auto attrbText = GMStation.
-        //  auto attrbVal = pointData[i];
-        //  featureAttributes.insert(attrbText,attrbVal);
+    pendingRecordInfos = QVector<std::shared_ptr<GroundMotionRecordInfo>>(numFiles);
+    pendingErrors = QVector<QString>(numFiles);
 
-        auto vecGMs = GMStation.getStationGroundMotions();
-        featureAttributes.insert("Number of Ground Motions", vecGMs.size());
+    progressLabel->setText("Loading " + QString::number(numFiles) + " unique ground motion records");
 
+    auto files = newRecordFiles;
+    auto infosData = pendingRecordInfos.data();
+    auto errorsData = pendingErrors.data();
 
-        QString GMNames;
-        for(int i = 0; i<vecGMs.size(); ++i)
+    loadWatcher->setFuture(QtConcurrent::map(pendingRecordIndices, [files, infosData, errorsData](const int i)
+    {
+        auto info = std::make_shared<GroundMotionRecordInfo>();
+
+        if(GroundMotionRecordCache::readRecordInfo(files.at(i), *info, errorsData[i]) == 0)
+            infosData[i] = std::move(info);
+    }));
+}
+
+
+void UserInputGMWidget::handleRecordsLoaded(void)
+{
+    if(loadWatcher->isCanceled() || pendingStations.isEmpty())
+        return;
+
+    // Keep the records that were read, and report the first file that failed
+    QString loadErrMsg;
+
+    for(int i = 0; i<newRecordFiles.size(); ++i)
+    {
+        if(pendingRecordInfos.at(i))
+            recordCache->insertRecordInfo(newRecordFiles.at(i), pendingRecordInfos.at(i));
+        else if(loadErrMsg.isEmpty())
+            loadErrMsg = pendingErrors.at(i);
+    }
+
+    pendingRecordInfos.clear();
+    pendingErrors.clear();
+
+    if(!loadErrMsg.isEmpty())
+    {
+        auto errorMessage = "Error importing ground motion file: " + loadErrMsg;
+
+        this->userMessageDialog(errorMessage);
+
+        this->showFileInput();
+
+        return;
+    }
+
+    // Create the table to store the fields
+    QList<Field> tableFields;
+    tableFields.append(Field::createText("AssetType", "NULL",4));
+    tableFields.append(Field::createText("TabName", "NULL",4));
+    tableFields.append(Field::createText("Station Name", "NULL",4));
+    tableFields.append(Field::createText("Latitude", "NULL",8));
+    tableFields.append(Field::createText("Longitude", "NULL",9));
+    tableFields.append(Field::createText("Number of Ground Motions","NULL",4));
+    tableFields.append(Field::createText("Ground Motions","",1));
+
+    // The intensity measures of the station, averaged over its scaled records, they are filled in once they are computed
+    for(auto&& it : IntensityMeasureCalculator::getIntensityMeasureNames())
+        tableFields.append(Field::createDouble(it, "NULL"));
+
+    auto gridFeatureCollection = new FeatureCollection(this);
+
+    // Create the feature collection table/layers
+    auto gridFeatureCollectionTable = new FeatureCollectionTable(tableFields, GeometryType::Point, SpatialReference::wgs84(), this);
+    gridFeatureCollection->tables()->append(gridFeatureCollectionTable);
+
+    auto gridLayer = new FeatureCollectionLayer(gridFeatureCollection,this);
+
+    // Create red cross SimpleMarkerSymbol
+    SimpleMarkerSymbol* crossSymbol = new SimpleMarkerSymbol(SimpleMarkerSymbolStyle::Cross, QColor("black"), 6, this);
+
+    // Create renderer and set symbol to crossSymbol
+    SimpleRenderer* renderer = new SimpleRenderer(crossSymbol, this);
+
+    // Set the renderer for the feature layer
+    gridFeatureCollectionTable->setRenderer(renderer);
+
+    // Set the scale at which the layer will become visible - if scale is too high, then the entire view will be filled with symbols
+    // gridLayer->setMinScale(80000);
+
+    pendingFeatures.clear();
+
+    for(int i = 0; i<pendingStations.size(); ++i)
+    {
+        auto& GMStation = pendingStations[i];
+
+        auto stationName = pendingStationNames.at(i);
+
+        try
         {
-            auto GMName = vecGMs.at(i).getName();
+            GMStation.importGroundMotions(recordCache);
+        }
+        catch(QString msg)
+        {
+
+            auto errorMessage = "Error importing ground motion file: " + stationName+"\n"+msg;
+
+            this->userMessageDialog(errorMessage);
 
-            GMNames.append(GMName);
+            pendingFeatures.clear();
 
-            if(i != vecGMs.size()-1)
-                GMNames.append(", ");
+            this->showFileInput();
 
+            return;
         }
 
+        // create the feature attributes
+        QMap<QString, QVariant> featureAttributes;
+
+        featureAttributes.insert("Number of Ground Motions", GMStation.getNumberOfGroundMotions());
+
+        QString GMNames = GMStation.getGroundMotionNames().join(", ");
+
         featureAttributes.insert("Station Name", stationName);
         featureAttributes.insert("Ground Motions", GMNames);
         featureAttributes.insert("AssetType", "GroundMotionGridPoint");
@@ -454,13 +577,18 @@ void UserInputGMWidget::loadUserGMData(void)
 
         gridFeatureCollectionTable->addFeature(feature);
 
+        pendingFeatures.push_back(feature);
+    }
 
-        ++count;
-        progressLabel->clear();
-        progressBar->setValue(count);
+    stationList.append(pendingStations);
 
-        QApplication::processEvents();
-    }
+    progressLabel->clear();
+
+    stationComboBox->clear();
+    for(auto&& it : stationList)
+        stationComboBox->addItem(QFileInfo(it.getStationFilePath()).fileName());
+
+    plotStationButton->setEnabled(!stationList.isEmpty());
 
     // Create a new layer
     auto layersTreeView = theVisualizationWidget->getLayersTree();
@@ -481,8 +609,11 @@ void UserInputGMWidget::loadUserGMData(void)
     // Add the event layer to the map
     theVisualizationWidget->addLayerToMap(gridLayer,eventItem);
 
-    // Reset the widget back to the input pane and close
+    pendingTable = gridFeatureCollectionTable;
+
+    // Reset the widget back to the input pane and close, a new load can start once the intensity measures are computed
     userGMStackedWidget->setCurrentWidget(fileInputWidget);
+    progressBarWidget->setVisible(false);
     fileInputWidget->setVisible(true);
 
     if(userGMStackedWidget->isModal())
@@ -492,7 +623,156 @@ void UserInputGMWidget::loadUserGMData(void)
 
     emit outputDirectoryPathChanged(motionDir, eventFile);
 
-    return;
+    // Compute the intensity measures of each unique record in the background, the resident time histories are taken from the cache and the others are read without being kept in it
+    auto numFiles = pendingRecordFiles.size();
+
+    pendingRecordIndices.resize(numFiles);
+    for(int i = 0; i<numFiles; ++i)
+        pendingRecordIndices[i] = i;
+
+    pendingMeasures = QVector<RecordIntensityMeasures>(numFiles);
+    pendingErrors = QVector<QString>(numFiles);
+
+    auto files = pendingRecordFiles;
+    auto cache = recordCache;
+    auto measuresData = pendingMeasures.data();
+    auto errorsData = pendingErrors.data();
+
+    IntensityMeasureCalculator measureCalculator;
+
+    WorkflowAppR2D::getInstance()->statusMessage("Computing the intensity measures of " + QString::number(numFiles) + " ground motion records");
+
+    measureWatcher->setFuture(QtConcurrent::map(pendingRecordIndices, [files, cache, measuresData, errorsData, measureCalculator](const int i)
+    {
+        auto record = cache->peekRecord(files.at(i), errorsData[i]);
+
+        if(record == nullptr)
+            return;
+
+        measureCalculator.computeIntensityMeasures(*record, measuresData[i], errorsData[i]);
+    }));
+}
+
+
+void UserInputGMWidget::handleMeasuresComputed(void)
+{
+    if(measureWatcher->isCanceled() || pendingStations.isEmpty())
+        return;
+
+    QHash<QString, int> recordIndex;
+    for(int i = 0; i<pendingRecordFiles.size(); ++i)
+        recordIndex.insert(pendingRecordFiles.at(i), i);
+
+    auto measureNames = IntensityMeasureCalculator::getIntensityMeasureNames();
+
+    for(int i = 0; i<pendingStations.size() && i<pendingFeatures.size(); ++i)
+    {
+        const auto& GMStation = pendingStations.at(i);
+
+        // The mean of the geometric mean of the horizontal components over the records of the station, each record multiplied by its scaling factor
+        auto stationRecordFiles = GMStation.getRecordFiles();
+        auto scalingFactors = GMStation.getScalingFactors();
+
+        QVector<double> measureSums(measureNames.size(), 0.0);
+        QVector<int> measureCounts(measureNames.size(), 0);
+
+        for(int j = 0; j<stationRecordFiles.size(); ++j)
+        {
+            const auto& measures = pendingMeasures.at(recordIndex.value(stationRecordFiles.at(j)));
+
+            auto scaled = IntensityMeasureCalculator::scale(IntensityMeasureCalculator::horizontalGeometricMean(measures), scalingFactors.at(j));
+
+            auto values = IntensityMeasureCalculator::toVector(scaled);
+
+            for(int k = 0; k<values.size(); ++k)
+            {
+                if(std::isnan(values.at(k)))
+                    continue;
+
+                measureSums[k] += values.at(k);
+                ++measureCounts[k];
+            }
+        }
+
+        auto feature = pendingFeatures.at(i);
+
+        for(int k = 0; k<measureNames.size(); ++k)
+        {
+            if(measureCounts.at(k) > 0)
+                feature->attributes()->replaceAttribute(measureNames.at(k), measureSums.at(k)/measureCounts.at(k));
+        }
+
+        pendingTable->updateFeature(feature);
+    }
+
+    // The records that failed keep NaN measures and are left out of the means, the first error is reported
+    QString errMsg;
+
+    for(auto&& it : pendingErrors)
+    {
+        if(!it.isEmpty())
+        {
+            errMsg = it;
+            break;
+        }
+    }
+
+    pendingStations.clear();
+    pendingStationNames.clear();
+    pendingFeatures.clear();
+    pendingTable = nullptr;
+    pendingMeasures.clear();
+    pendingErrors.clear();
+
+    this->setLoadControlsEnabled(true);
+
+    if(!errMsg.isEmpty())
+        this->userMessageDialog("Error computing the intensity measures: " + errMsg);
+    else
+        WorkflowAppR2D::getInstance()->statusMessage("The intensity measures of the ground motions are computed");
+}
+
+
+void UserInputGMWidget::showFileInput(void)
+{
+    userGMStackedWidget->setCurrentWidget(fileInputWidget);
+    progressBarWidget->setVisible(false);
+
+    this->setLoadControlsEnabled(true);
+}
+
+
+void UserInputGMWidget::setLoadControlsEnabled(const bool value)
+{
+    eventFileLineEdit->setEnabled(value);
+    motionDirLineEdit->setEnabled(value);
+    browseFileButton->setEnabled(value);
+    browseFolderButton->setEnabled(value);
+}
+
+
+void UserInputGMWidget::cancelLoading(void)
+{
+    // The worker threads write to the pending vectors, so they are stopped before the vectors are cleared
+    loadWatcher->cancel();
+    measureWatcher->cancel();
+
+    loadWatcher->waitForFinished();
+    measureWatcher->waitForFinished();
+
+    pendingStations.clear();
+    pendingStationNames.clear();
+    pendingRecordFiles.clear();
+    newRecordFiles.clear();
+    pendingRecordIndices.clear();
+    pendingRecordInfos.clear();
+    pendingMeasures.clear();
+    pendingErrors.clear();
+    pendingFeatures.clear();
+    pendingTable = nullptr;
+
+    if(userGMStackedWidget)
+        this->showFileInput();
 }
 
 
@@ -613,6 +893,8 @@ void UserInputGMWidget::chooseMotionDirDialog(void)
 
 void UserInputGMWidget::clear(void)
 {
+    this->cancelLoading();
+
     eventFile.clear();
     motionDir.clear();
 
@@ -620,4 +902,57 @@ void UserInputGMWidget::clear(void)
     motionDirLineEdit->clear();
 
     stationList.clear();
+
+    stationComboBox->clear();
+    plotStationButton->setEnabled(false);
+
+    if(theTimeHistoryWidget != nullptr)
+    {
+        theTimeHistoryWidget->clear();
+        theTimeHistoryWidget->close();
+    }
+
+    // The stations that are still held elsewhere keep the previous cache
+    recordCache = std::make_shared<GroundMotionRecordCache>();
+}
+
+
+void UserInputGMWidget::plotStationGroundMotions(void)
+{
+    auto index = stationComboBox->currentIndex();
+
+    if(index < 0 || index >= stationList.size())
+        return;
+
+    const auto& station = stationList.at(index);
+
+    // The time histories are read from the record cache, only the summary of each record is drawn
+    QVector<GroundMotionTimeHistory> records;
+
+    try
+    {
+        records = station.getStationGroundMotions();
+    }
+    catch(QString msg)
+    {
+        this->userMessageDialog("Error reading the ground motions of the station " + stationComboBox->currentText() + "\n" + msg);
+        return;
+    }
+
+    if(theTimeHistoryWidget == nullptr)
+    {
+        theTimeHistoryWidget = new TimeHistoryChartWidget(this);
+        theTimeHistoryWidget->setWindowFlags(Qt::Window);
+        theTimeHistoryWidget->resize(800, 500);
+    }
+
+    if(station.getNumberOfGroundMotions() > 0)
+        theTimeHistoryWidget->setValueTitle("Acceleration [" + station.getGroundMotionInfo(0)->units + "]");
+
+    theTimeHistoryWidget->setWindowTitle("Ground Motions of " + stationComboBox->currentText());
+    theTimeHistoryWidget->setTimeHistories(records, station.getScalingFactors());
+
+    theTimeHistoryWidget->show();
+    theTimeHistoryWidget->raise();
+    theTimeHistoryWidget->activateWindow();
 }
@@ -39,14 +39,20 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 // Written by: Stevan Gavrilovic, Frank McKenna
 
 #include "GroundMotionStation.h"
+#include "IntensityMeasureCalculator.h"
 #include "SimCenterAppWidget.h"
 
 #include <memory>
 
+#include <QFutureWatcher>
 #include <QMap>
 
 class VisualizationWidget;
 
+class TimeHistoryChartWidget;
+
+class QComboBox;
+class QPushButton;
 class QStackedWidget;
 class QLineEdit;
 class QProgressBar;
@@ -57,6 +63,8 @@ namespace Esri
 namespace ArcGISRuntime
 {
 class ArcGISMapImageLayer;
+class Feature;
+class FeatureCollectionTable;
 class GroupLayer;
 class FeatureCollectionLayer;
 class KmlLayer;
@@ -93,12 +101,30 @@ private slots:
     void chooseEventFileDialog(void);
     void chooseMotionDirDialog(void);
 
+    // Overlays the time histories of the records of the selected station
+    void plotStationGroundMotions(void);
+
+    // Creates the stations and their layer once the metadata of their records is read on the worker threads, then computes the intensity measures in the background
+    void handleRecordsLoaded(void);
+
+    // Sets the intensity measures of the stations in their features once they are computed
+    void handleMeasuresComputed(void);
+
 signals:
     void outputDirectoryPathChanged(QString motionDir, QString eventFile);
     void loadingComplete(const bool value);
 
 private:
 
+    // Puts the dialog back to the file input pane and enables the controls that start a load
+    void showFileInput(void);
+
+    // The controls that start a new load are disabled while the records are loaded
+    void setLoadControlsEnabled(const bool value);
+
+    // Stops the loading that is running, e.g., when the widget is cleared
+    void cancelLoading(void);
+
     std::unique_ptr<QStackedWidget> userGMStackedWidget;
 
     VisualizationWidget* theVisualizationWidget;
@@ -109,6 +135,9 @@ private:
     QLineEdit *eventFileLineEdit;
     QLineEdit *motionDirLineEdit;
 
+    QPushButton* browseFileButton;
+    QPushButton* browseFolderButton;
+
     QLabel* progressLabel;
     QWidget* progressBarWidget;
     QWidget* fileInputWidget;
@@ -116,6 +145,36 @@ private:
 
     QVector<GroundMotionStation> stationList;
 
+    // The stations in the order of the station list
+    QComboBox* stationComboBox;
+    QPushButton* plotStationButton;
+
+    TimeHistoryChartWidget* theTimeHistoryWidget;
+
+    // The records that are shared by the stations
+    std::shared_ptr<GroundMotionRecordCache> recordCache;
+
+    // The stations that are being loaded, and the unique records that they need
+    QVector<GroundMotionStation> pendingStations;
+    QStringList pendingStationNames;
+    QStringList pendingRecordFiles;
+
+    // The records that are not already in the cache, only their metadata is read
+    QStringList newRecordFiles;
+
+    // Each record is read into its own slot on the worker threads, the watchers report the progress and the end of the loading
+    QVector<int> pendingRecordIndices;
+    QVector<std::shared_ptr<GroundMotionRecordInfo>> pendingRecordInfos;
+    QVector<RecordIntensityMeasures> pendingMeasures;
+    QVector<QString> pendingErrors;
+
+    // The features of the stations that wait for their intensity measures
+    QVector<Esri::ArcGISRuntime::Feature*> pendingFeatures;
+    Esri::ArcGISRuntime::FeatureCollectionTable* pendingTable;
+
+    QFutureWatcher<void>* loadWatcher;
+    QFutureWatcher<void>* measureWatcher;
+
 };
 
 #endif // UserInputGMWidget_H
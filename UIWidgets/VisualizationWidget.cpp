@@ -37,7 +37,11 @@ UPDATES, ENHANCEMENTS, OR MODIFICATIONS.
 // Written by: Stevan Gavrilovic, Frank McKenna
 
 #include "ComponentInputWidget.h"
+#include "DMResultsProcessor.h"
+#include "EDPResultsProcessor.h"
+#include "GroupByEngine.h"
 #include "PopUpWidget.h"
+#include "RealizationFields.h"
 #include "SimCenterMapGraphicsView.h"
 #include "LayerTreeItem.h"
 #include "LayerTreeView.h"
@@ -455,6 +459,18 @@ void VisualizationWidget::loadBuildingData(void)
 
     QList<Field> fields;
     fields.append(Field::createDouble("LossRatio", "0.0"));
+
+    // The summary columns of the realization level results
+    QStringList summaryFields;
+    for(auto&& it : RealizationFields::results)
+        summaryFields += RealizationFields::getSummaryFields(it);
+
+    // The peak demands and the damage of the assets
+    summaryFields += EDPResultsProcessor::getDemandFields() + DMResultsProcessor::getDamageFields();
+
+    for(auto&& it : summaryFields)
+        fields.append(Field::createDouble(it, "0.0"));
+
     fields.append(Field::createText("ID", "NULL",4));
     fields.append(Field::createText("AssetType", "NULL",4));
     fields.append(Field::createText("TabName", "NULL",4));
@@ -490,16 +506,12 @@ void VisualizationWidget::loadBuildingData(void)
 
     auto nRows = buildingTableWidget->rowCount();
 
-    std::vector<std::string> vecLayerItems;
+    // Organize the layers according to occupancy type, the distinct types are the dictionary of the encoded column
+    QStringList occupancyTypes;
     for(int i = 0; i<nRows; ++i)
-    {
-        // Organize the layers according to occupancy type
-        auto occupancyType = buildingTableWidget->item(i,columnToMapLayers)->data(0).toString().toStdString();
+        occupancyTypes.append(buildingTableWidget->item(i,columnToMapLayers)->data(0).toString());
 
-        vecLayerItems.push_back(occupancyType);
-    }
-
-    this->uniqueVec<std::string>(vecLayerItems);
+    auto layerColumn = DictionaryColumn::encode(columnFilter, occupancyTypes);
 
     auto selectedBuildingsFeatureCollection = new FeatureCollection(this);
     selectedBuildingsTable = new FeatureCollectionTable(fields, GeometryType::Point, SpatialReference::wgs84(),this);
@@ -507,9 +519,9 @@ void VisualizationWidget::loadBuildingData(void)
     selectedBuildingsLayer = new FeatureCollectionLayer(selectedBuildingsFeatureCollection,this);
     selectedBuildingsTable->setRenderer(this->createBuildingRenderer());
 
-    // Map to hold the feature tables
-    std::map<std::string, FeatureCollectionTable*> tablesMap;
-    for(auto&& it : vecLayerItems)
+    // The feature table of each code of the layer column
+    QVector<FeatureCollectionTable*> layerTables;
+    for(auto&& it : layerColumn.dictionary)
     {
         auto featureCollection = new FeatureCollection(this);
 
@@ -519,19 +531,19 @@ void VisualizationWidget::loadBuildingData(void)
 
         auto newBuildingLayer = new FeatureCollectionLayer(featureCollection,this);
 
-        newBuildingLayer->setName(QString::fromStdString(it));
+        newBuildingLayer->setName(it);
 
         buildingLayer->layers()->append(newBuildingLayer);
 
         featureCollectionTable->setRenderer(this->createBuildingRenderer());
 
-        tablesMap.insert(std::make_pair(it,featureCollectionTable));
+        layerTables.push_back(featureCollectionTable);
 
         auto layerID = this->createUniqueID();
 
         newBuildingLayer->setLayerId(layerID);
 
-        layersTree->addItemToTree(QString::fromStdString(it), layerID, buildingsItem);
+        layersTree->addItemToTree(it, layerID, buildingsItem);
     }
 
     for(int i = 0; i<nRows; ++i)
@@ -572,13 +584,15 @@ void VisualizationWidget::loadBuildingData(void)
         featureAttributes.insert("TabName", buildingIDStr);
         featureAttributes.insert("UID", uid);
 
+        // The results are null until they are loaded, so that an asset without results is not shown as having no loss
+        for(auto&& it : summaryFields)
+            featureAttributes.insert(it, QVariant());
+
         auto latitude = buildingTableWidget->item(i,1)->data(0).toDouble();
         auto longitude = buildingTableWidget->item(i,2)->data(0).toDouble();
 
         // Get the feature collection table for this layer
-        auto layerTag = buildingTableWidget->item(i,columnToMapLayers)->data(0).toString().toStdString();
-
-        auto featureCollectionTable = tablesMap.at(layerTag);
+        auto featureCollectionTable = layerTables.at(layerColumn.codes.at(i));
 
         // Create the point and add it to the feature table
         Point point(longitude,latitude);
@@ -650,21 +664,16 @@ void VisualizationWidget::loadPipelineData(void)
     // Select a column that will define the layers
     int columnToMapLayers = 0;
 
-    std::vector<std::string> vecLayerItems;
+    QStringList layerTags;
     for(int i = 0; i<nRows; ++i)
-    {
-        // Organize the layers according to occupancy type
-        auto layerTag = pipelineTableWidget->item(i,columnToMapLayers)->data(0).toString().toStdString();
+        layerTags.append(pipelineTableWidget->item(i,columnToMapLayers)->data(0).toString());
 
-        vecLayerItems.push_back(layerTag);
-    }
-
-    this->uniqueVec<std::string>(vecLayerItems);
+    auto layerColumn = DictionaryColumn::encode(pipelineTableWidget->horizontalHeaderItem(columnToMapLayers)->text(), layerTags);
 
-    // Map to hold the feature tables
-    std::map<std::string, FeatureCollectionTable*> tablesMap;
+    // The feature table of each code of the layer column
+    QVector<FeatureCollectionTable*> layerTables;
 
-    for(auto&& it : vecLayerItems)
+    for(auto&& it : layerColumn.dictionary)
     {
         auto featureCollection = new FeatureCollection(this);
 
@@ -674,19 +683,19 @@ void VisualizationWidget::loadPipelineData(void)
 
         auto newpipelineLayer = new FeatureCollectionLayer(featureCollection,this);
 
-        newpipelineLayer->setName(QString::fromStdString(it));
+        newpipelineLayer->setName(it);
 
         pipelineLayer->layers()->append(newpipelineLayer);
 
         featureCollectionTable->setRenderer(this->createPipelineRenderer());
 
-        tablesMap.insert(std::make_pair(it,featureCollectionTable));
+        layerTables.push_back(featureCollectionTable);
 
         auto layerID = this->createUniqueID();
 
         newpipelineLayer->setLayerId(layerID);
 
-        layersTree->addItemToTree(QString::fromStdString(it), layerID ,pipelinesItem);
+        layersTree->addItemToTree(it, layerID ,pipelinesItem);
     }
 
     for(int i = 0; i<nRows; ++i)
@@ -723,10 +732,8 @@ void VisualizationWidget::loadPipelineData(void)
         featureAttributes.insert("AssetType", "PIPELINE");
         featureAttributes.insert("TabName", pipelineTableWidget->item(i,0)->data(0).toString());
 
-        // Get the feature collection table from the map
-        auto layerTag = pipelineTableWidget->item(i,columnToMapLayers)->data(0).toString().toStdString();
-
-        auto featureCollectionTable = tablesMap.at(layerTag);
+        // Get the feature collection table for this layer
+        auto featureCollectionTable = layerTables.at(layerColumn.codes.at(i));
 
         auto latitudeStart = pipelineTableWidget->item(i,3)->data(0).toDouble();
         auto longitudeStart = pipelineTableWidget->item(i,4)->data(0).toDouble();
@@ -1892,19 +1899,6 @@ FeatureCollectionLayer* VisualizationWidget::createAndAddXMLShakeMapLayer(const
 }
 
 
-template <typename T>
-void VisualizationWidget::uniqueVec(std::vector<T>& vec)
-{
-    std::sort(vec.begin(), vec.end());
-
-    // Using std::unique to get the unique items in the vector
-    auto ip = std::unique(vec.begin(), vec.end());
-
-    // Resizing the vector so as to remove the terms that became undefined after the unique operation
-    vec.resize(std::distance(vec.begin(), ip));
-}
-
-
 double VisualizationWidget::getLatFromScreenPoint(const QPointF& point)
 {
     auto mapPoint = mapViewWidget->screenToLocation(point.x(),point.y());
@@ -245,10 +245,6 @@ private:
     // Map to store the selected features according to their UID
     QMap<QString, Esri::ArcGISRuntime::Feature*> selectedFeatures;
 
-    // Returns a vector of sorted items that are unique
-    template <typename T>
-    void uniqueVec(std::vector<T>& vec);
-
     // The GIS widget
     QWidget* visWidget;
     void createVisualizationWidget(void);
@@ -513,9 +513,13 @@ void WorkflowAppR2D::setUpForApplicationRun(QString &workingDir, QString &subDir
     QString tmpDirectory = workDir.absoluteFilePath(tmpDirName);
     QDir destinationDirectory(tmpDirectory);
 
+    // Release the files of the last run that are still open before its folder is removed
+    theResultsWidget->prepareForRun(tmpDirectory);
+
     if(destinationDirectory.exists())
     {
-        destinationDirectory.removeRecursively();
+        if(!destinationDirectory.removeRecursively())
+            errorMessage("Could not remove all of the files of the last run in " + tmpDirectory);
     }
     else
         destinationDirectory.mkpath(tmpDirectory);
@@ -565,6 +569,9 @@ void WorkflowAppR2D::setUpForApplicationRun(QString &workingDir, QString &subDir
     file.close();
 
 
+    // Show the results as the workflow writes them, the old results were released before the run folder was removed above
+    theResultsWidget->watchResults(tmpDirectory + QDir::separator() + "Results");
+
     statusMessage("SetUp Done .. Now starting application");
 
     emit setUpForApplicationRunDone(tmpDirectory, inputFile);